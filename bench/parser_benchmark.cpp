@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "cpp_parser.h"
+
+namespace {
+
+// Slowest acceptable parse of the generated source. Well below what the
+// lexer manages, so only a real regression (a per-token scan, a graph or
+// symbol table built on every parse) trips it.
+constexpr double kMinimumLinesPerSecond = 300000.0;
+
+// classCount classes, each with a declared and out-of-class defined get()
+// and put() and eight free helpers: about 60 lines and 10 functions a class
+std::string buildCppSource(int classCount) {
+    std::string source = "#include <vector>\nnamespace app {\n\n";
+    for (int c = 0; c < classCount; ++c) {
+        const std::string name = "Store" + std::to_string(c);
+        source += "class " + name + " : public Base {\npublic:\n    int get(int id) const;\n"
+                  "    void put(int id, const std::string& value);\nprivate:\n    std::vector<int> items_;\n};\n\n";
+        source += "int " + name + "::get(int id) const {\n    if (id < 0) {\n        return fallback(id);\n    }\n"
+                  "    return items_[id] + lookup(id, 2);\n}\n\n";
+        source += "void " + name + "::put(int id, const std::string& value) {\n    items_[id] = value.size();\n"
+                  "    this->get(id);\n    log(\"put\", id);\n}\n\n";
+        for (int f = 0; f < 8; ++f) {
+            source += "static int helper" + std::to_string(c) + "_" + std::to_string(f) +
+                      "(int x) {\n    // " + std::to_string(f) + " times\n    return compute(x) * " +
+                      std::to_string(f) + ";\n}\n\n";
+        }
+    }
+    return source + "} // namespace app\n";
+}
+
+void BM_ParseCpp(benchmark::State& state) {
+    const std::string source = buildCppSource(static_cast<int>(state.range(0)));
+    const double lines = static_cast<double>(std::count(source.begin(), source.end(), '\n'));
+    CppParser parser;
+    double fastest = 0.0;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        bool parsed = parser.parseFile(source);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        benchmark::DoNotOptimize(parsed);
+        fastest = fastest == 0.0 ? elapsed.count() : std::min(fastest, elapsed.count());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(source.size() * state.iterations()));
+    state.counters["lines"] = lines;
+    state.counters["functions"] = static_cast<double>(parser.getFunctions().size());
+    state.counters["lines_per_second"] = benchmark::Counter(lines * state.iterations(), benchmark::Counter::kIsRate);
+    if (fastest > 0.0 && lines / fastest < kMinimumLinesPerSecond) {
+        state.SkipWithError(("parse throughput " + std::to_string(static_cast<long>(lines / fastest)) +
+                             " lines/s is below the minimum of " +
+                             std::to_string(static_cast<long>(kMinimumLinesPerSecond)))
+                                .c_str());
+    }
+}
+
+} // namespace
+
+// About 60k lines and 10k functions
+BENCHMARK(BM_ParseCpp)->Arg(1000)->Unit(benchmark::kMillisecond);
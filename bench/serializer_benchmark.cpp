@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include "xml_node.h"
+#include "xml_serializer.h"
+
+namespace {
+
+using Format = XmlSerializer::Format;
+using OutputStyle = XmlSerializer::OutputStyle;
+
+// A record-oriented document: <records><record id=".." type=".."><name>..</name>...</record>...
+std::shared_ptr<XmlNode> buildDocument(int recordCount) {
+    auto root = std::make_shared<XmlNode>("records");
+    for (int i = 0; i < recordCount; ++i) {
+        auto record = std::make_shared<XmlNode>("record");
+        root->addChild(record);
+        record->addAttribute("id", std::to_string(i));
+        record->addAttribute("type", (i % 3 == 0) ? "order" : "invoice");
+        
+        const char* fields[] = {"name", "price", "note"};
+        for (const char* field : fields) {
+            auto element = std::make_shared<XmlNode>(field);
+            record->addChild(element);
+            auto text = std::make_shared<XmlNode>("", XmlNode::NodeType::Text);
+            text->setValue(std::string(field) + " \"" + std::to_string(i * 7) + "\" & more");
+            element->addChild(text);
+        }
+    }
+    return root;
+}
+
+const std::shared_ptr<XmlNode>& sharedDocument() {
+    static const std::shared_ptr<XmlNode> document = buildDocument(20000);
+    return document;
+}
+
+template <Format F, OutputStyle S>
+void BM_Serialize(benchmark::State& state) {
+    XmlSerializer serializer;
+    const auto& document = sharedDocument();
+    size_t bytes = 0;
+    size_t outputSize = 0;
+    for (auto _ : state) {
+        std::string out = serializer.serialize(document, F, S);
+        bytes += out.size();
+        outputSize = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["output_bytes"] = static_cast<double>(outputSize);
+}
+
+// Decode speed of the binary formats, reported against the encoded size
+template <Format F>
+void BM_Deserialize(benchmark::State& state) {
+    XmlSerializer serializer;
+    const std::string encoded = serializer.serialize(sharedDocument(), F);
+    for (auto _ : state) {
+        auto node = (F == Format::CBOR) ? serializer.deserializeFromCbor(encoded)
+                                        : serializer.deserializeFromMessagePack(encoded);
+        benchmark::DoNotOptimize(node.get());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(encoded.size() * state.iterations()));
+}
+
+template <Format F, OutputStyle S>
+void BM_SerializeParallel(benchmark::State& state) {
+    XmlSerializer serializer;
+    const auto& document = sharedDocument();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string out = serializer.serializeParallel(document, F, S);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// Re-export after touching one record: only that record's fragment is rebuilt
+template <Format F, OutputStyle S>
+void BM_SerializeIncremental(benchmark::State& state) {
+    XmlSerializer serializer;
+    auto document = buildDocument(20000);
+    serializer.serializeIncremental(document, F, S);
+    size_t bytes = 0;
+    int edit = 0;
+    for (auto _ : state) {
+        document->getChildren()[edit % 20000]->addAttribute("edited", std::to_string(edit));
+        ++edit;
+        std::string out = serializer.serializeIncremental(document, F, S);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::XML, OutputStyle::Compact);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::XML, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::XML, OutputStyle::Minified);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::JSON, OutputStyle::Compact);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::JSON, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::JSON, OutputStyle::Minified);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::YAML, OutputStyle::Compact);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::YAML, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::YAML, OutputStyle::Minified);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::CBOR, OutputStyle::Compact);
+BENCHMARK_TEMPLATE2(BM_Serialize, Format::MessagePack, OutputStyle::Compact);
+
+BENCHMARK_TEMPLATE(BM_Deserialize, Format::CBOR);
+BENCHMARK_TEMPLATE(BM_Deserialize, Format::MessagePack);
+
+BENCHMARK_TEMPLATE2(BM_SerializeParallel, Format::XML, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_SerializeParallel, Format::JSON, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_SerializeParallel, Format::YAML, OutputStyle::Pretty);
+
+BENCHMARK_TEMPLATE2(BM_SerializeIncremental, Format::XML, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_SerializeIncremental, Format::JSON, OutputStyle::Pretty);
+BENCHMARK_TEMPLATE2(BM_SerializeIncremental, Format::YAML, OutputStyle::Pretty);
+
+BENCHMARK_MAIN();
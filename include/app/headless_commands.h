@@ -0,0 +1,10 @@
+#ifndef HEADLESS_COMMANDS_H
+#define HEADLESS_COMMANDS_H
+
+// Command-line operations that run without creating the GUI, e.g.
+//   Nexus --convert huge.xml out.json [--format json|yaml|csv|cbor|msgpack] [--style pretty|compact|minified]
+// Returns true when argv names a headless command; exitCode then holds the
+// process exit status and the caller should return it from main().
+bool runHeadlessCommand(int argc, char* argv[], int& exitCode);
+
+#endif // HEADLESS_COMMANDS_H
@@ -0,0 +1,186 @@
+#ifndef BINARY_FORMATS_H
+#define BINARY_FORMATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Low-level CBOR (RFC 8949) and MessagePack primitives. Only the types the
+// XmlNode mapping needs are produced (maps, arrays, UTF-8 strings, null); the
+// readers accept any well-formed item so unknown members can be skipped.
+
+struct CborEncoder {
+    static void head(std::string& out, uint8_t major, uint64_t value) {
+        major = static_cast<uint8_t>(major << 5);
+        if (value < 24) {
+            out += static_cast<char>(major | value);
+        } else if (value <= 0xff) {
+            out += static_cast<char>(major | 24);
+            out += static_cast<char>(value);
+        } else if (value <= 0xffff) {
+            out += static_cast<char>(major | 25);
+            appendBigEndian(out, value, 2);
+        } else if (value <= 0xffffffffULL) {
+            out += static_cast<char>(major | 26);
+            appendBigEndian(out, value, 4);
+        } else {
+            out += static_cast<char>(major | 27);
+            appendBigEndian(out, value, 8);
+        }
+    }
+
+    static void string(std::string& out, const char* data, size_t size) {
+        head(out, 3, size);
+        out.append(data, size);
+    }
+    static void string(std::string& out, const std::string& value) {
+        string(out, value.data(), value.size());
+    }
+    static void nil(std::string& out) { out += static_cast<char>(0xf6); }
+
+    static void arrayHeader(std::string& out, uint64_t count) { head(out, 4, count); }
+    static void mapHeader(std::string& out, uint64_t count) { head(out, 5, count); }
+
+    // Indefinite-length containers let a stream be written before its size is known
+    static void beginIndefiniteArray(std::string& out) { out += static_cast<char>(0x9f); }
+    static void beginIndefiniteMap(std::string& out) { out += static_cast<char>(0xbf); }
+    static void breakCode(std::string& out) { out += static_cast<char>(0xff); }
+
+    static void appendBigEndian(std::string& out, uint64_t value, int bytes) {
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+            out += static_cast<char>((value >> shift) & 0xff);
+        }
+    }
+};
+
+struct MessagePackEncoder {
+    static void string(std::string& out, const char* data, size_t size) {
+        if (size < 32) {
+            out += static_cast<char>(0xa0 | size);
+        } else if (size <= 0xff) {
+            out += static_cast<char>(0xd9);
+            out += static_cast<char>(size);
+        } else if (size <= 0xffff) {
+            out += static_cast<char>(0xda);
+            CborEncoder::appendBigEndian(out, size, 2);
+        } else {
+            out += static_cast<char>(0xdb);
+            CborEncoder::appendBigEndian(out, size, 4);
+        }
+        out.append(data, size);
+    }
+    static void string(std::string& out, const std::string& value) {
+        string(out, value.data(), value.size());
+    }
+    static void nil(std::string& out) { out += static_cast<char>(0xc0); }
+
+    static void arrayHeader(std::string& out, uint64_t count) {
+        if (count < 16) {
+            out += static_cast<char>(0x90 | count);
+        } else if (count <= 0xffff) {
+            out += static_cast<char>(0xdc);
+            CborEncoder::appendBigEndian(out, count, 2);
+        } else {
+            fixedArrayHeader(out, count);
+        }
+    }
+
+    static void mapHeader(std::string& out, uint64_t count) {
+        if (count < 16) {
+            out += static_cast<char>(0x80 | count);
+        } else if (count <= 0xffff) {
+            out += static_cast<char>(0xde);
+            CborEncoder::appendBigEndian(out, count, 2);
+        } else {
+            fixedMapHeader(out, count);
+        }
+    }
+
+    // Always 5 bytes wide, so a streaming writer can reserve the header and
+    // patch in the count once the container is closed
+    static constexpr size_t kFixedHeaderSize = 5;
+    static void fixedArrayHeader(std::string& out, uint64_t count) {
+        out += static_cast<char>(0xdd);
+        CborEncoder::appendBigEndian(out, count, 4);
+    }
+    static void fixedMapHeader(std::string& out, uint64_t count) {
+        out += static_cast<char>(0xdf);
+        CborEncoder::appendBigEndian(out, count, 4);
+    }
+    static void patchFixedHeader(std::string& out, size_t offset, uint64_t count) {
+        for (int i = 0; i < 4; ++i) {
+            out[offset + 1 + i] = static_cast<char>((count >> (24 - 8 * i)) & 0xff);
+        }
+    }
+};
+
+// One decoded item header. For strings and byte strings length is the payload
+// size, for arrays the element count and for maps the number of pairs.
+struct BinaryItem {
+    enum class Kind {
+        Map,
+        Array,
+        String,
+        Bytes,
+        Integer,
+        Float,
+        Boolean,
+        Nil,
+        Break,    // CBOR "break" closing an indefinite-length item
+        Other     // tags, extension types and simple values
+    };
+
+    Kind kind = Kind::Other;
+    uint64_t length = 0;
+    bool indefinite = false;
+};
+
+class CborReader {
+public:
+    CborReader(const char* data, size_t size);
+
+    // Reads the next item header; scalar payloads are consumed as well
+    bool next(BinaryItem& item);
+    // Reads the payload of a String item (including indefinite-length chunks)
+    bool readString(const BinaryItem& item, std::string& out);
+    // Skips the payload of an item whose header was just read
+    bool skip(const BinaryItem& item, int depth = 0);
+
+    bool atEnd() const { return pos_ >= size_; }
+    size_t offset() const { return pos_; }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    bool readArgument(uint8_t info, uint64_t& value);
+    bool fail(const std::string& message);
+
+    const unsigned char* data_;
+    size_t size_;
+    size_t pos_;
+    std::string errorMessage_;
+};
+
+class MessagePackReader {
+public:
+    MessagePackReader(const char* data, size_t size);
+
+    bool next(BinaryItem& item);
+    bool readString(const BinaryItem& item, std::string& out);
+    bool skip(const BinaryItem& item, int depth = 0);
+
+    bool atEnd() const { return pos_ >= size_; }
+    size_t offset() const { return pos_; }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    bool readBigEndian(int bytes, uint64_t& value);
+    bool consume(size_t bytes);
+    bool fail(const std::string& message);
+
+    const unsigned char* data_;
+    size_t size_;
+    size_t pos_;
+    std::string errorMessage_;
+};
+
+#endif // BINARY_FORMATS_H
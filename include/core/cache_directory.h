@@ -0,0 +1,13 @@
+#ifndef CACHE_DIRECTORY_H
+#define CACHE_DIRECTORY_H
+
+#include <filesystem>
+#include <string>
+
+// Directory name inside the per-user cache directory: $XDG_CACHE_HOME/nexus,
+// else ~/.cache/nexus (%LOCALAPPDATA%\nexus on Windows). Directories it
+// creates are private to the user. Only without any home directory does it
+// fall back to "nexus-<name>" in the temporary directory.
+std::filesystem::path userCacheDirectory(const std::string& name);
+
+#endif // CACHE_DIRECTORY_H
@@ -0,0 +1,79 @@
+#ifndef CALL_GRAPH_H
+#define CALL_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Call graph over interned function names, stored in compressed sparse row
+// form in both directions. Each distinct caller/callee pair is one edge that
+// carries the number of call sites behind it, so callers and callees of a
+// node are read in time proportional to its degree.
+class CallGraph {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kNoNode = UINT32_MAX;
+
+    struct Edge {
+        NodeId node;     // Callee in callees(), caller in callers()
+        uint32_t count;  // Call sites for this pair
+    };
+
+    class EdgeRange {
+    public:
+        EdgeRange(const Edge* begin, const Edge* end) : begin_(begin), end_(end) {}
+        const Edge* begin() const { return begin_; }
+        const Edge* end() const { return end_; }
+        size_t size() const { return static_cast<size_t>(end_ - begin_); }
+        bool empty() const { return begin_ == end_; }
+
+    private:
+        const Edge* begin_;
+        const Edge* end_;
+    };
+
+    CallGraph();
+
+    // Interns a name and returns its node; definitions are marked as such
+    NodeId addNode(const std::string& name, bool defined = true);
+    // Records one call site; it shows in the adjacency after the next build()
+    void addCall(NodeId caller, NodeId callee);
+    // Sorts all recorded calls into forward and reverse adjacency
+    void build();
+    void clear();
+
+    size_t nodeCount() const { return names_.size(); }
+    size_t edgeCount() const { return callees_.size(); }
+    NodeId find(const std::string& name) const;
+    const std::string& name(NodeId node) const { return names_[node]; }
+    // False for names that are only ever called (library or other files)
+    bool isDefined(NodeId node) const { return defined_[node] != 0; }
+
+    // Both ranges are ordered by node id
+    EdgeRange callees(NodeId node) const;
+    EdgeRange callers(NodeId node) const;
+
+    // Names of the callees or callers of name, each once
+    std::vector<std::string> calleeNames(const std::string& name) const;
+    std::vector<std::string> callerNames(const std::string& name) const;
+
+private:
+    static EdgeRange row(const std::vector<uint32_t>& offsets, const std::vector<Edge>& edges, NodeId node);
+    std::vector<std::string> rowNames(const std::vector<uint32_t>& offsets, const std::vector<Edge>& edges,
+                                      const std::string& name) const;
+
+    std::vector<std::string> names_;
+    std::vector<char> defined_;
+    std::unordered_map<std::string, NodeId> ids_;
+    std::vector<std::pair<NodeId, NodeId>> calls_;  // Caller and callee per call site
+
+    std::vector<uint32_t> calleeOffsets_;  // nodeCount() + 1 entries
+    std::vector<Edge> callees_;
+    std::vector<uint32_t> callerOffsets_;
+    std::vector<Edge> callers_;
+};
+
+#endif // CALL_GRAPH_H
@@ -0,0 +1,123 @@
+#ifndef CODE_MODEL_H
+#define CODE_MODEL_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "source_buffer.h"
+#include "call_graph.h"
+
+struct CodeParameter {
+    std::string name;
+    std::string type;  // Empty when the language does not spell it out
+    std::string defaultValue;
+};
+
+struct CodeFunction {
+    std::string name;
+    std::string container;      // Class of a method, or Go receiver type ("*Store")
+    std::string receiver;       // What a method calls its object: Python "self", the Go receiver
+    std::string qualifiedName;  // "Store::get", "Outer.method", "(*Store).Get"
+    std::string returnType;     // Go results as written: "error", "(int, error)"
+    std::vector<CodeParameter> parameters;
+    std::string signature;      // The declaration as the language writes it
+    int lineNumber;
+};
+
+// A class, Go struct or Go interface
+struct CodeType {
+    std::string name;
+    std::string kind;  // "class", "struct" or "interface"
+    std::vector<std::string> baseTypes;  // Base classes of C++ and Python classes
+    int lineNumber;
+};
+
+// A call site. The qualifier is what the call is written through: a scope
+// ("std", "Store"), an object ("this", "worker", "self.log") or a package
+// ("fmt"); empty for a bare call.
+struct CodeCall {
+    size_t callerIndex;  // Index of the calling function in getFunctions()
+    std::string callee;
+    std::string qualifier;
+    int lineNumber;
+    int argumentCount = -1;  // -1 when the parser does not count them
+};
+
+// "import a.b as c", "from m import f as g", Go "import c \"a/b\""
+struct CodeImport {
+    std::string module;  // Dotted Python module, leading dots kept; Go import path
+    std::string name;    // The name taken by "from m import name", else empty
+    std::string alias;   // Empty when the import binds its default name
+    int lineNumber;
+};
+
+// Symbols and calls of one source file in a form shared by every language.
+// Each parser fills its model at the end of parseFile, from the results it
+// already has, so views such as the function graph never re-parse anything.
+class CodeModel {
+public:
+    explicit CodeModel(SourceLanguage language = SourceLanguage::Cpp);
+
+    SourceLanguage getLanguage() const { return language_; }
+    const std::vector<CodeFunction>& getFunctions() const { return functions_; }
+    const std::vector<CodeType>& getTypes() const { return types_; }
+    const std::vector<CodeCall>& getCalls() const { return calls_; }
+    const std::vector<CodeImport>& getImports() const { return imports_; }
+    // Callee names by caller name, in call order
+    const std::map<std::string, std::vector<std::string>>& getFunctionCalls() const { return functionCalls_; }
+    // Names of the functions calling a callee name, each once, in order
+    std::vector<std::string> getCallerNames(const std::string& callee) const;
+    // Calls resolved against this file's own definitions: one node per
+    // definition, named by getSymbolName(), plus one per unresolved callee
+    // named by getCallName(). Built on first use after a change, so a model
+    // whose graph is never asked for costs nothing; that first call must
+    // not race with another.
+    const CallGraph& getCallGraph() const;
+    // Graph node of each function
+    CallGraph::NodeId getFunctionNode(size_t function) const;
+
+    size_t addFunction(CodeFunction function);
+    void addType(CodeType type);
+    // The caller must already have been added
+    void addCall(CodeCall call);
+    void addImport(CodeImport codeImport);
+
+    void clear();
+
+    // Rules shared with SymbolTable, which applies them across files
+
+    // "Store" of "*Store", "app::Store", "models.Store", "Store<T>" and "Store[T]"
+    static std::string_view getTypeName(std::string_view type);
+    // "worker" of a C++ qualifier written through an object ("worker.",
+    // "ptr->", "this->"); empty for a scope
+    static std::string_view getCallObject(std::string_view qualifier);
+    // Whether a call with this many arguments fits the parameters; always
+    // when they were not counted
+    static bool acceptsArguments(const CodeFunction& function, int argumentCount);
+    static bool sameParameterTypes(const CodeFunction& a, const CodeFunction& b);
+    // A C++ overload's qualified name with its parameter types: "max(int, int)"
+    static std::string getOverloadName(const CodeFunction& function);
+    // Node name of a call that did not resolve: the callee as written
+    static std::string getCallName(SourceLanguage language, const CodeCall& call);
+
+private:
+    void buildCallGraph() const;
+
+    SourceLanguage language_;
+    std::vector<CodeFunction> functions_;
+    std::vector<CodeType> types_;
+    std::vector<CodeCall> calls_;
+    std::vector<CodeImport> imports_;
+    std::map<std::string, std::vector<std::string>> functionCalls_;
+    // Derived from the above by buildCallGraph()
+    mutable bool graphBuilt_;
+    mutable std::vector<CallGraph::NodeId> functionNodes_;  // Graph node of each function
+    mutable std::vector<size_t> nodeFunctions_;             // A function of each defined node
+    mutable std::unordered_map<std::string, std::vector<CallGraph::NodeId>> calleeNodes_;  // Nodes of each bare name
+    mutable CallGraph callGraph_;
+};
+
+#endif // CODE_MODEL_H
@@ -0,0 +1,67 @@
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+enum class CompressionType {
+    None,
+    Gzip,
+    Xz,
+    Zstd
+};
+
+// Sniffs the magic bytes at the start of a file; falls back to None
+CompressionType detectCompression(const std::string& path);
+// Maps a ".gz", ".xz" or ".zst" suffix onto its compression type
+CompressionType compressionFromExtension(const std::string& path);
+// "data.xml.gz" -> "data.xml"; other paths are returned unchanged
+std::string stripCompressionExtension(const std::string& path);
+// Zstandard support is optional at build time (NEXUS_HAVE_ZSTD)
+bool isCompressionSupported(CompressionType type);
+
+class DecompressingBuffer;
+class CompressingBuffer;
+
+// std::istream over a file that is decompressed on the fly. The format is
+// detected from the file contents, so plain files are read unchanged. xz input
+// is decoded on several threads when liblzma supports it.
+class CompressedInputStream : public std::istream {
+public:
+    explicit CompressedInputStream(const std::string& path, unsigned threadCount = 0);
+    ~CompressedInputStream() override;
+
+    bool isOpen() const;
+    CompressionType compression() const;
+    // Bytes read from the file so far, for progress against the file size
+    uint64_t compressedBytesRead() const;
+
+    bool hasError() const { return !getErrorMessage().empty(); }
+    const std::string& getErrorMessage() const;
+
+private:
+    std::unique_ptr<DecompressingBuffer> buffer_;
+};
+
+// std::ostream that compresses into a file. close() must succeed for the
+// file to be complete; the destructor closes silently.
+class CompressedOutputStream : public std::ostream {
+public:
+    CompressedOutputStream(const std::string& path, CompressionType type,
+                           int level = -1, unsigned threadCount = 0);
+    ~CompressedOutputStream() override;
+
+    bool isOpen() const;
+    bool close();
+
+    bool hasError() const { return !getErrorMessage().empty(); }
+    const std::string& getErrorMessage() const;
+
+private:
+    std::unique_ptr<CompressingBuffer> buffer_;
+};
+
+#endif // COMPRESSED_STREAM_H
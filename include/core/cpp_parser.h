@@ -5,8 +5,8 @@
 #include <vector>
 #include <map>
 #include <memory>
-#include <QRegExp>
-#include <QStringList>
+#include "source_buffer.h"
+#include "code_model.h"
 
 struct CppParameter {
     std::string type;
@@ -24,6 +24,7 @@ struct CppFunction {
     bool isStatic;
     bool isVirtual;
     bool isConst;
+    bool isDefined;           // 有函数体, 而不只是声明
     std::string accessLevel;  // public, private, protected
 };
 
@@ -35,6 +36,20 @@ struct CppClass {
     int lineNumber;
 };
 
+// 函数体内的一次调用: 限定调用 std::max(a, b) 的 qualifier 为 "std",
+// 成员调用 obj.run() 的 qualifier 为空, object 为 "obj."
+struct CppCallSite {
+    std::string callee;
+    std::string qualifier;
+    size_t callerIndex;  // 调用方在 getFunctions() 中的下标
+    int lineNumber;
+    std::string object;  // 成员调用的对象及运算符: "obj.", "this->"; 对象是表达式时为 "()." 或 "()->"
+    int argumentCount;   // 实参个数, 括号不配对时为 -1
+};
+
+// 源码只被词法扫描一次 (注释、预处理指令和字符串字面量不会产生记号),
+// 随后对记号做一次线性遍历, 用作用域栈跟踪命名空间、类和函数体的花括号,
+// 同时产出函数、类和调用点. 只有声明没有定义的函数也列在 getFunctions() 中.
 class CppParser {
 public:
     CppParser();
@@ -42,11 +57,14 @@ public:
     
     // 解析 C++ 文件
     bool parseFile(const std::string& content);
+    bool parseFile(const SourceBuffer& source);
     
     // 获取解析结果
     const std::vector<CppFunction>& getFunctions() const { return functions_; }
     const std::vector<CppClass>& getClasses() const { return classes_; }
     const std::map<std::string, std::vector<std::string>>& getFunctionCalls() const { return functionCalls_; }
+    const std::vector<CppCallSite>& getCallSites() const { return callSites_; }
+    const CodeModel& getCodeModel() const { return model_; }
     
     // 辅助函数
     std::string getFunctionSignature(const CppFunction& func) const;
@@ -57,26 +75,13 @@ public:
     void clear();
 
 private:
+    void buildCodeModel();
+
     std::vector<CppFunction> functions_;
     std::vector<CppClass> classes_;
+    std::vector<CppCallSite> callSites_;
     std::map<std::string, std::vector<std::string>> functionCalls_;  // function -> list of called functions
-    
-    // 解析辅助函数
-    void parseFunctions(const std::string& content);
-    void parseClasses(const std::string& content);
-    void parseFunctionCalls(const std::string& content);
-    
-    CppFunction parseFunctionDeclaration(const std::string& line, int lineNumber);
-    std::vector<CppParameter> parseParameters(const std::string& paramStr);
-    std::string removeComments(const std::string& content);
-    std::string normalizeWhitespace(const std::string& text);
-    std::vector<std::string> splitLines(const std::string& content);
-    
-    // 正则表达式模式
-    QRegExp functionPattern_;
-    QRegExp classPattern_;
-    QRegExp functionCallPattern_;
-    QRegExp parameterPattern_;
+    CodeModel model_;
 };
 
 #endif // CPP_PARSER_H 
\ No newline at end of file
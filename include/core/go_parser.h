@@ -5,8 +5,8 @@
 #include <vector>
 #include <map>
 #include <memory>
-#include <QRegExp>
-#include <QStringList>
+#include "source_buffer.h"
+#include "code_model.h"
 
 struct GoParameter {
     std::string name;
@@ -16,6 +16,7 @@ struct GoParameter {
 
 struct GoFunction {
     std::string name;
+    std::string typeParameters;  // "[K comparable, V any]" for generic functions
     std::vector<std::string> returnTypes;  // Go can have multiple return values
     std::vector<GoParameter> parameters;
     std::vector<std::string> calledFunctions;
@@ -37,6 +38,21 @@ struct GoStruct {
     std::string comment;
 };
 
+struct GoImport {
+    std::string path;
+    std::string alias;  // "", "_", "." or a package name
+    int lineNumber;
+};
+
+// A call inside a function body: for fmt.Println(x) the qualifier is "fmt",
+// for s.store.Get(k) it is "s.store"
+struct GoCallSite {
+    std::string callee;
+    std::string qualifier;
+    size_t callerIndex;  // Index of the calling function in getFunctions()
+    int lineNumber;
+};
+
 struct GoInterface {
     std::string name;
     std::vector<std::string> methods;
@@ -45,6 +61,10 @@ struct GoInterface {
     std::string comment;
 };
 
+// The source is lexed once, with Go's automatic semicolon insertion, and the
+// tokens are walked once: package, imports, funcs, methods, structs,
+// interfaces and call sites come out of the same pass. Comments, raw strings
+// and func literals never leak into declarations.
 class GoParser {
 public:
     GoParser();
@@ -52,12 +72,16 @@ public:
     
     // Parse Go file
     bool parseFile(const std::string& content);
+    bool parseFile(const SourceBuffer& source);
     
     // Get parsing results
     const std::vector<GoFunction>& getFunctions() const { return functions_; }
     const std::vector<GoStruct>& getStructs() const { return structs_; }
     const std::vector<GoInterface>& getInterfaces() const { return interfaces_; }
     const std::map<std::string, std::vector<std::string>>& getFunctionCalls() const { return functionCalls_; }
+    const std::vector<GoImport>& getImports() const { return imports_; }
+    const std::vector<GoCallSite>& getCallSites() const { return callSites_; }
+    const CodeModel& getCodeModel() const { return model_; }
     const std::string& getPackageName() const { return packageName_; }
     
     // Helper functions
@@ -69,37 +93,16 @@ public:
     void clear();
 
 private:
+    void buildCodeModel();
+
     std::vector<GoFunction> functions_;
     std::vector<GoStruct> structs_;
     std::vector<GoInterface> interfaces_;
+    std::vector<GoImport> imports_;
+    std::vector<GoCallSite> callSites_;
     std::map<std::string, std::vector<std::string>> functionCalls_;  // function -> list of called functions
+    CodeModel model_;
     std::string packageName_;
-    
-    // Parsing helper functions
-    void parsePackage(const std::string& content);
-    void parseFunctions(const std::string& content);
-    void parseStructs(const std::string& content);
-    void parseInterfaces(const std::string& content);
-    void parseFunctionCalls(const std::string& content);
-    
-    GoFunction parseFunctionDefinition(const std::vector<std::string>& lines, int startLine);
-    std::vector<GoParameter> parseParameters(const std::string& paramStr);
-    std::vector<std::string> parseReturnTypes(const std::string& returnStr);
-    std::string removeComments(const std::string& content);
-    std::string normalizeWhitespace(const std::string& text);
-    std::vector<std::string> splitLines(const std::string& content);
-    std::string extractComment(const std::vector<std::string>& lines, int startLine);
-    bool isBlankOrComment(const std::string& line);
-    bool isExported(const std::string& name);
-    
-    // Regular expression patterns
-    QRegExp packagePattern_;
-    QRegExp functionPattern_;
-    QRegExp methodPattern_;
-    QRegExp structPattern_;
-    QRegExp interfacePattern_;
-    QRegExp functionCallPattern_;
-    QRegExp parameterPattern_;
 };
 
 #endif // GO_PARSER_H 
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "code_model.h"
+#include "cpp_parser.h"
+#include "python_parser.h"
+#include "go_parser.h"
+
+// Keeps the code model of a document that is being edited up to date without
+// parsing the whole text again on every change.
+//
+// The document is split into its top-level declarations (a function, a
+// class, a Go type or import block...), found on the code mask: a line
+// starts one when no bracket, literal or statement is left open before it.
+// Each declaration is parsed on its own and keeps its model. An edit reparses
+// only the declarations overlapping it, growing the range while the line
+// after it no longer starts a declaration (an unclosed brace or comment), and
+// moves the ones below by the change in line count. Namespaces do not count
+// as declarations, so the functions inside them are split too.
+//
+// Lines here are 0-based, as QTextDocument blocks; the model reports 1-based
+// line numbers like the parsers.
+class IncrementalParser {
+public:
+    // Returns count lines of the current text from line first, each followed
+    // by '\n'
+    using LineFetcher = std::function<std::string(int first, int count)>;
+
+    IncrementalParser();
+    ~IncrementalParser() = default;
+
+    // Parses the whole text and starts tracking it
+    void reset(SourceLanguage language, const std::string& text);
+    // Lines [firstLine, firstLine + oldLineCount) of the previous text were
+    // replaced by lines [firstLine, firstLine + newLineCount) of the current
+    // one. Either count may be 0, for a pure insertion or removal. False, and
+    // nothing done, when no text is tracked.
+    bool update(int firstLine, int oldLineCount, int newLineCount, const LineFetcher& fetchLines);
+    void clear();
+
+    bool isLoaded() const { return !declarations_.empty(); }
+    SourceLanguage getLanguage() const { return language_; }
+    int getLineCount() const { return lineCount_; }
+    size_t getDeclarationCount() const { return declarations_.size(); }
+    // First line of each top-level declaration
+    std::vector<int> getDeclarationLines() const;
+    // Lines read and parsed by the last reset() or update()
+    int getLastParsedLineCount() const { return lastParsedLines_; }
+
+    // The declarations' models merged, rebuilt only after a change. As in
+    // CppParser, a C++ function declaration is left out when another
+    // declaration defines it.
+    const CodeModel& getCodeModel();
+
+private:
+    struct Declaration {
+        int firstLine;
+        CodeModel model;             // Line numbers relative to firstLine
+        std::vector<bool> defined;   // C++: whether each model function has a body
+    };
+
+    // Parses the first lineCount lines of text, which begins at document line
+    // firstLine, into one declaration per start
+    std::vector<Declaration> parseDeclarations(const std::string& text, int firstLine,
+                                               const std::vector<int>& starts, int lineCount);
+    size_t declarationAt(int line) const;
+
+    SourceLanguage language_;
+    int lineCount_;
+    int lastParsedLines_;
+    std::vector<Declaration> declarations_;
+    CppParser cppParser_;
+    PythonParser pythonParser_;
+    GoParser goParser_;
+    CodeModel model_;
+    bool modelDirty_;
+};
+
+#endif // INCREMENTAL_PARSER_H
@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapping is released by close()
+// or the destructor; pointers into data() are invalid afterwards.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return open_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    bool open_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+    std::string errorMessage_;
+};
+
+#endif // MAPPED_FILE_H
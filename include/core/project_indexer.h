@@ -0,0 +1,114 @@
+#ifndef PROJECT_INDEXER_H
+#define PROJECT_INDEXER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "code_model.h"
+#include "call_graph.h"
+#include "symbol_table.h"
+
+// Parse results of one source file of a project
+struct IndexedFile {
+    std::string path;  // Relative to the project root, '/' separated
+    SourceLanguage language;
+    uint64_t size;
+    int64_t modifiedTime;   // Filesystem clock ticks
+    uint64_t contentHash;   // SymbolCache::hashContent, 0 until the file is read
+    bool parsed;  // False when the file could not be read or parsed
+    CodeModel model;
+};
+
+// Parses every C++, Python and Go file under a project directory, merges
+// the functions into one symbol table and resolves every call against it
+// into a project-wide call graph.
+//
+// The directory is walked once, skipping the directories the project tree
+// hides; the files are then parsed in parallel, largest first so no thread is
+// left with a big file at the end, each worker reusing its own parsers. The
+// merge into the symbol table and the call graph run on the calling thread
+// afterwards.
+//
+// With a cache path set, the models of unchanged files are taken from the
+// SymbolCache written by the previous run instead of being parsed again.
+//
+// A cancel flag, when set, is checked throughout: while listing, by every
+// worker between files, and per file while merging, so another thread can
+// stop a large project within about one file's work.
+class ProjectIndexer {
+public:
+    // Called with the files parsed so far and the number to parse; returning
+    // false cancels indexing. Always called on the calling thread, which may
+    // itself be a background thread.
+    using ProgressCallback = std::function<bool(size_t filesDone, size_t filesTotal)>;
+
+    ProjectIndexer();
+    ~ProjectIndexer() = default;
+    // The symbol table points into the files
+    ProjectIndexer(const ProjectIndexer&) = delete;
+    ProjectIndexer& operator=(const ProjectIndexer&) = delete;
+
+    bool indexProject(const std::string& rootPath);
+
+    // 0 uses one thread per hardware thread (default)
+    void setThreadCount(unsigned threads) { threadCount_ = threads; }
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+    // Setting *cancelled from any thread makes indexProject fail with
+    // "Indexing cancelled", leaving incomplete results; null (the default)
+    // leaves cancelling to the progress callback
+    void setCancelFlag(const std::atomic<bool>* cancelled) { cancelFlag_ = cancelled; }
+    // Symbol cache file to load before and save after indexing; empty (the
+    // default) disables the cache
+    void setCachePath(const std::string& cachePath) { cachePath_ = cachePath; }
+
+    // Results of the last indexProject, ordered by path
+    const std::string& getRootPath() const { return rootPath_; }
+    const std::vector<IndexedFile>& getFiles() const { return files_; }
+    size_t getFunctionCount() const { return functionCount_; }
+    // Files whose model came from the cache rather than the parsers
+    size_t getReusedFileCount() const { return reusedFileCount_; }
+    // Definitions of functions with this name, in path order; file indexes
+    // are those of getFiles()
+    std::vector<SymbolLocation> findFunctions(const std::string& name) const;
+    const SymbolTable& getSymbolTable() const { return symbolTable_; }
+    // Nodes are definitions named by SymbolTable::getSymbolName(), and the
+    // calls that did not resolve, named as written
+    const CallGraph& getCallGraph() const { return callGraph_; }
+    size_t getCallCount() const { return callCount_; }
+    size_t getResolvedCallCount() const { return resolvedCallCount_; }
+
+    // Build output, VCS metadata and dependency directories
+    static bool isSkippedDirectory(const std::string& name);
+    // False for files that are not C++, Python or Go source
+    static bool languageForPath(const std::string& path, SourceLanguage& language);
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    bool collectFiles();
+    bool parseFiles();
+    bool buildSymbolTable();
+    bool buildCallGraph();
+    bool isCancelled() const { return cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed); }
+    bool fail(const std::string& message);
+
+    unsigned threadCount_;
+    ProgressCallback progressCallback_;
+    const std::atomic<bool>* cancelFlag_;
+    std::string cachePath_;
+    std::string rootPath_;
+    std::vector<IndexedFile> files_;
+    SymbolTable symbolTable_;
+    CallGraph callGraph_;
+    size_t functionCount_;
+    size_t callCount_;
+    size_t resolvedCallCount_;
+    size_t reusedFileCount_;
+    std::string errorMessage_;
+};
+
+#endif // PROJECT_INDEXER_H
@@ -5,8 +5,8 @@
 #include <vector>
 #include <map>
 #include <memory>
-#include <QRegExp>
-#include <QStringList>
+#include "source_buffer.h"
+#include "code_model.h"
 
 struct PythonParameter {
     std::string name;
@@ -22,11 +22,12 @@ struct PythonFunction {
     std::vector<std::string> calledFunctions;
     int lineNumber;
     std::string className;  // If it's a method
+    std::string qualifiedName;  // As __qualname__: "Outer.method.<locals>.helper"
     bool isAsync;
     bool isStaticMethod;
     bool isClassMethod;
     bool isPrivate;  // starts with underscore
-    std::string decorator;
+    std::string decorator;  // Dotted decorator names, comma separated
     std::string docstring;
 };
 
@@ -36,9 +37,32 @@ struct PythonClass {
     std::vector<PythonFunction> methods;
     std::vector<std::string> attributes;
     int lineNumber;
+    std::string decorator;
     std::string docstring;
 };
 
+// A call inside a function body: for os.path.join(a, b) the qualifier is
+// "os.path", for self.run() it is "self"
+struct PythonCallSite {
+    std::string callee;
+    std::string qualifier;
+    size_t callerIndex;  // Index of the calling function in getFunctions()
+    int lineNumber;
+};
+
+// One name bound by an import statement: "import a.b as c", "from .m import f"
+struct PythonImport {
+    std::string module;  // "a.b", ".m": the dots of a relative import are kept
+    std::string name;    // Name taken by "from m import name", empty for "import m"
+    std::string alias;   // The "as" name, empty if none
+    int lineNumber;
+};
+
+// Single pass over the source: the text is split into logical lines (bracket
+// nesting, backslash continuations and triple-quoted strings may span several
+// physical lines) and each logical line is handled against a stack of the
+// enclosing def and class blocks, keyed by indentation. Decorators, docstrings,
+// methods and nested defs are attached as their lines are seen.
 class PythonParser {
 public:
     PythonParser();
@@ -46,11 +70,15 @@ public:
     
     // Parse Python file
     bool parseFile(const std::string& content);
+    bool parseFile(const SourceBuffer& source);
     
     // Get parsing results
     const std::vector<PythonFunction>& getFunctions() const { return functions_; }
     const std::vector<PythonClass>& getClasses() const { return classes_; }
     const std::map<std::string, std::vector<std::string>>& getFunctionCalls() const { return functionCalls_; }
+    const std::vector<PythonCallSite>& getCallSites() const { return callSites_; }
+    const std::vector<PythonImport>& getImports() const { return imports_; }
+    const CodeModel& getCodeModel() const { return model_; }
     
     // Helper functions
     std::string getFunctionSignature(const PythonFunction& func) const;
@@ -61,31 +89,14 @@ public:
     void clear();
 
 private:
+    void buildCodeModel();
+
     std::vector<PythonFunction> functions_;
     std::vector<PythonClass> classes_;
+    std::vector<PythonCallSite> callSites_;
+    std::vector<PythonImport> imports_;
     std::map<std::string, std::vector<std::string>> functionCalls_;  // function -> list of called functions
-    
-    // Parsing helper functions
-    void parseFunctions(const std::string& content);
-    void parseClasses(const std::string& content);
-    void parseFunctionCalls(const std::string& content);
-    
-    PythonFunction parseFunctionDefinition(const std::vector<std::string>& lines, int startLine);
-    std::vector<PythonParameter> parseParameters(const std::string& paramStr);
-    std::string removeComments(const std::string& content);
-    std::string normalizeWhitespace(const std::string& text);
-    std::vector<std::string> splitLines(const std::string& content);
-    std::string extractDocstring(const std::vector<std::string>& lines, int startLine);
-    int getIndentLevel(const std::string& line);
-    bool isBlankOrComment(const std::string& line);
-    
-    // Regular expression patterns
-    QRegExp functionPattern_;
-    QRegExp asyncFunctionPattern_;
-    QRegExp classPattern_;
-    QRegExp functionCallPattern_;
-    QRegExp parameterPattern_;
-    QRegExp decoratorPattern_;
+    CodeModel model_;
 };
 
 #endif // PYTHON_PARSER_H 
\ No newline at end of file
@@ -0,0 +1,503 @@
+#ifndef SERIALIZATION_WRITERS_H
+#define SERIALIZATION_WRITERS_H
+
+#include "xml_serializer.h"
+#include "binary_formats.h"
+#include <algorithm>
+#include <map>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 编译期特化的文本写出器: 每个 Format × OutputStyle 组合生成一份独立代码,
+// 缩进和换行在编译期确定, 序列化过程中不再按节点分派或分配缩进字符串.
+
+// 预先序列化好的子元素片段, 按子元素顺序排列 (并行模式下由各线程生成, 增量模式下来自节点缓存)
+struct SerializedFragments {
+    std::vector<std::string_view> chunks;  // 每块包含若干相邻子元素, 块内已带分隔符
+    std::vector<std::string> storage;      // 非借用片段的实际存储
+};
+
+// 节点上缓存的子树序列化结果, 每个 Format × OutputStyle 一项 (CSV 除外).
+// 仅当节点 revision 与缩进都未变化时才可复用.
+struct SerializedFragmentCache {
+    struct Entry {
+        bool valid = false;
+        uint64_t revision = 0;
+        int indent = 0;
+        bool includeComments = true;
+        std::string text;
+    };
+
+    static constexpr size_t kSlotCount = 9;
+    std::array<Entry, kSlotCount> entries;
+
+    static size_t slot(XmlSerializer::Format format, XmlSerializer::OutputStyle style) {
+        return static_cast<size_t>(format) * 3 + static_cast<size_t>(style);
+    }
+};
+
+template <XmlSerializer::OutputStyle Style>
+struct OutputStyleTraits;
+
+template <>
+struct OutputStyleTraits<XmlSerializer::OutputStyle::Compact> {
+    static constexpr int kIndentWidth = 0;
+    static constexpr bool kLineBreaks = false;
+};
+
+template <>
+struct OutputStyleTraits<XmlSerializer::OutputStyle::Pretty> {
+    static constexpr int kIndentWidth = 2;
+    static constexpr bool kLineBreaks = true;
+};
+
+template <>
+struct OutputStyleTraits<XmlSerializer::OutputStyle::Minified> {
+    static constexpr int kIndentWidth = 0;
+    static constexpr bool kLineBreaks = true;
+};
+
+namespace writer_detail {
+
+// Shared indent buffer; deeper levels are written in several appends
+constexpr char kSpaces[] = "                                                                ";
+constexpr size_t kSpacesLength = sizeof(kSpaces) - 1;
+
+template <XmlSerializer::OutputStyle Style>
+inline void appendIndent(std::string& out, int level) {
+    if constexpr (OutputStyleTraits<Style>::kIndentWidth > 0) {
+        size_t count = static_cast<size_t>(level) * OutputStyleTraits<Style>::kIndentWidth;
+        while (count > 0) {
+            size_t n = std::min(count, kSpacesLength);
+            out.append(kSpaces, n);
+            count -= n;
+        }
+    } else {
+        (void)out;
+        (void)level;
+    }
+}
+
+inline void appendEscapedXml(std::string& out, const std::string& str) {
+    size_t runStart = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        const char* replacement = nullptr;
+        switch (str[i]) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '"': replacement = "&quot;"; break;
+            case '\'': replacement = "&apos;"; break;
+            default: continue;
+        }
+        out.append(str, runStart, i - runStart);
+        out += replacement;
+        runStart = i + 1;
+    }
+    out.append(str, runStart, std::string::npos);
+}
+
+// JSON and the double-quoted YAML scalars we emit share the same escapes
+inline void appendEscapedQuoted(std::string& out, const std::string& str) {
+    size_t runStart = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        const char* replacement = nullptr;
+        switch (str[i]) {
+            case '\\': replacement = "\\\\"; break;
+            case '"': replacement = "\\\""; break;
+            case '\n': replacement = "\\n"; break;
+            case '\r': replacement = "\\r"; break;
+            case '\t': replacement = "\\t"; break;
+            default: continue;
+        }
+        out.append(str, runStart, i - runStart);
+        out += replacement;
+        runStart = i + 1;
+    }
+    out.append(str, runStart, std::string::npos);
+}
+
+// Text of an element: its value, else the Text children before its first
+// child element, which is where XmlParser keeps character data. The streaming
+// converter emits the same text, so both exports of a file agree.
+inline std::string elementText(const XmlNode& node) {
+    if (!node.getValue().empty()) return node.getValue();
+    std::string text;
+    for (const auto& child : node.getChildren()) {
+        if (child->getType() == XmlNode::NodeType::Element) break;
+        if (child->getType() == XmlNode::NodeType::Text) text += child->getValue();
+    }
+    return text;
+}
+
+} // namespace writer_detail
+
+template <XmlSerializer::OutputStyle Style>
+struct XmlTextWriter {
+    static void lineBreak(std::string& out) {
+        if constexpr (OutputStyleTraits<Style>::kLineBreaks) {
+            out += '\n';
+        } else {
+            (void)out;
+        }
+    }
+
+    // Writes "<name attr=..." without closing the start tag
+    static void startTag(std::string& out, int indent, const std::string& name,
+                         const std::map<std::string, std::string>& attributes) {
+        writer_detail::appendIndent<Style>(out, indent);
+        out += '<';
+        out += name;
+        for (const auto& attr : attributes) {
+            out += ' ';
+            out += attr.first;
+            out += "=\"";
+            writer_detail::appendEscapedXml(out, attr.second);
+            out += '"';
+        }
+    }
+
+    static void emptyTagEnd(std::string& out) {
+        out += " />";
+        lineBreak(out);
+    }
+
+    static void endTag(std::string& out, int indent, const std::string& name,
+                       bool hadChildElements) {
+        if (hadChildElements) {
+            writer_detail::appendIndent<Style>(out, indent);
+        }
+        out += "</";
+        out += name;
+        out += '>';
+        lineBreak(out);
+    }
+
+    static void comment(std::string& out, int indent, const std::string& text) {
+        writer_detail::appendIndent<Style>(out, indent);
+        out += "<!-- ";
+        out += text;
+        out += " -->";
+        lineBreak(out);
+    }
+
+    static void writeNode(const std::shared_ptr<XmlNode>& node, int indent,
+                          const XmlSerializer::SerializationConfig& config, std::string& out,
+                          const SerializedFragments* fragments = nullptr) {
+        if (!node) return;
+
+        switch (node->getType()) {
+            case XmlNode::NodeType::Element: {
+                startTag(out, indent, node->getName(), node->getAttributes());
+
+                if (node->isLeaf() && node->getValue().empty()) {
+                    emptyTagEnd(out);
+                    break;
+                }
+
+                out += '>';
+                writer_detail::appendEscapedXml(out, node->getValue());
+
+                bool hasChildren = false;
+                if (fragments) {
+                    lineBreak(out);
+                    for (const auto& chunk : fragments->chunks) {
+                        out.append(chunk.data(), chunk.size());
+                    }
+                    hasChildren = true;
+                } else {
+                    for (const auto& child : node->getChildren()) {
+                        if (child->getType() == XmlNode::NodeType::Element) {
+                            if (!hasChildren) lineBreak(out);
+                            writeNode(child, indent + 1, config, out);
+                            hasChildren = true;
+                        }
+                    }
+                }
+
+                // Text children follow the element children
+                for (const auto& child : node->getChildren()) {
+                    if (child->getType() == XmlNode::NodeType::Text) {
+                        writer_detail::appendEscapedXml(out, child->getValue());
+                    }
+                }
+
+                endTag(out, indent, node->getName(), hasChildren);
+                break;
+            }
+            case XmlNode::NodeType::Text:
+                writer_detail::appendEscapedXml(out, node->getValue());
+                break;
+            case XmlNode::NodeType::Comment:
+                if (config.includeComments) {
+                    comment(out, indent, node->getValue());
+                }
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+template <XmlSerializer::OutputStyle Style>
+struct JsonTextWriter {
+    // Writes "{" and the "@name" member; the object stays open
+    static void beginElement(std::string& out, int indent, const std::string& name) {
+        writer_detail::appendIndent<Style>(out, indent);
+        out += "{\n";
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += "\"@name\": \"";
+        writer_detail::appendEscapedQuoted(out, name);
+        out += '"';
+    }
+
+    static void attributes(std::string& out, int indent,
+                           const std::map<std::string, std::string>& attributes) {
+        if (attributes.empty()) return;
+        out += ",\n";
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += "\"@attributes\": {\n";
+        bool first = true;
+        for (const auto& attr : attributes) {
+            if (!first) out += ",\n";
+            writer_detail::appendIndent<Style>(out, indent + 2);
+            out += '"';
+            writer_detail::appendEscapedQuoted(out, attr.first);
+            out += "\": \"";
+            writer_detail::appendEscapedQuoted(out, attr.second);
+            out += '"';
+            first = false;
+        }
+        out += '\n';
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += '}';
+    }
+
+    static void text(std::string& out, int indent, const std::string& value) {
+        if (value.empty()) return;
+        out += ",\n";
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += "\"@text\": \"";
+        writer_detail::appendEscapedQuoted(out, value);
+        out += '"';
+    }
+
+    static void beginChildren(std::string& out, int indent) {
+        out += ",\n";
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += "\"@children\": [\n";
+    }
+
+    static void childSeparator(std::string& out) {
+        out += ",\n";
+    }
+
+    static void endChildren(std::string& out, int indent) {
+        out += '\n';
+        writer_detail::appendIndent<Style>(out, indent + 1);
+        out += ']';
+    }
+
+    static void endElement(std::string& out, int indent) {
+        out += '\n';
+        writer_detail::appendIndent<Style>(out, indent);
+        out += '}';
+    }
+
+    static void writeNode(const std::shared_ptr<XmlNode>& node, int indent,
+                          const XmlSerializer::SerializationConfig& config, std::string& out,
+                          const SerializedFragments* fragments = nullptr) {
+        if (!node) {
+            out += "null";
+            return;
+        }
+
+        switch (node->getType()) {
+            case XmlNode::NodeType::Element: {
+                beginElement(out, indent, node->getName());
+                attributes(out, indent, node->getAttributes());
+                text(out, indent, writer_detail::elementText(*node));
+
+                if (fragments) {
+                    beginChildren(out, indent);
+                    for (size_t i = 0; i < fragments->chunks.size(); ++i) {
+                        if (i > 0) childSeparator(out);
+                        out.append(fragments->chunks[i].data(), fragments->chunks[i].size());
+                    }
+                    endChildren(out, indent);
+                } else {
+                    bool first = true;
+                    for (const auto& child : node->getChildren()) {
+                        if (child->getType() != XmlNode::NodeType::Element) continue;
+                        if (first) {
+                            beginChildren(out, indent);
+                        } else {
+                            childSeparator(out);
+                        }
+                        writeNode(child, indent + 2, config, out);
+                        first = false;
+                    }
+                    if (!first) endChildren(out, indent);
+                }
+
+                endElement(out, indent);
+                break;
+            }
+            case XmlNode::NodeType::Text:
+                out += '"';
+                writer_detail::appendEscapedQuoted(out, node->getValue());
+                out += '"';
+                break;
+            default:
+                out += "null";
+                break;
+        }
+    }
+};
+
+template <XmlSerializer::OutputStyle Style>
+struct YamlTextWriter {
+    // Writes "name:" plus the attribute block; children follow at indent + 2
+    static void beginElement(std::string& out, int indent, const std::string& name,
+                             const std::map<std::string, std::string>& attributes) {
+        writer_detail::appendIndent<Style>(out, indent);
+        out += name;
+        out += ":\n";
+        if (attributes.empty()) return;
+        writer_detail::appendIndent<Style>(out, indent);
+        out += "  attributes:\n";
+        for (const auto& attr : attributes) {
+            writer_detail::appendIndent<Style>(out, indent);
+            out += "    ";
+            out += attr.first;
+            out += ": \"";
+            writer_detail::appendEscapedQuoted(out, attr.second);
+            out += "\"\n";
+        }
+    }
+
+    static void text(std::string& out, int indent, const std::string& value) {
+        if (value.empty()) return;
+        writer_detail::appendIndent<Style>(out, indent);
+        out += "  text: \"";
+        writer_detail::appendEscapedQuoted(out, value);
+        out += "\"\n";
+    }
+
+    static void writeNode(const std::shared_ptr<XmlNode>& node, int indent,
+                          const XmlSerializer::SerializationConfig& config, std::string& out,
+                          const SerializedFragments* fragments = nullptr) {
+        if (!node) return;
+
+        switch (node->getType()) {
+            case XmlNode::NodeType::Element:
+                beginElement(out, indent, node->getName(), node->getAttributes());
+                text(out, indent, writer_detail::elementText(*node));
+                if (fragments) {
+                    for (const auto& chunk : fragments->chunks) {
+                        out.append(chunk.data(), chunk.size());
+                    }
+                } else {
+                    for (const auto& child : node->getChildren()) {
+                        if (child->getType() == XmlNode::NodeType::Element) {
+                            writeNode(child, indent + 2, config, out);
+                        }
+                    }
+                }
+                break;
+            case XmlNode::NodeType::Text:
+                writer_detail::appendIndent<Style>(out, indent);
+                out += "- \"";
+                writer_detail::appendEscapedQuoted(out, node->getValue());
+                out += "\"\n";
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+// CBOR / MessagePack 写出器: 结构与 JSON 导出一致 ({"@name", "@attributes", "@text", "@children"}),
+// OutputStyle 对二进制格式没有意义.
+template <typename Encoder>
+struct BinaryNodeWriter {
+    template <size_t N>
+    static void key(std::string& out, const char (&name)[N]) {
+        Encoder::string(out, name, N - 1);
+    }
+
+    static void attributes(std::string& out, const std::map<std::string, std::string>& attributes) {
+        key(out, "@attributes");
+        Encoder::mapHeader(out, attributes.size());
+        for (const auto& attr : attributes) {
+            Encoder::string(out, attr.first);
+            Encoder::string(out, attr.second);
+        }
+    }
+
+    static void writeNode(const std::shared_ptr<XmlNode>& node, std::string& out) {
+        if (!node) {
+            Encoder::nil(out);
+            return;
+        }
+
+        switch (node->getType()) {
+            case XmlNode::NodeType::Element: {
+                size_t elementCount = 0;
+                for (const auto& child : node->getChildren()) {
+                    if (child->getType() == XmlNode::NodeType::Element) ++elementCount;
+                }
+
+                const auto& attrs = node->getAttributes();
+                const std::string text = writer_detail::elementText(*node);
+                size_t members = 1 + (attrs.empty() ? 0 : 1) + (text.empty() ? 0 : 1) +
+                                 (elementCount > 0 ? 1 : 0);
+                Encoder::mapHeader(out, members);
+                key(out, "@name");
+                Encoder::string(out, node->getName());
+                if (!attrs.empty()) {
+                    attributes(out, attrs);
+                }
+                if (!text.empty()) {
+                    key(out, "@text");
+                    Encoder::string(out, text);
+                }
+                if (elementCount > 0) {
+                    key(out, "@children");
+                    Encoder::arrayHeader(out, elementCount);
+                    for (const auto& child : node->getChildren()) {
+                        if (child->getType() == XmlNode::NodeType::Element) {
+                            writeNode(child, out);
+                        }
+                    }
+                }
+                break;
+            }
+            case XmlNode::NodeType::Text:
+                Encoder::string(out, node->getValue());
+                break;
+            default:
+                Encoder::nil(out);
+                break;
+        }
+    }
+};
+
+// Maps a (Format, OutputStyle) pair onto its writer; CSV has no styled writer
+template <XmlSerializer::Format F, XmlSerializer::OutputStyle Style>
+struct NodeWriter;
+
+template <XmlSerializer::OutputStyle Style>
+struct NodeWriter<XmlSerializer::Format::XML, Style> : XmlTextWriter<Style> {};
+
+template <XmlSerializer::OutputStyle Style>
+struct NodeWriter<XmlSerializer::Format::JSON, Style> : JsonTextWriter<Style> {};
+
+template <XmlSerializer::OutputStyle Style>
+struct NodeWriter<XmlSerializer::Format::YAML, Style> : YamlTextWriter<Style> {};
+
+#endif // SERIALIZATION_WRITERS_H
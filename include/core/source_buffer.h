@@ -0,0 +1,77 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Immutable source text shared by the code parsers, with an index of line
+// start offsets. Copies share the text and the index. Line numbers are
+// 1-based, as the parsers report them; a "\r\n" break belongs to the line it ends.
+class SourceBuffer {
+public:
+    SourceBuffer();
+    explicit SourceBuffer(std::string text);
+
+    const std::string& text() const { return *text_; }
+    std::string_view view() const { return *text_; }
+    size_t size() const { return text_->size(); }
+    bool empty() const { return text_->empty(); }
+
+    size_t lineCount() const { return lineStarts_->size(); }
+    // Line holding the byte at offset, by binary search
+    int lineAt(size_t offset) const;
+    size_t lineStart(int line) const;
+    // The line without its line break
+    std::string_view line(int line) const;
+
+private:
+    std::shared_ptr<const std::string> text_;
+    std::shared_ptr<const std::vector<size_t>> lineStarts_;
+};
+
+// Maps increasing offsets to lines in amortised constant time, for lexers that
+// walk the text front to back
+class LineCursor {
+public:
+    explicit LineCursor(const SourceBuffer& source) : source_(source) {}
+
+    // Offsets passed in must not decrease
+    int lineAt(size_t offset);
+
+private:
+    const SourceBuffer& source_;
+    int line_ = 1;
+};
+
+enum class SourceLanguage { Cpp, Python, Go };
+
+// The source with everything that is not code blanked out, byte for byte, so
+// offsets (and therefore lines) are the same as in the original:
+//   - comments, and in C++ preprocessor directives, become spaces; their
+//     line breaks are kept
+//   - the inside of a string or character literal, line breaks included,
+//     becomes spaces; its opening and closing quote characters are kept, so
+//     R"x(...)x", """...""" and `...` all read as "   " or `   `
+// A lexer over code() never has to deal with escapes, raw strings or
+// comments, and takes the text of a literal from the original at the same
+// offsets.
+class SourceMask {
+public:
+    using Range = std::pair<size_t, size_t>;  // [begin, end) byte offsets
+
+    SourceMask(const SourceBuffer& source, SourceLanguage language);
+
+    const std::string& code() const { return code_; }
+    // Every comment, in source order, delimiters included
+    const std::vector<Range>& comments() const { return comments_; }
+
+private:
+    std::string code_;
+    std::vector<Range> comments_;
+};
+
+#endif // SOURCE_BUFFER_H
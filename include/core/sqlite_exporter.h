@@ -0,0 +1,87 @@
+#ifndef SQLITE_EXPORTER_H
+#define SQLITE_EXPORTER_H
+
+#include "xml_serializer.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// Shreds XML into a SQLite database straight from an XmlStreamReader token
+// stream. Every child of the root element is one row in a table named after
+// the element, so <book> records land in "book" and <author> records in
+// "author". Columns are the flattened record fields (see XmlRecordBuilder),
+// stored as TEXT; a field first seen in a later record adds a column. Each table
+// also gets an "_id" INTEGER PRIMARY KEY in document order.
+//
+// Rows are inserted through one prepared statement per table inside batched
+// transactions, with the database in WAL mode. On failure the current batch is
+// rolled back; earlier batches stay committed.
+class SqliteExporter {
+public:
+    // Called periodically with the number of input bytes consumed so far;
+    // returning false cancels the export.
+    using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+    SqliteExporter();
+    ~SqliteExporter();
+
+    bool exportStream(std::istream& input, const std::string& databasePath);
+    // Compressed input (.gz/.xz/.zst) is decompressed on the fly
+    bool exportFile(const std::string& inputPath, const std::string& databasePath);
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+    void setConfig(const XmlSerializer::SerializationConfig& config) { config_ = config; }
+    // Rows per transaction
+    void setBatchSize(size_t rows) { batchSize_ = rows ? rows : 1; }
+    // Drop tables that already exist instead of appending to them (default)
+    void setReplaceTables(bool replace) { replaceTables_ = replace; }
+
+    // Statistics of the last export
+    uint64_t getRecordCount() const { return recordCount_; }
+    size_t getTableCount() const { return tables_.size(); }
+    uint64_t getBytesRead() const { return bytesRead_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static constexpr size_t kDefaultBatchSize = 50000;
+    // Progress is reported after roughly this many input bytes
+    static constexpr uint64_t kProgressInterval = 1024 * 1024;
+
+private:
+    struct Table;
+
+    bool open(const std::string& databasePath);
+    void close();
+    bool execute(const char* sql);
+    bool fail(const std::string& message);
+
+    Table* tableFor(const std::string& name);
+    bool addColumn(Table& table, const std::string& column);
+    bool prepareInsert(Table& table);
+    bool insertRecord(const std::string& name,
+                      const std::vector<std::pair<std::string, std::string>>& fields);
+    bool reportProgress(uint64_t bytesRead);
+
+    XmlSerializer::SerializationConfig config_;
+    ProgressCallback progressCallback_;
+    size_t batchSize_;
+    bool replaceTables_;
+
+    sqlite3* db_;
+    std::vector<std::unique_ptr<Table>> tables_;
+    size_t rowsInBatch_;
+    uint64_t nextProgress_;
+    uint64_t bytesRead_;
+    uint64_t recordCount_;
+    std::string errorMessage_;
+};
+
+#endif // SQLITE_EXPORTER_H
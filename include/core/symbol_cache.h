@@ -0,0 +1,75 @@
+#ifndef SYMBOL_CACHE_H
+#define SYMBOL_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+#include "project_indexer.h"
+
+// On-disk cache of per-file code models for the project indexer.
+//
+// Each entry is keyed by the file's project-relative path and records its
+// size, modification time and a content hash next to the model. The indexer
+// trusts an entry whose size and time still match without reading the file,
+// and otherwise re-reads the file and reuses the entry if the hash matches.
+// The file stays memory-mapped while loaded: load() validates the header and
+// every record's bounds but decodes only the file metadata, and a model is
+// decoded from the mapping when readModel() asks for it. Values are in host
+// byte order, since it is a local cache and not an exchange format.
+class SymbolCache {
+public:
+    // A cached file. The path points into the mapping and is valid until the
+    // cache is cleared, reloaded or saved.
+    struct Entry {
+        std::string_view path;
+        SourceLanguage language;
+        uint64_t size;
+        int64_t modifiedTime;
+        uint64_t contentHash;
+        bool parsed;
+        size_t modelOffset;     // Encoded model, relative to the mapping
+        size_t modelBytes;
+    };
+
+    SymbolCache();
+    ~SymbolCache() = default;
+
+    // A missing cache file is not an error: the cache is just empty
+    bool load(const std::string& cachePath);
+    // Writes to a temporary file first, so a failed save keeps the old cache.
+    // Releases the loaded entries first: the mapping must not keep the old
+    // file open while it is replaced.
+    bool save(const std::string& cachePath, const std::vector<IndexedFile>& files);
+    void clear();
+
+    size_t size() const { return entries_.size(); }
+    // Entry for a project-relative path, or nullptr
+    const Entry* find(std::string_view path) const;
+    // Decodes an entry's model; false if its bytes are damaged. Does not
+    // modify the cache, so threads may decode different entries at once.
+    bool readModel(const Entry& entry, CodeModel& model) const;
+
+    // Cache file for a project root, in userCacheDirectory("index")
+    static std::string defaultCachePath(const std::string& rootPath);
+    // 64-bit hash of file contents, eight bytes per step
+    static uint64_t hashContent(const char* data, size_t size);
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    class Reader;
+
+    bool fail(const std::string& message);
+
+    MappedFile file_;
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string_view, size_t> byPath_;
+    std::string errorMessage_;
+};
+
+#endif // SYMBOL_CACHE_H
@@ -0,0 +1,124 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "code_model.h"
+
+// A function definition in the project
+struct SymbolLocation {
+    uint32_t file;      // Index of the file in the order it was added
+    uint32_t function;  // Index into that file's model functions
+};
+
+// Resolves call sites to the definitions they call, across the files of a
+// project, with what each language lets a call see:
+//   C++     the caller's class and its bases, then free functions anywhere;
+//           overloads are told apart by the number of arguments
+//   Python  nested functions, the module, "from" imports, modules imported
+//           by name, and the class of self and cls
+//   Go      the caller's package (directory), imported packages, and the
+//           type of the method's receiver
+//
+// Definitions are kept in hash maps keyed by the 64-bit hash of their scope
+// and name. A lookup hashes its parts in place, so resolving a call builds
+// no qualified strings and costs a fixed number of lookups; a whole project
+// resolves in time linear in its call sites. A hit is checked against the
+// names themselves, so hash collisions cost time but never a wrong result.
+//
+// Variables are not typed: a call through any other object resolves only
+// when a single class in the project has a method of that name.
+class SymbolTable {
+public:
+    SymbolTable();
+    ~SymbolTable() = default;
+
+    // Adds the definitions, types and imports of a file and returns its
+    // index. The path is relative to the project root and '/' separated; the
+    // model is referenced, not copied, and must outlive the table.
+    uint32_t addFile(const std::string& path, const CodeModel& model);
+    // Room for this many functions in all, ahead of adding their files
+    void reserve(size_t functionCount);
+    void clear();
+
+    size_t getFileCount() const { return files_.size(); }
+    const std::string& getPath(uint32_t file) const { return files_[file].path; }
+    const CodeFunction& getFunction(const SymbolLocation& location) const;
+
+    // Definitions with this name or qualified name ("Store::get",
+    // "(*Store).Get", "Loader.run"), in the order added
+    std::vector<SymbolLocation> findFunctions(const std::string& name) const;
+    std::vector<SymbolLocation> findQualified(const std::string& qualifiedName) const;
+
+    // The definition called by a call site of file; false when it is not
+    // defined in the table or cannot be told apart from another
+    bool resolve(uint32_t file, const CodeCall& call, SymbolLocation& target) const;
+
+    // Call graph node name of a definition: its qualified name, followed by
+    // the parameter types for C++ overloads ("max(int, int)"). Python and Go
+    // names start with their module or package directory ("tools.gen.load",
+    // "cmd/app.main") unless the file was added without a path. A C++
+    // declaration and its definition share their name. Calls that do not
+    // resolve are named by CodeModel::getCallName().
+    std::string getSymbolName(const SymbolLocation& location) const;
+
+    // FNV-1a of the parts one after the other, as if they were concatenated
+    static uint64_t hashName(std::initializer_list<std::string_view> parts);
+
+private:
+    struct File {
+        std::string path;
+        std::string directory;  // Up to the last '/', empty at the root
+        std::string module;     // Python dotted module, Go directory; empty without a path
+        const CodeModel* model;
+    };
+    // Base type names of every definition of a type name
+    struct TypeBases {
+        std::string name;
+        std::vector<std::string> bases;
+    };
+    // The first definition under a key, and whether another one differs
+    struct Shared {
+        SymbolLocation first;
+        bool shared;
+    };
+    using Bucket = std::vector<SymbolLocation>;
+
+    // Definitions named name whose container type is scope, "" for free
+    // functions. Go definitions are keyed by package too: the directory.
+    Bucket members(SourceLanguage language, std::string_view scope, std::string_view name,
+                   std::string_view package = std::string_view()) const;
+    // Members of type and of its base types, nearest first
+    Bucket classMembers(SourceLanguage language, std::string_view type, std::string_view name) const;
+    // The one class method named name, when only one class has it
+    Bucket uniqueMethod(SourceLanguage language, const std::string& name) const;
+    // Files of a Python module or a Go import path
+    std::vector<uint32_t> moduleFiles(SourceLanguage language, std::string_view module) const;
+    // Keeps the candidates in files, or those with the argument count
+    static Bucket inFiles(const Bucket& candidates, const std::vector<uint32_t>& files);
+    Bucket withArguments(const Bucket& candidates, int argumentCount) const;
+    // The nearest candidate: same file, then same directory, then first
+    bool pick(uint32_t file, const Bucket& candidates, SymbolLocation& target) const;
+
+    bool resolveCpp(uint32_t file, const CodeFunction& caller, const CodeCall& call, SymbolLocation& target) const;
+    bool resolvePython(uint32_t file, const CodeFunction& caller, const CodeCall& call,
+                       SymbolLocation& target) const;
+    bool resolveGo(uint32_t file, const CodeFunction& caller, const CodeCall& call, SymbolLocation& target) const;
+
+    std::vector<File> files_;
+    std::unordered_map<uint64_t, Bucket> byName_;
+    std::unordered_map<uint64_t, Bucket> byMember_;     // Language, Go package, container type and name
+    std::unordered_map<uint64_t, Bucket> byQualified_;
+    std::unordered_map<uint64_t, TypeBases> types_;      // Language and name
+    std::unordered_map<uint64_t, std::vector<uint32_t>> modules_;  // Language and every dotted or '/' suffix
+    std::unordered_map<uint64_t, Shared> methodOwners_;  // Language and method name: in more than one class
+                                                         // (or Go package)
+    std::unordered_map<uint64_t, Shared> overloads_;     // C++ qualified name: with other parameter types
+};
+
+#endif // SYMBOL_TABLE_H
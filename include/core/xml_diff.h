@@ -0,0 +1,87 @@
+#ifndef XML_DIFF_H
+#define XML_DIFF_H
+
+#include "xml_node.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Structural diff of two XmlNode trees. Subtrees are compared by their
+// cached Merkle hashes (XmlNode::getHash), so equal subtrees compare in O(1)
+// and are never descended into. Within a changed
+// element the runs of identical children at both ends are skipped, the rest
+// are matched by hash first, then by name and "id" attribute, and only the
+// matched pairs that still differ are compared further. Hashing a fresh tree
+// is one linear pass; everything after it is proportional to the changes.
+//
+// The result is an edit script grouped by parent, parents in document order.
+// A deleted subtree whose
+// hash equals an inserted one is reported as a single Move, as are children
+// that were reordered within the same parent.
+class XmlDiff {
+public:
+    struct Edit {
+        enum class Type {
+            Insert,           // newNode added at newPath
+            Delete,           // oldNode removed from oldPath
+            Move,             // same subtree at a different position
+            Rename,           // element name changed
+            UpdateValue,      // text, comment or processing instruction changed
+            InsertAttribute,
+            DeleteAttribute,
+            UpdateAttribute
+        };
+
+        Type type;
+        std::shared_ptr<XmlNode> oldNode;  // null for Insert
+        std::shared_ptr<XmlNode> newNode;  // null for Delete
+        // XPath-like locations such as "/catalog/book[3]/title[1]"
+        std::string oldPath;
+        std::string newPath;
+        std::string attribute;             // attribute edits only
+        std::string oldValue;
+        std::string newValue;
+    };
+
+    XmlDiff() = default;
+    ~XmlDiff() = default;
+
+    // Returns false (with an error) only for missing input; identical trees
+    // give an empty edit list
+    bool diff(const std::shared_ptr<XmlNode>& oldRoot, const std::shared_ptr<XmlNode>& newRoot);
+
+    const std::vector<Edit>& getEdits() const { return edits_; }
+    bool isIdentical() const { return edits_.empty(); }
+    // One line per edit: "+ path", "- path", "> from -> to", "~ path: old -> new"
+    std::string toScript() const;
+
+    // Nodes whose subtrees were compared, and subtrees skipped as identical
+    uint64_t getComparedCount() const { return comparedCount_; }
+    uint64_t getSkippedCount() const { return skippedCount_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    // Values longer than this are shortened in the edit script
+    static constexpr size_t kMaxScriptValueLength = 80;
+
+private:
+    using NodePtr = std::shared_ptr<XmlNode>;
+
+    void compareNodes(const NodePtr& oldNode, const NodePtr& newNode,
+                      const std::string& oldPath, const std::string& newPath);
+    void compareAttributes(const NodePtr& oldNode, const NodePtr& newNode,
+                           const std::string& oldPath, const std::string& newPath);
+    void compareChildren(const NodePtr& oldNode, const NodePtr& newNode,
+                         const std::string& oldPath, const std::string& newPath);
+    void detectMoves();
+
+    std::vector<Edit> edits_;
+    uint64_t comparedCount_ = 0;
+    uint64_t skippedCount_ = 0;
+    std::string errorMessage_;
+};
+
+#endif // XML_DIFF_H
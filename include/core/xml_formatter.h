@@ -0,0 +1,88 @@
+#ifndef XML_FORMATTER_H
+#define XML_FORMATTER_H
+
+#include "xml_stream_reader.h"
+#include <deque>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Reindents or minifies XML in one streaming pass over XmlStreamReader tokens,
+// without building an XmlNode tree. Tags, comments, CDATA sections and entity
+// references are copied byte for byte; only whitespace between tags changes.
+//
+// Elements with mixed content are copied verbatim, including everything below
+// them, so their whitespace is preserved. An element counts as mixed when one of
+// its direct children is CDATA, text that is not whitespace, or a whitespace run
+// without a line break (as in "<b>a</b> <i>b</i>"). Classifying an element looks
+// ahead at most kLookaheadBytes of its content; an element that is still
+// undecided after that is formatted as structured. Memory use is bounded by this
+// window plus the largest single token.
+class XmlFormatter {
+public:
+    enum class Mode {
+        Pretty,
+        Minify
+    };
+
+    struct Options {
+        Mode mode = Mode::Pretty;
+        int indentSize = 2;
+        bool useTabs = false;
+    };
+
+    XmlFormatter();
+    explicit XmlFormatter(const Options& options);
+    ~XmlFormatter() = default;
+
+    bool format(std::istream& input, std::ostream& output);
+    bool formatString(const std::string& input, std::string& output);
+
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& getOptions() const { return options_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static constexpr size_t kLookaheadBytes = 64 * 1024;
+    // Output is flushed to the stream in blocks of this size
+    static constexpr size_t kFlushThreshold = 256 * 1024;
+
+private:
+    struct Token {
+        XmlStreamReader::TokenType type = XmlStreamReader::TokenType::None;
+        std::string raw;
+        int depth = 0;
+        bool emptyElement = false;
+        bool whitespace = false;   // Text made only of whitespace
+        bool lineBreak = false;    // Text containing a line break
+    };
+
+    struct Frame {
+        bool verbatim;
+        bool hasChildren;
+    };
+
+    bool readToken(Token& token);
+    bool fetch();
+    bool isMixedContent();
+    void breakLine(int depth);
+    void markChild();
+    bool flush(std::ostream& output, bool force = false);
+
+    Options options_;
+    XmlStreamReader* reader_;
+    bool readerDone_;
+    bool hasHeld_;
+    Token held_;
+    std::deque<Token> pending_;
+    size_t pendingBytes_;
+    std::vector<Frame> frames_;
+    bool atStart_;
+    std::string out_;
+    std::string errorMessage_;
+};
+
+#endif // XML_FORMATTER_H
@@ -1,12 +1,15 @@
 #ifndef XML_NODE_H
 #define XML_NODE_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <QMetaType>
 
+struct SerializedFragmentCache;
+
 class XmlNode : public std::enable_shared_from_this<XmlNode> {
 public:
     enum class NodeType {
@@ -29,9 +32,9 @@ public:
     std::shared_ptr<XmlNode> getParent() const { return parent_.lock(); }
 
     // Setters
-    void setName(const std::string& name) { name_ = name; }
-    void setValue(const std::string& value) { value_ = value; }
-    void setType(NodeType type) { type_ = type; }
+    void setName(const std::string& name) { name_ = name; markModified(); }
+    void setValue(const std::string& value) { value_ = value; markModified(); }
+    void setType(NodeType type) { type_ = type; markModified(); }
     void setParent(std::shared_ptr<XmlNode> parent) { parent_ = parent; }
 
     // Attribute management
@@ -42,6 +45,8 @@ public:
     // Child management
     void addChild(std::shared_ptr<XmlNode> child);
     void removeChild(std::shared_ptr<XmlNode> child);
+    // Replaces the child at index (no-op when out of range)
+    void setChild(size_t index, std::shared_ptr<XmlNode> child);
     std::shared_ptr<XmlNode> findChild(const std::string& name) const;
 
     // Utility methods
@@ -49,6 +54,29 @@ public:
     int getDepth() const;
     std::string getPath() const;
 
+    // Change tracking: every mutation bumps the revision of this node and all of
+    // its ancestors, so a subtree is unchanged as long as its revision is.
+    uint64_t getRevision() const { return revision_; }
+    void markModified();
+
+    // Content hash of this subtree (type, name, value, attributes and the
+    // hashes of the children, in order). Computed on first use and cached;
+    // mutations invalidate it on the node and its ancestors, so after an edit
+    // only the path to the root is rehashed. Not safe to call concurrently
+    // on a tree whose hashes are not yet computed.
+    uint64_t getHash() const;
+    // Same content, in O(1) once both hashes are cached
+    bool contentEquals(const XmlNode& other) const { return getHash() == other.getHash(); }
+    // Whether the subtree differs from when its hash was taken
+    bool changedSince(uint64_t hash) const { return getHash() != hash; }
+    // Groups of two or more element subtrees with equal content, the groups
+    // with most copies first. Copies nested inside the copies of a reported
+    // group are not reported again.
+    std::vector<std::vector<std::shared_ptr<XmlNode>>> findDuplicateSubtrees() const;
+
+    // Serialized fragments of this subtree, owned by XmlSerializer::serializeIncremental
+    std::shared_ptr<SerializedFragmentCache>& fragmentCache() const { return fragmentCache_; }
+
 private:
     std::string name_;
     std::string value_;
@@ -56,6 +84,10 @@ private:
     std::map<std::string, std::string> attributes_;
     std::vector<std::shared_ptr<XmlNode>> children_;
     std::weak_ptr<XmlNode> parent_;
+    uint64_t revision_ = 0;
+    mutable uint64_t hash_ = 0;
+    mutable bool hashValid_ = false;
+    mutable std::shared_ptr<SerializedFragmentCache> fragmentCache_;
 };
 
 Q_DECLARE_METATYPE(std::shared_ptr<XmlNode>)
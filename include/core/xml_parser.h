@@ -11,9 +11,10 @@ public:
     XmlParser();
     ~XmlParser() = default;
 
-    // Main parsing methods
+    // Main parsing methods; parseFile also reads .gz/.xz/.zst files
     std::shared_ptr<XmlNode> parseFile(const std::string& filename);
     std::shared_ptr<XmlNode> parseString(const std::string& xmlContent);
+    std::shared_ptr<XmlNode> parseStream(std::istream& stream);
 
     // Error handling
     bool hasError() const { return !errorMessage_.empty(); }
@@ -38,6 +39,7 @@ private:
     void skipWhitespace(std::istream& stream);
     char peekNextChar(std::istream& stream);
     char getNextChar(std::istream& stream);
+    char peekSecondChar(std::istream& stream);
     bool isWhitespace(char c);
     std::string unescapeXml(const std::string& text);
     std::string escapeXml(const std::string& text) const;
@@ -0,0 +1,139 @@
+#ifndef XML_PIPELINE_H
+#define XML_PIPELINE_H
+
+#include "xml_serializer.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Declarative record pipeline over an XmlStreamReader token stream:
+//   source (children of the root, flattened by XmlRecordBuilder)
+//     -> filter -> project / rename -> map -> sink (JSON, CSV or a callback)
+// No XmlNode tree is built. Adjacent project and rename stages are fused into
+// one field mapping, so every record is copied once however many of them there
+// are, and a limit stops reading as soon as it is reached. Records that pass
+// are handed to the sink in batches of kBatchSize.
+//
+// Stages can be added through the API or parsed from a text form shared by the
+// GUI and the command line, stages separated by '|':
+//   records book | where price >= 10 | select @id, title, price | rename @id=id | limit 100
+class XmlPipeline {
+public:
+    using Field = std::pair<std::string, std::string>;
+
+    struct Record {
+        std::string name;           // element name of the record
+        std::vector<Field> fields;  // in document order, see XmlRecordBuilder
+
+        // nullptr if the record has no such field
+        const std::string* field(const std::string& key) const;
+        // Replaces the value of an existing field or appends a new one
+        void set(const std::string& key, const std::string& value);
+    };
+
+    enum class Comparison {
+        Exists,
+        Equal,
+        NotEqual,
+        Less,
+        LessOrEqual,
+        Greater,
+        GreaterOrEqual,
+        Contains
+    };
+
+    using Predicate = std::function<bool(const Record&)>;
+    using Mapper = std::function<void(Record&)>;
+    // Receives the records that passed every stage; returning false stops the run
+    using BatchCallback = std::function<bool(const std::vector<Record>& batch)>;
+    // Called periodically with the number of input bytes consumed so far;
+    // returning false cancels the run.
+    using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+    XmlPipeline();
+    ~XmlPipeline() = default;
+
+    // Stages, applied in the order they are added
+    XmlPipeline& records(const std::string& name);  // keep records of one element name
+    XmlPipeline& filter(Predicate predicate);
+    // Orders compare numerically when both sides are numbers, as text otherwise;
+    // a missing field fails every comparison except NotEqual
+    XmlPipeline& where(const std::string& field, Comparison comparison, const std::string& value = "");
+    XmlPipeline& project(const std::vector<std::string>& fields);
+    XmlPipeline& rename(const std::string& from, const std::string& to);
+    XmlPipeline& map(Mapper mapper);
+    XmlPipeline& limit(uint64_t count);
+    void clear();
+    bool isEmpty() const { return stages_.empty(); }
+
+    // Appends the stages of a text pipeline (see above). Besides records, where,
+    // select, rename and limit it knows "map <field> upper|lower|trim". Operators
+    // of where are = != < <= > >= and ~ (contains); "where <field>" tests that
+    // the field exists. Values may be double-quoted. On error nothing is added.
+    bool parse(const std::string& spec);
+
+    // Runs the pipeline, handing the surviving records to sink
+    bool run(std::istream& input, const BatchCallback& sink);
+    // JSON output is an array of flat objects; CSV takes its columns from the
+    // first record written, as XmlStreamConverter does
+    bool run(std::istream& input, std::ostream& output, XmlSerializer::Format format,
+             XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty);
+    // Compressed input and output are handled as in XmlStreamConverter::convertFile
+    bool runFile(const std::string& inputPath, const std::string& outputPath,
+                 XmlSerializer::Format format,
+                 XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty);
+    // The first maxRecords results; reading stops once they are found
+    std::vector<Record> preview(std::istream& input, size_t maxRecords);
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+    void setConfig(const XmlSerializer::SerializationConfig& config) { config_ = config; }
+
+    // Statistics of the last run
+    uint64_t getRecordsRead() const { return recordsRead_; }
+    uint64_t getRecordsWritten() const { return recordsWritten_; }
+    uint64_t getBytesRead() const { return bytesRead_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static constexpr size_t kBatchSize = 1024;
+    // Output is flushed to the stream in blocks of this size
+    static constexpr size_t kFlushThreshold = 256 * 1024;
+    // Progress is reported after roughly this many input bytes
+    static constexpr uint64_t kProgressInterval = 1024 * 1024;
+
+private:
+    struct Stage {
+        enum class Kind { Records, Filter, Project, Rename, Map, Limit };
+        Kind kind;
+        std::string name;                 // Records
+        Predicate predicate;              // Filter
+        std::vector<std::string> fields;  // Project
+        std::string from;                 // Rename
+        std::string to;
+        Mapper mapper;                    // Map
+        uint64_t count = 0;               // Limit
+    };
+
+    // Executable form of the stages, see compile()
+    struct Step;
+
+    std::vector<Step> compile() const;
+    bool reportProgress(uint64_t bytesRead);
+
+    std::vector<Stage> stages_;
+    XmlSerializer::SerializationConfig config_;
+    ProgressCallback progressCallback_;
+    uint64_t nextProgress_;
+    uint64_t recordsRead_;
+    uint64_t recordsWritten_;
+    uint64_t bytesRead_;
+    std::string errorMessage_;
+};
+
+#endif // XML_PIPELINE_H
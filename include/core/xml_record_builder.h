@@ -0,0 +1,45 @@
+#ifndef XML_RECORD_BUILDER_H
+#define XML_RECORD_BUILDER_H
+
+#include "xml_serializer.h"
+#include "xml_stream_reader.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Flattens every child of the root element into one record of named fields
+// while tokens stream past, for tabular outputs (CSV, SQLite). Field names are
+// the record's attributes (prefixed with config.attributePrefix), the text of
+// nested elements as dotted paths ("address.city"), nested attributes as
+// "address.@zip" and the record's own text under config.textElementName.
+// Repeated fields within one record are joined with "; ".
+class XmlRecordBuilder {
+public:
+    using Field = std::pair<std::string, std::string>;
+
+    explicit XmlRecordBuilder(const XmlSerializer::SerializationConfig& config);
+
+    void startElement(const XmlStreamReader& reader);
+    // Returns true when the element closed a record; its fields stay
+    // available until the next record starts
+    bool endElement();
+    void characters(const XmlStreamReader& reader);
+
+    const std::string& recordName() const { return recordName_; }
+    const std::vector<Field>& fields() const { return fields_; }
+    // nullptr if the current record has no such field
+    const std::string* field(const std::string& name) const;
+
+private:
+    void setField(const std::string& name, const std::string& value);
+
+    const XmlSerializer::SerializationConfig& config_;
+    std::string recordName_;
+    std::vector<Field> fields_;
+    std::unordered_map<std::string, size_t> fieldIndex_;
+    std::vector<std::string> path_;   // dotted paths of open elements below the record
+    std::vector<std::string> texts_;  // text of the record and its open descendants
+};
+
+#endif // XML_RECORD_BUILDER_H
@@ -0,0 +1,103 @@
+#ifndef XML_RECORD_INDEX_H
+#define XML_RECORD_INDEX_H
+
+#include "mapped_file.h"
+#include "xml_node.h"
+#include "xml_record_scanner.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Random access to the records (children of the root) of a large XML file.
+//
+// The index keeps the byte offset of every stride-th record, so finding record
+// n means one binary search plus skipping fewer than stride records with
+// XmlRecordScanner. Records can also be indexed by the value of one attribute
+// of their start tag (e.g. "id"). Only the requested records are parsed.
+//
+// The index is saved to a file and reused until the source file changes. It is
+// built in segments: the records of each segment are found in parallel, then
+// appended to the index file with a checkpoint. An interrupted or cancelled
+// build resumes from the last checkpoint when build() is called again.
+//
+// Parallel scanning starts each chunk at the first "<name" of the record
+// element after the chunk's nominal start. The guess is checked against where
+// the previous chunk actually ended, and a chunk that started inside a record
+// is rescanned from the right place, so the result never depends on the guess.
+class XmlRecordIndex {
+public:
+    // Called with the source bytes indexed so far and the total; returning false
+    // cancels the build, which can be resumed later
+    using ProgressCallback = std::function<bool(uint64_t bytesDone, uint64_t bytesTotal)>;
+
+    struct Options {
+        std::string keyAttribute;              // also index records by this attribute
+        uint64_t stride = kDefaultStride;      // records per offset entry
+        uint64_t segmentBytes = kSegmentBytes; // source bytes between checkpoints
+        unsigned threadCount = 0;              // 0 = one per hardware thread
+    };
+
+    XmlRecordIndex();
+    ~XmlRecordIndex() = default;
+
+    // Builds the index of sourcePath into indexPath, resuming an interrupted
+    // build with the same options. A complete, current index is just loaded.
+    bool build(const std::string& sourcePath, const std::string& indexPath, const Options& options);
+    // Loads a complete index; fails if it is missing, unfinished or stale
+    bool load(const std::string& sourcePath, const std::string& indexPath);
+    void close();
+
+    bool isOpen() const { return source_.isOpen() && complete_; }
+    uint64_t getRecordCount() const { return recordCount_; }
+    const std::string& getKeyAttribute() const { return keyAttribute_; }
+
+    // Byte range [begin, end) of record number ordinal (0-based)
+    bool findRecord(uint64_t ordinal, uint64_t& begin, uint64_t& end);
+    // Ordinals of the records whose key attribute has this value, in order
+    std::vector<uint64_t> findByKey(const std::string& value) const;
+    bool readRecordText(uint64_t ordinal, std::string& text);
+    std::shared_ptr<XmlNode> readRecord(uint64_t ordinal);
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+
+    // "<source>.nxidx" beside the source when that directory is writable,
+    // otherwise a file in userCacheDirectory("index")
+    static std::string defaultIndexPath(const std::string& sourcePath);
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static constexpr uint64_t kDefaultStride = 1024;
+    static constexpr uint64_t kSegmentBytes = 256ull * 1024 * 1024;
+
+private:
+    struct Header;
+    struct ChunkResult;
+
+    bool openSource(const std::string& sourcePath);
+    bool readIndex(const std::string& indexPath, Header& header);
+    bool indexSegment(size_t begin, size_t end, unsigned threadCount, size_t& next);
+    ChunkResult scanChunk(size_t start, size_t limit) const;
+    size_t findCandidate(size_t from) const;
+    bool fail(const std::string& message);
+
+    MappedFile source_;
+    XmlRecordScanner::Layout layout_;
+    uint64_t sourceSize_;
+    int64_t sourceTime_;
+    std::string recordName_;  // name of the first record, for resynchronizing chunks
+    std::string keyAttribute_;
+    uint64_t stride_;
+    bool complete_;
+    uint64_t recordCount_;
+    std::vector<std::pair<uint64_t, uint64_t>> offsets_;  // (ordinal, byte offset), ascending
+    std::vector<std::pair<std::string, uint64_t>> keys_;  // (key, ordinal), sorted
+    ProgressCallback progressCallback_;
+    std::string errorMessage_;
+};
+
+#endif // XML_RECORD_INDEX_H
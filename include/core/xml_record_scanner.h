@@ -0,0 +1,67 @@
+#ifndef XML_RECORD_SCANNER_H
+#define XML_RECORD_SCANNER_H
+
+#include <cstddef>
+#include <string>
+
+// Finds record boundaries in an in-memory (typically memory-mapped) XML
+// document of the form <root><record/>...</root>, where every child of the root
+// is one record. Only markup is examined: text is skipped with memchr, and
+// comments, CDATA, processing instructions and quoted attribute values are
+// stepped over so a '<' or '>' inside them is not mistaken for a tag. Tag names
+// are not matched against each other, which keeps the scan cheap; use
+// XmlStreamReader when the input also needs validating.
+class XmlRecordScanner {
+public:
+    // Byte offsets into the document
+    struct Layout {
+        size_t rootBegin = 0;     // '<' of the root start tag
+        size_t contentBegin = 0;  // just past the root start tag
+        size_t contentEnd = 0;    // '<' of the root end tag
+        size_t rootEnd = 0;       // just past the root end tag
+        std::string rootName;
+    };
+
+    XmlRecordScanner(const char* data, size_t size);
+
+    // Locates the root start tag (skipping the prolog) and its end tag
+    // (searching back from the end of the document). Must be called first.
+    bool scanLayout();
+    // Locates only the root start tag, for a document still being written;
+    // contentEnd and rootEnd are left at the end of the data
+    bool scanRootStart();
+    const Layout& layout() const { return layout_; }
+
+    // Scans [begin, end) as a run of records instead of the root's content.
+    // With partial set, for input that is still being written, the run may stop
+    // part way through a record: nextRecord() then stops without an error at a
+    // truncated record, leaving pos at its start, and at an end tag outside any
+    // record (the root being closed), leaving pos at its '<' and setting
+    // reachedEndTag().
+    void setContentRange(size_t begin, size_t end, bool partial = false);
+    bool reachedEndTag() const { return reachedEndTag_; }
+
+    // Advances pos, which starts at layout().contentBegin, to the next record
+    // and reports it as [begin, end). Returns false after the last record or on
+    // error; check hasError() to tell them apart.
+    bool nextRecord(size_t& pos, size_t& begin, size_t& end);
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    size_t find(const char* pattern, size_t from, size_t limit) const;
+    size_t findTagEnd(size_t from, size_t limit) const;
+    size_t skipMarkup(size_t pos, size_t limit) const;
+    bool fail(const std::string& message, size_t offset);
+
+    const char* data_;
+    size_t size_;
+    Layout layout_;
+    bool partial_;
+    bool reachedEndTag_;
+    std::string errorMessage_;
+};
+
+#endif // XML_RECORD_SCANNER_H
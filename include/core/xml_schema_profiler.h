@@ -0,0 +1,123 @@
+#ifndef XML_SCHEMA_PROFILER_H
+#define XML_SCHEMA_PROFILER_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Infers the structure of an XML document in one streaming pass over
+// XmlStreamReader tokens. For every distinct element path
+// ("/catalog/book/title") it records how often the element occurs, how many
+// times per parent, which children and attributes it has, and what its text
+// and attribute values look like. Memory grows with the number of distinct
+// paths, not with the document.
+//
+// profileFile() cuts uncompressed input into runs of records (children of the
+// root) with XmlRecordScanner and profiles the runs in parallel. The partial
+// profiles are merged into the same result a sequential pass gives, except
+// that value samples may be picked in a different order.
+class XmlSchemaProfiler {
+public:
+    // Statistics of the values of one attribute or of one element's text
+    struct ValueStats {
+        uint64_t count = 0;
+        size_t minLength = 0;
+        size_t maxLength = 0;
+        double minNumber = 0;
+        double maxNumber = 0;
+        // Whether every value so far parses as the type
+        bool allBoolean = true;
+        bool allInteger = true;
+        bool allDecimal = true;
+        bool allDate = true;
+        bool allDateTime = true;
+        // The first kMaxDistinctValues distinct values with their counts;
+        // more values only set truncatedSamples
+        std::vector<std::pair<std::string, uint64_t>> samples;
+        bool truncatedSamples = false;
+
+        void add(const std::string& value);
+        void merge(const ValueStats& other);
+        // Narrowest XSD type that fits every value: boolean, integer, decimal,
+        // date, dateTime or string
+        std::string typeName() const;
+    };
+
+    struct ElementStats {
+        std::string name;
+        int depth = 0;
+        uint64_t count = 0;
+        // Occurrences per parent element, over the parents that contain it
+        uint64_t parentCount = 0;
+        uint64_t minPerParent = 0;
+        uint64_t maxPerParent = 0;
+        uint64_t withChildren = 0;  // instances with child elements
+        uint64_t mixedCount = 0;    // instances with both text and child elements
+        ValueStats text;            // non-whitespace text content
+        std::map<std::string, ValueStats> attributes;
+        std::vector<std::string> children;  // child element names, first seen first
+    };
+
+    struct Profile {
+        std::map<std::string, ElementStats> elements;  // by path
+        std::vector<uint64_t> depthHistogram;          // elements per depth
+        uint64_t elementCount = 0;
+        std::string rootPath;
+
+        void merge(const Profile& other);
+        // 0 when some parent instance lacks the element
+        uint64_t minOccurs(const std::string& path) const;
+        uint64_t maxOccurs(const std::string& path) const;
+    };
+
+    // Called periodically with the input bytes consumed so far; returning
+    // false cancels profiling
+    using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+    XmlSchemaProfiler();
+    ~XmlSchemaProfiler() = default;
+
+    bool profileStream(std::istream& input);
+    bool profileString(const std::string& xml);
+    // Parallel for plain files; compressed files are profiled sequentially
+    bool profileFile(const std::string& path);
+
+    const Profile& getProfile() const { return profile_; }
+    // XML Schema draft: nested anonymous types, children as sequences in
+    // first-seen order
+    std::string toXsd() const;
+    // Plain-text summary, one block per path
+    std::string toReport() const;
+
+    // 0 uses one thread per hardware thread (default)
+    void setThreadCount(unsigned threads) { threadCount_ = threads; }
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static constexpr size_t kMaxDistinctValues = 20;
+    // Samples are cut to this length; the type checks still see the whole value
+    static constexpr size_t kMaxSampleLength = 128;
+    // Text beyond this many bytes per element is not profiled
+    static constexpr size_t kMaxTextLength = 64 * 1024;
+    static constexpr uint64_t kProgressInterval = 1024 * 1024;
+
+private:
+    class Builder;
+
+    bool profileMapped(const char* data, size_t size);
+    bool fail(const std::string& message);
+
+    Profile profile_;
+    unsigned threadCount_;
+    ProgressCallback progressCallback_;
+    std::string errorMessage_;
+};
+
+#endif // XML_SCHEMA_PROFILER_H
@@ -5,6 +5,9 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <vector>
+
+struct SerializedFragments;
 
 class XmlSerializer {
 public:
@@ -12,7 +15,9 @@ public:
         XML,
         JSON,
         YAML,
-        CSV
+        CSV,
+        CBOR,         // 二进制, RFC 8949
+        MessagePack   // 二进制
     };
     
     enum class OutputStyle {
@@ -39,16 +44,45 @@ public:
     // CSV序列化 (适用于表格数据)
     std::string serializeToCsv(const std::shared_ptr<XmlNode>& node) const;
     
+    // 二进制序列化 (结构与 JSON 导出相同, 返回原始字节)
+    std::string serializeToCbor(const std::shared_ptr<XmlNode>& node) const;
+    std::string serializeToMessagePack(const std::shared_ptr<XmlNode>& node) const;
+    
     // 通用序列化接口
     std::string serialize(const std::shared_ptr<XmlNode>& node,
                          Format format = Format::XML,
                          OutputStyle style = OutputStyle::Pretty) const;
 
+    // 并行序列化: 根节点的子树按大小均衡分块, 各线程写入独立缓冲区后按顺序拼接.
+    // 输出与 serialize() 完全一致; threadCount 为 0 时使用硬件并发数.
+    std::string serializeParallel(const std::shared_ptr<XmlNode>& node,
+                                  Format format = Format::XML,
+                                  OutputStyle style = OutputStyle::Pretty,
+                                  unsigned threadCount = 0) const;
+
+    // 增量序列化: 前 config.fragmentCacheDepth 层子树的序列化片段缓存在节点上,
+    // 再次导出时 revision 未变的子树直接拼接缓存字节, 只重新生成被修改的子树.
+    // 输出与 serialize() 完全一致; 顶层的失效子树可并行重建.
+    std::string serializeIncremental(const std::shared_ptr<XmlNode>& node,
+                                     Format format = Format::XML,
+                                     OutputStyle style = OutputStyle::Pretty,
+                                     unsigned threadCount = 0) const;
+
+    // 释放子树上的所有片段缓存
+    void clearFragmentCache(const std::shared_ptr<XmlNode>& node) const;
+
     // 反序列化
     std::shared_ptr<XmlNode> deserializeFromXml(const std::string& content) const;
     std::shared_ptr<XmlNode> deserializeFromJson(const std::string& content) const;
     std::shared_ptr<XmlNode> deserializeFromYaml(const std::string& content) const;
     std::shared_ptr<XmlNode> deserializeFromCsv(const std::string& content) const;
+    // 除单个对象外, 也接受流式导出的 "根节点头 + 逐条记录" 对象序列
+    std::shared_ptr<XmlNode> deserializeFromCbor(const std::string& content) const;
+    std::shared_ptr<XmlNode> deserializeFromMessagePack(const std::string& content) const;
+    
+    static bool isBinaryFormat(Format format) {
+        return format == Format::CBOR || format == Format::MessagePack;
+    }
 
     // 验证功能
     bool validateXml(const std::string& xmlContent) const;
@@ -61,24 +95,6 @@ public:
     std::string convertToJson(const std::shared_ptr<XmlNode>& node) const;
     std::string convertToYaml(const std::shared_ptr<XmlNode>& node) const;
 
-private:
-    // 内部辅助方法
-    std::string _serializeXmlNode(const std::shared_ptr<XmlNode>& node, 
-                                 int indent = 0, 
-                                 OutputStyle style = OutputStyle::Pretty) const;
-    std::string _serializeJsonNode(const std::shared_ptr<XmlNode>& node,
-                                  int indent = 0,
-                                  OutputStyle style = OutputStyle::Pretty) const;
-    std::string _serializeYamlNode(const std::shared_ptr<XmlNode>& node,
-                                  int indent = 0,
-                                  OutputStyle style = OutputStyle::Pretty) const;
-    std::string _serializeCsvNode(const std::shared_ptr<XmlNode>& node) const;
-    
-    std::string _getIndent(int level, OutputStyle style) const;
-    std::string _escapeXmlString(const std::string& str) const;
-    std::string _escapeJsonString(const std::string& str) const;
-    std::string _escapeYamlString(const std::string& str) const;
-    
     // 配置选项
     struct SerializationConfig {
         bool includeComments = true;
@@ -87,7 +103,24 @@ private:
         std::string rootElementName = "root";
         std::string textElementName = "text";
         std::string attributePrefix = "@";
+        size_t parallelMinNodes = 4096;  // 小于该节点数时并行模式退化为串行
+        int fragmentCacheDepth = 2;      // 增量序列化缓存的层数, 每层约占一份输出大小的内存
     };
+
+    const SerializationConfig& getConfig() const { return config_; }
+
+private:
+    // 内部辅助方法: 按 Format × OutputStyle 分派到编译期特化的写出器 (serialization_writers.h)
+    void _writeNode(const std::shared_ptr<XmlNode>& node, Format format, OutputStyle style,
+                    int indent, std::string& out,
+                    const SerializedFragments* fragments = nullptr) const;
+    std::string _serializeCsvNode(const std::shared_ptr<XmlNode>& node) const;
+    SerializedFragments _serializeChildrenParallel(const std::shared_ptr<XmlNode>& node,
+                                                   Format format, OutputStyle style,
+                                                   unsigned threadCount) const;
+    void _writeIncremental(const std::shared_ptr<XmlNode>& node, Format format,
+                           OutputStyle style, int indent, int depth,
+                           unsigned threadCount, std::string& out) const;
     
     SerializationConfig config_;
 };
@@ -0,0 +1,76 @@
+#ifndef XML_SPLITTER_H
+#define XML_SPLITTER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Splits record-oriented XML (a root element whose children are the records)
+// into smaller well-formed files, and merges such files back into one.
+//
+// The input is memory-mapped and scanned once with XmlRecordScanner to plan the
+// output; the files are then written in parallel straight from the mapping.
+// Every shard repeats the original prolog, root start tag and root end tag, and
+// the bytes between records (whitespace, comments) are kept, so merging the
+// shards of a split reproduces the input byte for byte. Compressed input is not
+// supported since it cannot be mapped.
+class XmlSplitter {
+public:
+    // Called with the bytes written so far and the total to write; returning
+    // false cancels the operation. Always called on the calling thread.
+    using ProgressCallback = std::function<bool(uint64_t bytesDone, uint64_t bytesTotal)>;
+
+    XmlSplitter();
+    ~XmlSplitter() = default;
+
+    // Shards are written to outputDirectory (created if missing) as
+    // <input stem>.part-0001.xml, <input stem>.part-0002.xml, ...
+    bool splitByRecordCount(const std::string& inputPath, const std::string& outputDirectory,
+                            uint64_t recordsPerFile);
+    // Records are packed into shards of at most maxBytes each, counting the
+    // repeated prolog and root tags; a record too large to fit gets a shard of
+    // its own
+    bool splitBySize(const std::string& inputPath, const std::string& outputDirectory,
+                     uint64_t maxBytes);
+
+    // Concatenates the records of the inputs, which must share a root element
+    // name, under the prolog and root element of the first input
+    bool merge(const std::vector<std::string>& inputPaths, const std::string& outputPath);
+
+    // 0 uses one thread per hardware thread (default)
+    void setThreadCount(unsigned threads) { threadCount_ = threads; }
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+
+    // Results of the last operation
+    const std::vector<std::string>& getOutputFiles() const { return outputFiles_; }
+    uint64_t getRecordCount() const { return recordCount_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    // Large copies are broken into pieces of this size so they spread across threads
+    static constexpr size_t kWriteChunk = 8 * 1024 * 1024;
+
+private:
+    enum class Limit {
+        Records,
+        Bytes
+    };
+
+    struct WriteTask;
+
+    bool split(const std::string& inputPath, const std::string& outputDirectory,
+               Limit limit, uint64_t amount);
+    bool writeTasks(const std::vector<WriteTask>& tasks, const std::vector<uint64_t>& fileSizes);
+    bool fail(const std::string& message);
+
+    unsigned threadCount_;
+    ProgressCallback progressCallback_;
+    std::vector<std::string> outputFiles_;
+    uint64_t recordCount_;
+    std::string errorMessage_;
+};
+
+#endif // XML_SPLITTER_H
@@ -0,0 +1,80 @@
+#ifndef XML_STREAM_CONVERTER_H
+#define XML_STREAM_CONVERTER_H
+
+#include "xml_serializer.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Converts XML to JSON, YAML, CSV, CBOR or MessagePack straight from an
+// XmlStreamReader token stream, without building an XmlNode tree. JSON and YAML
+// output uses the same writers as XmlSerializer, so a document converted here
+// matches the DOM export of the same file parsed by XmlParser. Character data
+// that precedes an element's first child is emitted as the element's text,
+// trimmed; the DOM writers take it from the element's leading Text children
+// (only the whitespace around a comment inside that text can differ, as the
+// parser trims each Text node on its own). CSV output treats
+// every child of the root as one row (see convert()). CBOR uses
+// indefinite-length containers and MessagePack is written as a root header
+// followed by one object per record; XmlSerializer reads both back.
+class XmlStreamConverter {
+public:
+    // Called periodically with the number of input bytes consumed so far;
+    // returning false cancels the conversion.
+    using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+    XmlStreamConverter();
+    ~XmlStreamConverter() = default;
+
+    // Converts input to output in the given format. XML is not a valid target.
+    // CSV columns are taken from the first record: its attributes (prefixed with
+    // config.attributePrefix), the text of nested elements as dotted paths and
+    // the record's own text under config.textElementName. Fields missing from a
+    // record are left empty and fields unknown to the header are dropped.
+    bool convert(std::istream& input, std::ostream& output,
+                 XmlSerializer::Format format,
+                 XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty);
+
+    // Compressed input (.gz/.xz/.zst) is detected from its contents and
+    // progress is then reported in compressed bytes, to match the file size.
+    // An output path ending in .gz/.xz/.zst is compressed the same way.
+    bool convertFile(const std::string& inputPath, const std::string& outputPath,
+                     XmlSerializer::Format format,
+                     XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty);
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback_ = std::move(callback); }
+    void setConfig(const XmlSerializer::SerializationConfig& config) { config_ = config; }
+    const XmlSerializer::SerializationConfig& getConfig() const { return config_; }
+
+    // Statistics of the last conversion
+    uint64_t getBytesRead() const { return bytesRead_; }
+    uint64_t getElementCount() const { return elementCount_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    // Output is flushed to the stream in blocks of this size
+    static constexpr size_t kFlushThreshold = 256 * 1024;
+    // Progress is reported after roughly this many input bytes
+    static constexpr uint64_t kProgressInterval = 1024 * 1024;
+
+private:
+    // Pulls tokens from the reader and hands them to a format-specific emitter
+    template <typename Emitter>
+    bool run(std::istream& input, std::ostream& output, Emitter& emitter);
+
+    bool reportProgress(uint64_t bytesRead);
+    bool flush(std::string& buffer, std::ostream& output, bool force = false);
+
+    XmlSerializer::SerializationConfig config_;
+    ProgressCallback progressCallback_;
+    uint64_t nextProgress_;
+    uint64_t bytesRead_;
+    uint64_t elementCount_;
+    std::string errorMessage_;
+};
+
+#endif // XML_STREAM_CONVERTER_H
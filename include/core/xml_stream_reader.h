@@ -0,0 +1,100 @@
+#ifndef XML_STREAM_READER_H
+#define XML_STREAM_READER_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Pull-style XML tokenizer over a std::istream. Memory stays bounded by the
+// largest single token plus the stack of open element names, so documents far
+// larger than RAM can be processed. Self-closing tags are reported as a
+// StartElement (isEmptyElement() == true) followed by a synthesized EndElement.
+class XmlStreamReader {
+public:
+    enum class TokenType {
+        None,
+        StartElement,
+        EndElement,
+        Text,
+        CData,
+        Comment,
+        ProcessingInstruction,
+        Doctype,
+        EndDocument,
+        Error
+    };
+
+    using Attribute = std::pair<std::string, std::string>;
+
+    explicit XmlStreamReader(std::istream& input, size_t chunkSize = 64 * 1024);
+    ~XmlStreamReader() = default;
+
+    // Advances to the next token and returns its type
+    TokenType next();
+
+    // Current token
+    TokenType tokenType() const { return tokenType_; }
+    const std::string& name() const { return name_; }
+    const std::vector<Attribute>& attributes() const { return attributes_; }
+    std::string attribute(const std::string& key) const;
+    // Decoded character data for Text/CData, raw content for Comment/PI/Doctype
+    const std::string& text() const { return text_; }
+    // The exact bytes of the current token as they appear in the input
+    const std::string& rawToken() const { return raw_; }
+    bool isEmptyElement() const { return emptyElement_; }
+    bool isWhitespace() const;
+
+    // Depth of the current token: the root start/end tag is at depth 0,
+    // its children (and text inside the root) at depth 1, and so on.
+    int depth() const { return depth_; }
+    uint64_t bytesConsumed() const { return consumedBefore_ + pos_; }
+    uint64_t tokenOffset() const { return tokenOffset_; }
+    int lineNumber() const { return line_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    static std::string unescape(const std::string& text);
+    static void appendUnescaped(std::string& out, const char* begin, const char* end);
+
+private:
+    std::istream& input_;
+    size_t chunkSize_;
+    std::string buffer_;
+    size_t pos_;
+    uint64_t consumedBefore_;
+    bool eof_;
+
+    TokenType tokenType_;
+    std::string name_;
+    std::vector<Attribute> attributes_;
+    std::string text_;
+    std::string raw_;
+    bool emptyElement_;
+    bool pendingEnd_;
+    int depth_;
+    int line_;
+    int lineCursor_;
+    uint64_t tokenOffset_;
+    std::vector<std::string> openElements_;
+    std::string errorMessage_;
+
+    bool fill();
+    void compact();
+    size_t find(const char* pattern, size_t from);
+    size_t findTagEnd(size_t from);
+    size_t findDoctypeEnd(size_t from);
+    bool startsWith(const char* prefix);
+    void takeRaw(size_t end);
+    TokenType fail(const std::string& message);
+
+    TokenType readMarkup();
+    TokenType readStartTag(size_t end);
+    TokenType readEndTag(size_t end);
+    TokenType readText();
+};
+
+#endif // XML_STREAM_READER_H
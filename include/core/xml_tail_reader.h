@@ -0,0 +1,77 @@
+#ifndef XML_TAIL_READER_H
+#define XML_TAIL_READER_H
+
+#include "xml_node.h"
+#include "xml_parser.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Follows an XML file that is being appended to, such as an event log of the
+// form <log><event/>...  whose root end tag has not been written yet. Each
+// poll() reads only the bytes added since the previous one, parses the records
+// (children of the root) they complete and appends them to rootNode(). A record
+// that is only partly written is kept and finished on a later poll.
+//
+// If the file shrinks (truncated or replaced by a shorter one), the reader starts
+// over from the beginning and reports it through Update::restarted.
+class XmlTailReader {
+public:
+    struct Update {
+        // Bytes read from the file up to the end of the last complete record,
+        // for mirroring the file in an editor
+        std::string appendedText;
+        // Records completed since the last poll, already added to rootNode()
+        std::vector<std::shared_ptr<XmlNode>> records;
+        // The file was truncated: rootNode() and the text start from scratch
+        bool restarted = false;
+        // More data is waiting than one poll reads; poll again soon
+        bool hasMore = false;
+    };
+
+    XmlTailReader();
+    ~XmlTailReader() = default;
+
+    // Starts following path from its beginning; nothing is read until poll()
+    bool open(const std::string& path);
+    void close();
+    bool poll(Update& update);
+
+    bool isOpen() const { return !path_.empty(); }
+    const std::string& path() const { return path_; }
+    // Set once the root start tag has been read
+    std::shared_ptr<XmlNode> rootNode() const { return root_; }
+    // The root end tag has been written
+    bool isFinished() const { return finished_; }
+    uint64_t getRecordCount() const { return recordCount_; }
+    uint64_t getBytesRead() const { return fileOffset_; }
+
+    // Error handling
+    bool hasError() const { return !errorMessage_.empty(); }
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+    // Upper bound on the bytes read by one poll, so catching up with a large
+    // file does not stall the caller
+    static constexpr size_t kMaxReadPerPoll = 8 * 1024 * 1024;
+    // Give up if the root start tag has not appeared within this many bytes
+    static constexpr size_t kMaxPrologBytes = 1024 * 1024;
+
+private:
+    void reset();
+    bool readAppended(Update& update);
+    bool readRootStart(Update& update);
+    bool readRecords(Update& update);
+    bool fail(const std::string& message);
+
+    std::string path_;
+    uint64_t fileOffset_;   // bytes read from the file so far
+    std::string pending_;   // read but not yet consumed: starts at a record boundary
+    std::shared_ptr<XmlNode> root_;
+    bool finished_;
+    uint64_t recordCount_;
+    XmlParser parser_;
+    std::string errorMessage_;
+};
+
+#endif // XML_TAIL_READER_H
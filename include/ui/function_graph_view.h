@@ -19,7 +19,7 @@
 #include <QComboBox>
 #include <map>
 #include <vector>
-#include "cpp_parser.h"
+#include "code_model.h"
 
 class FunctionNode;
 class FunctionEdge;
@@ -31,8 +31,8 @@ public:
     explicit FunctionGraphView(QWidget* parent = nullptr);
     ~FunctionGraphView();
     
-    // 设置 C++ 解析数据
-    void setParserData(const CppParser& parser);
+    // 设置解析数据 (C++、Python、Go 解析器共用的代码模型)
+    void setCodeModel(const CodeModel& model);
     
     // 生成函数关系图
     void generateGraph();
@@ -75,11 +75,11 @@ private:
     QLabel* detailsLabel_;
     
     // 数据
-    std::vector<CppFunction> functions_;
-    std::vector<CppClass> classes_;
-    std::map<std::string, std::vector<std::string>> functionCalls_;
+    std::vector<CodeFunction> functions_;
+    std::vector<CallGraph::NodeId> functionNodes_;  // 每个函数在调用图中的节点
+    CallGraph callGraph_;
     
-    // 图形节点
+    // 图形节点, 以调用图节点名为键: 声明和定义共用一个节点, 同名方法各占一个
     std::map<std::string, FunctionNode*> nodes_;
     std::vector<FunctionEdge*> edges_;
     
@@ -97,9 +97,10 @@ class FunctionNode : public QObject, public QGraphicsEllipseItem {
     Q_OBJECT
     
 public:
-    FunctionNode(const CppFunction& function, QGraphicsItem* parent = nullptr);
+    FunctionNode(const CodeFunction& function, CallGraph::NodeId graphNode, QGraphicsItem* parent = nullptr);
     
-    const CppFunction& getFunction() const { return function_; }
+    const CodeFunction& getFunction() const { return function_; }
+    CallGraph::NodeId getGraphNode() const { return graphNode_; }
     void setSelected(bool selected);
     void updatePosition(const QPointF& pos);
     
@@ -116,7 +117,8 @@ signals:
     void nodeClicked(FunctionNode* node);
 
 private:
-    CppFunction function_;
+    CodeFunction function_;
+    CallGraph::NodeId graphNode_;
     QGraphicsTextItem* textItem_;
     bool isSelected_;
     bool isHighlighted_;
@@ -26,17 +26,31 @@
 #include <QTabWidget>
 #include <QTextBrowser>
 #include <QProgressBar>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDateTime>
+#include <atomic>
+#include <functional>
+#include <thread>
 #include "xml_parser.h"
 #include "xml_serializer.h"
+#include "xml_stream_converter.h"
+#include "sqlite_exporter.h"
+#include "xml_formatter.h"
+#include "xml_splitter.h"
+#include "xml_tail_reader.h"
+#include "xml_record_index.h"
+#include "xml_schema_profiler.h"
+#include "xml_pipeline.h"
 #include "xml_highlighter.h"
 #include "cpp_highlighter.h"
 #include "python_highlighter.h"
 #include "go_highlighter.h"
-#include "cpp_parser.h"
-#include "python_parser.h"
-#include "go_parser.h"
+#include "incremental_parser.h"
+#include "project_indexer.h"
 #include "function_graph_view.h"
 #include "search_dialog.h"
+#include "xml_diff_view.h"
 #include "code_folding.h"
 
 class MainWindow : public QMainWindow {
@@ -61,6 +75,23 @@ private slots:
 	void exportToJson();
 	void exportToYaml();
 	void exportToCsv();
+	void exportToCbor();
+	void exportToMessagePack();
+	void exportToSqlite();
+	void convertLargeXml();
+	void splitXml();
+	void mergeXml();
+	void compareXmlFiles();
+	void runPipeline();
+	void toggleTailMode(bool enabled);
+	void pollTail();
+	void pollProjectIndex();
+	void pollJob();
+	void onDocumentContentsChange(int position, int charsRemoved, int charsAdded);
+	void refreshCodeAnalysis();
+	void goToRecord();
+	void profileSchema();
+	void exportToXsd();
 	void importFromJson();
 	void importFromYaml();
 	void toggleEditMode();
@@ -70,6 +101,8 @@ private slots:
 	void performReplace();
 	void foldAllXml();
 	void unfoldAllXml();
+	void formatDocument();
+	void minifyDocument();
 	void about();
 	void onTreeItemClicked(QTreeWidgetItem* item, int column);
 
@@ -79,8 +112,45 @@ private:
 	void setupToolBar();
 	void setupStatusBar();
 	void setupStyle();
+	void startTail(const QString& fileName);
+	void stopTail();
+	// Calls ready once recordIndex_ matches the current file; a missing index
+	// is built as a background job first
+	void ensureRecordIndex(std::function<void()> ready);
+	void goToIndexedRecord();
+	// Profiles the document as a background job, then fills schemaProfiler_
+	// and calls done
+	void runSchemaProfile(std::function<void()> done);
+	void showSchemaProfile();
+	void saveXsdDraft();
+	// Shows the preview of a pipeline and runs it to a file if asked; an
+	// empty inputName means the input is content
+	void showPipelinePreview(const std::shared_ptr<XmlPipeline>& pipeline,
+	                         const std::vector<XmlPipeline::Record>& records,
+	                         const QString& inputName, const std::shared_ptr<std::string>& content);
+	void populateSchemaTree(const std::string& path, QTreeWidgetItem* parentItem);
 	void populateTreeWidget(const std::shared_ptr<XmlNode>& node, QTreeWidgetItem* parentItem = nullptr);
+	void setupTreeItem(QTreeWidgetItem* item, const std::shared_ptr<XmlNode>& node);
+	// Updates the tree to show newRoot, rebuilding only branches whose hashes changed
+	void refreshTreeWidget(const std::shared_ptr<XmlNode>& newRoot);
+	void refreshTreeItem(QTreeWidgetItem* item, const std::shared_ptr<XmlNode>& oldNode, const std::shared_ptr<XmlNode>& newNode);
 	void populateProjectTree(const QString& projectPath);
+	// Parses every source file of the project on a background thread
+	void startProjectIndex(const QString& projectPath);
+	void stopProjectIndex();
+	// Long file operations run one at a time as a background job: work runs
+	// on jobThread_, then finish gets its result on the GUI thread
+	void startJob(const QString& name, const QString& message, uint64_t bytesTotal,
+	              std::function<bool()> work, std::function<void(bool succeeded)> finish);
+	// If a job is running, offers to cancel it and returns true
+	bool offerToCancelJob(const QString& title);
+	// Cancels the running job and waits for its thread
+	void stopJob();
+	// Code analysis of the editor text: parsed once, then kept current edit by edit
+	void analyzeDocument(SourceLanguage language);
+	void applyDocumentEdits();
+	void resetDocumentAnalysis();
+	void showCodeSummary();
 	void populateProjectTreeRecursive(const QDir& dir, QTreeWidgetItem* parentItem);
 	void displayNodeDetails(const std::shared_ptr<XmlNode>& node);
 	void clearDisplay();
@@ -92,9 +162,12 @@ private:
 	bool isCurrentFileCpp() const;
 	bool isCurrentFilePython() const;
 	bool isCurrentFileGo() const;
-	void adaptPythonToCppParser(CppParser& cppParser);
-	void adaptGoToCppParser(CppParser& cppParser);
 	void toggleTheme();
+	void exportBinary(XmlSerializer::Format format, const QString& title, const QString& filter);
+	void reformatEditor(XmlFormatter::Mode mode);
+	// File I/O that handles .gz/.xz/.zst transparently
+	bool readFileContent(const QString& fileName, std::string& content, QString& error);
+	bool writeExportFile(const QString& fileName, const std::string& content, QString& error);
 	
 	// Search methods
 	void searchInTreeWidget(const QString& searchText);
@@ -119,6 +192,7 @@ private:
 	QTabWidget* rightTabs_;
 	QTextBrowser* markdownPreview_;
 	FunctionGraphView* functionGraphView_;
+	QTreeWidget* schemaTree_;
 	QProgressBar* progressBar_;
 	QLabel* lineCountLabel_;
 	QLabel* charCountLabel_;
@@ -126,9 +200,15 @@ private:
 	// Data
 	XmlParser parser_;
 	XmlSerializer serializer_;
-	CppParser cppParser_;
-	PythonParser pythonParser_;
-	GoParser goParser_;
+	// Loaded by the Parse actions; edits since the last refresh are one
+	// dirty line range, in current lines, and the change in line count
+	IncrementalParser documentParser_;
+	int documentLineCount_;
+	int dirtyFirstLine_;
+	int dirtyEndLine_;
+	int dirtyLineDelta_;
+	QTimer* analysisTimer_;
+	bool graphFollowsDocument_;
 	std::shared_ptr<XmlNode> rootNode_;
 	std::string currentFilePath_;
 	std::string currentProjectPath_;
@@ -143,6 +223,38 @@ private:
 	bool isGoMode_;
 	QSyntaxHighlighter* currentHighlighter_;
 	bool isDarkTheme_;
+	XmlTailReader tailReader_;
+	QFileSystemWatcher* tailWatcher_;
+	QTimer* tailTimer_;
+	std::shared_ptr<XmlRecordIndex> recordIndex_;
+	std::string recordIndexSource_;
+	QDateTime recordIndexTime_;
+	XmlSchemaProfiler schemaProfiler_;
+	// Project symbol table, filled by indexThread_; read it only once
+	// indexFinished_ is set
+	std::unique_ptr<ProjectIndexer> projectIndexer_;
+	std::thread indexThread_;
+	QTimer* indexTimer_;
+	std::atomic<size_t> indexFilesDone_{0};
+	std::atomic<size_t> indexFilesTotal_{0};
+	std::atomic<bool> indexCancelled_{false};
+	std::atomic<bool> indexFinished_{false};
+	bool indexSucceeded_;
+	// Background job (conversion, export, ...), run by jobThread_ and polled
+	// like indexing. The thread touches only the atomics; state shared by the
+	// work and finish functions is read once jobFinished_ is set
+	std::thread jobThread_;
+	QTimer* jobTimer_;
+	std::atomic<uint64_t> jobBytesDone_{0};
+	std::atomic<uint64_t> jobBytesTotal_{0};
+	std::atomic<bool> jobCancelled_{false};
+	std::atomic<bool> jobFinished_{false};
+	bool jobSucceeded_;
+	QString jobName_;
+	std::function<void(bool)> jobFinish_;
+	QString pipelineSpec_;
+	// Records shown before a pipeline is run on the whole input
+	static constexpr size_t kPipelinePreviewRecords = 100;
 	
 	// Actions
 	QAction* openAction_;
@@ -151,11 +263,25 @@ private:
 	QAction* exportJsonAction_;
 	QAction* exportYamlAction_;
 	QAction* exportCsvAction_;
+	QAction* exportCborAction_;
+	QAction* exportMessagePackAction_;
+	QAction* exportSqliteAction_;
+	QAction* exportXsdAction_;
+	QAction* convertLargeXmlAction_;
+	QAction* splitXmlAction_;
+	QAction* mergeXmlAction_;
+	QAction* compareXmlAction_;
+	QAction* pipelineAction_;
+	QAction* tailAction_;
 	QAction* importJsonAction_;
 	QAction* importYamlAction_;
 	QAction* searchAction_;
+	QAction* goToRecordAction_;
+	QAction* profileSchemaAction_;
 	QAction* foldAllAction_;
 	QAction* unfoldAllAction_;
+	QAction* formatDocumentAction_;
+	QAction* minifyDocumentAction_;
 	QAction* parseCppAction_;
 	QAction* parsePythonAction_;
 	QAction* parseGoAction_;
@@ -0,0 +1,64 @@
+#ifndef XML_DIFF_VIEW_H
+#define XML_DIFF_VIEW_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QListWidget>
+#include <QLabel>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "xml_diff.h"
+
+// Side-by-side view of an XmlDiff: the old tree on the left, the new one on
+// the right, each showing only the branches that lead to an edit. Runs of
+// unchanged siblings are folded into one "unchanged" row, so the view stays
+// small however large the documents are. Selecting an edit in the list
+// below selects the affected nodes on both sides.
+class XmlDiffView : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit XmlDiffView(QWidget* parent = nullptr);
+
+    void setDiff(const XmlDiff& diff, const std::shared_ptr<XmlNode>& oldRoot,
+                 const std::shared_ptr<XmlNode>& newRoot, const QString& oldTitle, const QString& newTitle);
+
+    // Edits beyond this many are counted but not shown
+    static constexpr size_t kMaxShownEdits = 5000;
+    // Nodes shown below an inserted or deleted element
+    static constexpr int kMaxSubtreeItems = 200;
+
+private slots:
+    void onEditSelected(int row);
+
+private:
+    using NodeSet = std::unordered_set<const XmlNode*>;
+    using ItemMap = std::unordered_map<const XmlNode*, QTreeWidgetItem*>;
+    // The first edit that touches each node
+    using EditMarks = std::unordered_map<const XmlNode*, XmlDiff::Edit::Type>;
+
+    void setupUi();
+    void buildTree(QTreeWidget* tree, const std::shared_ptr<XmlNode>& root, const NodeSet& onPath,
+                   const EditMarks& marks, ItemMap& items);
+    void addBranch(const std::shared_ptr<XmlNode>& node, QTreeWidgetItem* item, const NodeSet& onPath,
+                   const EditMarks& marks, ItemMap& items);
+    void addSubtree(const std::shared_ptr<XmlNode>& node, QTreeWidgetItem* item, int& budget);
+    static QString nodeLabel(const XmlNode& node);
+
+    QLabel* oldLabel_;
+    QLabel* newLabel_;
+    QLabel* summaryLabel_;
+    QTreeWidget* oldTree_;
+    QTreeWidget* newTree_;
+    QListWidget* editList_;
+    std::vector<XmlDiff::Edit> edits_;
+    ItemMap oldItems_;
+    ItemMap newItems_;
+};
+
+#endif // XML_DIFF_VIEW_H
@@ -0,0 +1,608 @@
+#include "headless_commands.h"
+#include "xml_stream_converter.h"
+#include "sqlite_exporter.h"
+#include "xml_formatter.h"
+#include "xml_splitter.h"
+#include "xml_record_index.h"
+#include "xml_schema_profiler.h"
+#include "xml_diff.h"
+#include "xml_pipeline.h"
+#include "xml_parser.h"
+#include "compressed_stream.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  Nexus --convert <input.xml> <output> [--format json|yaml|csv|cbor|msgpack|sqlite]"
+                 " [--style pretty|compact|minified]\n"
+              << "  Nexus --reformat <input.xml> <output.xml> [--minify] [--indent <n>|tab]\n"
+              << "  Nexus --split <input.xml> <output-dir> (--records <n> | --size <bytes>[K|M|G])"
+                 " [--threads <n>]\n"
+              << "  Nexus --merge <output.xml> <input.xml>... [--threads <n>]\n"
+              << "  Nexus --index <input.xml> [--key <attribute>] [--stride <n>] [--threads <n>]\n"
+              << "  Nexus --record <input.xml> (<number> | --key <value>)\n"
+              << "  Nexus --profile <input.xml> [--xsd <output.xsd>] [--threads <n>]\n"
+              << "  Nexus --diff <old.xml> <new.xml>\n"
+              << "  Nexus --pipeline <input.xml> <output> \"<stages>\" [--format json|csv]"
+                 " [--style pretty|compact|minified]\n"
+              << "    stages: records <name> | where <field> [=|!=|<|<=|>|>=|~ <value>] |\n"
+                 "            select <field>, ... | rename <old>=<new> | map <field> upper|lower|trim | limit <n>\n"
+              << "The format defaults to the output file extension. Input may be gzip, xz or\n"
+                 "zstd compressed; an output name ending in .gz, .xz or .zst is compressed.\n";
+}
+
+std::string lowerExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find_first_of("/\\", dot) != std::string::npos) {
+        return "";
+    }
+    std::string ext = path.substr(dot + 1);
+    for (char& c : ext) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return ext;
+}
+
+bool parseFormat(const std::string& name, XmlSerializer::Format& format) {
+    if (name == "json") {
+        format = XmlSerializer::Format::JSON;
+    } else if (name == "yaml" || name == "yml") {
+        format = XmlSerializer::Format::YAML;
+    } else if (name == "csv") {
+        format = XmlSerializer::Format::CSV;
+    } else if (name == "cbor") {
+        format = XmlSerializer::Format::CBOR;
+    } else if (name == "msgpack" || name == "messagepack" || name == "mpk") {
+        format = XmlSerializer::Format::MessagePack;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// SQLite output is handled by SqliteExporter rather than a serializer format
+bool isSqliteName(const std::string& name) {
+    return name == "sqlite" || name == "sqlite3" || name == "db";
+}
+
+bool parseStyle(const std::string& name, XmlSerializer::OutputStyle& style) {
+    if (name == "pretty") {
+        style = XmlSerializer::OutputStyle::Pretty;
+    } else if (name == "compact") {
+        style = XmlSerializer::OutputStyle::Compact;
+    } else if (name == "minified") {
+        style = XmlSerializer::OutputStyle::Minified;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint64_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<uint64_t>(file.tellg()) : 0;
+}
+
+int runConvert(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string outputPath = argv[3];
+    XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty;
+    XmlSerializer::Format format = XmlSerializer::Format::JSON;
+    bool formatGiven = false;
+    bool toSqlite = false;
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            toSqlite = isSqliteName(argv[++i]);
+            if (!toSqlite && !parseFormat(argv[i], format)) {
+                std::cerr << "Unknown format: " << argv[i] << "\n";
+                return 2;
+            }
+            formatGiven = true;
+        } else if (arg == "--style" && i + 1 < argc) {
+            if (!parseStyle(argv[++i], style)) {
+                std::cerr << "Unknown style: " << argv[i] << "\n";
+                return 2;
+            }
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (!formatGiven) {
+        std::string extension = lowerExtension(stripCompressionExtension(outputPath));
+        toSqlite = isSqliteName(extension);
+        if (!toSqlite && !parseFormat(extension, format)) {
+            std::cerr << "Cannot infer the output format from " << outputPath
+                      << "; use --format\n";
+            return 2;
+        }
+    }
+
+    uint64_t totalBytes = fileSize(inputPath);
+    auto progress = [totalBytes](uint64_t bytesRead) {
+        if (totalBytes > 0) {
+            std::cerr << "\rConverting... " << (bytesRead * 100 / totalBytes) << "%" << std::flush;
+        }
+        return true;
+    };
+
+    if (toSqlite) {
+        SqliteExporter exporter;
+        exporter.setProgressCallback(progress);
+        bool ok = exporter.exportFile(inputPath, outputPath);
+        std::cerr << "\r";
+        if (!ok) {
+            std::cerr << "Export failed: " << exporter.getErrorMessage() << "\n";
+            return 1;
+        }
+        std::cerr << "Inserted " << exporter.getRecordCount() << " rows into "
+                  << exporter.getTableCount() << " tables of " << outputPath << "\n";
+        return 0;
+    }
+
+    XmlStreamConverter converter;
+    converter.setProgressCallback(progress);
+
+    bool ok = converter.convertFile(inputPath, outputPath, format, style);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Conversion failed: " << converter.getErrorMessage() << "\n";
+        return 1;
+    }
+
+    std::cerr << "Converted " << converter.getElementCount() << " elements ("
+              << converter.getBytesRead() << " bytes) to " << outputPath << "\n";
+    return 0;
+}
+
+int runReformat(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string outputPath = argv[3];
+    XmlFormatter::Options options;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--minify") {
+            options.mode = XmlFormatter::Mode::Minify;
+        } else if (arg == "--indent" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "tab") {
+                options.useTabs = true;
+            } else {
+                options.indentSize = std::atoi(value.c_str());
+                if (options.indentSize < 0 || options.indentSize > 16) {
+                    std::cerr << "Invalid indent: " << value << "\n";
+                    return 2;
+                }
+            }
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    CompressedInputStream input(inputPath);
+    if (!input.isOpen()) {
+        std::cerr << input.getErrorMessage() << "\n";
+        return 1;
+    }
+    CompressionType compression = compressionFromExtension(outputPath);
+    if (!isCompressionSupported(compression)) {
+        std::cerr << "Zstandard support is not available in this build\n";
+        return 1;
+    }
+    CompressedOutputStream output(outputPath, compression);
+    if (!output.isOpen()) {
+        std::cerr << output.getErrorMessage() << "\n";
+        return 1;
+    }
+
+    XmlFormatter formatter(options);
+    bool ok = formatter.format(input, output);
+    std::string error = !ok ? formatter.getErrorMessage() : input.getErrorMessage();
+    if (!output.close() && error.empty()) {
+        error = output.getErrorMessage();
+    }
+    if (!error.empty()) {
+        std::remove(outputPath.c_str());
+        std::cerr << "Reformat failed: " << error << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Accepts a plain byte count or one with a K, M or G (binary) suffix
+bool parseByteSize(const std::string& text, uint64_t& bytes) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return false;
+    }
+    switch (std::toupper(static_cast<unsigned char>(*end))) {
+        case '\0': break;
+        case 'K': value <<= 10; ++end; break;
+        case 'M': value <<= 20; ++end; break;
+        case 'G': value <<= 30; ++end; break;
+        default: return false;
+    }
+    if (*end == 'B' || *end == 'b') ++end;
+    bytes = value;
+    return *end == '\0' && value > 0;
+}
+
+XmlSplitter::ProgressCallback byteProgress(const char* label) {
+    return [label](uint64_t bytesDone, uint64_t bytesTotal) {
+        if (bytesTotal > 0) {
+            std::cerr << "\r" << label << "... " << (bytesDone * 100 / bytesTotal) << "%" << std::flush;
+        }
+        return true;
+    };
+}
+
+int runSplit(int argc, char* argv[]) {
+    if (argc < 6) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string outputDirectory = argv[3];
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    XmlSplitter splitter;
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--records" && i + 1 < argc) {
+            records = std::strtoull(argv[++i], nullptr, 10);
+            if (records == 0) {
+                std::cerr << "Invalid record count: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (!parseByteSize(argv[++i], bytes)) {
+                std::cerr << "Invalid size: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            splitter.setThreadCount(static_cast<unsigned>(std::atoi(argv[++i])));
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if ((records == 0) == (bytes == 0)) {
+        std::cerr << "Give exactly one of --records or --size\n";
+        return 2;
+    }
+
+    splitter.setProgressCallback(byteProgress("Splitting"));
+    bool ok = records ? splitter.splitByRecordCount(inputPath, outputDirectory, records)
+                      : splitter.splitBySize(inputPath, outputDirectory, bytes);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Split failed: " << splitter.getErrorMessage() << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << splitter.getRecordCount() << " records to "
+              << splitter.getOutputFiles().size() << " files in " << outputDirectory << "\n";
+    return 0;
+}
+
+int runMerge(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 2;
+    }
+
+    std::string outputPath = argv[2];
+    std::vector<std::string> inputPaths;
+    XmlSplitter splitter;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            splitter.setThreadCount(static_cast<unsigned>(std::atoi(argv[++i])));
+        } else {
+            inputPaths.push_back(arg);
+        }
+    }
+
+    splitter.setProgressCallback(byteProgress("Merging"));
+    bool ok = splitter.merge(inputPaths, outputPath);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Merge failed: " << splitter.getErrorMessage() << "\n";
+        return 1;
+    }
+    std::cerr << "Merged " << splitter.getRecordCount() << " records from "
+              << inputPaths.size() << " files into " << outputPath << "\n";
+    return 0;
+}
+
+int runIndex(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    XmlRecordIndex::Options options;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--key" && i + 1 < argc) {
+            options.keyAttribute = argv[++i];
+        } else if (arg == "--stride" && i + 1 < argc) {
+            options.stride = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threadCount = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::string indexPath = XmlRecordIndex::defaultIndexPath(inputPath);
+    XmlRecordIndex index;
+    index.setProgressCallback(byteProgress("Indexing"));
+    bool ok = index.build(inputPath, indexPath, options);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Indexing failed: " << index.getErrorMessage() << "\n";
+        return 1;
+    }
+    std::cerr << "Indexed " << index.getRecordCount() << " records into " << indexPath << "\n";
+    return 0;
+}
+
+int runRecord(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string indexPath = XmlRecordIndex::defaultIndexPath(inputPath);
+    const bool byKey = std::strcmp(argv[3], "--key") == 0;
+    if (byKey && argc < 5) {
+        printUsage();
+        return 2;
+    }
+
+    // Reuse the saved index, or build one (resuming if interrupted)
+    XmlRecordIndex index;
+    if (!index.load(inputPath, indexPath) && !index.build(inputPath, indexPath, XmlRecordIndex::Options())) {
+        std::cerr << "Indexing failed: " << index.getErrorMessage() << "\n";
+        return 1;
+    }
+
+    std::vector<uint64_t> ordinals;
+    if (byKey) {
+        if (index.getKeyAttribute().empty()) {
+            std::cerr << "The index has no key attribute; rebuild it with --index --key <attribute>\n";
+            return 2;
+        }
+        ordinals = index.findByKey(argv[4]);
+        if (ordinals.empty()) {
+            std::cerr << "No record has " << index.getKeyAttribute() << "=\"" << argv[4] << "\"\n";
+            return 1;
+        }
+    } else {
+        uint64_t number = std::strtoull(argv[3], nullptr, 10);
+        if (number == 0) {
+            std::cerr << "Record numbers start at 1\n";
+            return 2;
+        }
+        ordinals.push_back(number - 1);
+    }
+
+    for (uint64_t ordinal : ordinals) {
+        std::string text;
+        if (!index.readRecordText(ordinal, text)) {
+            std::cerr << index.getErrorMessage() << "\n";
+            return 1;
+        }
+        std::cout << text << "\n";
+    }
+    return 0;
+}
+
+int runProfile(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string xsdPath;
+    XmlSchemaProfiler profiler;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--xsd" && i + 1 < argc) {
+            xsdPath = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            profiler.setThreadCount(static_cast<unsigned>(std::atoi(argv[++i])));
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    auto progress = byteProgress("Profiling");
+    const uint64_t totalBytes = fileSize(inputPath);
+    profiler.setProgressCallback([&progress, totalBytes](uint64_t bytesRead) {
+        return progress(bytesRead, totalBytes);
+    });
+    bool ok = profiler.profileFile(inputPath);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Profiling failed: " << profiler.getErrorMessage() << "\n";
+        return 1;
+    }
+    std::cout << profiler.toReport();
+
+    if (!xsdPath.empty()) {
+        std::ofstream output(xsdPath, std::ios::binary | std::ios::trunc);
+        output << profiler.toXsd();
+        if (!output) {
+            std::cerr << "Failed to write " << xsdPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Exit status as for diff(1): 0 identical, 1 different, 2 trouble
+int runDiff(int argc, char* argv[]) {
+    if (argc != 4) {
+        printUsage();
+        return 2;
+    }
+
+    XmlParser parser;
+    std::shared_ptr<XmlNode> oldRoot = parser.parseFile(argv[2]);
+    if (!oldRoot) {
+        std::cerr << argv[2] << ": " << parser.getErrorMessage() << "\n";
+        return 2;
+    }
+    std::shared_ptr<XmlNode> newRoot = parser.parseFile(argv[3]);
+    if (!newRoot) {
+        std::cerr << argv[3] << ": " << parser.getErrorMessage() << "\n";
+        return 2;
+    }
+
+    XmlDiff diff;
+    if (!diff.diff(oldRoot, newRoot)) {
+        std::cerr << diff.getErrorMessage() << "\n";
+        return 2;
+    }
+    std::cout << diff.toScript();
+    return diff.isIdentical() ? 0 : 1;
+}
+
+int runPipeline(int argc, char* argv[]) {
+    if (argc < 5) {
+        printUsage();
+        return 2;
+    }
+
+    std::string inputPath = argv[2];
+    std::string outputPath = argv[3];
+    XmlPipeline pipeline;
+    if (!pipeline.parse(argv[4])) {
+        std::cerr << "Invalid pipeline: " << pipeline.getErrorMessage() << "\n";
+        return 2;
+    }
+
+    XmlSerializer::Format format = XmlSerializer::Format::JSON;
+    XmlSerializer::OutputStyle style = XmlSerializer::OutputStyle::Pretty;
+    bool formatGiven = false;
+    for (int i = 5; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            if (!parseFormat(argv[++i], format)) {
+                std::cerr << "Unknown format: " << argv[i] << "\n";
+                return 2;
+            }
+            formatGiven = true;
+        } else if (arg == "--style" && i + 1 < argc) {
+            if (!parseStyle(argv[++i], style)) {
+                std::cerr << "Unknown style: " << argv[i] << "\n";
+                return 2;
+            }
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (!formatGiven && !parseFormat(lowerExtension(stripCompressionExtension(outputPath)), format)) {
+        std::cerr << "Cannot infer the output format from " << outputPath << "; use --format\n";
+        return 2;
+    }
+    if (format != XmlSerializer::Format::JSON && format != XmlSerializer::Format::CSV) {
+        std::cerr << "Pipelines write JSON or CSV only\n";
+        return 2;
+    }
+
+    auto progress = byteProgress("Running pipeline");
+    const uint64_t totalBytes = fileSize(inputPath);
+    pipeline.setProgressCallback([&progress, totalBytes](uint64_t bytesRead) {
+        return progress(bytesRead, totalBytes);
+    });
+    bool ok = pipeline.runFile(inputPath, outputPath, format, style);
+    std::cerr << "\r";
+    if (!ok) {
+        std::cerr << "Pipeline failed: " << pipeline.getErrorMessage() << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << pipeline.getRecordsWritten() << " of " << pipeline.getRecordsRead()
+              << " records to " << outputPath << "\n";
+    return 0;
+}
+
+} // namespace
+
+bool runHeadlessCommand(int argc, char* argv[], int& exitCode) {
+    if (argc < 2) {
+        return false;
+    }
+
+    if (std::strcmp(argv[1], "--convert") == 0) {
+        exitCode = runConvert(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--reformat") == 0) {
+        exitCode = runReformat(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--split") == 0) {
+        exitCode = runSplit(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--merge") == 0) {
+        exitCode = runMerge(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--index") == 0) {
+        exitCode = runIndex(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--record") == 0) {
+        exitCode = runRecord(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--profile") == 0) {
+        exitCode = runProfile(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--diff") == 0) {
+        exitCode = runDiff(argc, argv);
+        return true;
+    }
+    if (std::strcmp(argv[1], "--pipeline") == 0) {
+        exitCode = runPipeline(argc, argv);
+        return true;
+    }
+
+    return false;
+}
@@ -5,8 +5,15 @@
 #include <QTimer>
 #include <QMessageBox>
 #include "main_window.h"
+#include "headless_commands.h"
 
 int main(int argc, char *argv[]) {
+    // Batch commands run without a display
+    int exitCode = 0;
+    if (runHeadlessCommand(argc, argv, exitCode)) {
+        return exitCode;
+    }
+    
     QApplication app(argc, argv);
     
     // Set application properties
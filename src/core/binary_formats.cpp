@@ -0,0 +1,309 @@
+#include "binary_formats.h"
+
+namespace {
+
+// Nesting limit for skipping unknown members of untrusted input
+constexpr int kMaxSkipDepth = 512;
+
+} // namespace
+
+CborReader::CborReader(const char* data, size_t size)
+    : data_(reinterpret_cast<const unsigned char*>(data)), size_(size), pos_(0) {
+}
+
+bool CborReader::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message + " at offset " + std::to_string(pos_);
+    }
+    return false;
+}
+
+bool CborReader::readArgument(uint8_t info, uint64_t& value) {
+    if (info < 24) {
+        value = info;
+        return true;
+    }
+
+    int bytes = 0;
+    switch (info) {
+        case 24: bytes = 1; break;
+        case 25: bytes = 2; break;
+        case 26: bytes = 4; break;
+        case 27: bytes = 8; break;
+        default: return fail("Invalid CBOR additional information");
+    }
+    if (size_ - pos_ < static_cast<size_t>(bytes)) {
+        return fail("Unexpected end of CBOR data");
+    }
+
+    value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | data_[pos_++];
+    }
+    return true;
+}
+
+bool CborReader::next(BinaryItem& item) {
+    while (true) {
+        if (pos_ >= size_) {
+            return fail("Unexpected end of CBOR data");
+        }
+
+        uint8_t initial = data_[pos_++];
+        uint8_t major = initial >> 5;
+        uint8_t info = initial & 0x1f;
+        item = BinaryItem();
+
+        switch (major) {
+            case 0:
+            case 1:
+                item.kind = BinaryItem::Kind::Integer;
+                return readArgument(info, item.length);
+            case 2:
+            case 3:
+            case 4:
+            case 5:
+                item.kind = (major == 2) ? BinaryItem::Kind::Bytes
+                          : (major == 3) ? BinaryItem::Kind::String
+                          : (major == 4) ? BinaryItem::Kind::Array
+                                         : BinaryItem::Kind::Map;
+                if (info == 31) {
+                    item.indefinite = true;
+                    return true;
+                }
+                return readArgument(info, item.length);
+            case 6: {
+                // Tags only annotate the following item; decode straight through them
+                uint64_t tag;
+                if (!readArgument(info, tag)) return false;
+                continue;
+            }
+            default:
+                break;
+        }
+
+        // Major type 7: simple values, floats and break
+        switch (info) {
+            case 20:
+            case 21:
+                item.kind = BinaryItem::Kind::Boolean;
+                item.length = (info == 21);
+                return true;
+            case 22:
+            case 23:
+                item.kind = BinaryItem::Kind::Nil;
+                return true;
+            case 25:
+            case 26:
+            case 27: {
+                size_t bytes = (info == 25) ? 2 : (info == 26) ? 4 : 8;
+                if (size_ - pos_ < bytes) return fail("Unexpected end of CBOR data");
+                pos_ += bytes;
+                item.kind = BinaryItem::Kind::Float;
+                return true;
+            }
+            case 31:
+                item.kind = BinaryItem::Kind::Break;
+                return true;
+            default: {
+                uint64_t simple;
+                if (!readArgument(info, simple)) return false;
+                item.kind = BinaryItem::Kind::Other;
+                return true;
+            }
+        }
+    }
+}
+
+bool CborReader::readString(const BinaryItem& item, std::string& out) {
+    out.clear();
+    if (!item.indefinite) {
+        if (size_ - pos_ < item.length) return fail("CBOR string exceeds the input");
+        out.assign(reinterpret_cast<const char*>(data_ + pos_), item.length);
+        pos_ += item.length;
+        return true;
+    }
+
+    // Indefinite-length strings are a sequence of definite chunks ended by break
+    BinaryItem chunk;
+    while (next(chunk)) {
+        if (chunk.kind == BinaryItem::Kind::Break) return true;
+        if (chunk.kind != item.kind || chunk.indefinite) {
+            return fail("Invalid chunk in indefinite-length CBOR string");
+        }
+        if (size_ - pos_ < chunk.length) return fail("CBOR string exceeds the input");
+        out.append(reinterpret_cast<const char*>(data_ + pos_), chunk.length);
+        pos_ += chunk.length;
+    }
+    return false;
+}
+
+bool CborReader::skip(const BinaryItem& item, int depth) {
+    if (depth > kMaxSkipDepth) {
+        return fail("CBOR nesting too deep");
+    }
+
+    switch (item.kind) {
+        case BinaryItem::Kind::String:
+        case BinaryItem::Kind::Bytes: {
+            std::string ignored;
+            return readString(item, ignored);
+        }
+        case BinaryItem::Kind::Array:
+        case BinaryItem::Kind::Map: {
+            uint64_t perEntry = (item.kind == BinaryItem::Kind::Map) ? 2 : 1;
+            BinaryItem child;
+            for (uint64_t i = 0; item.indefinite || i < item.length * perEntry; ++i) {
+                if (!next(child)) return false;
+                if (child.kind == BinaryItem::Kind::Break) {
+                    return item.indefinite ? true : fail("Unexpected CBOR break");
+                }
+                if (!skip(child, depth + 1)) return false;
+            }
+            return true;
+        }
+        case BinaryItem::Kind::Break:
+            return fail("Unexpected CBOR break");
+        default:
+            return true;
+    }
+}
+
+MessagePackReader::MessagePackReader(const char* data, size_t size)
+    : data_(reinterpret_cast<const unsigned char*>(data)), size_(size), pos_(0) {
+}
+
+bool MessagePackReader::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message + " at offset " + std::to_string(pos_);
+    }
+    return false;
+}
+
+bool MessagePackReader::consume(size_t bytes) {
+    if (size_ - pos_ < bytes) {
+        return fail("Unexpected end of MessagePack data");
+    }
+    pos_ += bytes;
+    return true;
+}
+
+bool MessagePackReader::readBigEndian(int bytes, uint64_t& value) {
+    if (size_ - pos_ < static_cast<size_t>(bytes)) {
+        return fail("Unexpected end of MessagePack data");
+    }
+    value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | data_[pos_++];
+    }
+    return true;
+}
+
+bool MessagePackReader::next(BinaryItem& item) {
+    if (pos_ >= size_) {
+        return fail("Unexpected end of MessagePack data");
+    }
+
+    uint8_t type = data_[pos_++];
+    item = BinaryItem();
+
+    if (type <= 0x7f || type >= 0xe0) {
+        item.kind = BinaryItem::Kind::Integer;
+        return true;
+    }
+    if (type <= 0x8f) {
+        item.kind = BinaryItem::Kind::Map;
+        item.length = type & 0x0f;
+        return true;
+    }
+    if (type <= 0x9f) {
+        item.kind = BinaryItem::Kind::Array;
+        item.length = type & 0x0f;
+        return true;
+    }
+    if (type <= 0xbf) {
+        item.kind = BinaryItem::Kind::String;
+        item.length = type & 0x1f;
+        return true;
+    }
+
+    switch (type) {
+        case 0xc0:
+            item.kind = BinaryItem::Kind::Nil;
+            return true;
+        case 0xc2:
+        case 0xc3:
+            item.kind = BinaryItem::Kind::Boolean;
+            item.length = (type == 0xc3);
+            return true;
+        case 0xc4: case 0xc5: case 0xc6:
+            item.kind = BinaryItem::Kind::Bytes;
+            return readBigEndian(1 << (type - 0xc4), item.length);
+        case 0xc7: case 0xc8: case 0xc9: {
+            // ext 8/16/32: length, type byte, payload
+            uint64_t length;
+            if (!readBigEndian(1 << (type - 0xc7), length)) return false;
+            item.kind = BinaryItem::Kind::Other;
+            return consume(1 + length);
+        }
+        case 0xca:
+            item.kind = BinaryItem::Kind::Float;
+            return consume(4);
+        case 0xcb:
+            item.kind = BinaryItem::Kind::Float;
+            return consume(8);
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            item.kind = BinaryItem::Kind::Integer;
+            return readBigEndian(1 << (type - 0xcc), item.length);
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3:
+            item.kind = BinaryItem::Kind::Integer;
+            return consume(static_cast<size_t>(1) << (type - 0xd0));
+        case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+            // fixext 1/2/4/8/16: type byte plus payload
+            item.kind = BinaryItem::Kind::Other;
+            return consume(1 + (static_cast<size_t>(1) << (type - 0xd4)));
+        case 0xd9: case 0xda: case 0xdb:
+            item.kind = BinaryItem::Kind::String;
+            return readBigEndian(1 << (type - 0xd9), item.length);
+        case 0xdc: case 0xdd:
+            item.kind = BinaryItem::Kind::Array;
+            return readBigEndian(type == 0xdc ? 2 : 4, item.length);
+        case 0xde: case 0xdf:
+            item.kind = BinaryItem::Kind::Map;
+            return readBigEndian(type == 0xde ? 2 : 4, item.length);
+        default:
+            return fail("Invalid MessagePack type byte");
+    }
+}
+
+bool MessagePackReader::readString(const BinaryItem& item, std::string& out) {
+    if (size_ - pos_ < item.length) {
+        return fail("MessagePack string exceeds the input");
+    }
+    out.assign(reinterpret_cast<const char*>(data_ + pos_), item.length);
+    pos_ += item.length;
+    return true;
+}
+
+bool MessagePackReader::skip(const BinaryItem& item, int depth) {
+    if (depth > kMaxSkipDepth) {
+        return fail("MessagePack nesting too deep");
+    }
+
+    switch (item.kind) {
+        case BinaryItem::Kind::String:
+        case BinaryItem::Kind::Bytes:
+            return consume(item.length);
+        case BinaryItem::Kind::Array:
+        case BinaryItem::Kind::Map: {
+            uint64_t count = item.length * ((item.kind == BinaryItem::Kind::Map) ? 2 : 1);
+            BinaryItem child;
+            for (uint64_t i = 0; i < count; ++i) {
+                if (!next(child) || !skip(child, depth + 1)) return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
@@ -0,0 +1,43 @@
+#include "cache_directory.h"
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void createPrivateDirectory(const fs::path& directory, std::error_code& error) {
+    if (fs::create_directory(directory, error)) {
+        fs::permissions(directory, fs::perms::owner_all, error);
+    }
+}
+
+} // namespace
+
+fs::path userCacheDirectory(const std::string& name) {
+    std::error_code error;
+    fs::path base;
+    const char* xdgCache = std::getenv("XDG_CACHE_HOME");
+#ifdef _WIN32
+    const char* home = std::getenv("LOCALAPPDATA");
+    fs::path homeCache = home && *home ? fs::u8path(home) : fs::path();
+#else
+    const char* home = std::getenv("HOME");
+    fs::path homeCache = home && *home ? fs::u8path(home) / ".cache" : fs::path();
+#endif
+    // The XDG spec ignores relative paths
+    if (xdgCache && fs::u8path(xdgCache).is_absolute()) {
+        base = fs::u8path(xdgCache);
+    } else if (!homeCache.empty()) {
+        base = homeCache;
+    } else {
+        fs::path directory = fs::temp_directory_path(error) / ("nexus-" + name);
+        createPrivateDirectory(directory, error);
+        return directory;
+    }
+
+    fs::create_directories(base, error);
+    createPrivateDirectory(base / "nexus", error);
+    fs::path directory = base / "nexus" / name;
+    createPrivateDirectory(directory, error);
+    return directory;
+}
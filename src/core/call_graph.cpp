@@ -0,0 +1,115 @@
+#include "call_graph.h"
+#include <algorithm>
+
+CallGraph::CallGraph() {
+}
+
+CallGraph::NodeId CallGraph::addNode(const std::string& name, bool defined) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        if (defined) defined_[it->second] = 1;
+        return it->second;
+    }
+    NodeId id = static_cast<NodeId>(names_.size());
+    names_.push_back(name);
+    defined_.push_back(defined ? 1 : 0);
+    ids_.emplace(name, id);
+    return id;
+}
+
+void CallGraph::addCall(NodeId caller, NodeId callee) {
+    calls_.emplace_back(caller, callee);
+}
+
+void CallGraph::build() {
+    size_t n = names_.size();
+
+    // Counting sort of the call sites by caller
+    std::vector<uint32_t> offsets(n + 1, 0);
+    for (const auto& call : calls_) ++offsets[call.first + 1];
+    for (size_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+    std::vector<NodeId> targets(calls_.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& call : calls_) targets[fill[call.first]++] = call.second;
+
+    // Each row sorted, repeated callees folded into one edge with a count
+    calleeOffsets_.assign(n + 1, 0);
+    callees_.clear();
+    callees_.reserve(targets.size());
+    for (size_t caller = 0; caller < n; ++caller) {
+        auto begin = targets.begin() + offsets[caller];
+        auto end = targets.begin() + offsets[caller + 1];
+        std::sort(begin, end);
+        for (auto it = begin; it != end; ++it) {
+            if (callees_.size() > calleeOffsets_[caller] && callees_.back().node == *it) {
+                ++callees_.back().count;
+            } else {
+                callees_.push_back({*it, 1});
+            }
+        }
+        calleeOffsets_[caller + 1] = static_cast<uint32_t>(callees_.size());
+    }
+
+    // Reverse adjacency; filling by increasing caller keeps each row sorted
+    callerOffsets_.assign(n + 1, 0);
+    for (const Edge& edge : callees_) ++callerOffsets_[edge.node + 1];
+    for (size_t i = 0; i < n; ++i) callerOffsets_[i + 1] += callerOffsets_[i];
+    callers_.assign(callees_.size(), Edge{0, 0});
+    fill.assign(callerOffsets_.begin(), callerOffsets_.end() - 1);
+    for (size_t caller = 0; caller < n; ++caller) {
+        for (uint32_t e = calleeOffsets_[caller]; e < calleeOffsets_[caller + 1]; ++e) {
+            const Edge& edge = callees_[e];
+            callers_[fill[edge.node]++] = {static_cast<NodeId>(caller), edge.count};
+        }
+    }
+}
+
+void CallGraph::clear() {
+    names_.clear();
+    defined_.clear();
+    ids_.clear();
+    calls_.clear();
+    calleeOffsets_.clear();
+    callees_.clear();
+    callerOffsets_.clear();
+    callers_.clear();
+}
+
+CallGraph::NodeId CallGraph::find(const std::string& name) const {
+    auto it = ids_.find(name);
+    return it == ids_.end() ? kNoNode : it->second;
+}
+
+CallGraph::EdgeRange CallGraph::row(const std::vector<uint32_t>& offsets, const std::vector<Edge>& edges, NodeId node) {
+    // Nodes added since the last build() have no edges yet
+    if (static_cast<size_t>(node) + 1 >= offsets.size()) return EdgeRange(nullptr, nullptr);
+    const Edge* base = edges.data();
+    return EdgeRange(base + offsets[node], base + offsets[node + 1]);
+}
+
+CallGraph::EdgeRange CallGraph::callees(NodeId node) const {
+    return row(calleeOffsets_, callees_, node);
+}
+
+CallGraph::EdgeRange CallGraph::callers(NodeId node) const {
+    return row(callerOffsets_, callers_, node);
+}
+
+std::vector<std::string> CallGraph::rowNames(const std::vector<uint32_t>& offsets, const std::vector<Edge>& edges,
+                                             const std::string& name) const {
+    std::vector<std::string> result;
+    NodeId node = find(name);
+    if (node == kNoNode) return result;
+    EdgeRange range = row(offsets, edges, node);
+    result.reserve(range.size());
+    for (const Edge& edge : range) result.push_back(names_[edge.node]);
+    return result;
+}
+
+std::vector<std::string> CallGraph::calleeNames(const std::string& name) const {
+    return rowNames(calleeOffsets_, callees_, name);
+}
+
+std::vector<std::string> CallGraph::callerNames(const std::string& name) const {
+    return rowNames(callerOffsets_, callers_, name);
+}
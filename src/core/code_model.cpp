@@ -0,0 +1,367 @@
+#include "code_model.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+// The definitions of one model by name, to resolve its calls within the
+// file. Each name has few definitions in a file, so they are scanned.
+class LocalScope {
+public:
+    explicit LocalScope(const CodeModel& model) : model_(model), functions_(model.getFunctions()) {
+        byName_.reserve(functions_.size());
+        for (size_t i = 0; i < functions_.size(); ++i) byName_[functions_[i].name].push_back(i);
+        for (const CodeType& type : model.getTypes()) {
+            std::vector<std::string_view>& bases = bases_[type.name];
+            for (const std::string& base : type.baseTypes) {
+                std::string_view baseName = CodeModel::getTypeName(base);
+                if (std::find(bases.begin(), bases.end(), baseName) == bases.end()) bases.push_back(baseName);
+            }
+        }
+    }
+
+    // Index of the function a call resolves to, or npos
+    size_t resolve(const CodeCall& call) const {
+        const CodeFunction& caller = functions_[call.callerIndex];
+        const std::string& name = call.callee;
+        switch (model_.getLanguage()) {
+            case SourceLanguage::Cpp: {
+                std::string_view object = CodeModel::getCallObject(call.qualifier);
+                std::vector<size_t> candidates;
+                if (call.qualifier.empty() || object == "this") {
+                    if (!caller.container.empty()) {
+                        candidates = classMembers(CodeModel::getTypeName(caller.container), name);
+                    }
+                    if (candidates.empty() && object.empty()) candidates = members("", name);
+                } else if (!object.empty()) {
+                    candidates = uniqueMethod(name);
+                } else {
+                    candidates = classMembers(CodeModel::getTypeName(call.qualifier), name);
+                    if (candidates.empty()) candidates = members("", name);
+                }
+                for (size_t function : candidates) {
+                    if (CodeModel::acceptsArguments(functions_[function], call.argumentCount)) return function;
+                }
+                return candidates.empty() ? std::string::npos : candidates.front();
+            }
+            case SourceLanguage::Python:
+                if (call.qualifier.empty()) {
+                    // A function nested in the caller or one around it, then one of the module
+                    std::string_view scope = caller.qualifiedName;
+                    for (;;) {
+                        for (size_t function : named(name)) {
+                            const std::string& qualified = functions_[function].qualifiedName;
+                            if (qualified.size() == scope.size() + 10 + name.size() &&
+                                qualified.compare(0, scope.size(), scope) == 0 &&
+                                qualified.compare(scope.size(), 10, ".<locals>.") == 0) {
+                                return function;
+                            }
+                        }
+                        size_t enclosing = scope.rfind(".<locals>.");
+                        if (enclosing == std::string_view::npos) break;
+                        scope = scope.substr(0, enclosing);
+                    }
+                    return first(members("", name));
+                }
+                if (!caller.receiver.empty() && call.qualifier == caller.receiver) {
+                    return first(classMembers(CodeModel::getTypeName(caller.container), name));
+                }
+                if (isImported(call.qualifier)) {
+                    return std::string::npos;
+                }
+                if (call.qualifier.find('.') == std::string::npos) {
+                    std::vector<size_t> methods = classMembers(call.qualifier, name);
+                    if (!methods.empty()) return methods.front();
+                }
+                return first(uniqueMethod(name));
+            case SourceLanguage::Go:
+                if (call.qualifier.empty()) {
+                    return first(members("", name));
+                }
+                if (!caller.receiver.empty() && call.qualifier == caller.receiver) {
+                    return first(members(CodeModel::getTypeName(caller.container), name));
+                }
+                // A package of another directory
+                if (isImported(call.qualifier)) {
+                    return std::string::npos;
+                }
+                return first(uniqueMethod(name));
+        }
+        return std::string::npos;
+    }
+
+private:
+    static size_t first(const std::vector<size_t>& candidates) {
+        return candidates.empty() ? std::string::npos : candidates.front();
+    }
+
+    const std::vector<size_t>& named(std::string_view name) const {
+        static const std::vector<size_t> none;
+        auto it = byName_.find(name);
+        return it == byName_.end() ? none : it->second;
+    }
+
+    // Definitions named name whose container type is scope, "" for free functions
+    std::vector<size_t> members(std::string_view scope, std::string_view name) const {
+        std::vector<size_t> found;
+        for (size_t function : named(name)) {
+            const CodeFunction& candidate = functions_[function];
+            bool inScope = scope.empty() ? candidate.qualifiedName == candidate.name
+                                         : CodeModel::getTypeName(candidate.container) == scope;
+            if (inScope) found.push_back(function);
+        }
+        return found;
+    }
+
+    // Members of type and of its base types, nearest first
+    std::vector<size_t> classMembers(std::string_view type, std::string_view name) const {
+        std::vector<std::string_view> pending{type};
+        for (size_t k = 0; k < pending.size() && k < 32; ++k) {
+            std::vector<size_t> found = members(pending[k], name);
+            if (!found.empty()) {
+                return found;
+            }
+            auto it = bases_.find(pending[k]);
+            if (it == bases_.end()) continue;
+            for (std::string_view base : it->second) {
+                if (std::find(pending.begin(), pending.end(), base) == pending.end()) pending.push_back(base);
+            }
+        }
+        return {};
+    }
+
+    // The methods named name, when a single type of the file has them
+    std::vector<size_t> uniqueMethod(std::string_view name) const {
+        std::string_view owner;
+        for (size_t function : named(name)) {
+            const CodeFunction& candidate = functions_[function];
+            if (candidate.container.empty()) continue;
+            std::string_view type = CodeModel::getTypeName(candidate.container);
+            if (!owner.empty() && owner != type) return {};
+            owner = type;
+        }
+        return owner.empty() ? std::vector<size_t>() : members(owner, name);
+    }
+
+    // A Python module or Go package bound by an import of the file
+    bool isImported(const std::string& qualifier) const {
+        for (const CodeImport& imported : model_.getImports()) {
+            std::string_view binding = imported.alias;
+            if (binding.empty() && model_.getLanguage() == SourceLanguage::Go) {
+                size_t slash = imported.module.rfind('/');
+                binding = std::string_view(imported.module).substr(slash == std::string::npos ? 0 : slash + 1);
+            } else if (binding.empty()) {
+                binding = imported.name.empty() ? imported.module : imported.name;
+            }
+            // "os.path" is bound by "import os"
+            if (qualifier.compare(0, binding.size(), binding) == 0 &&
+                (qualifier.size() == binding.size() || qualifier[binding.size()] == '.')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const CodeModel& model_;
+    const std::vector<CodeFunction>& functions_;
+    std::unordered_map<std::string_view, std::vector<size_t>> byName_;
+    std::unordered_map<std::string_view, std::vector<std::string_view>> bases_;  // Merged over declarations
+};
+
+} // namespace
+
+CodeModel::CodeModel(SourceLanguage language) : language_(language), graphBuilt_(false) {
+}
+
+size_t CodeModel::addFunction(CodeFunction function) {
+    functions_.push_back(std::move(function));
+    graphBuilt_ = false;
+    return functions_.size() - 1;
+}
+
+void CodeModel::addType(CodeType type) {
+    types_.push_back(std::move(type));
+    graphBuilt_ = false;
+}
+
+void CodeModel::addCall(CodeCall call) {
+    functionCalls_[functions_[call.callerIndex].name].push_back(call.callee);
+    calls_.push_back(std::move(call));
+    graphBuilt_ = false;
+}
+
+void CodeModel::addImport(CodeImport codeImport) {
+    imports_.push_back(std::move(codeImport));
+    graphBuilt_ = false;
+}
+
+const CallGraph& CodeModel::getCallGraph() const {
+    buildCallGraph();
+    return callGraph_;
+}
+
+CallGraph::NodeId CodeModel::getFunctionNode(size_t function) const {
+    buildCallGraph();
+    return functionNodes_[function];
+}
+
+void CodeModel::buildCallGraph() const {
+    if (graphBuilt_) {
+        return;
+    }
+    callGraph_.clear();
+    functionNodes_.clear();
+    nodeFunctions_.clear();
+    calleeNodes_.clear();
+
+    auto addCalleeNode = [this](const std::string& name, CallGraph::NodeId node) {
+        std::vector<CallGraph::NodeId>& nodes = calleeNodes_[name];
+        if (std::find(nodes.begin(), nodes.end(), node) == nodes.end()) nodes.push_back(node);
+    };
+
+    // Overloads share a qualified name but not their parameter types
+    std::unordered_map<std::string_view, size_t> firstDefinition;
+    std::unordered_set<std::string_view> overloaded;
+    if (language_ == SourceLanguage::Cpp) {
+        for (size_t i = 0; i < functions_.size(); ++i) {
+            auto first = firstDefinition.emplace(functions_[i].qualifiedName, i);
+            if (!sameParameterTypes(functions_[first.first->second], functions_[i])) {
+                overloaded.insert(functions_[i].qualifiedName);
+            }
+        }
+    }
+
+    functionNodes_.reserve(functions_.size());
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        const CodeFunction& function = functions_[i];
+        CallGraph::NodeId node = callGraph_.addNode(
+            overloaded.count(function.qualifiedName) ? getOverloadName(function) : function.qualifiedName);
+        if (node == nodeFunctions_.size()) nodeFunctions_.push_back(i);
+        functionNodes_.push_back(node);
+        addCalleeNode(function.name, node);
+    }
+
+    LocalScope scope(*this);
+    for (const CodeCall& call : calls_) {
+        size_t target = scope.resolve(call);
+        CallGraph::NodeId callee;
+        if (target != std::string::npos) {
+            callee = functionNodes_[target];
+        } else {
+            callee = callGraph_.addNode(getCallName(language_, call), false);
+            addCalleeNode(call.callee, callee);
+        }
+        callGraph_.addCall(functionNodes_[call.callerIndex], callee);
+    }
+    callGraph_.build();
+    graphBuilt_ = true;
+}
+
+std::vector<std::string> CodeModel::getCallerNames(const std::string& callee) const {
+    buildCallGraph();
+    auto it = calleeNodes_.find(callee);
+    if (it == calleeNodes_.end()) {
+        return {};
+    }
+    // Reverse adjacency of every node the name stands for, so the cost is
+    // the number of callers
+    std::vector<CallGraph::NodeId> callers;
+    for (CallGraph::NodeId node : it->second) {
+        for (const CallGraph::Edge& edge : callGraph_.callers(node)) callers.push_back(edge.node);
+    }
+    std::sort(callers.begin(), callers.end());
+    callers.erase(std::unique(callers.begin(), callers.end()), callers.end());
+
+    std::vector<std::string> names;
+    std::unordered_set<std::string> seen;
+    for (CallGraph::NodeId node : callers) {
+        const std::string& name = functions_[nodeFunctions_[node]].name;
+        if (seen.insert(name).second) names.push_back(name);
+    }
+    return names;
+}
+
+void CodeModel::clear() {
+    functions_.clear();
+    types_.clear();
+    calls_.clear();
+    imports_.clear();
+    functionCalls_.clear();
+    graphBuilt_ = false;
+    functionNodes_.clear();
+    nodeFunctions_.clear();
+    calleeNodes_.clear();
+    callGraph_.clear();
+}
+
+std::string_view CodeModel::getTypeName(std::string_view type) {
+    while (!type.empty() && (type.front() == '*' || type.front() == '&')) type.remove_prefix(1);
+    size_t arguments = type.find_first_of("<[");
+    if (arguments != std::string_view::npos) type = type.substr(0, arguments);
+    size_t scope = type.rfind("::");
+    size_t dot = type.rfind('.');
+    if (scope != std::string_view::npos && (dot == std::string_view::npos || scope > dot)) {
+        return type.substr(scope + 2);
+    }
+    return dot == std::string_view::npos ? type : type.substr(dot + 1);
+}
+
+std::string_view CodeModel::getCallObject(std::string_view qualifier) {
+    if (qualifier.size() > 1 && qualifier.back() == '.') {
+        return qualifier.substr(0, qualifier.size() - 1);
+    }
+    if (qualifier.size() > 2 && qualifier.substr(qualifier.size() - 2) == "->") {
+        return qualifier.substr(0, qualifier.size() - 2);
+    }
+    return std::string_view();
+}
+
+bool CodeModel::acceptsArguments(const CodeFunction& function, int argumentCount) {
+    if (argumentCount < 0) {
+        return true;
+    }
+    const std::vector<CodeParameter>& parameters = function.parameters;
+    int required = 0;
+    int accepted = static_cast<int>(parameters.size());
+    for (const CodeParameter& parameter : parameters) {
+        if (parameter.type.find("...") != std::string::npos) {
+            accepted = std::numeric_limits<int>::max();
+        } else if (parameter.defaultValue.empty()) {
+            ++required;
+        }
+    }
+    if (parameters.size() == 1 && parameters[0].type == "void" && parameters[0].name.empty()) {
+        required = accepted = 0;
+    }
+    return argumentCount >= required && argumentCount <= accepted;
+}
+
+bool CodeModel::sameParameterTypes(const CodeFunction& a, const CodeFunction& b) {
+    if (a.parameters.size() != b.parameters.size()) return false;
+    for (size_t i = 0; i < a.parameters.size(); ++i) {
+        if (a.parameters[i].type != b.parameters[i].type) return false;
+    }
+    return true;
+}
+
+std::string CodeModel::getOverloadName(const CodeFunction& function) {
+    std::string name = function.qualifiedName + "(";
+    for (size_t i = 0; i < function.parameters.size(); ++i) {
+        if (i > 0) name += ", ";
+        name += function.parameters[i].type;
+    }
+    return name + ")";
+}
+
+std::string CodeModel::getCallName(SourceLanguage language, const CodeCall& call) {
+    if (call.qualifier.empty()) {
+        return call.callee;
+    }
+    if (language == SourceLanguage::Cpp) {
+        return getCallObject(call.qualifier).empty() ? call.qualifier + "::" + call.callee
+                                                     : call.qualifier + call.callee;
+    }
+    return call.qualifier + "." + call.callee;
+}
@@ -0,0 +1,630 @@
+#include "compressed_stream.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+#include <lzma.h>
+#ifdef NEXUS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr size_t kInputChunk = 256 * 1024;
+constexpr size_t kOutputChunk = 256 * 1024;
+// Bytes kept in front of the get area so peek-ahead parsers can unget
+constexpr size_t kPutback = 8;
+
+bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = std::strlen(suffix);
+    if (text.size() < length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[text.size() - length + i];
+        if (std::tolower(static_cast<unsigned char>(c)) != suffix[i]) return false;
+    }
+    return true;
+}
+
+unsigned resolveThreads(unsigned threadCount) {
+    return threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+CompressionType detectCompression(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[6] = {0};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    size_t got = static_cast<size_t>(file.gcount());
+
+    if (got >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return CompressionType::Gzip;
+    }
+    if (got >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0) {
+        return CompressionType::Xz;
+    }
+    if (got >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return CompressionType::Zstd;
+    }
+    return CompressionType::None;
+}
+
+CompressionType compressionFromExtension(const std::string& path) {
+    if (endsWith(path, ".gz")) return CompressionType::Gzip;
+    if (endsWith(path, ".xz")) return CompressionType::Xz;
+    if (endsWith(path, ".zst")) return CompressionType::Zstd;
+    return CompressionType::None;
+}
+
+std::string stripCompressionExtension(const std::string& path) {
+    switch (compressionFromExtension(path)) {
+        case CompressionType::Gzip:
+        case CompressionType::Xz:
+            return path.substr(0, path.size() - 3);
+        case CompressionType::Zstd:
+            return path.substr(0, path.size() - 4);
+        default:
+            return path;
+    }
+}
+
+bool isCompressionSupported(CompressionType type) {
+#ifdef NEXUS_HAVE_ZSTD
+    (void)type;
+    return true;
+#else
+    return type != CompressionType::Zstd;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Decompression
+
+class DecompressingBuffer : public std::streambuf {
+public:
+    explicit DecompressingBuffer(const std::string& path)
+        : file_(path, std::ios::binary), input_(kInputChunk), output_(kPutback + kOutputChunk),
+          inputPos_(0), inputSize_(0), inputEof_(false), compressedRead_(0) {
+        setg(output_.data() + kPutback, output_.data() + kPutback, output_.data() + kPutback);
+        if (!file_.is_open()) {
+            errorMessage_ = "Cannot open file: " + path;
+        }
+    }
+    ~DecompressingBuffer() override = default;
+
+    bool isOpen() const { return file_.is_open() && errorMessage_.empty(); }
+    virtual CompressionType type() const = 0;
+    uint64_t compressedBytesRead() const { return compressedRead_; }
+    const std::string& errorMessage() const { return errorMessage_; }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        if (!errorMessage_.empty()) {
+            return traits_type::eof();
+        }
+
+        // Keep the tail of the previous block so callers can unget across refills
+        size_t keep = std::min(kPutback, static_cast<size_t>(gptr() - eback()));
+        std::memmove(output_.data() + kPutback - keep, gptr() - keep, keep);
+
+        char* begin = output_.data() + kPutback;
+        size_t produced = decode(begin, kOutputChunk);
+        if (produced == 0) {
+            return traits_type::eof();
+        }
+        setg(begin - keep, begin, begin + produced);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    // Writes up to capacity decompressed bytes; returns 0 at the end of data or on error
+    virtual size_t decode(char* out, size_t capacity) = 0;
+
+    // Tops up the compressed input buffer; returns false at end of file
+    bool refill() {
+        if (inputPos_ < inputSize_) return true;
+        if (inputEof_) return false;
+        file_.read(input_.data(), static_cast<std::streamsize>(input_.size()));
+        inputSize_ = static_cast<size_t>(file_.gcount());
+        inputPos_ = 0;
+        compressedRead_ += inputSize_;
+        if (inputSize_ < input_.size()) inputEof_ = true;
+        return inputSize_ > 0;
+    }
+
+    size_t fail(const std::string& message) {
+        if (errorMessage_.empty()) errorMessage_ = message;
+        return 0;
+    }
+
+    std::ifstream file_;
+    std::vector<char> input_;
+    std::vector<char> output_;
+    size_t inputPos_;
+    size_t inputSize_;
+    bool inputEof_;
+    uint64_t compressedRead_;
+    std::string errorMessage_;
+};
+
+namespace {
+
+class PlainBuffer : public DecompressingBuffer {
+public:
+    using DecompressingBuffer::DecompressingBuffer;
+    CompressionType type() const override { return CompressionType::None; }
+
+protected:
+    size_t decode(char* out, size_t capacity) override {
+        if (!refill()) return 0;
+        size_t n = std::min(capacity, inputSize_ - inputPos_);
+        std::memcpy(out, input_.data() + inputPos_, n);
+        inputPos_ += n;
+        return n;
+    }
+};
+
+class GzipBuffer : public DecompressingBuffer {
+public:
+    explicit GzipBuffer(const std::string& path) : DecompressingBuffer(path), memberEnded_(false) {
+        std::memset(&stream_, 0, sizeof(stream_));
+        // 15 + 32: accept gzip or zlib headers
+        if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+            fail("Cannot initialise zlib");
+        }
+    }
+    ~GzipBuffer() override { inflateEnd(&stream_); }
+    CompressionType type() const override { return CompressionType::Gzip; }
+
+protected:
+    size_t decode(char* out, size_t capacity) override {
+        size_t produced = 0;
+        while (produced == 0) {
+            if (!refill()) {
+                // Running out of input is only fine right after a complete member
+                return memberEnded_ ? 0 : fail("Truncated gzip data");
+            }
+            stream_.next_in = reinterpret_cast<Bytef*>(input_.data() + inputPos_);
+            stream_.avail_in = static_cast<uInt>(inputSize_ - inputPos_);
+            stream_.next_out = reinterpret_cast<Bytef*>(out);
+            stream_.avail_out = static_cast<uInt>(capacity);
+
+            int ret = inflate(&stream_, Z_NO_FLUSH);
+            size_t consumed = (inputSize_ - inputPos_) - stream_.avail_in;
+            inputPos_ += consumed;
+            produced = capacity - stream_.avail_out;
+
+            if (ret == Z_STREAM_END) {
+                // Concatenated members (as written by pigz or "cat a.gz b.gz") continue
+                memberEnded_ = true;
+                inflateReset(&stream_);
+            } else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+                if (consumed > 0) memberEnded_ = false;
+            } else {
+                return fail(std::string("Corrupt gzip data: ") + (stream_.msg ? stream_.msg : "inflate failed"));
+            }
+        }
+        return produced;
+    }
+
+private:
+    z_stream stream_;
+    bool memberEnded_;
+};
+
+class XzBuffer : public DecompressingBuffer {
+public:
+    XzBuffer(const std::string& path, unsigned threadCount)
+        : DecompressingBuffer(path), stream_(LZMA_STREAM_INIT), finished_(false) {
+        lzma_ret ret;
+        unsigned threads = resolveThreads(threadCount);
+#if LZMA_VERSION >= 50040002
+        if (threads > 1) {
+            lzma_mt options;
+            std::memset(&options, 0, sizeof(options));
+            options.flags = LZMA_CONCATENATED;
+            options.threads = threads;
+            options.memlimit_threading = lzma_physmem() / 4;
+            options.memlimit_stop = UINT64_MAX;
+            ret = lzma_stream_decoder_mt(&stream_, &options);
+        } else {
+            ret = lzma_stream_decoder(&stream_, UINT64_MAX, LZMA_CONCATENATED);
+        }
+#else
+        (void)threads;
+        ret = lzma_stream_decoder(&stream_, UINT64_MAX, LZMA_CONCATENATED);
+#endif
+        if (ret != LZMA_OK) {
+            fail("Cannot initialise the xz decoder");
+        }
+    }
+    ~XzBuffer() override { lzma_end(&stream_); }
+    CompressionType type() const override { return CompressionType::Xz; }
+
+protected:
+    size_t decode(char* out, size_t capacity) override {
+        size_t produced = 0;
+        while (produced == 0 && !finished_) {
+            refill();
+            stream_.next_in = reinterpret_cast<const uint8_t*>(input_.data() + inputPos_);
+            stream_.avail_in = inputSize_ - inputPos_;
+            stream_.next_out = reinterpret_cast<uint8_t*>(out);
+            stream_.avail_out = capacity;
+
+            lzma_ret ret = lzma_code(&stream_, inputEof_ && stream_.avail_in == 0 ? LZMA_FINISH : LZMA_RUN);
+            inputPos_ = inputSize_ - stream_.avail_in;
+            produced = capacity - stream_.avail_out;
+
+            if (ret == LZMA_STREAM_END) {
+                finished_ = true;
+            } else if (ret != LZMA_OK) {
+                return fail(ret == LZMA_BUF_ERROR ? "Truncated xz data" : "Corrupt xz data");
+            }
+        }
+        return produced;
+    }
+
+private:
+    lzma_stream stream_;
+    bool finished_;
+};
+
+#ifndef NEXUS_HAVE_ZSTD
+class UnsupportedBuffer : public PlainBuffer {
+public:
+    explicit UnsupportedBuffer(const std::string& path) : PlainBuffer(path) {
+        fail("Zstandard support is not available in this build");
+    }
+    CompressionType type() const override { return CompressionType::Zstd; }
+};
+#endif
+
+#ifdef NEXUS_HAVE_ZSTD
+// libzstd decodes single-threaded; its frames are fast enough that I/O dominates
+class ZstdBuffer : public DecompressingBuffer {
+public:
+    explicit ZstdBuffer(const std::string& path)
+        : DecompressingBuffer(path), stream_(ZSTD_createDStream()), frameComplete_(true) {
+        if (!stream_) fail("Cannot initialise the zstd decoder");
+    }
+    ~ZstdBuffer() override { ZSTD_freeDStream(stream_); }
+    CompressionType type() const override { return CompressionType::Zstd; }
+
+protected:
+    size_t decode(char* out, size_t capacity) override {
+        size_t produced = 0;
+        while (produced == 0) {
+            if (!refill()) {
+                return frameComplete_ ? 0 : fail("Truncated zstd data");
+            }
+            ZSTD_inBuffer in = {input_.data() + inputPos_, inputSize_ - inputPos_, 0};
+            ZSTD_outBuffer output = {out, capacity, 0};
+            size_t ret = ZSTD_decompressStream(stream_, &output, &in);
+            if (ZSTD_isError(ret)) {
+                return fail(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(ret));
+            }
+            inputPos_ += in.pos;
+            produced = output.pos;
+            frameComplete_ = (ret == 0);
+        }
+        return produced;
+    }
+
+private:
+    ZSTD_DStream* stream_;
+    bool frameComplete_;
+};
+#endif
+
+std::unique_ptr<DecompressingBuffer> makeDecompressingBuffer(const std::string& path,
+                                                             unsigned threadCount) {
+    switch (detectCompression(path)) {
+        case CompressionType::Gzip:
+            return std::make_unique<GzipBuffer>(path);
+        case CompressionType::Xz:
+            return std::make_unique<XzBuffer>(path, threadCount);
+        case CompressionType::Zstd:
+#ifdef NEXUS_HAVE_ZSTD
+            return std::make_unique<ZstdBuffer>(path);
+#else
+            return std::make_unique<UnsupportedBuffer>(path);
+#endif
+        default:
+            return std::make_unique<PlainBuffer>(path);
+    }
+}
+
+} // namespace
+
+CompressedInputStream::CompressedInputStream(const std::string& path, unsigned threadCount)
+    : std::istream(nullptr), buffer_(makeDecompressingBuffer(path, threadCount)) {
+    rdbuf(buffer_.get());
+    if (!buffer_->isOpen()) {
+        setstate(std::ios::failbit);
+    }
+}
+
+CompressedInputStream::~CompressedInputStream() = default;
+
+bool CompressedInputStream::isOpen() const {
+    return buffer_->isOpen();
+}
+
+CompressionType CompressedInputStream::compression() const {
+    return buffer_->type();
+}
+
+uint64_t CompressedInputStream::compressedBytesRead() const {
+    return buffer_->compressedBytesRead();
+}
+
+const std::string& CompressedInputStream::getErrorMessage() const {
+    return buffer_->errorMessage();
+}
+
+// ---------------------------------------------------------------------------
+// Compression
+
+class CompressingBuffer : public std::streambuf {
+public:
+    explicit CompressingBuffer(const std::string& path)
+        : file_(path, std::ios::binary | std::ios::trunc), input_(kOutputChunk),
+          output_(kOutputChunk), closed_(false) {
+        setp(input_.data(), input_.data() + input_.size());
+        if (!file_.is_open()) {
+            errorMessage_ = "Cannot create file: " + path;
+        }
+    }
+    ~CompressingBuffer() override = default;
+
+    bool isOpen() const { return file_.is_open() && errorMessage_.empty(); }
+    const std::string& errorMessage() const { return errorMessage_; }
+
+    bool close() {
+        if (closed_) return errorMessage_.empty();
+        closed_ = true;
+        if (errorMessage_.empty()) {
+            encode(pbase(), static_cast<size_t>(pptr() - pbase()), true);
+        }
+        file_.close();
+        if (!file_ && errorMessage_.empty()) {
+            errorMessage_ = "Failed to write compressed output";
+        }
+        return errorMessage_.empty();
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!flushPending()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        return flushPending() ? 0 : -1;
+    }
+
+    // Compresses data (and finishes the stream when finish is set)
+    virtual bool encode(const char* data, size_t size, bool finish) = 0;
+
+    bool writeOutput(size_t size) {
+        file_.write(output_.data(), static_cast<std::streamsize>(size));
+        if (!file_) return fail("Failed to write compressed output");
+        return true;
+    }
+
+    bool fail(const std::string& message) {
+        if (errorMessage_.empty()) errorMessage_ = message;
+        return false;
+    }
+
+    std::ofstream file_;
+    std::vector<char> input_;
+    std::vector<char> output_;
+    bool closed_;
+    std::string errorMessage_;
+
+private:
+    bool flushPending() {
+        if (closed_ || !errorMessage_.empty()) return false;
+        bool ok = encode(pbase(), static_cast<size_t>(pptr() - pbase()), false);
+        setp(input_.data(), input_.data() + input_.size());
+        return ok;
+    }
+};
+
+namespace {
+
+class GzipWriter : public CompressingBuffer {
+public:
+    GzipWriter(const std::string& path, int level) : CompressingBuffer(path) {
+        std::memset(&stream_, 0, sizeof(stream_));
+        // 15 + 16: write a gzip header instead of a zlib one
+        if (deflateInit2(&stream_, level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, 9),
+                         Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            fail("Cannot initialise zlib");
+        }
+    }
+    ~GzipWriter() override {
+        close();
+        deflateEnd(&stream_);
+    }
+
+protected:
+    bool encode(const char* data, size_t size, bool finish) override {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream_.avail_in = static_cast<uInt>(size);
+        int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        // Keep draining while deflate fills the whole output buffer
+        do {
+            stream_.next_out = reinterpret_cast<Bytef*>(output_.data());
+            stream_.avail_out = static_cast<uInt>(output_.size());
+            int ret = deflate(&stream_, flush);
+            if (ret == Z_STREAM_ERROR) return fail("zlib compression failed");
+            if (!writeOutput(output_.size() - stream_.avail_out)) return false;
+            if (ret == Z_STREAM_END) break;
+        } while (stream_.avail_out == 0);
+        return true;
+    }
+
+private:
+    z_stream stream_;
+};
+
+class XzWriter : public CompressingBuffer {
+public:
+    XzWriter(const std::string& path, int level, unsigned threadCount)
+        : CompressingBuffer(path), stream_(LZMA_STREAM_INIT) {
+        uint32_t preset = level < 0 ? LZMA_PRESET_DEFAULT : static_cast<uint32_t>(std::min(level, 9));
+        unsigned threads = resolveThreads(threadCount);
+        lzma_ret ret;
+        if (threads > 1) {
+            lzma_mt options;
+            std::memset(&options, 0, sizeof(options));
+            options.threads = threads;
+            options.preset = preset;
+            options.check = LZMA_CHECK_CRC64;
+            ret = lzma_stream_encoder_mt(&stream_, &options);
+        } else {
+            ret = lzma_easy_encoder(&stream_, preset, LZMA_CHECK_CRC64);
+        }
+        if (ret != LZMA_OK) {
+            fail("Cannot initialise the xz encoder");
+        }
+    }
+    ~XzWriter() override {
+        close();
+        lzma_end(&stream_);
+    }
+
+protected:
+    bool encode(const char* data, size_t size, bool finish) override {
+        stream_.next_in = reinterpret_cast<const uint8_t*>(data);
+        stream_.avail_in = size;
+        while (true) {
+            stream_.next_out = reinterpret_cast<uint8_t*>(output_.data());
+            stream_.avail_out = output_.size();
+            lzma_ret ret = lzma_code(&stream_, finish ? LZMA_FINISH : LZMA_RUN);
+            if (ret != LZMA_OK && ret != LZMA_STREAM_END) return fail("xz compression failed");
+            if (!writeOutput(output_.size() - stream_.avail_out)) return false;
+            if (ret == LZMA_STREAM_END) return true;
+            if (!finish && stream_.avail_in == 0 && stream_.avail_out > 0) return true;
+        }
+    }
+
+private:
+    lzma_stream stream_;
+};
+
+#ifdef NEXUS_HAVE_ZSTD
+class ZstdWriter : public CompressingBuffer {
+public:
+    ZstdWriter(const std::string& path, int level, unsigned threadCount)
+        : CompressingBuffer(path), context_(ZSTD_createCCtx()) {
+        if (!context_) {
+            fail("Cannot initialise the zstd encoder");
+            return;
+        }
+        ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level < 0 ? 3 : level);
+        // Ignored by single-threaded builds of libzstd
+        ZSTD_CCtx_setParameter(context_, ZSTD_c_nbWorkers, static_cast<int>(resolveThreads(threadCount)));
+    }
+    ~ZstdWriter() override {
+        close();
+        ZSTD_freeCCtx(context_);
+    }
+
+protected:
+    bool encode(const char* data, size_t size, bool finish) override {
+        ZSTD_inBuffer in = {data, size, 0};
+        ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+        while (true) {
+            ZSTD_outBuffer out = {output_.data(), output_.size(), 0};
+            size_t remaining = ZSTD_compressStream2(context_, &out, &in, mode);
+            if (ZSTD_isError(remaining)) {
+                return fail(std::string("zstd compression failed: ") + ZSTD_getErrorName(remaining));
+            }
+            if (!writeOutput(out.pos)) return false;
+            if (finish ? remaining == 0 : in.pos == in.size) return true;
+        }
+    }
+
+private:
+    ZSTD_CCtx* context_;
+};
+#endif
+
+class PlainWriter : public CompressingBuffer {
+public:
+    using CompressingBuffer::CompressingBuffer;
+    ~PlainWriter() override { close(); }
+
+protected:
+    bool encode(const char* data, size_t size, bool finish) override {
+        (void)finish;
+        file_.write(data, static_cast<std::streamsize>(size));
+        return file_ ? true : fail("Failed to write output");
+    }
+};
+
+#ifndef NEXUS_HAVE_ZSTD
+class UnsupportedWriter : public PlainWriter {
+public:
+    explicit UnsupportedWriter(const std::string& path) : PlainWriter(path) {
+        fail("Zstandard support is not available in this build");
+    }
+};
+#endif
+
+std::unique_ptr<CompressingBuffer> makeCompressingBuffer(const std::string& path, CompressionType type,
+                                                         int level, unsigned threadCount) {
+    switch (type) {
+        case CompressionType::Gzip:
+            return std::make_unique<GzipWriter>(path, level);
+        case CompressionType::Xz:
+            return std::make_unique<XzWriter>(path, level, threadCount);
+        case CompressionType::Zstd:
+#ifdef NEXUS_HAVE_ZSTD
+            return std::make_unique<ZstdWriter>(path, level, threadCount);
+#else
+            return std::make_unique<UnsupportedWriter>(path);
+#endif
+        default:
+            return std::make_unique<PlainWriter>(path);
+    }
+}
+
+} // namespace
+
+CompressedOutputStream::CompressedOutputStream(const std::string& path, CompressionType type,
+                                               int level, unsigned threadCount)
+    : std::ostream(nullptr), buffer_(makeCompressingBuffer(path, type, level, threadCount)) {
+    rdbuf(buffer_.get());
+    if (!buffer_->isOpen()) {
+        setstate(std::ios::failbit);
+    }
+}
+
+CompressedOutputStream::~CompressedOutputStream() = default;
+
+bool CompressedOutputStream::isOpen() const {
+    return buffer_->isOpen();
+}
+
+bool CompressedOutputStream::close() {
+    bool ok = buffer_->close();
+    if (!ok) setstate(std::ios::badbit);
+    return ok;
+}
+
+const std::string& CompressedOutputStream::getErrorMessage() const {
+    return buffer_->errorMessage();
+}
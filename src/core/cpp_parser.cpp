@@ -1,279 +1,942 @@
 #include "cpp_parser.h"
 #include <algorithm>
-#include <sstream>
-#include <QRegExp>
-#include <QString>
-
-CppParser::CppParser() {
-    // Function definition pattern: modifier return_type function_name(parameters)
-    functionPattern_ = QRegExp(
-        "(?:^|\\s+)(?:virtual\\s+|static\\s+|inline\\s+)?"  // Optional modifiers
-        "([\\w:]+(?:\\s*[*&])?)"                            // Return type
-        "\\s+([\\w~]+)"                                     // Function name
-        "\\s*\\(([^)]*)\\)"                                 // Parameter list
-        "\\s*(?:const)?\\s*[{;]"                           // Optional const and function body start or declaration end
-    );
-    
-    // Class definition pattern
-    classPattern_ = QRegExp("class\\s+([\\w]+)\\s*(?::\\s*(.*))?\\s*\\{");
-    
-    // Function call pattern
-    functionCallPattern_ = QRegExp("([\\w]+)\\s*\\(");
-    
-    // Parameter pattern
-    parameterPattern_ = QRegExp("((?:const\\s+)?[\\w:]+(?:\\s*[*&])?)\\s+([\\w]+)(?:\\s*=\\s*([^,)]*))?");
+#include <cctype>
+#include <exception>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+enum class TokenKind { Identifier, Number, Literal, Punct };
+
+struct Token {
+    TokenKind kind;
+    std::string_view text;
+    int line;
+};
+
+bool isIdentifierStart(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalpha(u) || c == '_' || u >= 0x80;
 }
 
-CppParser::~CppParser() {
-    clear();
+bool isIdentifierChar(char c) {
+    return isIdentifierStart(c) || std::isdigit(static_cast<unsigned char>(c));
 }
 
-bool CppParser::parseFile(const std::string& content) {
-    clear();
-    
-    if (content.empty()) {
-        return false;
-    }
-    
-    try {
-        // Remove comments
-        std::string cleanContent = removeComments(content);
-        
-        // Parse classes
-        parseClasses(cleanContent);
-        
-        // Parse functions
-        parseFunctions(cleanContent);
-        
-        // Parse functions调用关系
-        parseFunctionCalls(cleanContent);
-        
-        return true;
-    } catch (const std::exception& e) {
-        return false;
+bool isLiteralPrefix(std::string_view word) {
+    return word == "L" || word == "u" || word == "U" || word == "u8" ||
+           word == "R" || word == "LR" || word == "uR" || word == "UR" || word == "u8R";
+}
+
+// Length of the punctuator at code[i]. The walker needs to see these as one
+// token: <<= ... :: -> && || == != <= >= ++ -- += -= *= /= %= &= |= ^= <<
+// ">>" is deliberately absent so that nested template argument lists close
+// one '>' at a time.
+size_t punctuatorLength(const std::string& code, size_t i) {
+    char next = i + 1 < code.size() ? code[i + 1] : '\0';
+    switch (code[i]) {
+        case ':':
+            return next == ':' ? 2 : 1;
+        case '-':
+            return next == '>' || next == '-' || next == '=' ? 2 : 1;
+        case '+':
+        case '&':
+        case '|':
+            return next == code[i] || next == '=' ? 2 : 1;
+        case '<':
+            if (next == '<') return i + 2 < code.size() && code[i + 2] == '=' ? 3 : 2;
+            return next == '=' ? 2 : 1;
+        case '.':
+            return next == '.' && i + 2 < code.size() && code[i + 2] == '.' ? 3 : 1;
+        case '=':
+        case '!':
+        case '>':
+        case '*':
+        case '/':
+        case '%':
+        case '^':
+            return next == '=' ? 2 : 1;
     }
+    return 1;
 }
 
-void CppParser::parseFunctions(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Skip comments, preprocessor directives and empty lines
-        if (line.empty() || line[0] == '#' || 
-            line.find("//") == 0 || line.find("/*") != std::string::npos) {
+// Splits the source into tokens in one pass over its mask, in which
+// comments and preprocessor directives are blank and literals are reduced to
+// their quotes. Token text is taken from the original at the same offsets, so
+// a literal (raw strings included) is a single Literal token.
+std::vector<Token> tokenize(const SourceBuffer& source) {
+    SourceMask mask(source, SourceLanguage::Cpp);
+    const std::string& code = mask.code();
+    std::string_view original = source.view();
+    LineCursor lines(source);
+
+    std::vector<Token> tokens;
+    tokens.reserve(code.size() / 4);
+
+    size_t size = code.size();
+    size_t i = 0;
+    auto push = [&](TokenKind kind, size_t start) {
+        tokens.push_back({kind, original.substr(start, i - start), lines.lineAt(start)});
+    };
+
+    while (i < size) {
+        char c = code[i];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+            ++i;
+            continue;
+        }
+
+        size_t start = i;
+        if (isIdentifierStart(c)) {
+            while (i < size && isIdentifierChar(code[i])) ++i;
+            if (i < size && (code[i] == '"' || code[i] == '\'') && isLiteralPrefix(std::string_view(code).substr(start, i - start))) {
+                c = code[i];
+            } else {
+                push(TokenKind::Identifier, start);
+                continue;
+            }
+        }
+        if (c == '"' || c == '\'') {
+            // The inside of the literal is blank in the mask
+            ++i;
+            while (i < size && code[i] != c && code[i] != '\n') ++i;
+            if (i < size && code[i] == c) ++i;
+            push(TokenKind::Literal, start);
             continue;
         }
-        
-        // Find function definitions
-        if (functionPattern_.indexIn(qline) != -1) {
-            CppFunction func = parseFunctionDeclaration(line, i + 1);
-            if (!func.name.empty()) {
-                functions_.push_back(func);
+        if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && i + 1 < size && std::isdigit(static_cast<unsigned char>(code[i + 1])))) {
+            while (i < size) {
+                char d = code[i];
+                if ((d == '+' || d == '-') && (code[i - 1] == 'e' || code[i - 1] == 'E' || code[i - 1] == 'p' || code[i - 1] == 'P')) {
+                    ++i;
+                } else if (d == '\'' && i + 1 < size && std::isalnum(static_cast<unsigned char>(code[i + 1]))) {
+                    ++i;  // digit separator
+                } else if (isIdentifierChar(d) || d == '.') {
+                    ++i;
+                } else {
+                    break;
+                }
             }
+            push(TokenKind::Number, start);
+            continue;
         }
+
+        i += punctuatorLength(code, i);
+        push(TokenKind::Punct, start);
     }
+    return tokens;
 }
 
-void CppParser::parseClasses(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        if (classPattern_.indexIn(qline) != -1) {
-            CppClass cls;
-            cls.name = classPattern_.cap(1).toStdString();
-            cls.lineNumber = i + 1;
-            
-            // Parse base classes
-            if (!classPattern_.cap(2).isEmpty()) {
-                QString baseClasses = classPattern_.cap(2);
-                QStringList bases = baseClasses.split(",");
-                for (const QString& base : bases) {
-                    QString trimmed = base.trimmed();
-                    // Remove access modifiers
-                    trimmed.replace(QRegExp("^(public|private|protected)\\s+"), "");
-                    cls.baseClasses.push_back(trimmed.toStdString());
-                }
+// Identifiers that are followed by '(' without being a function name
+const std::unordered_set<std::string_view> kNonCallKeywords = {
+    "if", "for", "while", "switch", "return", "sizeof", "catch", "alignof", "alignas",
+    "decltype", "noexcept", "static_assert", "typeid", "throw", "new", "delete",
+    "static_cast", "dynamic_cast", "const_cast", "reinterpret_cast", "defined",
+    "__attribute__", "__declspec", "operator", "co_await", "co_yield", "co_return"
+};
+
+// Keywords that may directly precede a call; any other identifier there
+// makes "Type name(args)" a variable declaration instead
+const std::unordered_set<std::string_view> kCallPrefixKeywords = {
+    "return", "else", "do", "new", "delete", "throw", "case", "co_await", "co_yield",
+    "co_return", "emit", "Q_EMIT", "and", "or", "not"
+};
+
+// Declaration specifiers that are reported as flags, not as part of the return type
+const std::unordered_set<std::string_view> kFunctionSpecifiers = {
+    "static", "virtual", "inline", "explicit", "constexpr", "consteval", "extern",
+    "Q_INVOKABLE", "Q_SLOT", "Q_SIGNAL"
+};
+
+const std::unordered_set<std::string_view> kTypeKeywords = {
+    "void", "bool", "char", "wchar_t", "char8_t", "char16_t", "char32_t", "short", "int",
+    "long", "float", "double", "signed", "unsigned", "auto", "const", "volatile"
+};
+
+bool isWordToken(const Token& token) {
+    return token.kind != TokenKind::Punct;
+}
+
+// Joins tokens the way they would normally be written: "const std::string&",
+// "std::map<int, int>"
+std::string joinTokens(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    std::string text;
+    for (size_t i = begin; i < end; ++i) {
+        if (i > begin && ((isWordToken(tokens[i]) && isWordToken(tokens[i - 1])) || tokens[i - 1].text == ",")) {
+            text += ' ';
+        }
+        text += tokens[i].text;
+    }
+    return text;
+}
+
+struct Scope {
+    enum class Kind { Namespace, Class, Function, Block };
+    Kind kind;
+    int classIndex;     // Class: index into the parsed classes
+    std::string access; // Class: current access level
+    int entryIndex;     // Function and blocks nested in it: the enclosing function
+};
+
+struct RawCallSite {
+    size_t entryIndex;
+    std::string callee;
+    std::string qualifier;
+    int lineNumber;
+    std::string object;
+    int argumentCount;
+};
+
+class SourceWalker {
+public:
+    explicit SourceWalker(const std::vector<Token>& tokens) : tokens_(tokens) {}
+
+    void run();
+
+    // Function definitions and declarations in source order
+    std::vector<CppFunction> entries;
+    std::vector<CppClass> classes;
+    std::vector<RawCallSite> calls;
+
+private:
+    bool is(size_t i, std::string_view text) const {
+        return i < tokens_.size() && tokens_[i].text == text;
+    }
+    bool isIdentifier(size_t i) const {
+        return i < tokens_.size() && tokens_[i].kind == TokenKind::Identifier;
+    }
+
+    size_t matchForward(size_t open, std::string_view openText, std::string_view closeText) const;
+    size_t skipAngles(size_t open) const;
+    size_t skipAttribute(size_t i) const;
+    size_t skipStatement(size_t i) const;
+
+    void walkBody(size_t& i);
+    void recordCall(size_t i, size_t entryIndex);
+
+    bool tryNamespace(size_t& i);
+    bool tryClass(size_t& i);
+    bool tryFunction(size_t nameIndex, size_t open, size_t& i);
+    std::vector<CppParameter> parseParameters(size_t begin, size_t end, bool& plausible) const;
+    void collectMembers(size_t begin, size_t end);
+
+    const std::vector<Token>& tokens_;
+    std::vector<Scope> scopes_;
+    size_t statementStart_ = 0;
+};
+
+// Index of the token closing the group opened at 'open', or npos. Statements
+// never end inside a parameter list, so ';' gives up early.
+size_t SourceWalker::matchForward(size_t open, std::string_view openText, std::string_view closeText) const {
+    int depth = 0;
+    for (size_t i = open; i < tokens_.size(); ++i) {
+        std::string_view text = tokens_[i].text;
+        if (tokens_[i].kind != TokenKind::Punct) continue;
+        if (text == openText) {
+            ++depth;
+        } else if (text == closeText) {
+            if (--depth == 0) return i;
+        } else if (text == ";" && openText != "{") {
+            return std::string::npos;
+        }
+    }
+    return std::string::npos;
+}
+
+// Past a template argument list "<...>", or 'open' itself if it is not one
+size_t SourceWalker::skipAngles(size_t open) const {
+    int depth = 0;
+    for (size_t i = open; i < tokens_.size() && i < open + 256; ++i) {
+        std::string_view text = tokens_[i].text;
+        if (text == "<") {
+            ++depth;
+        } else if (text == ">") {
+            if (--depth == 0) return i + 1;
+        } else if (text == "(") {
+            size_t close = matchForward(i, "(", ")");
+            if (close == std::string::npos) return open;
+            i = close;
+        } else if (text == ";" || text == "{" || text == "}") {
+            return open;
+        }
+    }
+    return open;
+}
+
+// Past "[[...]]" at i, or i when there is no "[[" there. An unclosed "[["
+// (being typed) is skipped one token at a time, so callers always move on.
+size_t SourceWalker::skipAttribute(size_t i) const {
+    if (!is(i, "[") || !is(i + 1, "[")) return i;
+    size_t close = matchForward(i, "[", "]");
+    return close == std::string::npos ? i + 1 : close + 1;
+}
+
+// Past the ';' ending the statement at i, or past its brace-enclosed body
+size_t SourceWalker::skipStatement(size_t i) const {
+    int depth = 0;
+    for (; i < tokens_.size(); ++i) {
+        std::string_view text = tokens_[i].text;
+        if (tokens_[i].kind != TokenKind::Punct) continue;
+        if (text == "(" || text == "[") {
+            ++depth;
+        } else if (text == ")" || text == "]") {
+            --depth;
+        } else if (text == "{") {
+            size_t close = matchForward(i, "{", "}");
+            if (close == std::string::npos) return tokens_.size();
+            i = close;
+            if (depth <= 0 && !is(i + 1, ";")) return i + 1;
+        } else if (text == "}" && depth <= 0) {
+            return i;
+        } else if (text == ";" && depth <= 0) {
+            return i + 1;
+        }
+    }
+    return i;
+}
+
+void SourceWalker::run() {
+    scopes_.push_back({Scope::Kind::Namespace, -1, "", -1});
+    statementStart_ = 0;
+
+    size_t i = 0;
+    while (i < tokens_.size()) {
+        Scope& scope = scopes_.back();
+        if (scope.entryIndex >= 0) {
+            walkBody(i);
+            continue;
+        }
+
+        const Token& token = tokens_[i];
+        std::string_view text = token.text;
+
+        if (scope.kind == Scope::Kind::Block) {
+            // Enum bodies, initializers and the like: only the braces matter
+            if (text == "{") {
+                scopes_.push_back({Scope::Kind::Block, -1, "", -1});
+            } else if (text == "}") {
+                scopes_.pop_back();
+                statementStart_ = i + 1;
+            }
+            ++i;
+            continue;
+        }
+
+        if (token.kind == TokenKind::Punct) {
+            if (text == ";") {
+                if (scope.kind == Scope::Kind::Class) collectMembers(statementStart_, i);
+                statementStart_ = ++i;
+            } else if (text == "}") {
+                if (scopes_.size() > 1) scopes_.pop_back();
+                statementStart_ = ++i;
+            } else if (text == "{") {
+                scopes_.push_back({Scope::Kind::Block, -1, "", -1});
+                ++i;
+            } else if (text == "(") {
+                size_t close = matchForward(i, "(", ")");
+                i = close == std::string::npos ? i + 1 : close + 1;
+            } else if (text == "[" && is(i + 1, "[")) {
+                i = skipAttribute(i);
+            } else {
+                ++i;
+            }
+            continue;
+        }
+
+        if (token.kind != TokenKind::Identifier) {
+            ++i;
+            continue;
+        }
+
+        if (text == "namespace" && tryNamespace(i)) continue;
+        if (text == "extern" && i + 2 < tokens_.size() && tokens_[i + 1].kind == TokenKind::Literal && is(i + 2, "{")) {
+            // extern "C" { ... } does not open a scope of its own
+            scopes_.push_back({Scope::Kind::Namespace, -1, "", -1});
+            statementStart_ = i += 3;
+            continue;
+        }
+        if ((text == "class" || text == "struct" || text == "union") &&
+            !(i > statementStart_ && is(i - 1, "enum")) && tryClass(i)) {
+            continue;
+        }
+        if (text == "template" && is(i + 1, "<")) {
+            size_t past = skipAngles(i + 1);
+            if (past == i + 1) {
+                ++i;
+                continue;
+            }
+            statementStart_ = i = past;
+            continue;
+        }
+        if (text == "typedef" || text == "using" || text == "friend" || text == "static_assert") {
+            statementStart_ = i = skipStatement(i);
+            continue;
+        }
+        if (scope.kind == Scope::Kind::Class) {
+            size_t colon = i + 1;
+            if ((text == "public" || text == "private" || text == "protected") &&
+                (is(colon, "slots") || is(colon, "Q_SLOTS"))) {
+                ++colon;
+            }
+            bool access = text == "public" || text == "private" || text == "protected";
+            bool signals = text == "signals" || text == "Q_SIGNALS";
+            if ((access || signals) && is(colon, ":")) {
+                scope.access = access ? std::string(text) : "public";
+                statementStart_ = i = colon + 1;
+                continue;
             }
-            
-            classes_.push_back(cls);
         }
+
+        if (text == "operator") {
+            // operator(), operator==, operator bool ...
+            size_t open = i + 1;
+            if (is(open, "(") && is(open + 1, ")")) open += 2;
+            while (open < tokens_.size() && !is(open, "(") && !is(open, ";") && !is(open, "{")) ++open;
+            if (is(open, "(") && tryFunction(i, open, i)) continue;
+            i = open;
+            continue;
+        }
+
+        if (is(i + 1, "(")) {
+            if (tryFunction(i, i + 1, i)) continue;
+            size_t close = matchForward(i + 1, "(", ")");
+            bool macro = statementStart_ == i && kNonCallKeywords.count(text) == 0;
+            i = close == std::string::npos ? i + 2 : close + 1;
+            // A macro invocation such as Q_PROPERTY(...) ends without a ';'
+            if (macro) statementStart_ = i;
+            continue;
+        }
+        ++i;
     }
 }
 
-void CppParser::parseFunctionCalls(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    std::string currentFunction;
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Check if this is the start of a function definition
-        if (functionPattern_.indexIn(qline) != -1) {
-            currentFunction = functionPattern_.cap(2).toStdString();
-        }
-        
-        // Find function calls within function body
-        if (!currentFunction.empty() && line.find("{") != std::string::npos) {
-            // Start parsing function body
-            size_t braceCount = std::count(line.begin(), line.end(), '{') - 
-                                std::count(line.begin(), line.end(), '}');
-            
-            for (size_t j = i + 1; j < lines.size() && braceCount > 0; ++j) {
-                const std::string& bodyLine = lines[j];
-                QString qBodyLine = QString::fromStdString(bodyLine);
-                
-                braceCount += std::count(bodyLine.begin(), bodyLine.end(), '{') - 
-                              std::count(bodyLine.begin(), bodyLine.end(), '}');
-                
-                // Find function calls
-                int pos = 0;
-                while ((pos = functionCallPattern_.indexIn(qBodyLine, pos)) != -1) {
-                    QString calledFunc = functionCallPattern_.cap(1);
-                    std::string calledFuncStr = calledFunc.toStdString();
-                    
-                    // Avoid keywords and common non-function calls
-                    if (calledFuncStr != "if" && calledFuncStr != "while" && 
-                        calledFuncStr != "for" && calledFuncStr != "switch" &&
-                        calledFuncStr != "return" && calledFuncStr != "sizeof") {
-                        functionCalls_[currentFunction].push_back(calledFuncStr);
-                    }
-                    
-                    pos += functionCallPattern_.matchedLength();
-                }
+// Inside a function body: track braces and record calls
+void SourceWalker::walkBody(size_t& i) {
+    const Token& token = tokens_[i];
+    size_t entryIndex = static_cast<size_t>(scopes_.back().entryIndex);
+    if (token.kind == TokenKind::Punct) {
+        if (token.text == "{") {
+            scopes_.push_back({Scope::Kind::Block, -1, "", static_cast<int>(entryIndex)});
+        } else if (token.text == "}") {
+            scopes_.pop_back();
+            if (scopes_.back().entryIndex < 0) statementStart_ = i + 1;
+        }
+    } else if (token.kind == TokenKind::Identifier) {
+        recordCall(i, entryIndex);
+    }
+    ++i;
+}
+
+void SourceWalker::recordCall(size_t i, size_t entryIndex) {
+    // Most identifiers of a body are not called, and that shows in the next token
+    if (!is(i + 1, "(") && !is(i + 1, "<")) return;
+    std::string_view name = tokens_[i].text;
+    if (kNonCallKeywords.count(name) || kTypeKeywords.count(name)) return;
+
+    size_t next = i + 1;
+    if (is(next, "<")) next = skipAngles(next);  // make_shared<Foo>(...)
+    if (!is(next, "(")) return;
+
+    // Qualifier of ns::name(...) and Type::name(...)
+    size_t start = i;
+    while (start >= 2 && is(start - 1, "::") && isIdentifier(start - 2)) start -= 2;
+    std::string qualifier;
+    if (start < i) qualifier = joinTokens(tokens_, start, i - 1);
+
+    // "Type name(args)" and "Type<Args> name(args)" declare a variable
+    if (start > 0 && isIdentifier(start - 1) && !kCallPrefixKeywords.count(tokens_[start - 1].text)) return;
+    if (start > 0 && is(start - 1, ">")) {
+        int depth = 0;
+        for (size_t k = start - 1; k > 0 && k + 32 > start; --k) {
+            std::string_view text = tokens_[k].text;
+            if (text == ">") ++depth;
+            if (text == "<" && --depth == 0) {
+                if (isIdentifier(k - 1)) return;
+                break;
             }
-            
-            currentFunction.clear();
+            if (text == ";" || text == "{" || text == "}" || text == "(" || text == ")" ||
+                text == "&&" || text == "||" || text == "=") {
+                break;
+            }
+        }
+    }
+
+    // Object of obj.run(), ptr->run() and this->run(); get().run() has none
+    std::string object;
+    if (start > 0 && (is(start - 1, ".") || is(start - 1, "->"))) {
+        object = (isIdentifier(start - 2) ? std::string(tokens_[start - 2].text) : "()") +
+                 std::string(tokens_[start - 1].text);
+    }
+
+    // Top-level commas of the argument list
+    int argumentCount = -1;
+    size_t close = matchForward(next, "(", ")");
+    if (close != std::string::npos) {
+        argumentCount = close > next + 1 ? 1 : 0;
+        int depth = 0;
+        for (size_t k = next + 1; k < close; ++k) {
+            std::string_view text = tokens_[k].text;
+            if (text == "(" || text == "[" || text == "{") ++depth;
+            if (text == ")" || text == "]" || text == "}") --depth;
+            if (text == "," && depth == 0) ++argumentCount;
         }
     }
+
+    calls.push_back({entryIndex, std::string(name), qualifier, tokens_[i].line, std::move(object), argumentCount});
 }
 
-CppFunction CppParser::parseFunctionDeclaration(const std::string& line, int lineNumber) {
-    CppFunction func;
-    QString qline = QString::fromStdString(line);
-    
-    if (functionPattern_.indexIn(qline) != -1) {
-        func.returnType = functionPattern_.cap(1).toStdString();
-        func.name = functionPattern_.cap(2).toStdString();
-        func.lineNumber = lineNumber;
-        
-        // 解析修饰符
-        func.isStatic = line.find("static") != std::string::npos;
-        func.isVirtual = line.find("virtual") != std::string::npos;
-        func.isConst = line.find("const") != std::string::npos;
-        
-        // 解析参数
-        QString paramStr = functionPattern_.cap(3);
-        func.parameters = parseParameters(paramStr.toStdString());
-    }
-    
-    return func;
+bool SourceWalker::tryNamespace(size_t& i) {
+    size_t j = i + 1;
+    while (isIdentifier(j) || is(j, "::")) ++j;
+    if (!is(j, "{")) return false;  // namespace alias
+    scopes_.push_back({Scope::Kind::Namespace, -1, "", -1});
+    statementStart_ = i = j + 1;
+    return true;
 }
 
-std::vector<CppParameter> CppParser::parseParameters(const std::string& paramStr) {
-    std::vector<CppParameter> parameters;
-    
-    if (paramStr.empty() || paramStr == "void") {
-        return parameters;
-    }
-    
-    QString qParamStr = QString::fromStdString(paramStr);
-    QStringList paramList = qParamStr.split(",");
-    
-    for (const QString& param : paramList) {
-        QString trimmed = param.trimmed();
-        if (trimmed.isEmpty()) continue;
-        
-        if (parameterPattern_.indexIn(trimmed) != -1) {
-            CppParameter p;
-            p.type = parameterPattern_.cap(1).toStdString();
-            p.name = parameterPattern_.cap(2).toStdString();
-            p.defaultValue = parameterPattern_.cap(3).toStdString();
-            parameters.push_back(p);
+bool SourceWalker::tryClass(size_t& i) {
+    size_t keyword = i;
+    size_t j = i + 1;
+    std::string name;
+    while (j < tokens_.size()) {
+        j = skipAttribute(j);
+        if (is(j, "alignas") && is(j + 1, "(")) {
+            size_t close = matchForward(j + 1, "(", ")");
+            if (close == std::string::npos) return false;
+            j = close + 1;
+        } else if (isIdentifier(j)) {
+            if (tokens_[j].text != "final") name = std::string(tokens_[j].text);
+            ++j;
+        } else if (is(j, "::")) {
+            ++j;
+        } else if (is(j, "<") && !name.empty()) {
+            size_t past = skipAngles(j);  // partial specialization
+            if (past == j) return false;
+            j = past;
         } else {
-            // 简单解析：假设最后一个单词是参数名
-            QStringList words = trimmed.split(QRegExp("\\s+"));
-            if (words.size() >= 2) {
-                CppParameter p;
-                p.name = words.last().toStdString();
-                words.removeLast();
-                p.type = words.join(" ").toStdString();
-                parameters.push_back(p);
+            break;
+        }
+    }
+    if (!is(j, "{") && !is(j, ":")) return false;  // forward or elaborated declaration
+
+    std::vector<std::string> bases;
+    if (is(j, ":")) {
+        size_t baseStart = ++j;
+        int angles = 0;
+        while (j < tokens_.size() && !is(j, "{")) {
+            std::string_view text = tokens_[j].text;
+            if (text == ";" || text == "}") return false;
+            if (text == "<") ++angles;
+            if (text == ">") --angles;
+            if (text == "," && angles == 0) {
+                if (j > baseStart) bases.push_back(joinTokens(tokens_, baseStart, j));
+                baseStart = j + 1;
+            } else if (angles == 0 && (text == "public" || text == "private" || text == "protected" || text == "virtual") &&
+                       j == baseStart) {
+                baseStart = j + 1;
             }
+            ++j;
         }
+        if (j >= tokens_.size()) return false;
+        if (j > baseStart) bases.push_back(joinTokens(tokens_, baseStart, j));
     }
-    
-    return parameters;
+
+    if (name.empty()) {
+        // Anonymous struct or union: nothing to report inside it
+        scopes_.push_back({Scope::Kind::Block, -1, "", -1});
+    } else {
+        CppClass cls;
+        cls.name = name;
+        cls.baseClasses = std::move(bases);
+        cls.lineNumber = tokens_[keyword].line;
+        classes.push_back(std::move(cls));
+        std::string access = tokens_[keyword].text == "class" ? "private" : "public";
+        scopes_.push_back({Scope::Kind::Class, static_cast<int>(classes.size() - 1), access, -1});
+    }
+    statementStart_ = i = j + 1;
+    return true;
 }
 
-std::string CppParser::removeComments(const std::string& content) {
-    std::string result = content;
-    
-    // 移除单行注释
-    size_t pos = 0;
-    while ((pos = result.find("//", pos)) != std::string::npos) {
-        size_t endPos = result.find('\n', pos);
-        if (endPos == std::string::npos) {
-            result.erase(pos);
-            break;
+// nameIndex is the function name (or the 'operator' keyword), open the '(' of
+// its parameter list. On success i is moved past the declaration, or into the
+// body of a definition.
+bool SourceWalker::tryFunction(size_t nameIndex, size_t open, size_t& i) {
+    const Scope& scope = scopes_.back();
+    std::string_view nameText = tokens_[nameIndex].text;
+    if (kNonCallKeywords.count(nameText) && nameText != "operator") return false;
+
+    size_t close = matchForward(open, "(", ")");
+    if (close == std::string::npos) return false;
+
+    bool isOperator = nameText == "operator";
+    std::string name = isOperator ? "operator" : std::string(nameText);
+    if (isOperator) {
+        std::string symbol = joinTokens(tokens_, nameIndex + 1, open);
+        name += (symbol.empty() || !isWordToken(tokens_[nameIndex + 1]) ? "" : " ") + symbol;
+    }
+    size_t nameStart = nameIndex;
+    bool isDestructor = nameIndex > statementStart_ && is(nameIndex - 1, "~");
+    if (isDestructor) {
+        name = "~" + name;
+        --nameStart;
+    }
+
+    // Qualifier of Type::name and ns::Type<T>::name
+    std::vector<std::string_view> qualifiers;
+    while (nameStart >= statementStart_ + 2 && is(nameStart - 1, "::")) {
+        size_t k = nameStart - 2;
+        if (is(k, ">")) {
+            int depth = 0;
+            while (k > statementStart_) {
+                if (is(k, ">")) ++depth;
+                if (is(k, "<") && --depth == 0) break;
+                --k;
+            }
+            if (k == statementStart_) break;
+            --k;
         }
-        result.erase(pos, endPos - pos);
+        if (!isIdentifier(k)) break;
+        qualifiers.insert(qualifiers.begin(), tokens_[k].text);
+        nameStart = k;
     }
-    
-    // 移除多行注释
-    pos = 0;
-    while ((pos = result.find("/*", pos)) != std::string::npos) {
-        size_t endPos = result.find("*/", pos);
-        if (endPos == std::string::npos) {
-            result.erase(pos);
+
+    // Declaration specifiers and return type
+    bool isStatic = false;
+    bool isVirtual = false;
+    std::vector<Token> returnTokens;
+    for (size_t k = statementStart_; k < nameStart; ++k) {
+        std::string_view text = tokens_[k].text;
+        if (text == "=" || text == "." || text == "->" || text == "return" || text == "(") return false;
+        if (text == "[" && is(k + 1, "[")) {
+            k = skipAttribute(k) - 1;
+            continue;
+        }
+        if (text == "static") isStatic = true;
+        if (text == "virtual") isVirtual = true;
+        if (kFunctionSpecifiers.count(text)) continue;
+        returnTokens.push_back(tokens_[k]);
+    }
+
+    std::string className;
+    if (!qualifiers.empty()) {
+        for (size_t q = 0; q < qualifiers.size(); ++q) {
+            if (q > 0) className += "::";
+            className += qualifiers[q];
+        }
+    } else if (scope.kind == Scope::Kind::Class) {
+        className = classes[static_cast<size_t>(scope.classIndex)].name;
+    }
+    // Not one conditional expression: its std::string temporary would not outlive the view
+    std::string_view ownerName;
+    if (!qualifiers.empty()) {
+        ownerName = qualifiers.back();
+    } else if (scope.kind == Scope::Kind::Class) {
+        ownerName = className;
+    }
+    bool isConstructor = !ownerName.empty() && (name == ownerName || (isDestructor && name.substr(1) == ownerName));
+    // Without a return type only constructors, destructors and conversion
+    // operators are functions; anything else is a macro invocation
+    if (returnTokens.empty() && !isConstructor && !isOperator) return false;
+
+    bool plausible = true;
+    std::vector<CppParameter> parameters = parseParameters(open + 1, close, plausible);
+    if (!plausible) return false;
+
+    // Trailing qualifiers
+    bool isConst = false;
+    std::string trailingReturn;
+    size_t k = close + 1;
+    while (k < tokens_.size()) {
+        std::string_view text = tokens_[k].text;
+        if (text == "const") {
+            isConst = true;
+            ++k;
+        } else if (text == "volatile" || text == "&" || text == "&&" || text == "override" || text == "final") {
+            ++k;
+        } else if ((text == "noexcept" || text == "throw" || text == "__attribute__") && is(k + 1, "(")) {
+            size_t end = matchForward(k + 1, "(", ")");
+            if (end == std::string::npos) return false;
+            k = end + 1;
+        } else if (text == "noexcept") {
+            ++k;
+        } else if (text == "->") {
+            size_t start = ++k;
+            while (k < tokens_.size() && !is(k, "{") && !is(k, ";") && !is(k, "=")) {
+                if (is(k, "<")) {
+                    size_t past = skipAngles(k);
+                    k = past == k ? k + 1 : past;
+                } else {
+                    ++k;
+                }
+            }
+            trailingReturn = joinTokens(tokens_, start, k);
+        } else if (is(k, "[") && is(k + 1, "[")) {
+            k = skipAttribute(k);
+        } else if (tokens_[k].kind == TokenKind::Identifier && text != "try" &&
+                   std::all_of(text.begin(), text.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)) || c == '_' || std::isdigit(static_cast<unsigned char>(c)); })) {
+            ++k;  // Q_DECL_OVERRIDE and similar macros
+        } else {
             break;
         }
-        result.erase(pos, endPos - pos + 2);
     }
-    
-    return result;
+
+    bool defined = false;
+    size_t bodyOpen = k;
+    if (is(k, "{")) {
+        defined = true;
+    } else if (is(k, "try") && is(k + 1, "{")) {
+        defined = true;
+        bodyOpen = k + 1;
+    } else if (is(k, ":") && isConstructor) {
+        // Member initializer list: name(args) or name{args}, comma separated
+        size_t j = k + 1;
+        while (j < tokens_.size()) {
+            while (isIdentifier(j) || is(j, "::")) ++j;
+            if (is(j, "<")) j = skipAngles(j);
+            size_t end = std::string::npos;
+            if (is(j, "(")) end = matchForward(j, "(", ")");
+            else if (is(j, "{")) end = matchForward(j, "{", "}");
+            if (end == std::string::npos) return false;
+            j = end + 1;
+            if (is(j, "...")) ++j;
+            if (!is(j, ",")) break;
+            ++j;
+        }
+        if (!is(j, "{")) return false;
+        defined = true;
+        bodyOpen = j;
+    } else if (is(k, ";")) {
+        bodyOpen = k;
+    } else if (is(k, "=") && (is(k + 1, "0") || is(k + 1, "default") || is(k + 1, "delete")) && is(k + 2, ";")) {
+        bodyOpen = k + 2;
+    } else {
+        return false;
+    }
+
+    CppFunction function;
+    function.name = name;
+    function.returnType = trailingReturn.empty() ? joinTokens(returnTokens, 0, returnTokens.size()) : trailingReturn;
+    function.parameters = std::move(parameters);
+    function.lineNumber = tokens_[nameIndex].line;
+    function.className = className;
+    function.isStatic = isStatic;
+    function.isVirtual = isVirtual;
+    function.isConst = isConst;
+    function.isDefined = defined;
+    function.accessLevel = scope.kind == Scope::Kind::Class ? scope.access : "";
+
+    if (scope.kind == Scope::Kind::Class && qualifiers.empty()) {
+        classes[static_cast<size_t>(scope.classIndex)].methods.push_back(function);
+    }
+    entries.push_back(std::move(function));
+
+    if (defined) {
+        scopes_.push_back({Scope::Kind::Function, -1, "", static_cast<int>(entries.size() - 1)});
+        i = bodyOpen + 1;
+    } else {
+        statementStart_ = i = bodyOpen + 1;
+    }
+    return true;
 }
 
-std::string CppParser::normalizeWhitespace(const std::string& text) {
-    std::string result;
-    bool inWhitespace = false;
-    
-    for (char c : text) {
-        if (std::isspace(c)) {
-            if (!inWhitespace) {
-                result += ' ';
-                inWhitespace = true;
+// Parameters between the parentheses [begin, end). plausible is cleared when
+// the list reads like constructor arguments ("Foo x(1, y.z)") rather than
+// parameter declarations.
+std::vector<CppParameter> SourceWalker::parseParameters(size_t begin, size_t end, bool& plausible) const {
+    std::vector<CppParameter> parameters;
+    if (end == begin + 1 && tokens_[begin].text == "void") return parameters;
+
+    size_t start = begin;
+    int depth = 0;
+    for (size_t i = begin; i <= end; ++i) {
+        if (i < end) {
+            std::string_view text = tokens_[i].text;
+            if (text == "(" || text == "[" || text == "{" ||
+                (text == "<" && i > begin && isIdentifier(i - 1))) {
+                ++depth;
+            } else if (text == ")" || text == "]" || text == "}" || (text == ">" && depth > 0)) {
+                --depth;
             }
+            if (!(text == "," && depth == 0)) continue;
+        }
+        if (i == start) {
+            start = i + 1;
+            continue;
+        }
+
+        if (tokens_[start].kind == TokenKind::Number || tokens_[start].kind == TokenKind::Literal) {
+            plausible = false;
+            return {};
+        }
+
+        CppParameter parameter;
+        size_t declEnd = i;
+        for (size_t k = start; k < i; ++k) {
+            if (tokens_[k].text == "=") {
+                declEnd = k;
+                parameter.defaultValue = joinTokens(tokens_, k + 1, i);
+                break;
+            }
+            if (tokens_[k].text == "." || tokens_[k].text == "->") {
+                plausible = false;
+                return {};
+            }
+        }
+
+        size_t nameIndex = declEnd;
+        if (declEnd > start && tokens_[declEnd - 1].text == "]") {
+            // int values[16]
+            size_t k = declEnd - 1;
+            while (k > start && tokens_[k].text != "[") --k;
+            nameIndex = k;
+        }
+        bool named = nameIndex > start + 1 && isIdentifier(nameIndex - 1) &&
+                     !kTypeKeywords.count(tokens_[nameIndex - 1].text) && !is(nameIndex - 2, "::");
+        if (named) {
+            // "const Foo" is a type without a name
+            bool cvOnly = true;
+            for (size_t k = start; k < nameIndex - 1; ++k) {
+                if (tokens_[k].text != "const" && tokens_[k].text != "volatile") cvOnly = false;
+            }
+            named = !cvOnly;
+        }
+        if (named) {
+            parameter.name = std::string(tokens_[nameIndex - 1].text);
+            parameter.type = joinTokens(tokens_, start, nameIndex - 1) + joinTokens(tokens_, nameIndex, declEnd);
         } else {
-            result += c;
-            inWhitespace = false;
+            parameter.type = joinTokens(tokens_, start, declEnd);
+        }
+        parameters.push_back(std::move(parameter));
+        start = i + 1;
+    }
+    return parameters;
+}
+
+// Data members of the class statement [begin, end): "int a = 1, *b;"
+void SourceWalker::collectMembers(size_t begin, size_t end) {
+    if (begin >= end) return;
+    std::string_view first = tokens_[begin].text;
+    if (first == "enum" || first == "class" || first == "struct" || first == "union" || first == "template") return;
+
+    CppClass& cls = classes[static_cast<size_t>(scopes_.back().classIndex)];
+    size_t start = begin;
+    int depth = 0;
+    for (size_t i = begin; i <= end; ++i) {
+        if (i < end) {
+            std::string_view text = tokens_[i].text;
+            if (text == "(" || text == "[" || text == "{" || (text == "<" && i > begin && isIdentifier(i - 1))) {
+                ++depth;
+            } else if (text == ")" || text == "]" || text == "}" || (text == ">" && depth > 0)) {
+                --depth;
+            }
+            if (!(text == "," && depth == 0)) continue;
+        }
+        size_t declEnd = start;
+        while (declEnd < i) {
+            std::string_view text = tokens_[declEnd].text;
+            if (text == "=" || text == "{" || text == "[" || text == ":" || text == "(") break;
+            ++declEnd;
         }
+        bool hasType = start > begin || declEnd - start >= 2;
+        if (declEnd > start && hasType && isIdentifier(declEnd - 1) && !kTypeKeywords.count(tokens_[declEnd - 1].text) &&
+            !(declEnd < i && tokens_[declEnd].text == "(")) {
+            cls.memberVariables.push_back(std::string(tokens_[declEnd - 1].text));
+        }
+        start = i + 1;
     }
-    
-    return result;
 }
 
-std::vector<std::string> CppParser::splitLines(const std::string& content) {
-    std::vector<std::string> lines;
-    std::stringstream ss(content);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        lines.push_back(line);
+std::string functionKey(const CppFunction& function) {
+    return function.className + "::" + function.name;
+}
+
+} // namespace
+
+CppParser::CppParser() : model_(SourceLanguage::Cpp) {
+}
+
+CppParser::~CppParser() {
+    clear();
+}
+
+bool CppParser::parseFile(const std::string& content) {
+    return parseFile(SourceBuffer(content));
+}
+
+bool CppParser::parseFile(const SourceBuffer& source) {
+    clear();
+
+    if (source.empty()) {
+        return false;
+    }
+
+    try {
+        std::vector<Token> tokens = tokenize(source);
+        SourceWalker walker(tokens);
+        walker.run();
+
+        // A declaration is listed only when the file has no definition for it;
+        // an out-of-class definition takes its flags from the declaration
+        std::vector<std::string> keys;
+        keys.reserve(walker.entries.size());
+        std::unordered_map<std::string_view, const CppFunction*> declarations;
+        std::unordered_set<std::string_view> definitions;
+        for (const CppFunction& entry : walker.entries) {
+            keys.push_back(functionKey(entry));
+            if (entry.isDefined) {
+                definitions.insert(keys.back());
+            } else {
+                declarations.emplace(keys.back(), &entry);
+            }
+        }
+
+        // Entries are moved out below; a declaration that is read is one
+        // with a definition, which is never kept
+        std::vector<size_t> functionIndex(walker.entries.size(), 0);
+        functions_.reserve(walker.entries.size());
+        for (size_t i = 0; i < walker.entries.size(); ++i) {
+            CppFunction& entry = walker.entries[i];
+            const std::string& key = keys[i];
+            if (!entry.isDefined && definitions.count(key)) {
+                continue;
+            }
+            if (entry.isDefined && entry.accessLevel.empty()) {
+                auto it = declarations.find(key);
+                if (it != declarations.end()) {
+                    entry.accessLevel = it->second->accessLevel;
+                    entry.isStatic = entry.isStatic || it->second->isStatic;
+                    entry.isVirtual = entry.isVirtual || it->second->isVirtual;
+                }
+            }
+            functionIndex[i] = functions_.size();
+            functions_.push_back(std::move(entry));
+        }
+
+        classes_ = std::move(walker.classes);
+
+        callSites_.reserve(walker.calls.size());
+        for (RawCallSite& call : walker.calls) {
+            CppFunction& caller = functions_[functionIndex[call.entryIndex]];
+            caller.calledFunctions.push_back(call.callee);
+            functionCalls_[caller.name].push_back(call.callee);
+            callSites_.push_back({std::move(call.callee), std::move(call.qualifier), functionIndex[call.entryIndex],
+                                  call.lineNumber, std::move(call.object), call.argumentCount});
+        }
+
+        buildCodeModel();
+
+        return true;
+    } catch (const std::exception&) {
+        return false;
     }
-    
-    return lines;
 }
 
 std::string CppParser::getFunctionSignature(const CppFunction& func) const {
     std::string signature = func.returnType + " " + func.name + "(";
-    
+
     for (size_t i = 0; i < func.parameters.size(); ++i) {
         if (i > 0) signature += ", ";
         signature += func.parameters[i].type + " " + func.parameters[i].name;
@@ -281,13 +944,13 @@ std::string CppParser::getFunctionSignature(const CppFunction& func) const {
             signature += " = " + func.parameters[i].defaultValue;
         }
     }
-    
+
     signature += ")";
-    
+
     if (func.isConst) {
         signature += " const";
     }
-    
+
     return signature;
 }
 
@@ -300,20 +963,38 @@ std::vector<std::string> CppParser::getCalledFunctions(const std::string& functi
 }
 
 std::vector<std::string> CppParser::getCallingFunctions(const std::string& functionName) const {
-    std::vector<std::string> callers;
-    
-    for (const auto& pair : functionCalls_) {
-        const auto& calledFunctions = pair.second;
-        if (std::find(calledFunctions.begin(), calledFunctions.end(), functionName) != calledFunctions.end()) {
-            callers.push_back(pair.first);
-        }
-    }
-    
-    return callers;
+    // Over the call graph, so a name also finds callers of its methods
+    return model_.getCallerNames(functionName);
 }
 
 void CppParser::clear() {
     functions_.clear();
     classes_.clear();
+    callSites_.clear();
     functionCalls_.clear();
-} 
\ No newline at end of file
+    model_.clear();
+}
+
+void CppParser::buildCodeModel() {
+    for (const CppClass& cls : classes_) {
+        model_.addType({cls.name, "class", cls.baseClasses, cls.lineNumber});
+    }
+    for (const CppFunction& func : functions_) {
+        CodeFunction function;
+        function.name = func.name;
+        function.container = func.className;
+        function.qualifiedName = func.className.empty() ? func.name : func.className + "::" + func.name;
+        function.returnType = func.returnType;
+        for (const CppParameter& param : func.parameters) {
+            function.parameters.push_back({param.name, param.type, param.defaultValue});
+        }
+        function.signature = getFunctionSignature(func);
+        function.lineNumber = func.lineNumber;
+        model_.addFunction(std::move(function));
+    }
+    for (const CppCallSite& call : callSites_) {
+        // The model has one qualifier: the scope, or else the object with its "." or "->"
+        model_.addCall({call.callerIndex, call.callee, call.qualifier.empty() ? call.object : call.qualifier,
+                        call.lineNumber, call.argumentCount});
+    }
+}
@@ -1,481 +1,678 @@
 #include "go_parser.h"
 #include <algorithm>
-#include <sstream>
-#include <QRegExp>
-#include <QString>
-
-GoParser::GoParser() {
-    // Package declaration pattern
-    packagePattern_ = QRegExp("^\\s*package\\s+(\\w+)");
-    
-    // Function definition pattern: func functionName(parameters) returnType
-    functionPattern_ = QRegExp("^\\s*func\\s+(\\w+)\\s*\\(([^)]*)\\)\\s*([^{]*)?\\s*\\{?");
-    
-    // Method definition pattern: func (receiver Type) methodName(parameters) returnType
-    methodPattern_ = QRegExp("^\\s*func\\s*\\(\\s*(\\w+)\\s+(\\*?\\w+)\\s*\\)\\s*(\\w+)\\s*\\(([^)]*)\\)\\s*([^{]*)?\\s*\\{?");
-    
-    // Struct definition pattern: type StructName struct {
-    structPattern_ = QRegExp("^\\s*type\\s+(\\w+)\\s+struct\\s*\\{");
-    
-    // Interface definition pattern: type InterfaceName interface {
-    interfacePattern_ = QRegExp("^\\s*type\\s+(\\w+)\\s+interface\\s*\\{");
-    
-    // Function call pattern: functionName(
-    functionCallPattern_ = QRegExp("(\\w+)\\s*\\(");
-    
-    // Parameter pattern: name type or name ...type
-    parameterPattern_ = QRegExp("(\\w+)\\s+(\\.\\.\\.)?(\\*?[\\w\\[\\]]+)");
+#include <cctype>
+#include <exception>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+enum class TokenKind { Ident, Number, String, Op };
+
+struct Token {
+    TokenKind kind;
+    std::string_view text;
+    int line;
+};
+
+// A run of comments on consecutive lines of their own
+struct CommentGroup {
+    int lastLine;
+    std::string text;
+};
+
+bool isIdentStart(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalpha(u) || c == '_' || u >= 0x80;
 }
 
-GoParser::~GoParser() {
-    clear();
+bool isIdentChar(char c) {
+    return isIdentStart(c) || std::isdigit(static_cast<unsigned char>(c));
 }
 
-bool GoParser::parseFile(const std::string& content) {
-    clear();
-    
-    if (content.empty()) {
-        return false;
-    }
-    
-    try {
-        // Remove comments but keep structure
-        std::string cleanContent = removeComments(content);
-        
-        // Parse package declaration
-        parsePackage(cleanContent);
-        
-        // Parse structs
-        parseStructs(cleanContent);
-        
-        // Parse interfaces
-        parseInterfaces(cleanContent);
-        
-        // Parse functions
-        parseFunctions(cleanContent);
-        
-        // Parse function calls
-        parseFunctionCalls(cleanContent);
-        
-        return true;
-    } catch (const std::exception& e) {
-        return false;
-    }
+const char* const kMultiCharOperators[] = {
+    "<<=", ">>=", "&^=", "...", "&&", "||", "<-", "++", "--", "==", "!=", "<=", ">=",
+    ":=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<", ">>", "&^"
+};
+
+// Keywords after which a line break ends the statement
+const std::unordered_set<std::string_view> kSemicolonKeywords = {
+    "break", "continue", "fallthrough", "return"
+};
+
+const std::string_view kInsertedSemicolon = ";";
+
+std::string trimmed(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return std::string(text.substr(first, last - first + 1));
 }
 
-void GoParser::parsePackage(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (const std::string& line : lines) {
-        QString qline = QString::fromStdString(line);
-        
-        if (packagePattern_.indexIn(qline) != -1) {
-            packageName_ = packagePattern_.cap(1).toStdString();
-            break;
-        }
+// Tokenizes Go source in one pass over its mask, inserting the semicolons the
+// language inserts at line ends. A general comment spanning lines keeps its
+// line breaks in the mask, so it acts like a newline as the spec requires.
+class Lexer {
+public:
+    explicit Lexer(const SourceBuffer& source)
+        : source_(source), mask_(source, SourceLanguage::Go), code_(mask_.code()), lines_(source) {}
+
+    void run(std::vector<Token>& tokens);
+    // Comment groups for doc comments, built from the comment ranges
+    void collectComments(std::vector<CommentGroup>& comments) const;
+
+private:
+    void push(std::vector<Token>& tokens, TokenKind kind, size_t start) {
+        tokens.push_back({kind, source_.view().substr(start, pos_ - start), lines_.lineAt(start)});
     }
-}
 
-void GoParser::parseFunctions(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Skip blank lines and comments
-        if (isBlankOrComment(line)) {
+    const SourceBuffer& source_;
+    SourceMask mask_;
+    const std::string& code_;
+    LineCursor lines_;
+    size_t pos_ = 0;
+    bool needSemicolon_ = false;
+};
+
+void Lexer::run(std::vector<Token>& tokens) {
+    size_t size = code_.size();
+    tokens.reserve(size / 4);
+
+    while (pos_ < size) {
+        char c = code_[pos_];
+        if (c == '\n') {
+            if (needSemicolon_) {
+                tokens.push_back({TokenKind::Op, kInsertedSemicolon, lines_.lineAt(pos_)});
+                needSemicolon_ = false;
+            }
+            ++pos_;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r') {
+            ++pos_;
             continue;
         }
-        
-        // Check for method definition first (has receiver)
-        if (methodPattern_.indexIn(qline) != -1) {
-            GoFunction func = parseFunctionDefinition(lines, i);
-            if (!func.name.empty()) {
-                func.isMethod = true;
-                func.receiverName = methodPattern_.cap(1).toStdString();
-                func.receiverType = methodPattern_.cap(2).toStdString();
-                functions_.push_back(func);
+
+        size_t start = pos_;
+        if (isIdentStart(c)) {
+            while (pos_ < size && isIdentChar(code_[pos_])) ++pos_;
+            push(tokens, TokenKind::Ident, start);
+            std::string_view word = tokens.back().text;
+            bool keyword = word == "func" || word == "if" || word == "for" || word == "switch" ||
+                           word == "select" || word == "go" || word == "defer" || word == "var" ||
+                           word == "const" || word == "type" || word == "package" || word == "import" ||
+                           word == "case" || word == "default" || word == "else" || word == "range" ||
+                           word == "chan" || word == "map" || word == "struct" || word == "interface" ||
+                           word == "goto";
+            needSemicolon_ = !keyword || kSemicolonKeywords.count(word);
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && pos_ + 1 < size && std::isdigit(static_cast<unsigned char>(code_[pos_ + 1])))) {
+            bool hex = c == '0' && pos_ + 1 < size && (code_[pos_ + 1] == 'x' || code_[pos_ + 1] == 'X');
+            while (pos_ < size) {
+                char d = code_[pos_];
+                char before = pos_ > start ? code_[pos_ - 1] : '\0';
+                bool exponentSign = (d == '+' || d == '-') &&
+                                    (hex ? (before == 'p' || before == 'P') : (before == 'e' || before == 'E'));
+                if (!(isIdentChar(d) || d == '.' || exponentSign)) break;
+                ++pos_;
             }
+            push(tokens, TokenKind::Number, start);
+            needSemicolon_ = true;
+            continue;
+        }
+        if (c == '"' || c == '\'' || c == '`') {
+            // The mask has blanked the inside, line breaks of raw strings included
+            ++pos_;
+            while (pos_ < size && code_[pos_] != c && code_[pos_] != '\n') ++pos_;
+            if (pos_ < size && code_[pos_] == c) ++pos_;
+            push(tokens, TokenKind::String, start);
+            needSemicolon_ = true;
+            continue;
         }
-        // Check for regular function definition
-        else if (functionPattern_.indexIn(qline) != -1) {
-            GoFunction func = parseFunctionDefinition(lines, i);
-            if (!func.name.empty()) {
-                func.isMethod = false;
-                functions_.push_back(func);
+
+        size_t length = 1;
+        for (const char* op : kMultiCharOperators) {
+            size_t n = std::char_traits<char>::length(op);
+            if (size - pos_ >= n && code_.compare(pos_, n, op) == 0) {
+                length = n;
+                break;
             }
         }
+        pos_ += length;
+        push(tokens, TokenKind::Op, start);
+        std::string_view op = tokens.back().text;
+        needSemicolon_ = op == ")" || op == "]" || op == "}" || op == "++" || op == "--";
+    }
+    if (needSemicolon_) {
+        tokens.push_back({TokenKind::Op, kInsertedSemicolon, lines_.lineAt(size)});
     }
 }
 
-void GoParser::parseStructs(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        if (structPattern_.indexIn(qline) != -1) {
-            GoStruct strct;
-            strct.name = structPattern_.cap(1).toStdString();
-            strct.lineNumber = i + 1;
-            strct.isExported = isExported(strct.name);
-            strct.comment = extractComment(lines, i);
-            
-            // Parse struct fields (simplified - just collect field names)
-            for (size_t j = i + 1; j < lines.size(); ++j) {
-                const std::string& fieldLine = lines[j];
-                QString qFieldLine = QString::fromStdString(fieldLine).trimmed();
-                
-                if (qFieldLine == "}") {
-                    break; // End of struct
-                }
-                
-                if (!qFieldLine.isEmpty() && !qFieldLine.startsWith("//")) {
-                    // Simple field parsing - extract field name
-                    QStringList parts = qFieldLine.split(QRegExp("\\s+"));
-                    if (!parts.isEmpty()) {
-                        strct.fields.push_back(parts[0].toStdString());
-                    }
-                }
-            }
-            
-            structs_.push_back(strct);
+void Lexer::collectComments(std::vector<CommentGroup>& comments) const {
+    std::string_view text = source_.view();
+    for (const SourceMask::Range& range : mask_.comments()) {
+        int firstLine = source_.lineAt(range.first);
+        // Only comments with nothing but blanks before them on their line
+        size_t lineBegin = source_.lineStart(firstLine);
+        if (code_.find_first_not_of(" \t", lineBegin) < range.first) continue;
+
+        std::string_view body = text.substr(range.first + 2, range.second - range.first - 2);
+        if (text[range.first + 1] == '*' && body.size() >= 2 && body.substr(body.size() - 2) == "*/") {
+            body.remove_suffix(2);
         }
+        int lastLine = source_.lineAt(range.second > range.first ? range.second - 1 : range.first);
+        if (!comments.empty() && comments.back().lastLine == firstLine - 1) {
+            comments.back().text += " " + trimmed(body);
+        } else {
+            comments.push_back({lastLine, trimmed(body)});
+        }
+        comments.back().lastLine = lastLine;
     }
 }
 
-void GoParser::parseInterfaces(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        if (interfacePattern_.indexIn(qline) != -1) {
-            GoInterface iface;
-            iface.name = interfacePattern_.cap(1).toStdString();
-            iface.lineNumber = i + 1;
-            iface.isExported = isExported(iface.name);
-            iface.comment = extractComment(lines, i);
-            
-            // Parse interface methods (simplified)
-            for (size_t j = i + 1; j < lines.size(); ++j) {
-                const std::string& methodLine = lines[j];
-                QString qMethodLine = QString::fromStdString(methodLine).trimmed();
-                
-                if (qMethodLine == "}") {
-                    break; // End of interface
-                }
-                
-                if (!qMethodLine.isEmpty() && !qMethodLine.startsWith("//")) {
-                    // Simple method parsing - extract method signature
-                    iface.methods.push_back(qMethodLine.toStdString());
-                }
-            }
-            
-            interfaces_.push_back(iface);
+// Keywords, builtins and predeclared types that are never reported as calls
+const std::unordered_set<std::string_view> kNonCallNames = {
+    "if", "for", "switch", "select", "go", "defer", "return", "func", "range", "case",
+    "chan", "map", "struct", "interface", "type", "var", "const", "else", "default",
+    "make", "new", "len", "cap", "append", "copy", "delete", "panic", "recover",
+    "print", "println", "close", "clear", "min", "max", "complex", "real", "imag",
+    "bool", "string", "int", "int8", "int16", "int32", "int64", "uint", "uint8",
+    "uint16", "uint32", "uint64", "uintptr", "byte", "rune", "float32", "float64",
+    "complex64", "complex128", "error", "any"
+};
+
+// Words that start a type, so "chan int" is not a parameter named chan
+const std::unordered_set<std::string_view> kTypeKeywords = {
+    "chan", "map", "func", "struct", "interface"
+};
+
+bool isExportedName(const std::string& name) {
+    return !name.empty() && std::isupper(static_cast<unsigned char>(name[0]));
+}
+
+// Source text of tokens [begin, end) with each gap between tokens reduced to one space
+std::string spanText(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    std::string text;
+    for (size_t i = begin; i < end; ++i) {
+        if (tokens[i].text.data() == kInsertedSemicolon.data()) continue;
+        if (!text.empty() && tokens[i].text.data() != tokens[i - 1].text.data() + tokens[i - 1].text.size()) {
+            text += ' ';
         }
+        text += tokens[i].text;
     }
+    return text;
 }
 
-void GoParser::parseFunctionCalls(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    std::string currentFunction;
-    int braceLevel = 0;
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Check if this is a function definition
-        if (functionPattern_.indexIn(qline) != -1) {
-            currentFunction = functionPattern_.cap(1).toStdString();
-            braceLevel = 0;
-        } else if (methodPattern_.indexIn(qline) != -1) {
-            currentFunction = methodPattern_.cap(3).toStdString();
-            braceLevel = 0;
-        }
-        
-        // Count braces to track function scope
-        braceLevel += std::count(line.begin(), line.end(), '{');
-        braceLevel -= std::count(line.begin(), line.end(), '}');
-        
-        // If we're inside a function, look for function calls
-        if (!currentFunction.empty() && braceLevel > 0) {
-            int pos = 0;
-            while ((pos = functionCallPattern_.indexIn(qline, pos)) != -1) {
-                QString calledFunc = functionCallPattern_.cap(1);
-                std::string calledFuncStr = calledFunc.toStdString();
-                
-                // Avoid Go keywords and built-ins
-                if (calledFuncStr != "if" && calledFuncStr != "for" && 
-                    calledFuncStr != "switch" && calledFuncStr != "select" &&
-                    calledFuncStr != "go" && calledFuncStr != "defer" &&
-                    calledFuncStr != "make" && calledFuncStr != "new" &&
-                    calledFuncStr != "len" && calledFuncStr != "cap" &&
-                    calledFuncStr != "append" && calledFuncStr != "copy" &&
-                    calledFuncStr != "delete" && calledFuncStr != "panic" &&
-                    calledFuncStr != "recover" && calledFuncStr != "print" &&
-                    calledFuncStr != "println") {
-                    functionCalls_[currentFunction].push_back(calledFuncStr);
-                }
-                
-                pos += functionCallPattern_.matchedLength();
-            }
+struct RawCallSite {
+    size_t functionIndex;
+    std::string callee;
+    std::string qualifier;
+    int lineNumber;
+};
+
+class FileWalker {
+public:
+    FileWalker(const std::vector<Token>& tokens, const std::vector<CommentGroup>& comments)
+        : tokens_(tokens), comments_(comments) {}
+
+    void run();
+
+    std::string packageName;
+    std::vector<GoImport> imports;
+    std::vector<GoFunction> functions;
+    std::vector<GoStruct> structs;
+    std::vector<GoInterface> interfaces;
+    std::vector<RawCallSite> calls;
+
+private:
+    bool is(size_t i, std::string_view text) const {
+        return i < tokens_.size() && tokens_[i].text == text;
+    }
+    bool isIdent(size_t i) const {
+        return i < tokens_.size() && tokens_[i].kind == TokenKind::Ident;
+    }
+
+    size_t matchBracket(size_t open) const;
+    size_t skipStatement(size_t i) const;
+    std::string docComment(int line);
+
+    size_t parseImports(size_t i);
+    size_t parseImportSpec(size_t i);
+    size_t parseFunc(size_t i);
+    size_t parseTypes(size_t i);
+    size_t parseTypeSpec(size_t i, int line);
+    size_t walkBody(size_t open, size_t functionIndex);
+    std::vector<GoParameter> parseParameters(size_t begin, size_t end) const;
+
+    const std::vector<Token>& tokens_;
+    const std::vector<CommentGroup>& comments_;
+    size_t nextComment_ = 0;
+};
+
+// Index of the bracket closing the one at 'open', or the end of the tokens
+size_t FileWalker::matchBracket(size_t open) const {
+    int depth = 0;
+    for (size_t i = open; i < tokens_.size(); ++i) {
+        if (tokens_[i].kind != TokenKind::Op) continue;
+        std::string_view text = tokens_[i].text;
+        if (text == "(" || text == "[" || text == "{") {
+            ++depth;
+        } else if ((text == ")" || text == "]" || text == "}") && --depth == 0) {
+            return i;
         }
-        
-        // Reset when we exit function scope
-        if (braceLevel <= 0 && !currentFunction.empty()) {
-            currentFunction.clear();
+    }
+    return tokens_.size();
+}
+
+// Past the ';' ending the declaration or statement at i
+size_t FileWalker::skipStatement(size_t i) const {
+    while (i < tokens_.size() && !is(i, ";")) {
+        if (is(i, "(") || is(i, "[") || is(i, "{")) {
+            i = matchBracket(i);
         }
+        ++i;
     }
+    return std::min(i + 1, tokens_.size());
 }
 
-GoFunction GoParser::parseFunctionDefinition(const std::vector<std::string>& lines, int startLine) {
-    GoFunction func;
-    const std::string& line = lines[startLine];
-    QString qline = QString::fromStdString(line);
-    
-    // Check if it's a method (with receiver)
-    if (methodPattern_.indexIn(qline) != -1) {
-        func.name = methodPattern_.cap(3).toStdString();
-        func.receiverName = methodPattern_.cap(1).toStdString();
-        func.receiverType = methodPattern_.cap(2).toStdString();
-        func.isMethod = true;
-        
-        // Parse parameters
-        QString paramStr = methodPattern_.cap(4);
-        func.parameters = parseParameters(paramStr.toStdString());
-        
-        // Parse return types
-        QString returnStr = methodPattern_.cap(5);
-        func.returnTypes = parseReturnTypes(returnStr.toStdString());
-    }
-    // Regular function
-    else if (functionPattern_.indexIn(qline) != -1) {
-        func.name = functionPattern_.cap(1).toStdString();
-        func.isMethod = false;
-        
-        // Parse parameters
-        QString paramStr = functionPattern_.cap(2);
-        func.parameters = parseParameters(paramStr.toStdString());
-        
-        // Parse return types
-        QString returnStr = functionPattern_.cap(3);
-        func.returnTypes = parseReturnTypes(returnStr.toStdString());
-    }
-    
-    func.lineNumber = startLine + 1;
-    func.isExported = isExported(func.name);
-    func.packageName = packageName_;
-    func.comment = extractComment(lines, startLine);
-    
-    return func;
+// The comment group ending right above 'line'. Declarations are visited in
+// source order, so the groups are consumed with a single cursor.
+std::string FileWalker::docComment(int line) {
+    while (nextComment_ < comments_.size() && comments_[nextComment_].lastLine < line - 1) {
+        ++nextComment_;
+    }
+    if (nextComment_ < comments_.size() && comments_[nextComment_].lastLine == line - 1) {
+        return comments_[nextComment_].text;
+    }
+    return "";
 }
 
-std::vector<GoParameter> GoParser::parseParameters(const std::string& paramStr) {
-    std::vector<GoParameter> parameters;
-    
-    if (paramStr.empty()) {
-        return parameters;
-    }
-    
-    QString qParamStr = QString::fromStdString(paramStr);
-    QStringList paramList = qParamStr.split(",");
-    
-    for (const QString& param : paramList) {
-        QString trimmed = param.trimmed();
-        if (trimmed.isEmpty()) continue;
-        
-        GoParameter p;
-        p.isVariadic = false;
-        
-        if (parameterPattern_.indexIn(trimmed) != -1) {
-            p.name = parameterPattern_.cap(1).toStdString();
-            p.isVariadic = !parameterPattern_.cap(2).isEmpty();
-            p.type = parameterPattern_.cap(3).toStdString();
+void FileWalker::run() {
+    size_t i = 0;
+    while (i < tokens_.size()) {
+        std::string_view text = tokens_[i].text;
+        if (text == "package" && isIdent(i + 1)) {
+            packageName = std::string(tokens_[i + 1].text);
+            i = skipStatement(i);
+        } else if (text == "import") {
+            i = parseImports(i + 1);
+        } else if (text == "func") {
+            i = parseFunc(i);
+        } else if (text == "type") {
+            i = parseTypes(i);
         } else {
-            // Simple parsing - try to extract name and type
-            QStringList parts = trimmed.split(QRegExp("\\s+"));
-            if (parts.size() >= 2) {
-                p.name = parts[0].toStdString();
-                p.type = parts[1].toStdString();
-                if (p.type.substr(0, 3) == "...") {
-                    p.isVariadic = true;
-                    p.type = p.type.substr(3); // Remove "..."
-                }
-            } else if (parts.size() == 1) {
-                // Just a type, no name
-                p.type = parts[0].toStdString();
-            }
+            // var, const and anything unrecognised
+            i = skipStatement(i);
         }
-        
-        if (!p.type.empty()) {
-            parameters.push_back(p);
+    }
+}
+
+size_t FileWalker::parseImports(size_t i) {
+    if (!is(i, "(")) return parseImportSpec(i);
+    size_t close = matchBracket(i);
+    ++i;
+    while (i < close) {
+        if (is(i, ";")) {
+            ++i;
+            continue;
         }
+        i = std::min(parseImportSpec(i), close);
     }
-    
-    return parameters;
+    return skipStatement(close);
 }
 
-std::vector<std::string> GoParser::parseReturnTypes(const std::string& returnStr) {
-    std::vector<std::string> returnTypes;
-    
-    QString qReturnStr = QString::fromStdString(returnStr).trimmed();
-    if (qReturnStr.isEmpty()) {
-        return returnTypes;
+size_t FileWalker::parseImportSpec(size_t i) {
+    if (i >= tokens_.size()) return i;
+    GoImport spec;
+    if (tokens_[i].kind != TokenKind::String) {
+        spec.alias = std::string(tokens_[i].text);
+        ++i;
     }
-    
-    // Remove parentheses if present (multiple return values)
-    if (qReturnStr.startsWith("(") && qReturnStr.endsWith(")")) {
-        qReturnStr = qReturnStr.mid(1, qReturnStr.length() - 2);
+    if (i < tokens_.size() && tokens_[i].kind == TokenKind::String) {
+        std::string_view path = tokens_[i].text;
+        spec.path = std::string(path.size() >= 2 ? path.substr(1, path.size() - 2) : path);
+        spec.lineNumber = tokens_[i].line;
+        imports.push_back(std::move(spec));
     }
-    
-    QStringList types = qReturnStr.split(",");
-    for (const QString& type : types) {
-        QString trimmed = type.trimmed();
-        if (!trimmed.isEmpty()) {
-            returnTypes.push_back(trimmed.toStdString());
+    return skipStatement(i);
+}
+
+size_t FileWalker::parseFunc(size_t i) {
+    GoFunction func;
+    func.lineNumber = tokens_[i].line;
+    func.comment = docComment(tokens_[i].line);
+    func.isMethod = false;
+    size_t k = i + 1;
+
+    if (is(k, "(")) {
+        // Receiver: (s *Server), (Server) or (l *List[T])
+        size_t close = matchBracket(k);
+        size_t typeStart = k + 1;
+        if (close > k + 2 && isIdent(k + 1) && !is(k + 2, ".") && !is(k + 2, "[")) {
+            func.receiverName = std::string(tokens_[k + 1].text);
+            typeStart = k + 2;
         }
+        size_t typeEnd = typeStart;
+        while (typeEnd < close && !is(typeEnd, "[")) ++typeEnd;
+        func.receiverType = spanText(tokens_, typeStart, typeEnd);
+        func.isMethod = true;
+        k = close + 1;
     }
-    
-    return returnTypes;
-}
 
-std::string GoParser::removeComments(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    std::string result;
-    
-    bool inBlockComment = false;
-    
-    for (const std::string& line : lines) {
-        std::string processedLine = line;
-        
-        if (!inBlockComment) {
-            // Handle single-line comments
-            size_t commentPos = processedLine.find("//");
-            if (commentPos != std::string::npos) {
-                processedLine = processedLine.substr(0, commentPos);
+    if (!isIdent(k)) return skipStatement(k);
+    func.name = std::string(tokens_[k].text);
+    func.isExported = isExportedName(func.name);
+    ++k;
+
+    if (is(k, "[")) {
+        size_t close = matchBracket(k);
+        func.typeParameters = spanText(tokens_, k, close + 1);
+        k = close + 1;
+    }
+    if (!is(k, "(")) return skipStatement(k);
+    size_t close = matchBracket(k);
+    func.parameters = parseParameters(k + 1, close);
+    k = close + 1;
+
+    // Results: a parenthesised list or a single type
+    if (is(k, "(")) {
+        close = matchBracket(k);
+        for (const GoParameter& result : parseParameters(k + 1, close)) {
+            func.returnTypes.push_back(result.type);
+        }
+        k = close + 1;
+    } else {
+        size_t start = k;
+        while (k < tokens_.size() && !is(k, "{") && !is(k, ";")) {
+            if (is(k, "(") || is(k, "[")) {
+                k = matchBracket(k);
+            } else if ((is(k, "struct") || is(k, "interface")) && is(k + 1, "{")) {
+                k = matchBracket(k + 1);
             }
-            
-            // Handle start of block comments
-            size_t blockStart = processedLine.find("/*");
-            if (blockStart != std::string::npos) {
-                size_t blockEnd = processedLine.find("*/", blockStart + 2);
-                if (blockEnd != std::string::npos) {
-                    // Block comment starts and ends on same line
-                    processedLine = processedLine.substr(0, blockStart) + 
-                                  processedLine.substr(blockEnd + 2);
-                } else {
-                    // Block comment starts but doesn't end
-                    processedLine = processedLine.substr(0, blockStart);
-                    inBlockComment = true;
-                }
+            ++k;
+        }
+        if (k > start) func.returnTypes.push_back(spanText(tokens_, start, k));
+    }
+
+    functions.push_back(std::move(func));
+    if (is(k, "{")) {
+        k = walkBody(k, functions.size() - 1);
+    }
+    return skipStatement(k);
+}
+
+// Records the calls in the body opened at 'open'; returns the closing brace
+size_t FileWalker::walkBody(size_t open, size_t functionIndex) {
+    int depth = 0;
+    size_t i = open;
+    for (; i < tokens_.size(); ++i) {
+        const Token& token = tokens_[i];
+        if (token.kind == TokenKind::Op) {
+            if (token.text == "{") ++depth;
+            if (token.text == "}" && --depth == 0) break;
+            continue;
+        }
+        if (token.kind != TokenKind::Ident || kNonCallNames.count(token.text)) continue;
+
+        size_t next = i + 1;
+        if (is(next, "[") && !is(i - 1, "func")) {
+            next = matchBracket(next) + 1;  // Map[int, string](xs, f)
+        }
+        if (!is(next, "(")) continue;
+
+        size_t start = i;
+        while (start >= 2 && is(start - 1, ".") && isIdent(start - 2)) start -= 2;
+        std::string qualifier = start < i ? spanText(tokens_, start, i - 1) : std::string();
+        calls.push_back({functionIndex, std::string(token.text), qualifier, token.line});
+    }
+    return std::min(i + 1, tokens_.size());
+}
+
+// Parameter or result list between the parentheses [begin, end). Names share
+// the type that follows them: "a, b int, opts ...Option".
+std::vector<GoParameter> FileWalker::parseParameters(size_t begin, size_t end) const {
+    struct Segment {
+        size_t begin;
+        size_t end;
+        bool named;
+    };
+    std::vector<Segment> segments;
+    size_t start = begin;
+    for (size_t i = begin; i <= end; ++i) {
+        if (i < end) {
+            if (is(i, "(") || is(i, "[") || is(i, "{")) {
+                i = matchBracket(i);
+                continue;
             }
-        } else {
-            // We're in a block comment, look for end
-            size_t blockEnd = processedLine.find("*/");
-            if (blockEnd != std::string::npos) {
-                processedLine = processedLine.substr(blockEnd + 2);
-                inBlockComment = false;
-            } else {
-                processedLine = "";
+            if (!is(i, ",")) continue;
+        }
+        size_t segmentEnd = i;
+        while (segmentEnd > start && is(segmentEnd - 1, ";")) --segmentEnd;  // before a line-broken ')'
+        if (segmentEnd > start) {
+            bool named = segmentEnd - start >= 2 && isIdent(start) && !kTypeKeywords.count(tokens_[start].text) &&
+                         !is(start + 1, ".") && !(is(start + 1, "[") && matchBracket(start + 1) == segmentEnd - 1);
+            segments.push_back({start, segmentEnd, named});
+        }
+        start = i + 1;
+    }
+
+    bool anyNamed = std::any_of(segments.begin(), segments.end(), [](const Segment& s) { return s.named; });
+    std::vector<GoParameter> parameters;
+    size_t pendingNames = 0;
+    for (const Segment& segment : segments) {
+        GoParameter parameter;
+        parameter.isVariadic = false;
+        size_t typeStart = segment.begin;
+        if (anyNamed) {
+            parameter.name = std::string(tokens_[segment.begin].text);
+            if (!segment.named) {
+                // Takes the type of the next named segment
+                parameters.push_back(std::move(parameter));
+                ++pendingNames;
+                continue;
             }
+            typeStart = segment.begin + 1;
         }
-        
-        result += processedLine + "\n";
+        if (is(typeStart, "...")) {
+            parameter.isVariadic = true;
+            ++typeStart;
+        }
+        parameter.type = spanText(tokens_, typeStart, segment.end);
+        for (size_t p = parameters.size() - pendingNames; p < parameters.size(); ++p) {
+            parameters[p].type = parameter.type;
+        }
+        pendingNames = 0;
+        parameters.push_back(std::move(parameter));
     }
-    
-    return result;
+    return parameters;
 }
 
-std::string GoParser::normalizeWhitespace(const std::string& text) {
-    std::string result;
-    bool inWhitespace = false;
-    
-    for (char c : text) {
-        if (std::isspace(c)) {
-            if (!inWhitespace) {
-                result += ' ';
-                inWhitespace = true;
-            }
-        } else {
-            result += c;
-            inWhitespace = false;
+size_t FileWalker::parseTypes(size_t i) {
+    int line = tokens_[i].line;
+    if (!is(i + 1, "(")) return parseTypeSpec(i + 1, line);
+
+    size_t close = matchBracket(i + 1);
+    size_t k = i + 2;
+    while (k < close) {
+        if (is(k, ";")) {
+            ++k;
+            continue;
         }
+        k = std::min(parseTypeSpec(k, tokens_[k].line), close);
     }
-    
-    return result;
+    return skipStatement(close);
 }
 
-std::vector<std::string> GoParser::splitLines(const std::string& content) {
-    std::vector<std::string> lines;
-    std::stringstream ss(content);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        lines.push_back(line);
+size_t FileWalker::parseTypeSpec(size_t i, int line) {
+    if (!isIdent(i)) return skipStatement(i);
+    std::string name(tokens_[i].text);
+    size_t k = i + 1;
+    // Type parameters, as opposed to an array length: [T any], [K, V comparable]
+    if (is(k, "[") && isIdent(k + 1) && !is(k + 2, "]")) {
+        k = matchBracket(k) + 1;
+    }
+
+    bool isStruct = is(k, "struct") && is(k + 1, "{");
+    bool isInterface = is(k, "interface") && is(k + 1, "{");
+    if (!isStruct && !isInterface) return skipStatement(k);
+
+    size_t open = k + 1;
+    size_t close = matchBracket(open);
+    std::string comment = docComment(line);
+
+    // Field or method declarations, separated by semicolons
+    std::vector<std::pair<size_t, size_t>> elements;
+    size_t start = open + 1;
+    for (size_t e = open + 1; e <= close; ++e) {
+        if (e < close && (is(e, "(") || is(e, "[") || is(e, "{"))) {
+            e = matchBracket(e);
+            continue;
+        }
+        if (e == close || is(e, ";")) {
+            if (e > start) elements.emplace_back(start, e);
+            start = e + 1;
+        }
+    }
+
+    if (isStruct) {
+        GoStruct strct;
+        strct.name = name;
+        strct.lineNumber = tokens_[i].line;
+        strct.isExported = isExportedName(name);
+        strct.comment = comment;
+        for (const auto& element : elements) {
+            size_t b = element.first;
+            size_t e = element.second;
+            if (e > b + 1 && tokens_[e - 1].kind == TokenKind::String) --e;  // field tag
+            bool embedded = is(b, "*") || e == b + 1 ||
+                            (is(b + 1, ".") && (e == b + 3 || (is(b + 3, "[") && matchBracket(b + 3) == e - 1))) ||
+                            (is(b + 1, "[") && matchBracket(b + 1) == e - 1);
+            if (embedded) {
+                // The field is named after the type: *pkg.Base[T] -> Base
+                size_t nameEnd = b;
+                while (nameEnd < e && !is(nameEnd, "[")) ++nameEnd;
+                while (nameEnd > b && !isIdent(nameEnd - 1)) --nameEnd;
+                if (nameEnd > b) strct.fields.push_back(std::string(tokens_[nameEnd - 1].text));
+                continue;
+            }
+            for (size_t f = b; isIdent(f); f += 2) {
+                strct.fields.push_back(std::string(tokens_[f].text));
+                if (!is(f + 1, ",")) break;
+            }
+        }
+        structs.push_back(std::move(strct));
+    } else {
+        GoInterface iface;
+        iface.name = name;
+        iface.lineNumber = tokens_[i].line;
+        iface.isExported = isExportedName(name);
+        iface.comment = comment;
+        for (const auto& element : elements) {
+            iface.methods.push_back(spanText(tokens_, element.first, element.second));
+        }
+        interfaces.push_back(std::move(iface));
     }
-    
-    return lines;
+    return skipStatement(close);
 }
 
-std::string GoParser::extractComment(const std::vector<std::string>& lines, int startLine) {
-    std::string comment;
-    
-    // Look for comment before the function
-    for (int i = startLine - 1; i >= 0; --i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line).trimmed();
-        
-        if (qline.startsWith("//")) {
-            comment = qline.mid(2).trimmed().toStdString() + " " + comment;
-        } else if (!qline.isEmpty()) {
-            break; // Hit non-comment, non-blank line
-        }
-    }
-    
-    return comment;
+} // namespace
+
+GoParser::GoParser() : model_(SourceLanguage::Go) {
 }
 
-bool GoParser::isBlankOrComment(const std::string& line) {
-    QString qline = QString::fromStdString(line).trimmed();
-    return qline.isEmpty() || qline.startsWith("//") || qline.startsWith("/*");
+GoParser::~GoParser() {
+    clear();
 }
 
-bool GoParser::isExported(const std::string& name) {
-    return !name.empty() && std::isupper(name[0]);
+bool GoParser::parseFile(const std::string& content) {
+    return parseFile(SourceBuffer(content));
+}
+
+bool GoParser::parseFile(const SourceBuffer& source) {
+    clear();
+
+    if (source.empty()) {
+        return false;
+    }
+
+    try {
+        std::vector<Token> tokens;
+        std::vector<CommentGroup> comments;
+        Lexer lexer(source);
+        lexer.run(tokens);
+        lexer.collectComments(comments);
+
+        FileWalker walker(tokens, comments);
+        walker.run();
+
+        packageName_ = std::move(walker.packageName);
+        imports_ = std::move(walker.imports);
+        functions_ = std::move(walker.functions);
+        structs_ = std::move(walker.structs);
+        interfaces_ = std::move(walker.interfaces);
+
+        callSites_.reserve(walker.calls.size());
+        for (RawCallSite& call : walker.calls) {
+            GoFunction& caller = functions_[call.functionIndex];
+            caller.calledFunctions.push_back(call.callee);
+            functionCalls_[caller.name].push_back(call.callee);
+            callSites_.push_back({std::move(call.callee), std::move(call.qualifier), call.functionIndex, call.lineNumber});
+        }
+
+        // Methods are attached to the structs of their receivers
+        std::unordered_map<std::string, size_t> structIndex;
+        for (size_t i = 0; i < structs_.size(); ++i) {
+            structIndex.emplace(structs_[i].name, i);
+        }
+        for (GoFunction& func : functions_) {
+            func.packageName = packageName_;
+            if (!func.isMethod) continue;
+            std::string base = func.receiverType;
+            if (!base.empty() && base[0] == '*') base.erase(0, 1);
+            auto it = structIndex.find(base);
+            if (it != structIndex.end()) {
+                structs_[it->second].methods.push_back(func);
+            }
+        }
+
+        buildCodeModel();
+
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
 }
 
 std::string GoParser::getFunctionSignature(const GoFunction& func) const {
     std::string signature;
-    
+
     if (func.isMethod) {
         signature += "func (" + func.receiverName + " " + func.receiverType + ") ";
     } else {
         signature += "func ";
     }
-    
-    signature += func.name + "(";
-    
+
+    signature += func.name + func.typeParameters + "(";
+
     for (size_t i = 0; i < func.parameters.size(); ++i) {
         if (i > 0) signature += ", ";
-        
+
         if (!func.parameters[i].name.empty()) {
             signature += func.parameters[i].name + " ";
         }
-        
+
         if (func.parameters[i].isVariadic) {
             signature += "...";
         }
-        
+
         signature += func.parameters[i].type;
     }
-    
+
     signature += ")";
-    
+
     if (!func.returnTypes.empty()) {
         if (func.returnTypes.size() == 1) {
             signature += " " + func.returnTypes[0];
@@ -488,7 +685,7 @@ std::string GoParser::getFunctionSignature(const GoFunction& func) const {
             signature += ")";
         }
     }
-    
+
     return signature;
 }
 
@@ -501,22 +698,61 @@ std::vector<std::string> GoParser::getCalledFunctions(const std::string& functio
 }
 
 std::vector<std::string> GoParser::getCallingFunctions(const std::string& functionName) const {
-    std::vector<std::string> callers;
-    
-    for (const auto& pair : functionCalls_) {
-        const auto& calledFunctions = pair.second;
-        if (std::find(calledFunctions.begin(), calledFunctions.end(), functionName) != calledFunctions.end()) {
-            callers.push_back(pair.first);
-        }
-    }
-    
-    return callers;
+    // Over the call graph, so a name also finds callers of its methods
+    return model_.getCallerNames(functionName);
 }
 
 void GoParser::clear() {
     functions_.clear();
     structs_.clear();
     interfaces_.clear();
+    imports_.clear();
+    callSites_.clear();
     functionCalls_.clear();
     packageName_.clear();
-} 
\ No newline at end of file
+    model_.clear();
+}
+
+void GoParser::buildCodeModel() {
+    for (const GoStruct& strct : structs_) {
+        model_.addType({strct.name, "struct", {}, strct.lineNumber});
+    }
+    for (const GoInterface& iface : interfaces_) {
+        model_.addType({iface.name, "interface", {}, iface.lineNumber});
+    }
+    for (const GoFunction& func : functions_) {
+        CodeFunction function;
+        function.name = func.name;
+        if (func.isMethod) {
+            // Method expression form: (*Store).Get, Store.Len
+            function.container = func.receiverType;
+            function.receiver = func.receiverName;
+            bool pointer = !func.receiverType.empty() && func.receiverType[0] == '*';
+            function.qualifiedName = (pointer ? "(" + func.receiverType + ")" : func.receiverType) + "." + func.name;
+        } else {
+            function.qualifiedName = func.name;
+        }
+        if (func.returnTypes.size() == 1) {
+            function.returnType = func.returnTypes[0];
+        } else if (!func.returnTypes.empty()) {
+            function.returnType = "(";
+            for (size_t i = 0; i < func.returnTypes.size(); ++i) {
+                if (i > 0) function.returnType += ", ";
+                function.returnType += func.returnTypes[i];
+            }
+            function.returnType += ")";
+        }
+        for (const GoParameter& param : func.parameters) {
+            function.parameters.push_back({param.name, param.isVariadic ? "..." + param.type : param.type, ""});
+        }
+        function.signature = getFunctionSignature(func);
+        function.lineNumber = func.lineNumber;
+        model_.addFunction(std::move(function));
+    }
+    for (const GoCallSite& call : callSites_) {
+        model_.addCall({call.callerIndex, call.callee, call.qualifier, call.lineNumber});
+    }
+    for (const GoImport& imported : imports_) {
+        model_.addImport({imported.path, std::string(), imported.alias, imported.lineNumber});
+    }
+}
@@ -0,0 +1,317 @@
+#include "incremental_parser.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// "namespace a {", "inline namespace v1 {" and "extern "C" {" open a scope
+// whose contents are still top-level declarations
+bool opensTransparentScope(const std::string& code, size_t begin, size_t brace) {
+    auto word = [&](size_t& i) {
+        while (i < brace && std::isspace(static_cast<unsigned char>(code[i]))) ++i;
+        size_t start = i;
+        while (i < brace && isIdentifierChar(code[i])) ++i;
+        return code.substr(start, i - start);
+    };
+    size_t i = begin;
+    std::string first = word(i);
+    if (first == "inline") first = word(i);
+    if (first == "namespace") return true;
+    return first == "extern" && std::memchr(code.data() + i, '"', brace - i) != nullptr;
+}
+
+// Relative line numbers at which a top-level declaration starts in text,
+// lines that begin with one, given its SourceMask code(). Literal interiors
+// are blank there, line breaks included, so lines are counted on the text
+// and each quote character of the code opens or closes a literal.
+std::vector<int> declarationStarts(const std::string& text, const std::string& code, SourceLanguage language) {
+    std::vector<int> starts{0};
+    std::vector<bool> braces;  // True for a namespace or extern block
+    int blockDepth = 0;
+    int bracketDepth = 0;
+    char quote = 0;
+    bool complete = true;      // C++: no statement is open at block depth 0
+    size_t statementStart = 0;
+    bool continued = false;    // Python: the line before ends with a backslash
+    bool decorators = false;   // Python: the col-0 lines so far are decorators
+    char lastCode = 0;
+    int line = 0;
+    bool atLineStart = true;
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        char c = code[i];
+        if (text[i] == '\n') {
+            ++line;
+            atLineStart = true;
+            continued = lastCode == '\\';
+            lastCode = 0;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            continue;
+        }
+
+        if (atLineStart) {
+            atLineStart = false;
+            bool column0 = i == 0 || text[i - 1] == '\n';
+            bool open = quote != 0 || bracketDepth > 0 || blockDepth > 0;
+            bool start = false;
+            switch (language) {
+                case SourceLanguage::Cpp:
+                    start = !open && complete;
+                    break;
+                case SourceLanguage::Go:
+                    start = !open && column0;
+                    break;
+                case SourceLanguage::Python:
+                    if (!open && !continued && column0) {
+                        size_t end = i;
+                        while (end < code.size() && isIdentifierChar(code[end])) ++end;
+                        std::string keyword = code.substr(i, end - i);
+                        bool clause = keyword == "else" || keyword == "elif" || keyword == "except" ||
+                                      keyword == "finally";
+                        start = !clause && !decorators;
+                        decorators = c == '@';
+                    }
+                    break;
+            }
+            if (start && line > 0) starts.push_back(line);
+        }
+        lastCode = c;
+
+        if (quote) {
+            if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '"' || c == '\'' || c == '`') {
+            quote = c;
+            continue;
+        }
+
+        if (blockDepth == 0 && bracketDepth == 0 && complete) {
+            statementStart = i;
+            complete = false;
+        }
+        switch (c) {
+            case '(':
+            case '[':
+                ++bracketDepth;
+                break;
+            case ')':
+            case ']':
+                if (bracketDepth > 0) --bracketDepth;
+                break;
+            case '{':
+                if (language == SourceLanguage::Cpp && blockDepth == 0 && bracketDepth == 0 &&
+                    opensTransparentScope(code, statementStart, i)) {
+                    braces.push_back(true);
+                    complete = true;
+                } else if (language == SourceLanguage::Python) {
+                    ++bracketDepth;
+                } else {
+                    braces.push_back(false);
+                    ++blockDepth;
+                }
+                break;
+            case '}':
+                if (language == SourceLanguage::Python) {
+                    if (bracketDepth > 0) --bracketDepth;
+                    break;
+                }
+                if (!braces.empty()) {
+                    if (!braces.back()) --blockDepth;
+                    braces.pop_back();
+                }
+                if (blockDepth == 0 && bracketDepth == 0) complete = true;
+                break;
+            case ';':
+                if (blockDepth == 0 && bracketDepth == 0) complete = true;
+                break;
+        }
+    }
+    return starts;
+}
+
+} // namespace
+
+IncrementalParser::IncrementalParser()
+    : language_(SourceLanguage::Cpp), lineCount_(0), lastParsedLines_(0), modelDirty_(false) {
+}
+
+void IncrementalParser::clear() {
+    declarations_.clear();
+    lineCount_ = 0;
+    lastParsedLines_ = 0;
+    model_ = CodeModel(language_);
+    modelDirty_ = false;
+}
+
+void IncrementalParser::reset(SourceLanguage language, const std::string& text) {
+    language_ = language;
+    lineCount_ = static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1;
+    SourceMask mask(SourceBuffer(text), language_);
+    declarations_ = parseDeclarations(text, 0, declarationStarts(text, mask.code(), language_), lineCount_);
+    lastParsedLines_ = lineCount_;
+    modelDirty_ = true;
+}
+
+std::vector<IncrementalParser::Declaration> IncrementalParser::parseDeclarations(
+    const std::string& text, int firstLine, const std::vector<int>& starts, int lineCount) {
+    // Offset of each line of text, and of the end
+    std::vector<size_t> lineOffsets{0};
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') lineOffsets.push_back(i + 1);
+    }
+    lineOffsets.push_back(text.size());
+    auto offsetOf = [&](int line) { return lineOffsets[std::min<size_t>(line, lineOffsets.size() - 1)]; };
+
+    std::vector<Declaration> declarations;
+    for (size_t k = 0; k < starts.size() && starts[k] < lineCount; ++k) {
+        int end = k + 1 < starts.size() ? std::min(starts[k + 1], lineCount) : lineCount;
+        SourceBuffer source(text.substr(offsetOf(starts[k]), offsetOf(end) - offsetOf(starts[k])));
+
+        Declaration declaration{firstLine + starts[k], CodeModel(language_), {}};
+        switch (language_) {
+            case SourceLanguage::Cpp:
+                if (cppParser_.parseFile(source)) {
+                    declaration.model = cppParser_.getCodeModel();
+                    for (const CppFunction& function : cppParser_.getFunctions()) {
+                        declaration.defined.push_back(function.isDefined);
+                    }
+                }
+                break;
+            case SourceLanguage::Python:
+                if (pythonParser_.parseFile(source)) declaration.model = pythonParser_.getCodeModel();
+                break;
+            case SourceLanguage::Go:
+                if (goParser_.parseFile(source)) declaration.model = goParser_.getCodeModel();
+                break;
+        }
+        declarations.push_back(std::move(declaration));
+    }
+    return declarations;
+}
+
+size_t IncrementalParser::declarationAt(int line) const {
+    auto it = std::upper_bound(declarations_.begin(), declarations_.end(), line,
+                               [](int value, const Declaration& d) { return value < d.firstLine; });
+    return it == declarations_.begin() ? 0 : static_cast<size_t>(it - declarations_.begin() - 1);
+}
+
+bool IncrementalParser::update(int firstLine, int oldLineCount, int newLineCount, const LineFetcher& fetchLines) {
+    if (declarations_.empty()) {
+        return false;
+    }
+    // A pure insertion or removal is widened by the line after it, or at the
+    // end the line before it, which the old and new text both have
+    oldLineCount = std::max(0, oldLineCount);
+    newLineCount = std::max(0, newLineCount);
+    if (oldLineCount == 0 || newLineCount == 0) {
+        if (firstLine + oldLineCount >= lineCount_ && firstLine > 0) --firstLine;
+        ++oldLineCount;
+        ++newLineCount;
+    }
+    firstLine = std::max(0, std::min(firstLine, lineCount_ - 1));
+    oldLineCount = std::max(1, std::min(oldLineCount, lineCount_ - firstLine));
+
+    // The declaration before is taken too when the edit touches the line that
+    // starts one, since that line may now continue the one before
+    size_t first = declarationAt(firstLine);
+    if (first > 0 && declarations_[first].firstLine == firstLine) --first;
+    size_t last = declarationAt(firstLine + oldLineCount - 1) + 1;
+
+    int delta = newLineCount - oldLineCount;
+    lineCount_ += delta;
+    for (size_t k = last; k < declarations_.size(); ++k) {
+        declarations_[k].firstLine += delta;
+    }
+
+    // Read one line past the range: if it no longer starts a declaration the
+    // edit ran into the next one, which is then reparsed as well
+    int regionStart = declarations_[first].firstLine;
+    int regionEnd;
+    std::string text;
+    std::vector<int> starts;
+    for (;;) {
+        regionEnd = last < declarations_.size() ? declarations_[last].firstLine : lineCount_;
+        bool lookahead = last < declarations_.size();
+        text = fetchLines(regionStart, regionEnd - regionStart + (lookahead ? 1 : 0));
+        SourceMask mask(SourceBuffer(text), language_);
+        starts = declarationStarts(text, mask.code(), language_);
+        if (!lookahead || std::binary_search(starts.begin(), starts.end(), regionEnd - regionStart)) {
+            break;
+        }
+        ++last;
+    }
+
+    std::vector<Declaration> parsed = parseDeclarations(text, regionStart, starts, regionEnd - regionStart);
+    declarations_.erase(declarations_.begin() + first, declarations_.begin() + last);
+    declarations_.insert(declarations_.begin() + first, std::make_move_iterator(parsed.begin()),
+                         std::make_move_iterator(parsed.end()));
+    lastParsedLines_ = regionEnd - regionStart;
+    modelDirty_ = true;
+    return true;
+}
+
+std::vector<int> IncrementalParser::getDeclarationLines() const {
+    std::vector<int> lines;
+    lines.reserve(declarations_.size());
+    for (const Declaration& declaration : declarations_) {
+        lines.push_back(declaration.firstLine);
+    }
+    return lines;
+}
+
+const CodeModel& IncrementalParser::getCodeModel() {
+    if (!modelDirty_) {
+        return model_;
+    }
+    model_ = CodeModel(language_);
+
+    // Same key as CppParser: a declaration with a definition elsewhere in the
+    // file is dropped. Declarations have no calls, so none is lost.
+    auto functionKey = [](const CodeFunction& function) { return function.container + "::" + function.name; };
+    std::unordered_set<std::string> definitions;
+    for (const Declaration& declaration : declarations_) {
+        for (size_t i = 0; i < declaration.defined.size(); ++i) {
+            if (declaration.defined[i]) definitions.insert(functionKey(declaration.model.getFunctions()[i]));
+        }
+    }
+
+    std::vector<size_t> functionIndex;
+    for (const Declaration& declaration : declarations_) {
+        const std::vector<CodeFunction>& functions = declaration.model.getFunctions();
+        functionIndex.assign(functions.size(), 0);
+        for (CodeType type : declaration.model.getTypes()) {
+            type.lineNumber += declaration.firstLine;
+            model_.addType(std::move(type));
+        }
+        for (size_t i = 0; i < functions.size(); ++i) {
+            bool isDeclaration = i < declaration.defined.size() && !declaration.defined[i];
+            if (isDeclaration && definitions.count(functionKey(functions[i]))) {
+                continue;
+            }
+            functionIndex[i] = model_.getFunctions().size();
+            CodeFunction function = functions[i];
+            function.lineNumber += declaration.firstLine;
+            model_.addFunction(std::move(function));
+        }
+        for (CodeCall call : declaration.model.getCalls()) {
+            call.callerIndex = functionIndex[call.callerIndex];
+            call.lineNumber += declaration.firstLine;
+            model_.addCall(std::move(call));
+        }
+        for (CodeImport imported : declaration.model.getImports()) {
+            imported.lineNumber += declaration.firstLine;
+            model_.addImport(std::move(imported));
+        }
+    }
+    modelDirty_ = false;
+    return model_;
+}
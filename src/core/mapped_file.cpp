@@ -0,0 +1,118 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0), open_(false), file_(INVALID_HANDLE_VALUE), mapping_(nullptr) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    errorMessage_.clear();
+
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        errorMessage_ = "Cannot open file: " + path;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        errorMessage_ = "Cannot read the size of " + path;
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped; they are simply empty
+    if (size_ > 0) {
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data_ = mapping_ ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (!data_) {
+            errorMessage_ = "Cannot map file: " + path;
+            close();
+            return false;
+        }
+    }
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+    size_ = 0;
+    open_ = false;
+}
+
+#else
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), open_(false), fd_(-1) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    errorMessage_.clear();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        errorMessage_ = "Cannot open file: " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+        errorMessage_ = "Cannot read the size of " + path;
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    // Empty files cannot be mapped; they are simply empty
+    if (size_ > 0) {
+        void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (address == MAP_FAILED) {
+            errorMessage_ = "Cannot map file: " + path + " (" + std::strerror(errno) + ")";
+            close();
+            return false;
+        }
+        data_ = static_cast<const char*>(address);
+        madvise(address, size_, MADV_SEQUENTIAL);
+    }
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+    open_ = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
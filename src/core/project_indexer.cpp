@@ -0,0 +1,318 @@
+#include "project_indexer.h"
+#include "cpp_parser.h"
+#include "python_parser.h"
+#include "go_parser.h"
+#include "symbol_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool readWholeFile(const fs::path& path, uint64_t size, std::string& content) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return false;
+    content.resize(static_cast<size_t>(size));
+    input.read(&content[0], static_cast<std::streamsize>(size));
+    // The file may have shrunk since it was listed
+    content.resize(static_cast<size_t>(input.gcount()));
+    return !input.bad();
+}
+
+// One set of parsers per worker, reused for every file it takes
+struct Parsers {
+    CppParser cpp;
+    PythonParser python;
+    GoParser go;
+
+    bool parse(IndexedFile& file, const SourceBuffer& source) {
+        switch (file.language) {
+            case SourceLanguage::Cpp:
+                if (!cpp.parseFile(source)) return false;
+                file.model = cpp.getCodeModel();
+                return true;
+            case SourceLanguage::Python:
+                if (!python.parseFile(source)) return false;
+                file.model = python.getCodeModel();
+                return true;
+            case SourceLanguage::Go:
+                if (!go.parseFile(source)) return false;
+                file.model = go.getCodeModel();
+                return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+ProjectIndexer::ProjectIndexer()
+    : threadCount_(0), cancelFlag_(nullptr), functionCount_(0), callCount_(0), resolvedCallCount_(0), reusedFileCount_(0) {
+}
+
+bool ProjectIndexer::isSkippedDirectory(const std::string& name) {
+    return (!name.empty() && name[0] == '.') || name == "build" || name == "bin" || name == "obj" ||
+           name == "node_modules";
+}
+
+bool ProjectIndexer::languageForPath(const std::string& path, SourceLanguage& language) {
+    std::string extension = fs::u8path(path).extension().u8string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".cpp" || extension == ".cc" || extension == ".cxx" || extension == ".c" ||
+        extension == ".h" || extension == ".hpp" || extension == ".hh" || extension == ".hxx") {
+        language = SourceLanguage::Cpp;
+    } else if (extension == ".py") {
+        language = SourceLanguage::Python;
+    } else if (extension == ".go") {
+        language = SourceLanguage::Go;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ProjectIndexer::indexProject(const std::string& rootPath) {
+    errorMessage_.clear();
+    rootPath_ = rootPath;
+    symbolTable_.clear();
+    callGraph_.clear();
+    files_.clear();
+    functionCount_ = 0;
+    callCount_ = 0;
+    resolvedCallCount_ = 0;
+    reusedFileCount_ = 0;
+
+    if (!collectFiles() || !parseFiles()) {
+        return false;
+    }
+    if (!buildSymbolTable() || !buildCallGraph()) {
+        return fail("Indexing cancelled");
+    }
+    return true;
+}
+
+bool ProjectIndexer::collectFiles() {
+    std::error_code error;
+    fs::path root = fs::u8path(rootPath_);
+    if (!fs::is_directory(root, error)) {
+        return fail("Not a directory: " + rootPath_);
+    }
+
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error);
+    if (error) {
+        return fail("Cannot read directory " + rootPath_ + ": " + error.message());
+    }
+    for (; it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (error) {
+            return fail("Cannot read directory " + rootPath_ + ": " + error.message());
+        }
+        if (isCancelled()) {
+            return fail("Indexing cancelled");
+        }
+        const fs::directory_entry& entry = *it;
+        std::string name = entry.path().filename().u8string();
+        if (entry.is_directory(error)) {
+            if (isSkippedDirectory(name)) it.disable_recursion_pending();
+            continue;
+        }
+
+        SourceLanguage language;
+        if (!entry.is_regular_file(error) || !languageForPath(name, language)) {
+            continue;
+        }
+        IndexedFile file;
+        file.path = entry.path().lexically_relative(root).generic_u8string();
+        file.language = language;
+        file.size = entry.file_size(error);
+        file.modifiedTime = error ? 0 : static_cast<int64_t>(entry.last_write_time(error).time_since_epoch().count());
+        file.contentHash = 0;
+        file.parsed = false;
+        file.model = CodeModel(language);
+        if (error) {
+            error.clear();
+            continue;
+        }
+        files_.push_back(std::move(file));
+    }
+
+    std::sort(files_.begin(), files_.end(),
+              [](const IndexedFile& a, const IndexedFile& b) { return a.path < b.path; });
+    return true;
+}
+
+bool ProjectIndexer::parseFiles() {
+    // A cache that cannot be read is rebuilt from scratch, it is not an error
+    SymbolCache cache;
+    if (!cachePath_.empty() && !cache.load(cachePath_)) {
+        cache.clear();
+    }
+    if (isCancelled()) {
+        return fail("Indexing cancelled");
+    }
+
+    // Entries whose size and time still match are trusted without reading the
+    // file; the others are read and reused only if the content hash matches.
+    // Trusted files are counted as done up front and their models decoded by
+    // the workers before any file is read.
+    std::vector<const SymbolCache::Entry*> cached(files_.size(), nullptr);
+    std::vector<size_t> trusted;
+    std::vector<size_t> order;
+    for (size_t i = 0; i < files_.size(); ++i) {
+        IndexedFile& file = files_[i];
+        const SymbolCache::Entry* entry = cache.find(file.path);
+        if (!entry || !entry->parsed || entry->language != file.language) {
+            order.push_back(i);
+            continue;
+        }
+        cached[i] = entry;
+        if (entry->size == file.size && entry->modifiedTime == file.modifiedTime) {
+            trusted.push_back(i);
+        } else {
+            order.push_back(i);
+        }
+    }
+
+    // Largest files first so the last tasks handed out are small ones
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return files_[a].size > files_[b].size; });
+
+    fs::path root = fs::u8path(rootPath_);
+    std::atomic<size_t> nextTask{0};
+    std::atomic<size_t> filesDone{trusted.size()};
+    std::atomic<size_t> filesTrusted{0};
+    std::atomic<size_t> filesHashed{0};
+    std::atomic<bool> cancelled{false};
+    const size_t taskCount = trusted.size() + order.size();
+
+    auto worker = [&](bool reportsProgress) {
+        Parsers parsers;
+        std::string content;
+        size_t index;
+        while (!cancelled && !isCancelled() && (index = nextTask.fetch_add(1)) < taskCount) {
+            if (index < trusted.size()) {
+                IndexedFile& file = files_[trusted[index]];
+                const SymbolCache::Entry* entry = cached[trusted[index]];
+                if (cache.readModel(*entry, file.model)) {
+                    file.contentHash = entry->contentHash;
+                    file.parsed = true;
+                    ++filesTrusted;
+                    continue;
+                }
+                // A damaged model is parsed again like a changed file
+                cached[trusted[index]] = nullptr;
+                --filesDone;
+            }
+            size_t fileIndex = index < trusted.size() ? trusted[index] : order[index - trusted.size()];
+            IndexedFile& file = files_[fileIndex];
+            const SymbolCache::Entry* entry = cached[fileIndex];
+            if (readWholeFile(root / fs::u8path(file.path), file.size, content)) {
+                file.contentHash = SymbolCache::hashContent(content.data(), content.size());
+                if (entry && entry->size == content.size() && entry->contentHash == file.contentHash &&
+                    cache.readModel(*entry, file.model)) {
+                    file.parsed = true;
+                    ++filesHashed;
+                } else {
+                    file.parsed = parsers.parse(file, SourceBuffer(std::move(content)));
+                }
+            }
+            content.clear();
+
+            size_t done = ++filesDone;
+            if (reportsProgress && progressCallback_ && !progressCallback_(done, files_.size())) {
+                cancelled = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    unsigned threadCount = threadCount_ ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+    unsigned workerCount = static_cast<unsigned>(std::min<size_t>(threadCount, taskCount));
+    for (unsigned i = 1; i < workerCount; ++i) {
+        workers.emplace_back(worker, false);
+    }
+    worker(true);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (cancelled || isCancelled()) {
+        return fail("Indexing cancelled");
+    }
+    reusedFileCount_ += filesTrusted + filesHashed;
+    if (progressCallback_) {
+        progressCallback_(files_.size(), files_.size());
+    }
+
+    // Nothing to write when every file was trusted and none was removed;
+    // a cache that cannot be written only costs the next run its reuse
+    if (!cachePath_.empty() && (filesTrusted != files_.size() || cache.size() != files_.size())) {
+        cache.save(cachePath_, files_);
+    }
+    return true;
+}
+
+bool ProjectIndexer::buildSymbolTable() {
+    for (const IndexedFile& file : files_) {
+        functionCount_ += file.model.getFunctions().size();
+    }
+    symbolTable_.reserve(functionCount_);
+    // Added in path order, so table file indexes are those of files_
+    for (const IndexedFile& file : files_) {
+        if (isCancelled()) {
+            return false;
+        }
+        symbolTable_.addFile(file.path, file.model);
+    }
+    return true;
+}
+
+bool ProjectIndexer::buildCallGraph() {
+    std::vector<CallGraph::NodeId> functionNodes;
+    std::vector<size_t> firstNode(files_.size() + 1, 0);
+    for (uint32_t f = 0; f < files_.size(); ++f) {
+        firstNode[f] = functionNodes.size();
+        if (isCancelled()) {
+            return false;
+        }
+        for (uint32_t i = 0; i < files_[f].model.getFunctions().size(); ++i) {
+            functionNodes.push_back(callGraph_.addNode(symbolTable_.getSymbolName({f, i})));
+        }
+    }
+    firstNode[files_.size()] = functionNodes.size();
+
+    for (uint32_t f = 0; f < files_.size(); ++f) {
+        if (isCancelled()) {
+            return false;
+        }
+        const CodeModel& model = files_[f].model;
+        for (const CodeCall& call : model.getCalls()) {
+            SymbolLocation target;
+            CallGraph::NodeId callee;
+            if (symbolTable_.resolve(f, call, target)) {
+                callee = functionNodes[firstNode[target.file] + target.function];
+                ++resolvedCallCount_;
+            } else {
+                callee = callGraph_.addNode(CodeModel::getCallName(model.getLanguage(), call), false);
+            }
+            callGraph_.addCall(functionNodes[firstNode[f] + call.callerIndex], callee);
+        }
+        callCount_ += model.getCalls().size();
+    }
+    callGraph_.build();
+    return true;
+}
+
+std::vector<SymbolLocation> ProjectIndexer::findFunctions(const std::string& name) const {
+    return symbolTable_.findFunctions(name);
+}
+
+bool ProjectIndexer::fail(const std::string& message) {
+    errorMessage_ = message;
+    return false;
+}
@@ -1,450 +1,661 @@
 #include "python_parser.h"
 #include <algorithm>
-#include <sstream>
-#include <QRegExp>
-#include <QString>
-
-PythonParser::PythonParser() {
-    // Function definition pattern: def function_name(parameters):
-    functionPattern_ = QRegExp("^\\s*def\\s+(\\w+)\\s*\\(([^)]*)\\)\\s*(?:\\s*->\\s*([^:]+))?:");
-    
-    // Async function definition pattern: async def function_name(parameters):
-    asyncFunctionPattern_ = QRegExp("^\\s*async\\s+def\\s+(\\w+)\\s*\\(([^)]*)\\)\\s*(?:\\s*->\\s*([^:]+))?:");
-    
-    // Class definition pattern: class ClassName(BaseClass):
-    classPattern_ = QRegExp("^\\s*class\\s+(\\w+)(?:\\s*\\(([^)]*)\\))?\\s*:");
-    
-    // Function call pattern: function_name(
-    functionCallPattern_ = QRegExp("(\\w+)\\s*\\(");
-    
-    // Parameter pattern with type annotations
-    parameterPattern_ = QRegExp("(\\w+)(?:\\s*:\\s*([^=,)]+))?(?:\\s*=\\s*([^,)]+))?");
-    
-    // Decorator pattern: @decorator_name
-    decoratorPattern_ = QRegExp("^\\s*@(\\w+)");
+#include <cctype>
+#include <exception>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+
+enum class TokenKind { Name, Number, String, Op };
+
+struct Token {
+    TokenKind kind;
+    std::string_view text;
+    int line;
+};
+
+struct LogicalLine {
+    int indent = 0;
+    std::vector<Token> tokens;
+};
+
+bool isNameStart(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalpha(u) || c == '_' || u >= 0x80;
 }
 
-PythonParser::~PythonParser() {
-    clear();
+bool isNameChar(char c) {
+    return isNameStart(c) || std::isdigit(static_cast<unsigned char>(c));
 }
 
-bool PythonParser::parseFile(const std::string& content) {
-    clear();
-    
-    if (content.empty()) {
-        return false;
-    }
-    
-    try {
-        // Remove excessive comments but keep docstrings
-        std::string cleanContent = removeComments(content);
-        
-        // Parse classes
-        parseClasses(cleanContent);
-        
-        // Parse functions
-        parseFunctions(cleanContent);
-        
-        // Parse function calls
-        parseFunctionCalls(cleanContent);
-        
-        return true;
-    } catch (const std::exception& e) {
-        return false;
+bool isStringPrefix(std::string_view word) {
+    if (word.size() > 2) return false;
+    for (char c : word) {
+        char lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (lower != 'r' && lower != 'b' && lower != 'u' && lower != 'f') return false;
     }
+    return true;
 }
 
-void PythonParser::parseFunctions(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Skip blank lines and pure comments
-        if (isBlankOrComment(line)) {
+const char* const kMultiCharOperators[] = {
+    "**=", "//=", ">>=", "<<=", "...", "->", "**", "//", "==", "!=", "<=", ">=", ":=",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "@=", "<<", ">>"
+};
+
+// Splits the source into logical lines as Python's tokenizer does: blank
+// lines are dropped, and lines are joined inside brackets and after a
+// backslash. The reader walks the mask of the source, where comments are
+// blank and each string (triple-quoted ones included) is reduced to its
+// outer quotes; token text comes from the original at the same offsets.
+class LogicalLineReader {
+public:
+    explicit LogicalLineReader(const SourceBuffer& source)
+        : mask_(source, SourceLanguage::Python), code_(mask_.code()), original_(source.view()), lines_(source) {}
+
+    bool next(LogicalLine& out);
+
+private:
+    void push(std::vector<Token>& tokens, TokenKind kind, size_t start) {
+        tokens.push_back({kind, original_.substr(start, pos_ - start), lines_.lineAt(start)});
+    }
+
+    SourceMask mask_;
+    const std::string& code_;
+    std::string_view original_;
+    LineCursor lines_;
+    size_t pos_ = 0;
+};
+
+bool LogicalLineReader::next(LogicalLine& out) {
+    out.tokens.clear();
+    int depth = 0;
+    size_t size = code_.size();
+
+    // Indentation of the first physical line that holds a token
+    while (pos_ < size) {
+        int indent = 0;
+        while (pos_ < size && (code_[pos_] == ' ' || code_[pos_] == '\t' || code_[pos_] == '\f')) {
+            char c = code_[pos_];
+            indent = c == '\t' ? (indent / 8 + 1) * 8 : (c == ' ' ? indent + 1 : 0);
+            ++pos_;
+        }
+        if (pos_ < size && code_[pos_] == '\r') ++pos_;
+        if (pos_ < size && code_[pos_] == '\n') {
+            ++pos_;
+            continue;
+        }
+        out.indent = indent;
+        break;
+    }
+
+    while (pos_ < size) {
+        char c = code_[pos_];
+        if (c == '\n') {
+            ++pos_;
+            if (depth == 0 && !out.tokens.empty()) return true;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f') {
+            ++pos_;
+            continue;
+        }
+        if (c == '\\') {
+            // Explicit line joining
+            size_t next = pos_ + 1;
+            if (next < size && code_[next] == '\r') ++next;
+            if (next < size && code_[next] == '\n') {
+                pos_ = next + 1;
+                continue;
+            }
+        }
+
+        size_t start = pos_;
+        if (isNameStart(c)) {
+            while (pos_ < size && isNameChar(code_[pos_])) ++pos_;
+            if (pos_ < size && (code_[pos_] == '"' || code_[pos_] == '\'') &&
+                isStringPrefix(std::string_view(code_).substr(start, pos_ - start))) {
+                c = code_[pos_];
+            } else {
+                push(out.tokens, TokenKind::Name, start);
+                continue;
+            }
+        }
+        if (c == '"' || c == '\'') {
+            ++pos_;
+            while (pos_ < size && code_[pos_] != c && code_[pos_] != '\n') ++pos_;
+            if (pos_ < size && code_[pos_] == c) ++pos_;
+            push(out.tokens, TokenKind::String, start);
             continue;
         }
-        
-        // Check for function definition
-        if (functionPattern_.indexIn(qline) != -1 || asyncFunctionPattern_.indexIn(qline) != -1) {
-            PythonFunction func = parseFunctionDefinition(lines, i);
-            if (!func.name.empty()) {
-                functions_.push_back(func);
+        if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && pos_ + 1 < size && std::isdigit(static_cast<unsigned char>(code_[pos_ + 1])))) {
+            while (pos_ < size && (isNameChar(code_[pos_]) || code_[pos_] == '.' ||
+                                   ((code_[pos_] == '+' || code_[pos_] == '-') &&
+                                    (code_[pos_ - 1] == 'e' || code_[pos_ - 1] == 'E')))) {
+                ++pos_;
+            }
+            push(out.tokens, TokenKind::Number, start);
+            continue;
+        }
+
+        size_t length = 1;
+        for (const char* op : kMultiCharOperators) {
+            size_t n = std::char_traits<char>::length(op);
+            if (size - pos_ >= n && code_.compare(pos_, n, op) == 0) {
+                length = n;
+                break;
             }
         }
+        if (length == 1) {
+            if (c == '(' || c == '[' || c == '{') ++depth;
+            if ((c == ')' || c == ']' || c == '}') && depth > 0) --depth;
+        }
+        pos_ += length;
+        push(out.tokens, TokenKind::Op, start);
     }
+    return !out.tokens.empty();
 }
 
-void PythonParser::parseClasses(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    
-    for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        if (classPattern_.indexIn(qline) != -1) {
-            PythonClass cls;
-            cls.name = classPattern_.cap(1).toStdString();
-            cls.lineNumber = i + 1;
-            
-            // Parse base classes
-            if (!classPattern_.cap(2).isEmpty()) {
-                QString baseClasses = classPattern_.cap(2);
-                QStringList bases = baseClasses.split(",");
-                for (const QString& base : bases) {
-                    QString trimmed = base.trimmed();
-                    cls.baseClasses.push_back(trimmed.toStdString());
-                }
-            }
-            
-            // Extract docstring
-            cls.docstring = extractDocstring(lines, i + 1);
-            
-            classes_.push_back(cls);
+// Keywords, and the builtins the parser has always left out of call lists
+const std::unordered_set<std::string_view> kNonCallNames = {
+    "if", "elif", "else", "while", "for", "in", "is", "not", "and", "or", "with", "as",
+    "try", "except", "finally", "return", "yield", "await", "assert", "del", "raise",
+    "import", "from", "global", "nonlocal", "lambda", "pass", "def", "class", "async",
+    "print", "len", "range", "str", "int", "float", "list", "dict", "set", "tuple", "bool"
+};
+
+// Source text of tokens [begin, end) with every run of whitespace, line
+// breaks or comments between two tokens reduced to one space
+std::string spanText(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    std::string text;
+    for (size_t i = begin; i < end; ++i) {
+        if (i > begin && tokens[i].text.data() != tokens[i - 1].text.data() + tokens[i - 1].text.size()) {
+            text += ' ';
         }
+        text += tokens[i].text;
     }
+    return text;
 }
 
-void PythonParser::parseFunctionCalls(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    std::string currentFunction;
-    int currentIndent = -1;
-    
+// Contents of a docstring literal, indentation removed as inspect.cleandoc does
+std::string docstringText(std::string_view literal) {
+    size_t prefix = 0;
+    while (prefix < literal.size() && literal[prefix] != '"' && literal[prefix] != '\'') ++prefix;
+    literal.remove_prefix(prefix);
+    size_t quotes = literal.size() >= 6 && literal[1] == literal[0] && literal[2] == literal[0] ? 3 : 1;
+    if (literal.size() < quotes * 2) return "";
+    literal = literal.substr(quotes, literal.size() - quotes * 2);
+
+    std::vector<std::string_view> lines;
+    size_t start = 0;
+    while (start <= literal.size()) {
+        size_t newline = literal.find('\n', start);
+        if (newline == std::string_view::npos) newline = literal.size();
+        std::string_view line = literal.substr(start, newline - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        lines.push_back(line);
+        start = newline + 1;
+    }
+
+    size_t margin = std::string_view::npos;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        size_t indent = lines[i].find_first_not_of(" \t");
+        if (indent != std::string_view::npos) margin = std::min(margin, indent);
+    }
+
+    std::string text;
     for (size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line = lines[i];
-        QString qline = QString::fromStdString(line);
-        
-        // Check if this is a function definition
-        if (functionPattern_.indexIn(qline) != -1) {
-            currentFunction = functionPattern_.cap(1).toStdString();
-            currentIndent = getIndentLevel(line);
-        } else if (asyncFunctionPattern_.indexIn(qline) != -1) {
-            currentFunction = asyncFunctionPattern_.cap(1).toStdString();
-            currentIndent = getIndentLevel(line);
-        }
-        
-        // If we're inside a function, look for function calls
-        if (!currentFunction.empty()) {
-            int lineIndent = getIndentLevel(line);
-            
-            // If we've reached a line with same or less indentation than function definition,
-            // we're no longer in the function (unless it's a blank/comment line)
-            if (lineIndent <= currentIndent && !isBlankOrComment(line) && 
-                functionPattern_.indexIn(qline) == -1 && asyncFunctionPattern_.indexIn(qline) == -1) {
-                currentFunction.clear();
-                currentIndent = -1;
-                continue;
-            }
-            
-            // Look for function calls in this line
-            int pos = 0;
-            while ((pos = functionCallPattern_.indexIn(qline, pos)) != -1) {
-                QString calledFunc = functionCallPattern_.cap(1);
-                std::string calledFuncStr = calledFunc.toStdString();
-                
-                // Avoid Python keywords and built-ins
-                if (calledFuncStr != "if" && calledFuncStr != "while" && 
-                    calledFuncStr != "for" && calledFuncStr != "try" &&
-                    calledFuncStr != "with" && calledFuncStr != "print" &&
-                    calledFuncStr != "len" && calledFuncStr != "range" &&
-                    calledFuncStr != "str" && calledFuncStr != "int" &&
-                    calledFuncStr != "float" && calledFuncStr != "list" &&
-                    calledFuncStr != "dict" && calledFuncStr != "set" &&
-                    calledFuncStr != "tuple" && calledFuncStr != "bool") {
-                    functionCalls_[currentFunction].push_back(calledFuncStr);
+        std::string_view line = lines[i];
+        if (i == 0) {
+            size_t first = line.find_first_not_of(" \t");
+            line = first == std::string_view::npos ? std::string_view() : line.substr(first);
+        } else if (margin != std::string_view::npos) {
+            line = line.size() > margin ? line.substr(margin) : std::string_view();
+        }
+        size_t last = line.find_last_not_of(" \t");
+        line = last == std::string_view::npos ? std::string_view() : line.substr(0, last + 1);
+        if (i > 0) text += '\n';
+        text += line;
+    }
+
+    size_t first = text.find_first_not_of('\n');
+    size_t last = text.find_last_not_of('\n');
+    return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+}
+
+struct Block {
+    enum class Kind { Class, Function };
+    Kind kind;
+    int indent;            // indentation of the def or class line
+    size_t index;          // into the parsed functions or classes
+    std::string qualifiedName;
+    int functionIndex;     // innermost function at or around this block, -1 at class level
+    bool docstringPending; // the first statement of the body has not been seen yet
+};
+
+struct RawCallSite {
+    size_t functionIndex;
+    std::string callee;
+    std::string qualifier;
+    int lineNumber;
+};
+
+class ModuleWalker {
+public:
+    void handle(const LogicalLine& line);
+    void finish();
+
+    std::vector<PythonFunction> functions;
+    std::vector<PythonClass> classes;
+    std::vector<RawCallSite> calls;
+    std::vector<PythonImport> imports;
+
+private:
+    void handleDefinition(const LogicalLine& line, size_t keyword, bool isAsync);
+    void handleStatement(const std::vector<Token>& tokens, size_t begin, size_t end, bool firstInBody);
+    void handleImport(const std::vector<Token>& tokens, size_t begin, size_t end);
+    void recordCalls(const std::vector<Token>& tokens, size_t begin, size_t end, int functionIndex);
+    std::vector<PythonParameter> parseParameters(const std::vector<Token>& tokens, size_t begin, size_t end) const;
+    void addAttribute(size_t classIndex, std::string_view name);
+
+    int currentFunction() const { return blocks_.empty() ? -1 : blocks_.back().functionIndex; }
+
+    std::vector<Block> blocks_;
+    std::vector<std::string> pendingDecorators_;
+    std::vector<std::vector<size_t>> classMethods_;
+    std::vector<std::unordered_set<std::string>> classAttributes_;
+    std::vector<int> methodClass_;  // per function: owning class, or -1
+};
+
+void ModuleWalker::handle(const LogicalLine& line) {
+    while (!blocks_.empty() && line.indent <= blocks_.back().indent) {
+        blocks_.pop_back();
+    }
+
+    const std::vector<Token>& tokens = line.tokens;
+    bool firstInBody = !blocks_.empty() && blocks_.back().docstringPending;
+    if (firstInBody) blocks_.back().docstringPending = false;
+
+    if (tokens[0].text == "@") {
+        // Decorator: its dotted name, without arguments
+        size_t end = 1;
+        while (end < tokens.size() && (tokens[end].kind == TokenKind::Name || tokens[end].text == ".")) ++end;
+        pendingDecorators_.push_back(spanText(tokens, 1, end));
+        recordCalls(tokens, 1, tokens.size(), currentFunction());
+        return;
+    }
+
+    size_t keyword = tokens[0].text == "async" && tokens.size() > 1 ? 1 : 0;
+    if ((tokens[keyword].text == "def" || tokens[keyword].text == "class") &&
+        keyword + 1 < tokens.size() && tokens[keyword + 1].kind == TokenKind::Name) {
+        handleDefinition(line, keyword, keyword == 1);
+        return;
+    }
+
+    pendingDecorators_.clear();
+    handleStatement(tokens, 0, tokens.size(), firstInBody);
+}
+
+void ModuleWalker::handleDefinition(const LogicalLine& line, size_t keyword, bool isAsync) {
+    const std::vector<Token>& tokens = line.tokens;
+    std::string name(tokens[keyword + 1].text);
+    bool isClass = tokens[keyword].text == "class";
+
+    const Block* parent = blocks_.empty() ? nullptr : &blocks_.back();
+    std::string qualifiedName = name;
+    if (parent) {
+        qualifiedName = parent->qualifiedName + (parent->kind == Block::Kind::Function ? ".<locals>." : ".") + name;
+    }
+    int enclosingFunction = currentFunction();
+
+    // Parenthesised part after the name and the ':' ending the header
+    size_t open = keyword + 2;
+    size_t close = open;
+    bool hasParens = open < tokens.size() && tokens[open].text == "(";
+    if (hasParens) {
+        int depth = 0;
+        for (close = open; close < tokens.size(); ++close) {
+            std::string_view text = tokens[close].text;
+            if (text == "(" || text == "[" || text == "{") ++depth;
+            if ((text == ")" || text == "]" || text == "}") && --depth == 0) break;
+        }
+        hasParens = close < tokens.size();
+    }
+    size_t colon = hasParens ? close + 1 : open;
+    size_t arrow = tokens.size();
+    int depth = 0;
+    for (; colon < tokens.size(); ++colon) {
+        std::string_view text = tokens[colon].text;
+        if (text == "(" || text == "[" || text == "{") ++depth;
+        if (text == ")" || text == "]" || text == "}") --depth;
+        if (text == "->" && depth == 0) arrow = colon;
+        if (text == ":" && depth == 0) break;
+    }
+
+    std::string decorator;
+    for (size_t i = 0; i < pendingDecorators_.size(); ++i) {
+        if (i > 0) decorator += ", ";
+        decorator += pendingDecorators_[i];
+    }
+
+    // Defaults, base classes and annotations are evaluated in the enclosing scope
+    recordCalls(tokens, keyword + 2, colon, enclosingFunction);
+
+    Block block;
+    block.indent = line.indent;
+    block.qualifiedName = qualifiedName;
+    block.docstringPending = true;
+
+    if (isClass) {
+        PythonClass cls;
+        cls.name = name;
+        cls.lineNumber = tokens[keyword].line;
+        cls.decorator = decorator;
+        if (hasParens) {
+            size_t start = open + 1;
+            depth = 0;
+            for (size_t i = open + 1; i <= close; ++i) {
+                std::string_view text = tokens[i].text;
+                if (i < close && (text == "(" || text == "[" || text == "{")) ++depth;
+                if (i < close && (text == ")" || text == "]" || text == "}")) --depth;
+                if (i == close || (text == "," && depth == 0)) {
+                    // metaclass=... and other keywords are not bases
+                    bool keywordArgument = i - start >= 2 && tokens[start + 1].text == "=";
+                    if (i > start && !keywordArgument) cls.baseClasses.push_back(spanText(tokens, start, i));
+                    start = i + 1;
                 }
-                
-                pos += functionCallPattern_.matchedLength();
             }
         }
+        classes.push_back(std::move(cls));
+        classMethods_.emplace_back();
+        classAttributes_.emplace_back();
+
+        block.kind = Block::Kind::Class;
+        block.index = classes.size() - 1;
+        block.functionIndex = enclosingFunction;
+    } else {
+        PythonFunction func;
+        func.name = name;
+        func.qualifiedName = qualifiedName;
+        func.lineNumber = tokens[keyword + 1].line;
+        func.isAsync = isAsync;
+        func.isPrivate = !name.empty() && name[0] == '_';
+        func.isStaticMethod = false;
+        func.isClassMethod = false;
+        for (const std::string& d : pendingDecorators_) {
+            if (d == "staticmethod") func.isStaticMethod = true;
+            if (d == "classmethod") func.isClassMethod = true;
+        }
+        func.decorator = decorator;
+        if (hasParens) func.parameters = parseParameters(tokens, open + 1, close);
+        if (arrow < colon) func.returnType = spanText(tokens, arrow + 1, colon);
+
+        int owner = -1;
+        if (parent && parent->kind == Block::Kind::Class) {
+            owner = static_cast<int>(parent->index);
+            func.className = classes[parent->index].name;
+            classMethods_[parent->index].push_back(functions.size());
+        }
+        functions.push_back(std::move(func));
+        methodClass_.push_back(owner);
+
+        block.kind = Block::Kind::Function;
+        block.index = functions.size() - 1;
+        block.functionIndex = static_cast<int>(block.index);
+    }
+    pendingDecorators_.clear();
+    blocks_.push_back(std::move(block));
+
+    // Body on the header line: def f(): return g()
+    if (colon + 1 < tokens.size()) {
+        blocks_.back().docstringPending = false;
+        handleStatement(tokens, colon + 1, tokens.size(), true);
     }
 }
 
-PythonFunction PythonParser::parseFunctionDefinition(const std::vector<std::string>& lines, int startLine) {
-    PythonFunction func;
-    const std::string& line = lines[startLine];
-    QString qline = QString::fromStdString(line);
-    
-    // Check for async function
-    if (asyncFunctionPattern_.indexIn(qline) != -1) {
-        func.name = asyncFunctionPattern_.cap(1).toStdString();
-        func.isAsync = true;
-        func.returnType = asyncFunctionPattern_.cap(3).toStdString();
-        
-        // Parse parameters
-        QString paramStr = asyncFunctionPattern_.cap(2);
-        func.parameters = parseParameters(paramStr.toStdString());
-    } else if (functionPattern_.indexIn(qline) != -1) {
-        func.name = functionPattern_.cap(1).toStdString();
-        func.isAsync = false;
-        func.returnType = functionPattern_.cap(3).toStdString();
-        
-        // Parse parameters
-        QString paramStr = functionPattern_.cap(2);
-        func.parameters = parseParameters(paramStr.toStdString());
-    }
-    
-    func.lineNumber = startLine + 1;
-    
-    // Check if function is private (starts with underscore)
-    func.isPrivate = func.name.length() > 0 && func.name[0] == '_';
-    
-    // Look for decorators before the function
-    for (int i = startLine - 1; i >= 0; --i) {
-        const std::string& prevLine = lines[i];
-        QString qPrevLine = QString::fromStdString(prevLine);
-        
-        if (decoratorPattern_.indexIn(qPrevLine) != -1) {
-            std::string decorator = decoratorPattern_.cap(1).toStdString();
-            if (func.decorator.empty()) {
-                func.decorator = decorator;
+void ModuleWalker::handleStatement(const std::vector<Token>& tokens, size_t begin, size_t end, bool firstInBody) {
+    if (begin >= end) return;
+
+    if (firstInBody && !blocks_.empty()) {
+        bool onlyStrings = std::all_of(tokens.begin() + begin, tokens.begin() + end,
+                                       [](const Token& t) { return t.kind == TokenKind::String; });
+        if (onlyStrings) {
+            std::string doc;
+            for (size_t i = begin; i < end; ++i) doc += docstringText(tokens[i].text);
+            const Block& block = blocks_.back();
+            if (block.kind == Block::Kind::Class) {
+                classes[block.index].docstring = doc;
             } else {
-                func.decorator = decorator + ", " + func.decorator;
-            }
-            
-            // Check for special decorators
-            if (decorator == "staticmethod") {
-                func.isStaticMethod = true;
-            } else if (decorator == "classmethod") {
-                func.isClassMethod = true;
+                functions[block.index].docstring = doc;
             }
-        } else if (!isBlankOrComment(prevLine)) {
-            break; // Stop if we hit a non-decorator, non-blank line
+            return;
         }
     }
-    
-    // Extract docstring
-    func.docstring = extractDocstring(lines, startLine + 1);
-    
-    return func;
-}
 
-std::vector<PythonParameter> PythonParser::parseParameters(const std::string& paramStr) {
-    std::vector<PythonParameter> parameters;
-    
-    if (paramStr.empty()) {
-        return parameters;
-    }
-    
-    QString qParamStr = QString::fromStdString(paramStr);
-    QStringList paramList = qParamStr.split(",");
-    
-    for (const QString& param : paramList) {
-        QString trimmed = param.trimmed();
-        if (trimmed.isEmpty()) continue;
-        
-        PythonParameter p;
-        p.isOptional = false;
-        
-        if (parameterPattern_.indexIn(trimmed) != -1) {
-            p.name = parameterPattern_.cap(1).toStdString();
-            p.type = parameterPattern_.cap(2).toStdString();
-            p.defaultValue = parameterPattern_.cap(3).toStdString();
-            p.isOptional = !p.defaultValue.empty();
-        } else {
-            // Simple parameter name without type annotation
-            p.name = trimmed.toStdString();
-        }
-        
-        if (!p.name.empty()) {
-            parameters.push_back(p);
-        }
-    }
-    
-    return parameters;
-}
+    if (tokens[begin].text == "import" || tokens[begin].text == "from") {
+        handleImport(tokens, begin, end);
+        return;
+    }
 
-std::string PythonParser::removeComments(const std::string& content) {
-    std::vector<std::string> lines = splitLines(content);
-    std::string result;
-    
-    for (const std::string& line : lines) {
-        std::string processedLine = line;
-        
-        // Find # that's not inside a string
-        bool inString = false;
-        char stringChar = '\0';
-        bool inTripleString = false;
-        
-        for (size_t i = 0; i < processedLine.length(); ++i) {
-            char c = processedLine[i];
-            
-            if (!inString && !inTripleString) {
-                if (c == '\'' || c == '"') {
-                    // Check for triple quotes
-                    if (i + 2 < processedLine.length() && 
-                        processedLine.substr(i, 3) == std::string(3, c)) {
-                        inTripleString = true;
-                        stringChar = c;
-                        i += 2; // Skip next two characters
-                        continue;
-                    } else {
-                        inString = true;
-                        stringChar = c;
-                    }
-                } else if (c == '#') {
-                    // Found comment, truncate line here
-                    processedLine = processedLine.substr(0, i);
-                    break;
-                }
-            } else if (inTripleString) {
-                if (i + 2 < processedLine.length() && 
-                    processedLine.substr(i, 3) == std::string(3, stringChar)) {
-                    inTripleString = false;
-                    stringChar = '\0';
-                    i += 2;
-                }
-            } else if (inString) {
-                if (c == stringChar && (i == 0 || processedLine[i-1] != '\\')) {
-                    inString = false;
-                    stringChar = '\0';
-                }
+    // Class attributes: "name = ..." and "name: type" in the class body,
+    // "self.name = ..." in its methods
+    if (!blocks_.empty()) {
+        const Block& block = blocks_.back();
+        bool assignment = end - begin >= 2 && (tokens[begin + 1].text == "=" || tokens[begin + 1].text == ":");
+        if (block.kind == Block::Kind::Class && tokens[begin].kind == TokenKind::Name && assignment) {
+            addAttribute(block.index, tokens[begin].text);
+        } else if (block.kind == Block::Kind::Function && methodClass_[block.index] >= 0 &&
+                   end - begin >= 4 && tokens[begin + 1].text == "." && tokens[begin + 2].kind == TokenKind::Name &&
+                   (tokens[begin + 3].text == "=" || tokens[begin + 3].text == ":")) {
+            const PythonFunction& method = functions[block.index];
+            if (!method.isStaticMethod && !method.parameters.empty() &&
+                tokens[begin].text == method.parameters[0].name) {
+                addAttribute(static_cast<size_t>(methodClass_[block.index]), tokens[begin + 2].text);
             }
         }
-        
-        result += processedLine + "\n";
     }
-    
-    return result;
+
+    recordCalls(tokens, begin, end, currentFunction());
 }
 
-std::string PythonParser::normalizeWhitespace(const std::string& text) {
-    std::string result;
-    bool inWhitespace = false;
-    
-    for (char c : text) {
-        if (std::isspace(c)) {
-            if (!inWhitespace) {
-                result += ' ';
-                inWhitespace = true;
-            }
-        } else {
-            result += c;
-            inWhitespace = false;
+// "import a.b as c, d" and "from ..m import (f as g, h)"
+void ModuleWalker::handleImport(const std::vector<Token>& tokens, size_t begin, size_t end) {
+    size_t i = begin + 1;
+    auto dottedName = [&]() {
+        size_t start = i;
+        while (i < end && ((tokens[i].kind == TokenKind::Name && tokens[i].text != "import" && tokens[i].text != "as") ||
+                           tokens[i].text == "." || tokens[i].text == "...")) {
+            ++i;
+        }
+        return spanText(tokens, start, i);
+    };
+    auto alias = [&]() {
+        if (i + 1 < end && tokens[i].text == "as" && tokens[i + 1].kind == TokenKind::Name) {
+            i += 2;
+            return std::string(tokens[i - 1].text);
+        }
+        return std::string();
+    };
+    int line = tokens[begin].line;
+
+    if (tokens[begin].text == "import") {
+        while (i < end) {
+            std::string module = dottedName();
+            if (module.empty()) break;
+            imports.push_back({module, std::string(), alias(), line});
+            if (i < end && tokens[i].text != ",") break;
+            ++i;
         }
+        return;
     }
-    
-    return result;
-}
 
-std::vector<std::string> PythonParser::splitLines(const std::string& content) {
-    std::vector<std::string> lines;
-    std::stringstream ss(content);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        lines.push_back(line);
+    std::string module = dottedName();
+    if (i >= end || tokens[i].text != "import") return;
+    ++i;
+    while (i < end) {
+        if (tokens[i].kind != TokenKind::Name) {  // "(", ",", ")" and "*"
+            ++i;
+            continue;
+        }
+        std::string name(tokens[i++].text);
+        imports.push_back({module, name, alias(), line});
     }
-    
-    return lines;
 }
 
-std::string PythonParser::extractDocstring(const std::vector<std::string>& lines, int startLine) {
-    if (startLine >= (int)lines.size()) {
-        return "";
+void ModuleWalker::recordCalls(const std::vector<Token>& tokens, size_t begin, size_t end, int functionIndex) {
+    if (functionIndex < 0) return;  // module and class level code is not attributed
+
+    for (size_t i = begin; i + 1 < end; ++i) {
+        if (tokens[i].kind != TokenKind::Name || tokens[i + 1].text != "(") continue;
+        if (kNonCallNames.count(tokens[i].text)) continue;
+
+        size_t start = i;
+        while (start >= begin + 2 && tokens[start - 1].text == "." && tokens[start - 2].kind == TokenKind::Name) {
+            start -= 2;
+        }
+        std::string qualifier = start < i ? spanText(tokens, start, i - 1) : std::string();
+        calls.push_back({static_cast<size_t>(functionIndex), std::string(tokens[i].text), qualifier, tokens[i].line});
     }
-    
-    // Look for docstring starting after the function definition
-    for (int i = startLine; i < (int)lines.size(); ++i) {
-        const std::string& line = lines[i];
-        
-        if (isBlankOrComment(line)) {
-            continue;
+}
+
+std::vector<PythonParameter> ModuleWalker::parseParameters(const std::vector<Token>& tokens, size_t begin, size_t end) const {
+    std::vector<PythonParameter> parameters;
+    size_t start = begin;
+    int depth = 0;
+    for (size_t i = begin; i <= end; ++i) {
+        if (i < end) {
+            std::string_view text = tokens[i].text;
+            if (text == "(" || text == "[" || text == "{") ++depth;
+            if (text == ")" || text == "]" || text == "}") --depth;
+            if (!(text == "," && depth == 0)) continue;
         }
-        
-        // Check if this line contains a string literal (potential docstring)
-        QString qline = QString::fromStdString(line);
-        qline = qline.trimmed();
-        
-        if (qline.startsWith("\"\"\"") || qline.startsWith("'''")) {
-            // Found start of docstring
-            std::string docstring;
-            std::string delimiter = qline.startsWith("\"\"\"") ? "\"\"\"" : "'''";
-            
-            // Check if it's a single-line docstring
-            if (qline.endsWith(QString::fromStdString(delimiter)) && qline.length() > 6) {
-                docstring = qline.mid(3, qline.length() - 6).toStdString();
-                return docstring;
-            } else {
-                // Multi-line docstring
-                docstring = qline.mid(3).toStdString();
-                
-                for (int j = i + 1; j < (int)lines.size(); ++j) {
-                    const std::string& docLine = lines[j];
-                    QString qDocLine = QString::fromStdString(docLine);
-                    
-                    if (qDocLine.contains(QString::fromStdString(delimiter))) {
-                        // Found end of docstring
-                        int endPos = qDocLine.indexOf(QString::fromStdString(delimiter));
-                        if (endPos > 0) {
-                            docstring += "\n" + qDocLine.left(endPos).toStdString();
-                        }
-                        break;
-                    } else {
-                        docstring += "\n" + docLine;
-                    }
+
+        // name[: annotation][= default]; bare * and / only mark argument kinds
+        size_t nameEnd = start;
+        if (nameEnd < i && (tokens[nameEnd].text == "*" || tokens[nameEnd].text == "**")) ++nameEnd;
+        if (nameEnd < i && tokens[nameEnd].kind == TokenKind::Name) {
+            ++nameEnd;
+            PythonParameter parameter;
+            parameter.name = spanText(tokens, start, nameEnd);
+            size_t equals = i;
+            int nested = 0;
+            for (size_t k = nameEnd; k < i; ++k) {
+                std::string_view text = tokens[k].text;
+                if (text == "(" || text == "[" || text == "{") ++nested;
+                if (text == ")" || text == "]" || text == "}") --nested;
+                if (text == "=" && nested == 0) {
+                    equals = k;
+                    break;
                 }
-                
-                return docstring;
             }
-        } else {
-            // No docstring found
-            break;
+            if (nameEnd < equals && tokens[nameEnd].text == ":") {
+                parameter.type = spanText(tokens, nameEnd + 1, equals);
+            }
+            if (equals < i) {
+                parameter.defaultValue = spanText(tokens, equals + 1, i);
+            }
+            parameter.isOptional = !parameter.defaultValue.empty();
+            parameters.push_back(std::move(parameter));
         }
+        start = i + 1;
     }
-    
-    return "";
+    return parameters;
 }
 
-int PythonParser::getIndentLevel(const std::string& line) {
-    int indent = 0;
-    for (char c : line) {
-        if (c == ' ') {
-            indent++;
-        } else if (c == '\t') {
-            indent += 4; // Assume tab = 4 spaces
-        } else {
-            break;
+void ModuleWalker::addAttribute(size_t classIndex, std::string_view name) {
+    if (classAttributes_[classIndex].insert(std::string(name)).second) {
+        classes[classIndex].attributes.push_back(std::string(name));
+    }
+}
+
+// Methods are copied into their classes once their calls are known
+void ModuleWalker::finish() {
+    for (const RawCallSite& call : calls) {
+        functions[call.functionIndex].calledFunctions.push_back(call.callee);
+    }
+    for (size_t c = 0; c < classes.size(); ++c) {
+        for (size_t index : classMethods_[c]) {
+            classes[c].methods.push_back(functions[index]);
         }
     }
-    return indent;
 }
 
-bool PythonParser::isBlankOrComment(const std::string& line) {
-    QString qline = QString::fromStdString(line).trimmed();
-    return qline.isEmpty() || qline.startsWith("#");
+} // namespace
+
+PythonParser::PythonParser() : model_(SourceLanguage::Python) {
+}
+
+PythonParser::~PythonParser() {
+    clear();
+}
+
+bool PythonParser::parseFile(const std::string& content) {
+    return parseFile(SourceBuffer(content));
+}
+
+bool PythonParser::parseFile(const SourceBuffer& source) {
+    clear();
+
+    if (source.empty()) {
+        return false;
+    }
+
+    try {
+        LogicalLineReader reader(source);
+        ModuleWalker walker;
+        LogicalLine line;
+        while (reader.next(line)) {
+            walker.handle(line);
+        }
+        walker.finish();
+
+        functions_ = std::move(walker.functions);
+        classes_ = std::move(walker.classes);
+        imports_ = std::move(walker.imports);
+        callSites_.reserve(walker.calls.size());
+        for (RawCallSite& call : walker.calls) {
+            functionCalls_[functions_[call.functionIndex].name].push_back(call.callee);
+            callSites_.push_back({std::move(call.callee), std::move(call.qualifier), call.functionIndex, call.lineNumber});
+        }
+
+        buildCodeModel();
+
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
 }
 
 std::string PythonParser::getFunctionSignature(const PythonFunction& func) const {
     std::string signature;
-    
+
     if (func.isAsync) {
         signature += "async ";
     }
-    
+
     signature += "def " + func.name + "(";
-    
+
     for (size_t i = 0; i < func.parameters.size(); ++i) {
         if (i > 0) signature += ", ";
-        
+
         signature += func.parameters[i].name;
-        
+
         if (!func.parameters[i].type.empty()) {
             signature += ": " + func.parameters[i].type;
         }
-        
+
         if (!func.parameters[i].defaultValue.empty()) {
             signature += " = " + func.parameters[i].defaultValue;
         }
     }
-    
+
     signature += ")";
-    
+
     if (!func.returnType.empty()) {
         signature += " -> " + func.returnType;
     }
-    
+
     return signature;
 }
 
@@ -457,20 +668,43 @@ std::vector<std::string> PythonParser::getCalledFunctions(const std::string& fun
 }
 
 std::vector<std::string> PythonParser::getCallingFunctions(const std::string& functionName) const {
-    std::vector<std::string> callers;
-    
-    for (const auto& pair : functionCalls_) {
-        const auto& calledFunctions = pair.second;
-        if (std::find(calledFunctions.begin(), calledFunctions.end(), functionName) != calledFunctions.end()) {
-            callers.push_back(pair.first);
-        }
-    }
-    
-    return callers;
+    // Over the call graph, so a name also finds callers of its methods
+    return model_.getCallerNames(functionName);
 }
 
 void PythonParser::clear() {
     functions_.clear();
     classes_.clear();
+    callSites_.clear();
+    imports_.clear();
     functionCalls_.clear();
-} 
\ No newline at end of file
+    model_.clear();
+}
+
+void PythonParser::buildCodeModel() {
+    for (const PythonClass& cls : classes_) {
+        model_.addType({cls.name, "class", cls.baseClasses, cls.lineNumber});
+    }
+    for (const PythonFunction& func : functions_) {
+        CodeFunction function;
+        function.name = func.name;
+        function.container = func.className;
+        if (!func.className.empty() && !func.isStaticMethod && !func.parameters.empty()) {
+            function.receiver = func.parameters[0].name;
+        }
+        function.qualifiedName = func.qualifiedName;
+        function.returnType = func.returnType;
+        for (const PythonParameter& param : func.parameters) {
+            function.parameters.push_back({param.name, param.type, param.defaultValue});
+        }
+        function.signature = getFunctionSignature(func);
+        function.lineNumber = func.lineNumber;
+        model_.addFunction(std::move(function));
+    }
+    for (const PythonCallSite& call : callSites_) {
+        model_.addCall({call.callerIndex, call.callee, call.qualifier, call.lineNumber});
+    }
+    for (const PythonImport& imported : imports_) {
+        model_.addImport({imported.module, imported.name, imported.alias, imported.lineNumber});
+    }
+}
@@ -0,0 +1,260 @@
+#include "source_buffer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+bool isWordChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalnum(u) || c == '_' || u >= 0x80;
+}
+
+// Identifier characters immediately before offset
+std::string_view wordBefore(const std::string& text, size_t offset) {
+    size_t start = offset;
+    while (start > 0 && isWordChar(text[start - 1])) --start;
+    return std::string_view(text).substr(start, offset - start);
+}
+
+class MaskBuilder {
+public:
+    MaskBuilder(const std::string& text, std::string& code, std::vector<SourceMask::Range>& comments)
+        : text_(text), code_(code), comments_(comments), size_(text.size()) {}
+
+    void run(SourceLanguage language);
+
+private:
+    // Blanks [begin, end); line breaks stay unless the range is a literal
+    void blank(size_t begin, size_t end, bool keepLineBreaks) {
+        if (begin >= end) return;
+        if (!keepLineBreaks) {
+            std::memset(&code_[begin], ' ', end - begin);
+            return;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            if (code_[i] != '\n' && code_[i] != '\r') code_[i] = ' ';
+        }
+    }
+    // A literal whose opening quote is at open and whose closing quote ends
+    // just before end (or which is unterminated, when end is not past a quote)
+    void literal(size_t open, size_t end, bool terminated) {
+        blank(open + 1, terminated ? end - 1 : end, false);
+    }
+
+    size_t lineComment(size_t i);
+    size_t blockComment(size_t i);
+    size_t quoted(size_t i, bool multiLine);
+    size_t tripleQuoted(size_t i);
+    size_t rawCppString(size_t i);
+    size_t directive(size_t i);
+
+    const std::string& text_;
+    std::string& code_;
+    std::vector<SourceMask::Range>& comments_;
+    size_t size_;
+};
+
+size_t MaskBuilder::lineComment(size_t i) {
+    const void* newline = std::memchr(text_.data() + i, '\n', size_ - i);
+    size_t end = newline ? static_cast<const char*>(newline) - text_.data() : size_;
+    size_t last = end > i && text_[end - 1] == '\r' ? end - 1 : end;
+    blank(i, last, false);
+    comments_.emplace_back(i, end);
+    return end;
+}
+
+size_t MaskBuilder::blockComment(size_t i) {
+    size_t close = text_.find("*/", i + 2);
+    size_t end = close == std::string::npos ? size_ : close + 2;
+    blank(i, end, true);
+    comments_.emplace_back(i, end);
+    return end;
+}
+
+// Single-quoted or double-quoted literal with backslash escapes; it ends at
+// the line break unless multiLine (a Go raw string has no escapes either)
+size_t MaskBuilder::quoted(size_t i, bool multiLine) {
+    char quote = text_[i];
+    bool escapes = quote != '`';
+    size_t j = i + 1;
+    while (j < size_ && text_[j] != quote) {
+        if (text_[j] == '\n' && !multiLine) {
+            literal(i, j, false);
+            return j;
+        }
+        j += escapes && text_[j] == '\\' && j + 1 < size_ ? 2 : 1;
+    }
+    if (j >= size_) {
+        literal(i, size_, false);
+        return size_;
+    }
+    literal(i, j + 1, true);
+    return j + 1;
+}
+
+size_t MaskBuilder::tripleQuoted(size_t i) {
+    char quote = text_[i];
+    size_t j = i + 3;
+    while (j < size_) {
+        if (text_[j] == '\\' && j + 1 < size_) {
+            j += 2;
+            continue;
+        }
+        if (text_[j] == quote && j + 2 < size_ && text_[j + 1] == quote && text_[j + 2] == quote) {
+            literal(i, j + 3, true);
+            return j + 3;
+        }
+        ++j;
+    }
+    literal(i, size_, false);
+    return size_;
+}
+
+// R"delim( ... )delim" with i at the quote
+size_t MaskBuilder::rawCppString(size_t i) {
+    size_t paren = i + 1;
+    while (paren < size_ && paren - i <= 17 && text_[paren] != '(' && text_[paren] != '\n') ++paren;
+    if (paren >= size_ || text_[paren] != '(') return quoted(i, false);
+    std::string terminator = ")" + text_.substr(i + 1, paren - i - 1) + "\"";
+    size_t close = text_.find(terminator, paren + 1);
+    if (close == std::string::npos) {
+        literal(i, size_, false);
+        return size_;
+    }
+    size_t end = close + terminator.size();
+    literal(i, end, true);
+    return end;
+}
+
+// Preprocessor directive with backslash continuations and embedded comments
+size_t MaskBuilder::directive(size_t i) {
+    size_t j = i;
+    while (j < size_ && text_[j] != '\n') {
+        if (text_[j] == '\\' && j + 1 < size_ && (text_[j + 1] == '\n' || text_[j + 1] == '\r')) {
+            j += text_[j + 1] == '\r' && j + 2 < size_ && text_[j + 2] == '\n' ? 3 : 2;
+            continue;
+        }
+        if (text_[j] == '/' && j + 1 < size_ && text_[j + 1] == '*') {
+            blank(i, j, true);
+            i = j = blockComment(j);
+            continue;
+        }
+        if (text_[j] == '/' && j + 1 < size_ && text_[j + 1] == '/') {
+            blank(i, j, true);
+            return lineComment(j);
+        }
+        ++j;
+    }
+    blank(i, j, true);
+    return j;
+}
+
+void MaskBuilder::run(SourceLanguage language) {
+    bool lineStart = true;
+    size_t i = 0;
+    while (i < size_) {
+        char c = text_[i];
+        if (c == '\n') {
+            lineStart = true;
+            ++i;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            ++i;
+            continue;
+        }
+        bool atLineStart = lineStart;
+        lineStart = false;
+
+        if (language == SourceLanguage::Python) {
+            if (c == '#') {
+                i = lineComment(i);
+            } else if (c == '"' || c == '\'') {
+                bool triple = i + 2 < size_ && text_[i + 1] == c && text_[i + 2] == c;
+                i = triple ? tripleQuoted(i) : quoted(i, false);
+            } else {
+                ++i;
+            }
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size_ && text_[i + 1] == '/') {
+            i = lineComment(i);
+        } else if (c == '/' && i + 1 < size_ && text_[i + 1] == '*') {
+            i = blockComment(i);
+        } else if (language == SourceLanguage::Go) {
+            i = c == '"' || c == '\'' ? quoted(i, false) : c == '`' ? quoted(i, true) : i + 1;
+        } else if (c == '#' && atLineStart) {
+            i = directive(i);
+        } else if (c == '"') {
+            std::string_view prefix = wordBefore(text_, i);
+            bool raw = !prefix.empty() && prefix.back() == 'R' &&
+                       (prefix == "R" || prefix == "LR" || prefix == "uR" || prefix == "UR" || prefix == "u8R");
+            i = raw ? rawCppString(i) : quoted(i, false);
+        } else if (c == '\'') {
+            // After a digit or letter this is a digit separator (1'000'000),
+            // unless the letters are a character literal prefix
+            std::string_view prefix = wordBefore(text_, i);
+            bool literalPrefix = prefix == "L" || prefix == "u" || prefix == "U" || prefix == "u8";
+            i = prefix.empty() || literalPrefix ? quoted(i, false) : i + 1;
+        } else {
+            ++i;
+        }
+    }
+}
+
+} // namespace
+
+SourceBuffer::SourceBuffer() : SourceBuffer(std::string()) {
+}
+
+SourceBuffer::SourceBuffer(std::string text)
+    : text_(std::make_shared<const std::string>(std::move(text))) {
+    // memchr is vectorised by the C library, so the index costs little more
+    // than reading the text once
+    auto starts = std::make_shared<std::vector<size_t>>();
+    starts->reserve(text_->size() / 32 + 1);
+    starts->push_back(0);
+    const char* data = text_->data();
+    size_t size = text_->size();
+    size_t pos = 0;
+    while (pos < size) {
+        const void* hit = std::memchr(data + pos, '\n', size - pos);
+        if (!hit) break;
+        pos = static_cast<const char*>(hit) - data + 1;
+        starts->push_back(pos);
+    }
+    lineStarts_ = std::move(starts);
+}
+
+int SourceBuffer::lineAt(size_t offset) const {
+    auto it = std::upper_bound(lineStarts_->begin(), lineStarts_->end(), offset);
+    return static_cast<int>(it - lineStarts_->begin());
+}
+
+size_t SourceBuffer::lineStart(int line) const {
+    if (line < 1) return 0;
+    if (static_cast<size_t>(line) > lineStarts_->size()) return size();
+    return (*lineStarts_)[line - 1];
+}
+
+std::string_view SourceBuffer::line(int line) const {
+    if (line < 1 || static_cast<size_t>(line) > lineStarts_->size()) return {};
+    size_t begin = (*lineStarts_)[line - 1];
+    size_t end = static_cast<size_t>(line) < lineStarts_->size() ? (*lineStarts_)[line] - 1 : size();
+    if (end > begin && (*text_)[end - 1] == '\r') --end;
+    return view().substr(begin, end - begin);
+}
+
+int LineCursor::lineAt(size_t offset) {
+    while (static_cast<size_t>(line_) < source_.lineCount() && source_.lineStart(line_ + 1) <= offset) {
+        ++line_;
+    }
+    return line_;
+}
+
+SourceMask::SourceMask(const SourceBuffer& source, SourceLanguage language)
+    : code_(source.text()) {
+    MaskBuilder(source.text(), code_, comments_).run(language);
+}
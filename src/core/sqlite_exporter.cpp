@@ -0,0 +1,323 @@
+#include "sqlite_exporter.h"
+#include "xml_stream_reader.h"
+#include "xml_record_builder.h"
+#include "compressed_stream.h"
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+#include <sqlite3.h>
+
+namespace {
+
+std::string quoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (char c : name) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+// SQLite compares column names case-insensitively (ASCII only)
+std::string foldCase(const std::string& name) {
+    std::string folded = name;
+    for (char& c : folded) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return folded;
+}
+
+const char* const kKeyColumn = "_id";
+
+} // namespace
+
+struct SqliteExporter::Table {
+    std::string name;
+    std::vector<std::string> columns;                   // SQL column names, in insert order
+    std::unordered_map<std::string, int> fieldColumns;  // record field -> index into columns
+    std::unordered_set<std::string> foldedColumns;      // for case-insensitive clashes
+    sqlite3_stmt* insert = nullptr;
+};
+
+SqliteExporter::SqliteExporter()
+    : batchSize_(kDefaultBatchSize), replaceTables_(true), db_(nullptr), rowsInBatch_(0),
+      nextProgress_(0), bytesRead_(0), recordCount_(0) {
+}
+
+SqliteExporter::~SqliteExporter() {
+    close();
+}
+
+bool SqliteExporter::exportFile(const std::string& inputPath, const std::string& databasePath) {
+    CompressedInputStream input(inputPath);
+    if (!input.isOpen()) {
+        errorMessage_ = input.getErrorMessage();
+        return false;
+    }
+
+    // Report the position in the compressed file so progress matches its size
+    ProgressCallback callback = progressCallback_;
+    if (callback && input.compression() != CompressionType::None) {
+        progressCallback_ = [&input, &callback](uint64_t) {
+            return callback(input.compressedBytesRead());
+        };
+    }
+
+    bool ok = exportStream(input, databasePath);
+    progressCallback_ = callback;
+    if (input.hasError()) {
+        errorMessage_ = input.getErrorMessage();
+        ok = false;
+    }
+    return ok;
+}
+
+bool SqliteExporter::exportStream(std::istream& input, const std::string& databasePath) {
+    errorMessage_.clear();
+    nextProgress_ = kProgressInterval;
+    bytesRead_ = 0;
+    recordCount_ = 0;
+
+    if (!open(databasePath)) {
+        close();
+        return false;
+    }
+
+    XmlStreamReader reader(input);
+    XmlRecordBuilder record(config_);
+    bool rootSeen = false;
+    bool ok = true;
+
+    while (ok) {
+        XmlStreamReader::TokenType token = reader.next();
+        if (token == XmlStreamReader::TokenType::Error) {
+            ok = fail(reader.getErrorMessage());
+            break;
+        }
+        if (token == XmlStreamReader::TokenType::EndDocument) {
+            break;
+        }
+
+        switch (token) {
+            case XmlStreamReader::TokenType::StartElement:
+                if (reader.depth() == 0) {
+                    if (rootSeen) {
+                        ok = fail("Multiple root elements (line " + std::to_string(reader.lineNumber()) + ")");
+                        break;
+                    }
+                    rootSeen = true;
+                }
+                record.startElement(reader);
+                break;
+            case XmlStreamReader::TokenType::EndElement:
+                if (record.endElement()) {
+                    ok = insertRecord(record.recordName(), record.fields());
+                }
+                break;
+            case XmlStreamReader::TokenType::Text:
+            case XmlStreamReader::TokenType::CData:
+                record.characters(reader);
+                break;
+            default:
+                break;
+        }
+
+        ok = ok && reportProgress(reader.bytesConsumed());
+    }
+
+    if (ok && !rootSeen) {
+        ok = fail("No root element found");
+    }
+    bytesRead_ = reader.bytesConsumed();
+
+    if (ok) {
+        ok = execute("COMMIT");
+    } else {
+        sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+    close();
+    return ok;
+}
+
+bool SqliteExporter::open(const std::string& databasePath) {
+    tables_.clear();
+    rowsInBatch_ = 0;
+
+    int rc = sqlite3_open_v2(databasePath.c_str(), &db_,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        return fail("Cannot open database " + databasePath + ": " +
+                    (db_ ? sqlite3_errmsg(db_) : sqlite3_errstr(rc)));
+    }
+
+    // WAL keeps readers unblocked and turns each commit into a sequential
+    // append; NORMAL sync is still crash-safe in WAL mode
+    return execute("PRAGMA journal_mode=WAL") &&
+           execute("PRAGMA synchronous=NORMAL") &&
+           execute("PRAGMA temp_store=MEMORY") &&
+           execute("PRAGMA cache_size=-65536") &&
+           execute("BEGIN");
+}
+
+void SqliteExporter::close() {
+    for (auto& table : tables_) {
+        sqlite3_finalize(table->insert);
+        table->insert = nullptr;
+    }
+    if (db_) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+bool SqliteExporter::execute(const char* sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &message) != SQLITE_OK) {
+        std::string error = message ? message : sqlite3_errmsg(db_);
+        sqlite3_free(message);
+        return fail(error);
+    }
+    return true;
+}
+
+bool SqliteExporter::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message;
+    }
+    return false;
+}
+
+SqliteExporter::Table* SqliteExporter::tableFor(const std::string& name) {
+    // Records of one kind usually come in runs, and documents have few kinds
+    for (auto& table : tables_) {
+        if (table->name == name) return table.get();
+    }
+
+    auto table = std::make_unique<Table>();
+    table->name = name;
+    table->foldedColumns.insert(kKeyColumn);
+
+    const std::string quoted = quoteIdentifier(name);
+    if (replaceTables_ && !execute(("DROP TABLE IF EXISTS " + quoted).c_str())) {
+        return nullptr;
+    }
+    if (!execute(("CREATE TABLE IF NOT EXISTS " + quoted + " (" + kKeyColumn +
+                  " INTEGER PRIMARY KEY)").c_str())) {
+        return nullptr;
+    }
+
+    if (!replaceTables_) {
+        // Appending: pick up the columns of an existing table
+        sqlite3_stmt* info = nullptr;
+        if (sqlite3_prepare_v2(db_, ("PRAGMA table_info(" + quoted + ")").c_str(), -1, &info, nullptr) != SQLITE_OK) {
+            fail(sqlite3_errmsg(db_));
+            return nullptr;
+        }
+        while (sqlite3_step(info) == SQLITE_ROW) {
+            std::string column = reinterpret_cast<const char*>(sqlite3_column_text(info, 1));
+            if (foldCase(column) == kKeyColumn) continue;
+            table->fieldColumns.emplace(column, static_cast<int>(table->columns.size()));
+            table->foldedColumns.insert(foldCase(column));
+            table->columns.push_back(column);
+        }
+        sqlite3_finalize(info);
+    }
+
+    tables_.push_back(std::move(table));
+    return tables_.back().get();
+}
+
+bool SqliteExporter::addColumn(Table& table, const std::string& field) {
+    // "Name" and "name" are distinct XML fields but clash as SQLite columns
+    std::string column = field;
+    for (int suffix = 2; table.foldedColumns.count(foldCase(column)); ++suffix) {
+        column = field + "_" + std::to_string(suffix);
+    }
+
+    // The insert statement changes shape; drop it before altering the table
+    sqlite3_finalize(table.insert);
+    table.insert = nullptr;
+
+    if (!execute(("ALTER TABLE " + quoteIdentifier(table.name) + " ADD COLUMN " +
+                  quoteIdentifier(column) + " TEXT").c_str())) {
+        return false;
+    }
+    table.fieldColumns.emplace(field, static_cast<int>(table.columns.size()));
+    table.foldedColumns.insert(foldCase(column));
+    table.columns.push_back(column);
+    return true;
+}
+
+bool SqliteExporter::prepareInsert(Table& table) {
+    std::string sql = "INSERT INTO " + quoteIdentifier(table.name);
+    if (table.columns.empty()) {
+        sql += " DEFAULT VALUES";
+    } else {
+        std::string values;
+        sql += " (";
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            if (i > 0) {
+                sql += ", ";
+                values += ", ";
+            }
+            sql += quoteIdentifier(table.columns[i]);
+            values += '?';
+        }
+        sql += ") VALUES (" + values + ")";
+    }
+
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &table.insert, nullptr) != SQLITE_OK) {
+        return fail(sqlite3_errmsg(db_));
+    }
+    return true;
+}
+
+bool SqliteExporter::insertRecord(const std::string& name,
+                                  const std::vector<std::pair<std::string, std::string>>& fields) {
+    Table* table = tableFor(name);
+    if (!table) return false;
+
+    for (const auto& field : fields) {
+        if (!table->fieldColumns.count(field.first) && !addColumn(*table, field.first)) {
+            return false;
+        }
+    }
+    if (!table->insert && !prepareInsert(*table)) {
+        return false;
+    }
+
+    // Unbound parameters stay NULL, so missing fields need no work. The field
+    // strings outlive the step, so SQLite does not have to copy them.
+    sqlite3_stmt* insert = table->insert;
+    for (const auto& field : fields) {
+        int column = table->fieldColumns.find(field.first)->second;
+        sqlite3_bind_text(insert, column + 1, field.second.data(),
+                          static_cast<int>(field.second.size()), SQLITE_STATIC);
+    }
+    int rc = sqlite3_step(insert);
+    sqlite3_reset(insert);
+    sqlite3_clear_bindings(insert);
+    if (rc != SQLITE_DONE) {
+        return fail("Insert into " + name + " failed: " + sqlite3_errmsg(db_));
+    }
+
+    ++recordCount_;
+    if (++rowsInBatch_ >= batchSize_) {
+        rowsInBatch_ = 0;
+        return execute("COMMIT") && execute("BEGIN");
+    }
+    return true;
+}
+
+bool SqliteExporter::reportProgress(uint64_t bytesRead) {
+    bytesRead_ = bytesRead;
+    if (bytesRead < nextProgress_) {
+        return true;
+    }
+    nextProgress_ = bytesRead + kProgressInterval;
+    if (progressCallback_ && !progressCallback_(bytesRead)) {
+        return fail("Export cancelled");
+    }
+    return true;
+}
@@ -0,0 +1,360 @@
+#include "symbol_cache.h"
+#include "cache_directory.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Cache file layout: magic, file count, payload size, then one record per
+// file: path, metadata, model size and the model. Strings are a uint32 length
+// and the bytes.
+const char kMagic[8] = {'N', 'X', 'S', 'Y', 'M', '0', '0', '3'};
+constexpr size_t kHeaderBytes = sizeof(kMagic) + 2 * sizeof(uint64_t);
+// Record without path bytes or model: path length, language, size, time,
+// hash, parsed flag and model size
+constexpr size_t kMinimumRecordBytes = 4 + 1 + 8 + 8 + 8 + 1 + 8;
+
+constexpr uint64_t kHashMultiplier = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t kHashMixer = 0xFF51AFD7ED558CCDULL;
+
+uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= kHashMixer;
+    value ^= value >> 33;
+    return value;
+}
+
+template <typename T>
+void append(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& text) {
+    append<uint32_t>(out, static_cast<uint32_t>(text.size()));
+    out += text;
+}
+
+void appendModel(std::string& out, const CodeModel& model) {
+    append<uint32_t>(out, static_cast<uint32_t>(model.getTypes().size()));
+    for (const CodeType& type : model.getTypes()) {
+        appendString(out, type.name);
+        appendString(out, type.kind);
+        append<uint32_t>(out, static_cast<uint32_t>(type.baseTypes.size()));
+        for (const std::string& base : type.baseTypes) appendString(out, base);
+        append<int32_t>(out, type.lineNumber);
+    }
+    append<uint32_t>(out, static_cast<uint32_t>(model.getFunctions().size()));
+    for (const CodeFunction& function : model.getFunctions()) {
+        appendString(out, function.name);
+        appendString(out, function.container);
+        appendString(out, function.receiver);
+        appendString(out, function.qualifiedName);
+        appendString(out, function.returnType);
+        append<uint32_t>(out, static_cast<uint32_t>(function.parameters.size()));
+        for (const CodeParameter& param : function.parameters) {
+            appendString(out, param.name);
+            appendString(out, param.type);
+            appendString(out, param.defaultValue);
+        }
+        appendString(out, function.signature);
+        append<int32_t>(out, function.lineNumber);
+    }
+    append<uint32_t>(out, static_cast<uint32_t>(model.getCalls().size()));
+    for (const CodeCall& call : model.getCalls()) {
+        append<uint32_t>(out, static_cast<uint32_t>(call.callerIndex));
+        appendString(out, call.callee);
+        appendString(out, call.qualifier);
+        append<int32_t>(out, call.lineNumber);
+        append<int32_t>(out, call.argumentCount);
+    }
+    append<uint32_t>(out, static_cast<uint32_t>(model.getImports().size()));
+    for (const CodeImport& imported : model.getImports()) {
+        appendString(out, imported.module);
+        appendString(out, imported.name);
+        appendString(out, imported.alias);
+        append<int32_t>(out, imported.lineNumber);
+    }
+}
+
+} // namespace
+
+// Bounds-checked decoding from the mapping; after the first overrun every
+// read yields zero and ok() stays false
+class SymbolCache::Reader {
+public:
+    Reader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return p_ == end_; }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!ok_ || static_cast<size_t>(end_ - p_) < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return value;
+    }
+
+    // Bytes in the mapping, valid as long as it is
+    std::string_view readView(size_t length) {
+        if (!ok_ || static_cast<size_t>(end_ - p_) < length) {
+            ok_ = false;
+            return std::string_view();
+        }
+        std::string_view bytes(p_, length);
+        p_ += length;
+        return bytes;
+    }
+
+    std::string_view readStringView() { return readView(read<uint32_t>()); }
+    std::string readString() { return std::string(readStringView()); }
+
+    // Counts are checked against the bytes left so a corrupt file cannot
+    // make the decoder reserve huge vectors
+    uint32_t readCount(size_t minimumItemBytes) {
+        uint32_t count = read<uint32_t>();
+        if (ok_ && static_cast<uint64_t>(count) * minimumItemBytes > static_cast<uint64_t>(end_ - p_)) {
+            ok_ = false;
+            return 0;
+        }
+        return count;
+    }
+
+    void readModel(CodeModel& model) {
+        uint32_t typeCount = readCount(16);
+        for (uint32_t i = 0; ok_ && i < typeCount; ++i) {
+            CodeType type;
+            type.name = readString();
+            type.kind = readString();
+            uint32_t baseCount = readCount(4);
+            for (uint32_t b = 0; ok_ && b < baseCount; ++b) type.baseTypes.push_back(readString());
+            type.lineNumber = read<int32_t>();
+            model.addType(std::move(type));
+        }
+        uint32_t functionCount = readCount(32);
+        for (uint32_t i = 0; ok_ && i < functionCount; ++i) {
+            CodeFunction function;
+            function.name = readString();
+            function.container = readString();
+            function.receiver = readString();
+            function.qualifiedName = readString();
+            function.returnType = readString();
+            uint32_t paramCount = readCount(12);
+            function.parameters.reserve(paramCount);
+            for (uint32_t k = 0; ok_ && k < paramCount; ++k) {
+                CodeParameter param;
+                param.name = readString();
+                param.type = readString();
+                param.defaultValue = readString();
+                function.parameters.push_back(std::move(param));
+            }
+            function.signature = readString();
+            function.lineNumber = read<int32_t>();
+            model.addFunction(std::move(function));
+        }
+        uint32_t callCount = readCount(20);
+        for (uint32_t i = 0; ok_ && i < callCount; ++i) {
+            CodeCall call;
+            call.callerIndex = read<uint32_t>();
+            call.callee = readString();
+            call.qualifier = readString();
+            call.lineNumber = read<int32_t>();
+            call.argumentCount = read<int32_t>();
+            if (call.callerIndex >= model.getFunctions().size()) {
+                ok_ = false;
+                break;
+            }
+            model.addCall(std::move(call));
+        }
+        uint32_t importCount = readCount(16);
+        for (uint32_t i = 0; ok_ && i < importCount; ++i) {
+            CodeImport imported;
+            imported.module = readString();
+            imported.name = readString();
+            imported.alias = readString();
+            imported.lineNumber = read<int32_t>();
+            model.addImport(std::move(imported));
+        }
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+    bool ok_ = true;
+};
+
+SymbolCache::SymbolCache() {
+}
+
+bool SymbolCache::fail(const std::string& message) {
+    errorMessage_ = message;
+    return false;
+}
+
+void SymbolCache::clear() {
+    entries_.clear();
+    byPath_.clear();
+    file_.close();
+    errorMessage_.clear();
+}
+
+const SymbolCache::Entry* SymbolCache::find(std::string_view path) const {
+    auto it = byPath_.find(path);
+    return it == byPath_.end() ? nullptr : &entries_[it->second];
+}
+
+bool SymbolCache::readModel(const Entry& entry, CodeModel& model) const {
+    model = CodeModel(entry.language);
+    Reader reader(file_.data() + entry.modelOffset, entry.modelBytes);
+    reader.readModel(model);
+    if (!reader.ok() || !reader.atEnd()) {
+        model.clear();
+        return false;
+    }
+    return true;
+}
+
+bool SymbolCache::load(const std::string& cachePath) {
+    clear();
+
+    std::error_code error;
+    fs::file_status status = fs::status(fs::u8path(cachePath), error);
+    if (!fs::exists(status)) {
+        return true;
+    }
+    if (!fs::is_regular_file(status)) {
+        return fail("Not a symbol cache: " + cachePath);
+    }
+    if (!file_.open(cachePath)) {
+        return fail(file_.getErrorMessage());
+    }
+
+    // Nothing in the file is trusted until its header and the bounds of every
+    // record have been checked against the mapping
+    Reader header(file_.data(), file_.size());
+    std::string_view magic = header.readView(sizeof(kMagic));
+    uint64_t fileCount = header.read<uint64_t>();
+    uint64_t payloadBytes = header.read<uint64_t>();
+    if (!header.ok() || magic != std::string_view(kMagic, sizeof(kMagic)) ||
+        payloadBytes != file_.size() - kHeaderBytes || fileCount > payloadBytes / kMinimumRecordBytes) {
+        file_.close();
+        return fail("Not a symbol cache or truncated: " + cachePath);
+    }
+
+    Reader reader(file_.data() + kHeaderBytes, static_cast<size_t>(payloadBytes));
+    entries_.reserve(static_cast<size_t>(fileCount));
+    for (uint64_t i = 0; reader.ok() && i < fileCount; ++i) {
+        Entry entry;
+        entry.path = reader.readStringView();
+        uint8_t language = reader.read<uint8_t>();
+        entry.language = static_cast<SourceLanguage>(language);
+        entry.size = reader.read<uint64_t>();
+        entry.modifiedTime = reader.read<int64_t>();
+        entry.contentHash = reader.read<uint64_t>();
+        entry.parsed = reader.read<uint8_t>() != 0;
+        uint64_t modelBytes = reader.read<uint64_t>();
+        if (language > static_cast<uint8_t>(SourceLanguage::Go) || modelBytes > payloadBytes) {
+            break;
+        }
+        const char* model = reader.readView(static_cast<size_t>(modelBytes)).data();
+        entry.modelOffset = static_cast<size_t>(model - file_.data());
+        entry.modelBytes = static_cast<size_t>(modelBytes);
+        entries_.push_back(entry);
+    }
+    if (!reader.ok() || entries_.size() != fileCount || !reader.atEnd()) {
+        clear();
+        return fail("Corrupt symbol cache: " + cachePath);
+    }
+
+    byPath_.reserve(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        byPath_.emplace(entries_[i].path, i);
+    }
+    return true;
+}
+
+bool SymbolCache::save(const std::string& cachePath, const std::vector<IndexedFile>& files) {
+    clear();
+
+    std::string payload;
+    std::string model;
+    for (const IndexedFile& file : files) {
+        appendString(payload, file.path);
+        append<uint8_t>(payload, static_cast<uint8_t>(file.language));
+        append<uint64_t>(payload, file.size);
+        append<int64_t>(payload, file.modifiedTime);
+        append<uint64_t>(payload, file.contentHash);
+        append<uint8_t>(payload, file.parsed ? 1 : 0);
+        model.clear();
+        appendModel(model, file.model);
+        append<uint64_t>(payload, model.size());
+        payload += model;
+    }
+
+    // A directory the cache creates is private to the user
+    std::error_code error;
+    fs::path target = fs::u8path(cachePath);
+    if (target.has_parent_path() && fs::create_directories(target.parent_path(), error)) {
+        fs::permissions(target.parent_path(), fs::perms::owner_all, error);
+    }
+    fs::path temporary = target;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(kMagic, sizeof(kMagic));
+        uint64_t fileCount = files.size();
+        uint64_t payloadBytes = payload.size();
+        out.write(reinterpret_cast<const char*>(&fileCount), sizeof(fileCount));
+        out.write(reinterpret_cast<const char*>(&payloadBytes), sizeof(payloadBytes));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!out.flush()) {
+            out.close();
+            fs::remove(temporary, error);
+            return fail("Cannot write symbol cache " + cachePath);
+        }
+    }
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return fail("Cannot replace symbol cache " + cachePath);
+    }
+    return true;
+}
+
+std::string SymbolCache::defaultCachePath(const std::string& rootPath) {
+    std::error_code error;
+    fs::path cache = userCacheDirectory("index");
+    fs::path absolute = fs::absolute(fs::u8path(rootPath), error).lexically_normal();
+    std::string name = absolute.filename().u8string();
+    if (name.empty()) name = absolute.parent_path().filename().u8string();
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx",
+                  static_cast<unsigned long long>(std::hash<std::string>()(absolute.u8string())));
+    return (cache / (name + "-" + hash + ".nxsym")).u8string();
+}
+
+uint64_t SymbolCache::hashContent(const char* data, size_t size) {
+    uint64_t hash = mix(size * kHashMultiplier + 1);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ mix(word)) * kHashMultiplier;
+        hash = (hash << 31) | (hash >> 33);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, size - i);
+        hash = (hash ^ mix(word)) * kHashMultiplier;
+    }
+    return mix(hash);
+}
@@ -0,0 +1,460 @@
+#include "symbol_table.h"
+#include <algorithm>
+
+namespace {
+
+// Between a container type and a name in member keys
+constexpr std::string_view kScopeSeparator("\0", 1);
+
+// Leads member and type keys, so a call never resolves into another language
+std::string_view languageKey(SourceLanguage language) {
+    switch (language) {
+        case SourceLanguage::Cpp: return "c";
+        case SourceLanguage::Python: return "p";
+        case SourceLanguage::Go: return "g";
+    }
+    return "";
+}
+
+// Go names are package scoped, so Go keys lead with the directory
+uint64_t memberKey(SourceLanguage language, std::string_view package, std::string_view scope, std::string_view name) {
+    return SymbolTable::hashName({languageKey(language), package, kScopeSeparator, scope, kScopeSeparator, name});
+}
+
+bool equalsParts(const std::string& text, std::initializer_list<std::string_view> parts) {
+    size_t offset = 0;
+    for (std::string_view part : parts) {
+        if (text.compare(offset, part.size(), part) != 0) return false;
+        offset += part.size();
+    }
+    return offset == text.size();
+}
+
+// Python module of "from ..a import b" or "import a.b", without the dots
+std::string absoluteModule(const std::string& module, const std::string& name) {
+    size_t start = module.find_first_not_of('.');
+    std::string base = start == std::string::npos ? std::string() : module.substr(start);
+    if (name.empty()) return base;
+    return base.empty() ? name : base + "." + name;
+}
+
+} // namespace
+
+SymbolTable::SymbolTable() {
+}
+
+void SymbolTable::clear() {
+    files_.clear();
+    byName_.clear();
+    byMember_.clear();
+    byQualified_.clear();
+    types_.clear();
+    modules_.clear();
+    methodOwners_.clear();
+    overloads_.clear();
+}
+
+void SymbolTable::reserve(size_t functionCount) {
+    byName_.reserve(functionCount);
+    byMember_.reserve(functionCount);
+    byQualified_.reserve(functionCount);
+}
+
+uint64_t SymbolTable::hashName(std::initializer_list<std::string_view> parts) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::string_view part : parts) {
+        for (char c : part) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+uint32_t SymbolTable::addFile(const std::string& path, const CodeModel& model) {
+    uint32_t file = static_cast<uint32_t>(files_.size());
+    files_.emplace_back();
+    File& entry = files_.back();
+    entry.path = path;
+    entry.model = &model;
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos) entry.directory = path.substr(0, slash);
+
+    char separator = '.';
+    if (model.getLanguage() == SourceLanguage::Python && !path.empty()) {
+        // "pkg/mod.py" is pkg.mod and "pkg/__init__.py" is pkg
+        std::string module = path;
+        size_t extension = module.rfind('.');
+        if (extension != std::string::npos && (slash == std::string::npos || extension > slash)) {
+            module.erase(extension);
+        }
+        std::replace(module.begin(), module.end(), '/', '.');
+        if (module == "__init__") {
+            module.clear();
+        } else if (module.size() > 9 && module.compare(module.size() - 9, 9, ".__init__") == 0) {
+            module.erase(module.size() - 9);
+        }
+        entry.module = module;
+    } else if (model.getLanguage() == SourceLanguage::Go) {
+        entry.module = entry.directory;
+        separator = '/';
+    }
+
+    // Every trailing part, since imports name modules from a root that is
+    // not necessarily the project's
+    if (!entry.module.empty()) {
+        std::string_view module = entry.module;
+        for (size_t start = 0;;) {
+            modules_[hashName({languageKey(model.getLanguage()), module.substr(start)})].push_back(file);
+            size_t next = module.find(separator, start);
+            if (next == std::string_view::npos) break;
+            start = next + 1;
+        }
+    }
+
+    std::string_view language = languageKey(model.getLanguage());
+    const bool isGo = model.getLanguage() == SourceLanguage::Go;
+    std::string_view package = isGo ? std::string_view(entry.directory) : std::string_view();
+    const auto& functions = model.getFunctions();
+    for (uint32_t i = 0; i < functions.size(); ++i) {
+        const CodeFunction& function = functions[i];
+        SymbolLocation location{file, i};
+        byName_[hashName({function.name})].push_back(location);
+        uint64_t member = memberKey(model.getLanguage(), package, CodeModel::getTypeName(function.container), function.name);
+        byMember_[member].push_back(location);
+        byQualified_[hashName({function.qualifiedName})].push_back(location);
+
+        // Kept up to date here so that neither question scans all the
+        // definitions of a common name ("size", "operator==") per call
+        if (!function.container.empty()) {
+            auto owner = methodOwners_.emplace(hashName({language, function.name}), Shared{location, false});
+            const CodeFunction& first = getFunction(owner.first->second.first);
+            if (first.name != function.name || CodeModel::getTypeName(first.container) != CodeModel::getTypeName(function.container) ||
+                (isGo && files_[owner.first->second.first.file].directory != entry.directory)) {
+                owner.first->second.shared = true;
+            }
+        }
+        if (model.getLanguage() == SourceLanguage::Cpp) {
+            auto overload = overloads_.emplace(hashName({function.qualifiedName}), Shared{location, false});
+            const CodeFunction& first = getFunction(overload.first->second.first);
+            if (first.qualifiedName == function.qualifiedName && !CodeModel::sameParameterTypes(first, function)) {
+                overload.first->second.shared = true;
+            }
+        }
+    }
+    // A class may be defined in many files (or declared again); its bases
+    // are merged so walking them does not depend on how often
+    for (const CodeType& type : model.getTypes()) {
+        TypeBases& entry = types_[hashName({language, type.name})];
+        if (entry.name.empty()) {
+            entry.name = type.name;
+        } else if (entry.name != type.name) {
+            continue;
+        }
+        for (const std::string& base : type.baseTypes) {
+            std::string_view baseName = CodeModel::getTypeName(base);
+            if (std::find(entry.bases.begin(), entry.bases.end(), baseName) == entry.bases.end()) {
+                entry.bases.emplace_back(baseName);
+            }
+        }
+    }
+    return file;
+}
+
+const CodeFunction& SymbolTable::getFunction(const SymbolLocation& location) const {
+    return files_[location.file].model->getFunctions()[location.function];
+}
+
+std::vector<SymbolLocation> SymbolTable::findFunctions(const std::string& name) const {
+    Bucket found;
+    auto it = byName_.find(hashName({name}));
+    if (it != byName_.end()) {
+        for (const SymbolLocation& location : it->second) {
+            if (getFunction(location).name == name) found.push_back(location);
+        }
+    }
+    return found;
+}
+
+std::vector<SymbolLocation> SymbolTable::findQualified(const std::string& qualifiedName) const {
+    Bucket found;
+    auto it = byQualified_.find(hashName({qualifiedName}));
+    if (it != byQualified_.end()) {
+        for (const SymbolLocation& location : it->second) {
+            if (getFunction(location).qualifiedName == qualifiedName) found.push_back(location);
+        }
+    }
+    return found;
+}
+
+SymbolTable::Bucket SymbolTable::members(SourceLanguage language, std::string_view scope, std::string_view name,
+                                         std::string_view package) const {
+    Bucket found;
+    auto it = byMember_.find(memberKey(language, package, scope, name));
+    if (it == byMember_.end()) {
+        return found;
+    }
+    for (const SymbolLocation& location : it->second) {
+        const CodeFunction& function = getFunction(location);
+        const File& source = files_[location.file];
+        if (function.name != name || source.model->getLanguage() != language) continue;
+        if (language == SourceLanguage::Go && source.directory != package) continue;
+        // Free functions are the top-level ones, not Python nested functions
+        bool inScope = scope.empty() ? function.qualifiedName == function.name : CodeModel::getTypeName(function.container) == scope;
+        if (inScope) found.push_back(location);
+    }
+    return found;
+}
+
+SymbolTable::Bucket SymbolTable::classMembers(SourceLanguage language, std::string_view type,
+                                              std::string_view name) const {
+    // Breadth first through the bases, each once, bounded for deep hierarchies
+    std::vector<std::string_view> pending{type};
+    for (size_t k = 0; k < pending.size() && k < 32; ++k) {
+        Bucket found = members(language, pending[k], name);
+        if (!found.empty()) {
+            return found;
+        }
+        auto it = types_.find(hashName({languageKey(language), pending[k]}));
+        if (it == types_.end() || it->second.name != pending[k]) continue;
+        for (const std::string& base : it->second.bases) {
+            if (std::find(pending.begin(), pending.end(), base) == pending.end()) pending.push_back(base);
+        }
+    }
+    return {};
+}
+
+SymbolTable::Bucket SymbolTable::uniqueMethod(SourceLanguage language, const std::string& name) const {
+    auto it = methodOwners_.find(hashName({languageKey(language), name}));
+    if (it == methodOwners_.end() || it->second.shared) {
+        return {};
+    }
+    const CodeFunction& first = getFunction(it->second.first);
+    if (first.name != name) {
+        return {};
+    }
+    std::string_view package;
+    if (language == SourceLanguage::Go) package = files_[it->second.first.file].directory;
+    return members(language, CodeModel::getTypeName(first.container), name, package);
+}
+
+std::vector<uint32_t> SymbolTable::moduleFiles(SourceLanguage language, std::string_view module) const {
+    // A Go import path also names the module it is in: try
+    // "example.com/app/store", then "app/store", then "store"
+    for (size_t start = 0; start < module.size();) {
+        std::string_view suffix = module.substr(start);
+        std::vector<uint32_t> files;
+        auto it = modules_.find(hashName({languageKey(language), suffix}));
+        if (it != modules_.end()) {
+            for (uint32_t file : it->second) {
+                const std::string& name = files_[file].module;
+                bool matches = files_[file].model->getLanguage() == language && name.size() >= suffix.size() &&
+                               name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+                               (name.size() == suffix.size() || name[name.size() - suffix.size() - 1] == '.' ||
+                                name[name.size() - suffix.size() - 1] == '/');
+                if (matches) files.push_back(file);
+            }
+        }
+        if (!files.empty()) {
+            return files;
+        }
+        size_t slash = module.find('/', start);
+        if (slash == std::string_view::npos) break;
+        start = slash + 1;
+    }
+    return {};
+}
+
+SymbolTable::Bucket SymbolTable::inFiles(const Bucket& candidates, const std::vector<uint32_t>& files) {
+    Bucket found;
+    for (const SymbolLocation& location : candidates) {
+        if (std::find(files.begin(), files.end(), location.file) != files.end()) found.push_back(location);
+    }
+    return found;
+}
+
+SymbolTable::Bucket SymbolTable::withArguments(const Bucket& candidates, int argumentCount) const {
+    if (argumentCount < 0 || candidates.size() < 2) {
+        return candidates;
+    }
+    Bucket found;
+    for (const SymbolLocation& location : candidates) {
+        if (CodeModel::acceptsArguments(getFunction(location), argumentCount)) found.push_back(location);
+    }
+    // A macro or an unparsed default may hide the right one
+    return found.empty() ? candidates : found;
+}
+
+bool SymbolTable::pick(uint32_t file, const Bucket& candidates, SymbolLocation& target) const {
+    if (candidates.empty()) {
+        return false;
+    }
+    for (const SymbolLocation& location : candidates) {
+        if (location.file == file) {
+            target = location;
+            return true;
+        }
+    }
+    for (const SymbolLocation& location : candidates) {
+        if (files_[location.file].directory == files_[file].directory) {
+            target = location;
+            return true;
+        }
+    }
+    target = candidates.front();
+    return true;
+}
+
+bool SymbolTable::resolve(uint32_t file, const CodeCall& call, SymbolLocation& target) const {
+    const CodeModel& model = *files_[file].model;
+    const CodeFunction& caller = model.getFunctions()[call.callerIndex];
+    switch (model.getLanguage()) {
+        case SourceLanguage::Cpp:
+            return resolveCpp(file, caller, call, target);
+        case SourceLanguage::Python:
+            return resolvePython(file, caller, call, target);
+        case SourceLanguage::Go:
+            return resolveGo(file, caller, call, target);
+    }
+    return false;
+}
+
+bool SymbolTable::resolveCpp(uint32_t file, const CodeFunction& caller, const CodeCall& call,
+                             SymbolLocation& target) const {
+    const SourceLanguage language = SourceLanguage::Cpp;
+    std::string_view object = CodeModel::getCallObject(call.qualifier);
+    bool throughObject = !object.empty();
+    Bucket candidates;
+    if (call.qualifier.empty() || (throughObject && object == "this")) {
+        // Members of the caller's class and its bases hide free functions
+        if (!caller.container.empty()) candidates = classMembers(language, CodeModel::getTypeName(caller.container), call.callee);
+        if (candidates.empty() && !throughObject) candidates = members(language, "", call.callee);
+    } else if (throughObject) {
+        candidates = uniqueMethod(language, call.callee);
+    } else {
+        // Type::name() or Base::name(); namespaces are not recorded, so
+        // ns::name() is taken as a free function
+        candidates = classMembers(language, CodeModel::getTypeName(call.qualifier), call.callee);
+        if (candidates.empty()) candidates = members(language, "", call.callee);
+    }
+    return pick(file, withArguments(candidates, call.argumentCount), target);
+}
+
+bool SymbolTable::resolvePython(uint32_t file, const CodeFunction& caller, const CodeCall& call,
+                                SymbolLocation& target) const {
+    const SourceLanguage language = SourceLanguage::Python;
+    const std::vector<uint32_t> self{file};
+    const std::vector<CodeImport>& imports = files_[file].model->getImports();
+    const std::string& name = call.callee;
+
+    if (call.qualifier.empty()) {
+        // A function nested in the caller or in a function around it, then
+        // one of the module
+        std::string_view scope = caller.qualifiedName;
+        for (;;) {
+            auto nested = byQualified_.find(hashName({scope, ".<locals>.", name}));
+            if (nested != byQualified_.end()) {
+                for (const SymbolLocation& location : nested->second) {
+                    if (location.file == file &&
+                        equalsParts(getFunction(location).qualifiedName, {scope, ".<locals>.", name})) {
+                        target = location;
+                        return true;
+                    }
+                }
+            }
+            size_t enclosing = scope.rfind(".<locals>.");
+            if (enclosing == std::string_view::npos) break;
+            scope = scope.substr(0, enclosing);
+        }
+        if (pick(file, inFiles(members(language, "", name), self), target)) {
+            return true;
+        }
+        // from m import name, from m import f as name
+        for (const CodeImport& imported : imports) {
+            if (imported.name.empty() || (imported.alias.empty() ? imported.name : imported.alias) != name) continue;
+            std::vector<uint32_t> files = moduleFiles(language, absoluteModule(imported.module, ""));
+            return pick(file, inFiles(members(language, "", imported.name), files), target);
+        }
+        return false;
+    }
+
+    if (!caller.receiver.empty() && call.qualifier == caller.receiver) {
+        return pick(file, classMembers(language, CodeModel::getTypeName(caller.container), name), target);
+    }
+
+    // m.f() after "import a.b as m" or "from a import m", a.b.f() after "import a.b"
+    for (const CodeImport& imported : imports) {
+        std::string module;
+        if (imported.name.empty()) {
+            if ((imported.alias.empty() ? imported.module : imported.alias) == call.qualifier) {
+                module = absoluteModule(imported.module, "");
+            }
+        } else if ((imported.alias.empty() ? imported.name : imported.alias) == call.qualifier) {
+            module = absoluteModule(imported.module, imported.name);
+        }
+        if (module.empty()) continue;
+        if (pick(file, inFiles(members(language, "", name), moduleFiles(language, module)), target)) {
+            return true;
+        }
+        // "from m import Class" binds a class, not a module
+        return imported.name.empty() ? false : pick(file, classMembers(language, imported.name, name), target);
+    }
+
+    // Class.method(), with the class defined anywhere
+    if (call.qualifier.find('.') == std::string::npos) {
+        Bucket methods = classMembers(language, call.qualifier, name);
+        if (!methods.empty()) {
+            return pick(file, methods, target);
+        }
+    }
+    return pick(file, uniqueMethod(language, name), target);
+}
+
+bool SymbolTable::resolveGo(uint32_t file, const CodeFunction& caller, const CodeCall& call,
+                            SymbolLocation& target) const {
+    const SourceLanguage language = SourceLanguage::Go;
+    const std::string& name = call.callee;
+    const std::string& package = files_[file].directory;
+    if (call.qualifier.empty()) {
+        return pick(file, members(language, "", name, package), target);
+    }
+
+    // pkg.Func() through an import, named by its alias or last path element
+    for (const CodeImport& imported : files_[file].model->getImports()) {
+        std::string_view alias = imported.alias;
+        if (alias.empty()) {
+            size_t slash = imported.module.rfind('/');
+            alias = std::string_view(imported.module).substr(slash == std::string::npos ? 0 : slash + 1);
+        }
+        if (alias == call.qualifier) {
+            // Once per package, though the import path may match several
+            Bucket candidates;
+            std::vector<std::string_view> packages;
+            for (uint32_t moduleFile : moduleFiles(language, imported.module)) {
+                std::string_view directory = files_[moduleFile].directory;
+                if (std::find(packages.begin(), packages.end(), directory) != packages.end()) continue;
+                packages.push_back(directory);
+                Bucket found = members(language, "", name, directory);
+                candidates.insert(candidates.end(), found.begin(), found.end());
+            }
+            return pick(file, candidates, target);
+        }
+    }
+
+    if (!caller.receiver.empty() && call.qualifier == caller.receiver) {
+        return pick(file, members(language, CodeModel::getTypeName(caller.container), name, package), target);
+    }
+    return pick(file, uniqueMethod(language, name), target);
+}
+
+std::string SymbolTable::getSymbolName(const SymbolLocation& location) const {
+    const File& source = files_[location.file];
+    const CodeFunction& function = getFunction(location);
+    if (source.model->getLanguage() != SourceLanguage::Cpp) {
+        return source.module.empty() ? function.qualifiedName : source.module + "." + function.qualifiedName;
+    }
+
+    // Overloads share a qualified name but not their parameter types
+    auto it = overloads_.find(hashName({function.qualifiedName}));
+    return it->second.shared ? CodeModel::getOverloadName(function) : function.qualifiedName;
+}
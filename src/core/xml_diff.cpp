@@ -0,0 +1,322 @@
+#include "xml_diff.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+namespace {
+
+// Location step of a child, without the position: "title", "text()", ...
+std::string stepName(const XmlNode& node) {
+    switch (node.getType()) {
+        case XmlNode::NodeType::Text: return "text()";
+        case XmlNode::NodeType::Comment: return "comment()";
+        case XmlNode::NodeType::ProcessingInstruction: return "processing-instruction(" + node.getName() + ")";
+        default: return node.getName();
+    }
+}
+
+// 1-based position of every child among the siblings with the same step name
+std::vector<uint32_t> stepPositions(const std::vector<std::shared_ptr<XmlNode>>& children) {
+    std::unordered_map<std::string, uint32_t> counters;
+    std::vector<uint32_t> positions;
+    positions.reserve(children.size());
+    for (const auto& child : children) {
+        positions.push_back(++counters[stepName(*child)]);
+    }
+    return positions;
+}
+
+std::string childPath(const std::string& parentPath, const XmlNode& child, uint32_t position) {
+    return parentPath + "/" + stepName(child) + "[" + std::to_string(position) + "]";
+}
+
+// Children that are not identical are paired when they have the same type,
+// name and (for elements) "id" attribute
+std::string identityKey(const XmlNode& node) {
+    std::string key(1, static_cast<char>('0' + static_cast<int>(node.getType())));
+    key += node.getName();
+    if (node.getType() == XmlNode::NodeType::Element && node.hasAttribute("id")) {
+        key += '\0';
+        key += node.getAttribute("id");
+    }
+    return key;
+}
+
+// Indices (into pairs) of a longest run whose second members increase:
+// those pairs kept their order, every other pair was moved
+std::vector<bool> longestIncreasingRun(const std::vector<std::pair<size_t, size_t>>& pairs) {
+    std::vector<size_t> tails;         // pair index ending the best run of each length
+    std::vector<long> previous(pairs.size(), -1);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        auto it = std::lower_bound(tails.begin(), tails.end(), pairs[i].second,
+                                   [&pairs](size_t index, size_t value) { return pairs[index].second < value; });
+        if (it != tails.begin()) {
+            previous[i] = static_cast<long>(*(it - 1));
+        }
+        if (it == tails.end()) {
+            tails.push_back(i);
+        } else {
+            *it = i;
+        }
+    }
+    std::vector<bool> kept(pairs.size(), false);
+    for (long i = tails.empty() ? -1 : static_cast<long>(tails.back()); i >= 0; i = previous[i]) {
+        kept[i] = true;
+    }
+    return kept;
+}
+
+std::string quote(const std::string& value) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (i == XmlDiff::kMaxScriptValueLength) {
+            quoted += "...";
+            break;
+        }
+        char c = value[i];
+        if (c == '\n') {
+            quoted += "\\n";
+        } else if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+bool XmlDiff::diff(const std::shared_ptr<XmlNode>& oldRoot, const std::shared_ptr<XmlNode>& newRoot) {
+    edits_.clear();
+    comparedCount_ = 0;
+    skippedCount_ = 0;
+    errorMessage_.clear();
+    if (!oldRoot || !newRoot) {
+        errorMessage_ = "Both documents are required";
+        return false;
+    }
+
+    const std::string oldPath = oldRoot->getType() == XmlNode::NodeType::Document ? "" : "/" + oldRoot->getName();
+    const std::string newPath = newRoot->getType() == XmlNode::NodeType::Document ? "" : "/" + newRoot->getName();
+    compareNodes(oldRoot, newRoot, oldPath, newPath);
+    detectMoves();
+    return true;
+}
+
+void XmlDiff::compareNodes(const NodePtr& oldNode, const NodePtr& newNode,
+                           const std::string& oldPath, const std::string& newPath) {
+    ++comparedCount_;
+    if (oldNode->getHash() == newNode->getHash()) {
+        ++skippedCount_;
+        return;
+    }
+
+    if (oldNode->getType() != newNode->getType()) {
+        edits_.push_back({Edit::Type::Delete, oldNode, nullptr, oldPath, "", "", "", ""});
+        edits_.push_back({Edit::Type::Insert, nullptr, newNode, "", newPath, "", "", ""});
+        return;
+    }
+
+    if (oldNode->getName() != newNode->getName()) {
+        edits_.push_back({Edit::Type::Rename, oldNode, newNode, oldPath, newPath, "",
+                          oldNode->getName(), newNode->getName()});
+    }
+    if (oldNode->getValue() != newNode->getValue()) {
+        edits_.push_back({Edit::Type::UpdateValue, oldNode, newNode, oldPath, newPath, "",
+                          oldNode->getValue(), newNode->getValue()});
+    }
+    compareAttributes(oldNode, newNode, oldPath, newPath);
+    compareChildren(oldNode, newNode, oldPath, newPath);
+}
+
+void XmlDiff::compareAttributes(const NodePtr& oldNode, const NodePtr& newNode,
+                                const std::string& oldPath, const std::string& newPath) {
+    // Both maps are sorted by name, so one merge pass finds every difference
+    const auto& oldAttributes = oldNode->getAttributes();
+    const auto& newAttributes = newNode->getAttributes();
+    auto oldIt = oldAttributes.begin();
+    auto newIt = newAttributes.begin();
+    while (oldIt != oldAttributes.end() || newIt != newAttributes.end()) {
+        if (newIt == newAttributes.end() || (oldIt != oldAttributes.end() && oldIt->first < newIt->first)) {
+            edits_.push_back({Edit::Type::DeleteAttribute, oldNode, newNode, oldPath, newPath,
+                              oldIt->first, oldIt->second, ""});
+            ++oldIt;
+        } else if (oldIt == oldAttributes.end() || newIt->first < oldIt->first) {
+            edits_.push_back({Edit::Type::InsertAttribute, oldNode, newNode, oldPath, newPath,
+                              newIt->first, "", newIt->second});
+            ++newIt;
+        } else {
+            if (oldIt->second != newIt->second) {
+                edits_.push_back({Edit::Type::UpdateAttribute, oldNode, newNode, oldPath, newPath,
+                                  oldIt->first, oldIt->second, newIt->second});
+            }
+            ++oldIt;
+            ++newIt;
+        }
+    }
+}
+
+void XmlDiff::compareChildren(const NodePtr& oldNode, const NodePtr& newNode,
+                              const std::string& oldPath, const std::string& newPath) {
+    const auto& oldChildren = oldNode->getChildren();
+    const auto& newChildren = newNode->getChildren();
+
+    // Unchanged runs at both ends are the common case and cost one hash
+    // comparison per child
+    const size_t shorter = std::min(oldChildren.size(), newChildren.size());
+    size_t prefix = 0;
+    while (prefix < shorter && oldChildren[prefix]->getHash() == newChildren[prefix]->getHash()) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < shorter - prefix &&
+           oldChildren[oldChildren.size() - 1 - suffix]->getHash() ==
+           newChildren[newChildren.size() - 1 - suffix]->getHash()) {
+        ++suffix;
+    }
+    skippedCount_ += prefix + suffix;
+    const size_t oldCount = oldChildren.size() - prefix - suffix;
+    const size_t newCount = newChildren.size() - prefix - suffix;
+    if (oldCount == 0 && newCount == 0) {
+        return;
+    }
+
+    // Pair the remaining children: identical subtrees first, then by identity
+    const size_t unmatched = static_cast<size_t>(-1);
+    std::vector<size_t> matchOf(oldCount, unmatched);
+    std::vector<bool> newMatched(newCount, false);
+    std::unordered_multimap<uint64_t, size_t> byHash;
+    for (size_t j = 0; j < newCount; ++j) {
+        byHash.emplace(newChildren[prefix + j]->getHash(), j);
+    }
+    std::vector<bool> identical(oldCount, false);
+    for (size_t i = 0; i < oldCount; ++i) {
+        auto it = byHash.find(oldChildren[prefix + i]->getHash());
+        if (it != byHash.end()) {
+            matchOf[i] = it->second;
+            newMatched[it->second] = true;
+            identical[i] = true;
+            byHash.erase(it);
+        }
+    }
+    std::unordered_map<std::string, std::deque<size_t>> byKey;
+    for (size_t j = 0; j < newCount; ++j) {
+        if (!newMatched[j]) {
+            byKey[identityKey(*newChildren[prefix + j])].push_back(j);
+        }
+    }
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (matchOf[i] != unmatched) continue;
+        auto it = byKey.find(identityKey(*oldChildren[prefix + i]));
+        if (it != byKey.end() && !it->second.empty()) {
+            matchOf[i] = it->second.front();
+            newMatched[matchOf[i]] = true;
+            it->second.pop_front();
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (matchOf[i] != unmatched) pairs.emplace_back(i, matchOf[i]);
+    }
+    const std::vector<bool> inOrder = longestIncreasingRun(pairs);
+
+    const std::vector<uint32_t> oldPositions = stepPositions(oldChildren);
+    const std::vector<uint32_t> newPositions = stepPositions(newChildren);
+    size_t pairIndex = 0;
+    for (size_t i = 0; i < oldCount; ++i) {
+        const NodePtr& oldChild = oldChildren[prefix + i];
+        const std::string oldChildPath = childPath(oldPath, *oldChild, oldPositions[prefix + i]);
+        if (matchOf[i] == unmatched) {
+            edits_.push_back({Edit::Type::Delete, oldChild, nullptr, oldChildPath, "", "", "", ""});
+            continue;
+        }
+
+        const NodePtr& newChild = newChildren[prefix + matchOf[i]];
+        const std::string newChildPath = childPath(newPath, *newChild, newPositions[prefix + matchOf[i]]);
+        if (!inOrder[pairIndex++]) {
+            edits_.push_back({Edit::Type::Move, oldChild, newChild, oldChildPath, newChildPath, "", "", ""});
+        }
+        if (identical[i]) {
+            ++skippedCount_;
+        } else {
+            compareNodes(oldChild, newChild, oldChildPath, newChildPath);
+        }
+    }
+    for (size_t j = 0; j < newCount; ++j) {
+        if (!newMatched[j]) {
+            const NodePtr& newChild = newChildren[prefix + j];
+            edits_.push_back({Edit::Type::Insert, nullptr, newChild, "",
+                              childPath(newPath, *newChild, newPositions[prefix + j]), "", "", ""});
+        }
+    }
+}
+
+void XmlDiff::detectMoves() {
+    // A subtree deleted in one place and inserted unchanged in another was moved
+    std::unordered_multimap<uint64_t, size_t> deletes;
+    for (size_t i = 0; i < edits_.size(); ++i) {
+        if (edits_[i].type == Edit::Type::Delete) {
+            deletes.emplace(edits_[i].oldNode->getHash(), i);
+        }
+    }
+    if (deletes.empty()) {
+        return;
+    }
+
+    std::vector<bool> merged(edits_.size(), false);
+    for (size_t i = 0; i < edits_.size(); ++i) {
+        if (edits_[i].type != Edit::Type::Insert) continue;
+        auto it = deletes.find(edits_[i].newNode->getHash());
+        if (it == deletes.end()) continue;
+        Edit& move = edits_[it->second];
+        move.type = Edit::Type::Move;
+        move.newNode = edits_[i].newNode;
+        move.newPath = edits_[i].newPath;
+        merged[i] = true;
+        deletes.erase(it);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < edits_.size(); ++i) {
+        if (!merged[i]) {
+            if (kept != i) edits_[kept] = std::move(edits_[i]);
+            ++kept;
+        }
+    }
+    edits_.resize(kept);
+}
+
+std::string XmlDiff::toScript() const {
+    std::string script;
+    for (const Edit& edit : edits_) {
+        switch (edit.type) {
+            case Edit::Type::Insert:
+                script += "+ " + edit.newPath + "\n";
+                break;
+            case Edit::Type::Delete:
+                script += "- " + edit.oldPath + "\n";
+                break;
+            case Edit::Type::Move:
+                script += "> " + edit.oldPath + " -> " + edit.newPath + "\n";
+                break;
+            case Edit::Type::Rename:
+            case Edit::Type::UpdateValue:
+                script += "~ " + edit.oldPath + ": " + quote(edit.oldValue) + " -> " + quote(edit.newValue) + "\n";
+                break;
+            case Edit::Type::InsertAttribute:
+                script += "+ " + edit.newPath + "/@" + edit.attribute + " = " + quote(edit.newValue) + "\n";
+                break;
+            case Edit::Type::DeleteAttribute:
+                script += "- " + edit.oldPath + "/@" + edit.attribute + "\n";
+                break;
+            case Edit::Type::UpdateAttribute:
+                script += "~ " + edit.oldPath + "/@" + edit.attribute + ": " + quote(edit.oldValue) + " -> " +
+                          quote(edit.newValue) + "\n";
+                break;
+        }
+    }
+    return script;
+}
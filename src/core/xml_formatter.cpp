@@ -0,0 +1,231 @@
+#include "xml_formatter.h"
+#include <sstream>
+
+namespace {
+
+using TokenType = XmlStreamReader::TokenType;
+
+bool isXmlWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+XmlFormatter::XmlFormatter() : XmlFormatter(Options()) {
+}
+
+XmlFormatter::XmlFormatter(const Options& options)
+    : options_(options), reader_(nullptr), readerDone_(false), hasHeld_(false),
+      pendingBytes_(0), atStart_(true) {
+}
+
+bool XmlFormatter::formatString(const std::string& input, std::string& output) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    if (!format(in, out)) {
+        return false;
+    }
+    output = out.str();
+    return true;
+}
+
+bool XmlFormatter::format(std::istream& input, std::ostream& output) {
+    XmlStreamReader reader(input);
+    reader_ = &reader;
+    readerDone_ = false;
+    hasHeld_ = false;
+    pending_.clear();
+    pendingBytes_ = 0;
+    frames_.clear();
+    atStart_ = true;
+    out_.clear();
+    errorMessage_.clear();
+
+    while (!pending_.empty() || fetch()) {
+        Token token = std::move(pending_.front());
+        pending_.pop_front();
+        pendingBytes_ -= token.raw.size();
+
+        const bool verbatim = !frames_.empty() && frames_.back().verbatim;
+        switch (token.type) {
+            case TokenType::StartElement:
+                if (!verbatim) {
+                    breakLine(token.depth);
+                    markChild();
+                }
+                out_ += token.raw;
+                // The content decides how the element is laid out
+                frames_.push_back({verbatim || (!token.emptyElement && isMixedContent()), false});
+                break;
+            case TokenType::EndElement: {
+                Frame frame = frames_.back();
+                frames_.pop_back();
+                if (token.raw.empty()) break;  // end of a self-closing tag
+                if (!frame.verbatim && frame.hasChildren) {
+                    breakLine(token.depth);
+                }
+                out_ += token.raw;
+                break;
+            }
+            case TokenType::Text:
+                if (verbatim) {
+                    out_ += token.raw;
+                } else if (!token.whitespace) {
+                    // Only reached past the lookahead window (or outside the
+                    // root); keep the text and stop reindenting this element
+                    out_ += token.raw;
+                    markChild();
+                    if (!frames_.empty()) frames_.back().verbatim = true;
+                }
+                break;
+            default:
+                // Comments, CDATA, processing instructions and the doctype
+                if (!verbatim) {
+                    breakLine(token.depth);
+                    markChild();
+                }
+                out_ += token.raw;
+                break;
+        }
+
+        if (!flush(output)) {
+            break;
+        }
+    }
+
+    reader_ = nullptr;
+    if (hasError()) {
+        return false;
+    }
+    if (options_.mode == Mode::Pretty && !atStart_) {
+        out_ += '\n';
+    }
+    return flush(output, true);
+}
+
+bool XmlFormatter::readToken(Token& token) {
+    TokenType type = reader_->next();
+    if (type == TokenType::Error) {
+        errorMessage_ = reader_->getErrorMessage();
+        return false;
+    }
+    if (type == TokenType::EndDocument) {
+        return false;
+    }
+
+    token.type = type;
+    token.raw = reader_->rawToken();
+    token.depth = reader_->depth();
+    token.emptyElement = reader_->isEmptyElement();
+    token.whitespace = true;
+    token.lineBreak = false;
+    if (type == TokenType::Text) {
+        // Judged on the raw bytes: "&#10;" is deliberate content, not layout
+        for (char c : token.raw) {
+            if (!isXmlWhitespace(c)) token.whitespace = false;
+            if (c == '\n') token.lineBreak = true;
+        }
+    }
+    return true;
+}
+
+bool XmlFormatter::fetch() {
+    Token token;
+    if (hasHeld_) {
+        token = std::move(held_);
+        hasHeld_ = false;
+    } else if (readerDone_ || !readToken(token)) {
+        readerDone_ = true;
+        return false;
+    }
+
+    // The reader may split long text at buffer boundaries; join the pieces so
+    // layout decisions see the whole run
+    if (token.type == TokenType::Text) {
+        Token next;
+        while (!readerDone_) {
+            if (!readToken(next)) {
+                readerDone_ = true;
+                break;
+            }
+            if (next.type != TokenType::Text) {
+                held_ = std::move(next);
+                hasHeld_ = true;
+                break;
+            }
+            token.raw += next.raw;
+            token.whitespace = token.whitespace && next.whitespace;
+            token.lineBreak = token.lineBreak || next.lineBreak;
+        }
+    }
+
+    pendingBytes_ += token.raw.size();
+    pending_.push_back(std::move(token));
+    return true;
+}
+
+bool XmlFormatter::isMixedContent() {
+    // Scans the content of the element whose start tag was just taken off the
+    // queue, reading ahead as needed
+    int level = 0;
+    for (size_t i = 0;; ++i) {
+        if (i == pending_.size() && (pendingBytes_ > kLookaheadBytes || !fetch())) {
+            return false;
+        }
+
+        const Token& token = pending_[i];
+        switch (token.type) {
+            case TokenType::StartElement:
+                ++level;
+                break;
+            case TokenType::EndElement:
+                if (level == 0) return false;
+                --level;
+                break;
+            case TokenType::Text:
+                if (level == 0 && (!token.whitespace || !token.lineBreak)) return true;
+                break;
+            case TokenType::CData:
+                if (level == 0) return true;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void XmlFormatter::breakLine(int depth) {
+    if (options_.mode == Mode::Minify) {
+        return;
+    }
+    if (atStart_) {
+        atStart_ = false;
+        return;
+    }
+    out_ += '\n';
+    if (options_.useTabs) {
+        out_.append(static_cast<size_t>(depth), '\t');
+    } else {
+        out_.append(static_cast<size_t>(depth * options_.indentSize), ' ');
+    }
+}
+
+void XmlFormatter::markChild() {
+    atStart_ = false;
+    if (!frames_.empty()) {
+        frames_.back().hasChildren = true;
+    }
+}
+
+bool XmlFormatter::flush(std::ostream& output, bool force) {
+    if (!force && out_.size() < kFlushThreshold) {
+        return true;
+    }
+    output.write(out_.data(), static_cast<std::streamsize>(out_.size()));
+    out_.clear();
+    if (!output) {
+        errorMessage_ = "Failed to write output";
+        return false;
+    }
+    return true;
+}
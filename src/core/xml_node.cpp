@@ -1,13 +1,43 @@
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
 #include "xml_node.h"
 
+namespace {
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t hashBytes(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// Strings are hashed with their terminator so "ab"+"c" differs from "a"+"bc"
+uint64_t hashString(uint64_t hash, const std::string& text) {
+    return hashBytes(hash, text.c_str(), text.size() + 1);
+}
+
+uint64_t hashWord(uint64_t hash, uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+    }
+    return hashBytes(hash, reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+} // namespace
+
 XmlNode::XmlNode(const std::string& name, NodeType type)
     : name_(name), type_(type) {
 }
 
 void XmlNode::addAttribute(const std::string& key, const std::string& value) {
     attributes_[key] = value;
+    markModified();
 }
 
 std::string XmlNode::getAttribute(const std::string& key) const {
@@ -23,6 +53,7 @@ void XmlNode::addChild(std::shared_ptr<XmlNode> child) {
     if (child) {
         child->setParent(shared_from_this());
         children_.push_back(child);
+        markModified();
     }
 }
 
@@ -30,6 +61,15 @@ void XmlNode::removeChild(std::shared_ptr<XmlNode> child) {
     auto it = std::find(children_.begin(), children_.end(), child);
     if (it != children_.end()) {
         children_.erase(it);
+        markModified();
+    }
+}
+
+void XmlNode::setChild(size_t index, std::shared_ptr<XmlNode> child) {
+    if (child && index < children_.size()) {
+        child->setParent(shared_from_this());
+        children_[index] = child;
+        markModified();
     }
 }
 
@@ -67,4 +107,70 @@ std::string XmlNode::getPath() const {
         ss << pathParts[i];
     }
     return ss.str();
-} 
\ No newline at end of file
+}
+
+void XmlNode::markModified() {
+    ++revision_;
+    hashValid_ = false;
+    for (auto parent = parent_.lock(); parent; parent = parent->getParent()) {
+        ++parent->revision_;
+        parent->hashValid_ = false;
+    }
+}
+
+uint64_t XmlNode::getHash() const {
+    if (hashValid_) {
+        return hash_;
+    }
+    uint64_t hash = hashWord(kFnvOffset, static_cast<uint64_t>(type_));
+    hash = hashString(hash, name_);
+    hash = hashString(hash, value_);
+    for (const auto& attribute : attributes_) {
+        hash = hashString(hash, attribute.first);
+        hash = hashString(hash, attribute.second);
+    }
+    hash = hashWord(hash, children_.size());
+    for (const auto& child : children_) {
+        hash = hashWord(hash, child->getHash());
+    }
+    hash_ = hash;
+    hashValid_ = true;
+    return hash_;
+}
+
+std::vector<std::vector<std::shared_ptr<XmlNode>>> XmlNode::findDuplicateSubtrees() const {
+    // Group the element subtrees by hash, then drop groups that are implied
+    // by a group higher up: every copy sits in a copy of the same parent
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<XmlNode>>> byHash;
+    std::vector<std::shared_ptr<XmlNode>> pending(children_.rbegin(), children_.rend());
+    while (!pending.empty()) {
+        std::shared_ptr<XmlNode> node = pending.back();
+        pending.pop_back();
+        if (node->type_ != NodeType::Element) continue;
+        byHash[node->getHash()].push_back(node);
+        pending.insert(pending.end(), node->children_.rbegin(), node->children_.rend());
+    }
+
+    auto parentHash = [this](const std::shared_ptr<XmlNode>& node) -> uint64_t {
+        auto parent = node->getParent();
+        return parent && parent.get() != this ? parent->getHash() : 0;
+    };
+    std::vector<std::vector<std::shared_ptr<XmlNode>>> groups;
+    for (const auto& entry : byHash) {
+        const auto& nodes = entry.second;
+        if (nodes.size() < 2) continue;
+        const uint64_t firstParent = parentHash(nodes.front());
+        auto parentGroup = firstParent != 0 ? byHash.find(firstParent) : byHash.end();
+        bool nested = parentGroup != byHash.end() && parentGroup->second.size() >= 2;
+        for (size_t i = 1; nested && i < nodes.size(); ++i) {
+            nested = parentHash(nodes[i]) == firstParent;
+        }
+        if (!nested) {
+            groups.push_back(nodes);
+        }
+    }
+    std::sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.front()->getPath() < b.front()->getPath();
+    });
+    return groups;
+}
\ No newline at end of file
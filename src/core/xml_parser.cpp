@@ -1,4 +1,5 @@
 #include "xml_parser.h"
+#include "compressed_stream.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -8,27 +9,44 @@ XmlParser::XmlParser() {
 }
 
 std::shared_ptr<XmlNode> XmlParser::parseFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        errorMessage_ = "Cannot open file: " + filename;
+    // Compressed files are decoded while parsing, never inflated in memory
+    CompressedInputStream file(filename);
+    if (!file.isOpen()) {
+        errorMessage_ = file.hasError() ? file.getErrorMessage() : "Cannot open file: " + filename;
         return nullptr;
     }
     
-    clearError();
-    std::string content{std::istreambuf_iterator<char>(file),
-                        std::istreambuf_iterator<char>()};
-    return parseString(content);
+    auto root = parseStream(file);
+    if (file.hasError()) {
+        errorMessage_ = file.getErrorMessage();
+        return nullptr;
+    }
+    return root;
 }
 
 std::shared_ptr<XmlNode> XmlParser::parseString(const std::string& xmlContent) {
-    clearError();
-    
     std::istringstream stream(xmlContent);
+    return parseStream(stream);
+}
+
+std::shared_ptr<XmlNode> XmlParser::parseStream(std::istream& stream) {
+    clearError();
     skipWhitespace(stream);
     
-    // Check for XML declaration
-    if (peekNextChar(stream) == '<' && stream.peek() == '?') {
-        parseProcessingInstruction(stream);
+    // Skip the XML declaration and any comments before the root
+    while (peekNextChar(stream) == '<') {
+        char second = peekSecondChar(stream);
+        if (second == '?') {
+            getNextChar(stream); // consume '<'
+            parseProcessingInstruction(stream);
+        } else if (second == '!') {
+            parseElement(stream);
+            if (hasError()) {
+                return nullptr;
+            }
+        } else {
+            break;
+        }
         skipWhitespace(stream);
     }
     
@@ -63,10 +81,13 @@ std::shared_ptr<XmlNode> XmlParser::parseElement(std::istream& stream) {
     // Check for comment
     if (peekNextChar(stream) == '!') {
         getNextChar(stream); // consume '!'
-        if (peekNextChar(stream) == '-' && stream.peek() == '-') {
-            parseComment(stream);
-            return parseElement(stream);
+        if (peekNextChar(stream) == '-' && peekSecondChar(stream) == '-') {
+            auto commentNode = std::make_shared<XmlNode>("", XmlNode::NodeType::Comment);
+            commentNode->setValue(parseComment(stream));
+            return commentNode;
         }
+        errorMessage_ = "Unsupported markup declaration";
+        return nullptr;
     }
     
     // Parse tag name
@@ -107,7 +128,7 @@ std::shared_ptr<XmlNode> XmlParser::parseElement(std::istream& stream) {
         
         char nextChar = peekNextChar(stream);
         if (nextChar == '<') {
-            if (stream.peek() == '/') {
+            if (peekSecondChar(stream) == '/') {
                 // Closing tag
                 getNextChar(stream); // consume '<'
                 getNextChar(stream); // consume '/'
@@ -127,6 +148,8 @@ std::shared_ptr<XmlNode> XmlParser::parseElement(std::istream& stream) {
                 auto childNode = parseElement(stream);
                 if (childNode) {
                     node->addChild(childNode);
+                } else if (hasError()) {
+                    return nullptr;
                 }
             }
         } else if (nextChar == '\0') {
@@ -150,7 +173,8 @@ std::string XmlParser::parseTagName(std::istream& stream) {
     std::string name;
     char c;
     
-    while ((c = peekNextChar(stream)) && (isalnum(c) || c == '_' || c == '-')) {
+    while ((c = peekNextChar(stream)) &&
+           (isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == ':' || c == '.')) {
         name += getNextChar(stream);
     }
     
@@ -225,12 +249,13 @@ std::string XmlParser::parseText(std::istream& stream) {
 std::string XmlParser::parseComment(std::istream& stream) {
     std::string comment;
     
-    // Already consumed '!' and first '-', now consume second '-'
+    // Already consumed '!', now consume both '-'
+    getNextChar(stream); // consume first '-'
     getNextChar(stream); // consume second '-'
     
     char c;
     while ((c = getNextChar(stream)) != '\0') {
-        if (c == '-' && peekNextChar(stream) == '-' && stream.peek() == '>') {
+        if (c == '-' && peekNextChar(stream) == '-' && peekSecondChar(stream) == '>') {
             getNextChar(stream); // consume second '-'
             getNextChar(stream); // consume '>'
             break;
@@ -264,13 +289,25 @@ void XmlParser::skipWhitespace(std::istream& stream) {
     }
 }
 
+// Both return '\0' at end of input so the parsing loops terminate
 char XmlParser::peekNextChar(std::istream& stream) {
-    return stream.peek();
+    int c = stream.peek();
+    return c == std::char_traits<char>::eof() ? '\0' : static_cast<char>(c);
 }
 
 char XmlParser::getNextChar(std::istream& stream) {
     char c;
-    stream.get(c);
+    return stream.get(c) ? c : '\0';
+}
+
+char XmlParser::peekSecondChar(std::istream& stream) {
+    if (stream.get() == std::char_traits<char>::eof()) {
+        stream.clear(stream.rdstate() & ~std::ios::failbit);
+        return '\0';
+    }
+    char c = peekNextChar(stream);
+    stream.clear(stream.rdstate() & ~std::ios::eofbit);
+    stream.unget();
     return c;
 }
 
@@ -0,0 +1,726 @@
+#include "xml_pipeline.h"
+#include "xml_stream_reader.h"
+#include "xml_record_builder.h"
+#include "serialization_writers.h"
+#include "compressed_stream.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+
+using Style = XmlSerializer::OutputStyle;
+using Field = XmlPipeline::Field;
+using Record = XmlPipeline::Record;
+
+std::string trimmed(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+const std::string* findField(const std::vector<Field>& fields, const std::string& key) {
+    // Records have few fields; a scan beats building an index per record
+    for (const auto& field : fields) {
+        if (field.first == key) return &field.second;
+    }
+    return nullptr;
+}
+
+// Overwrites out[count] in place so the strings keep their capacity across records
+void putField(std::vector<Field>& out, size_t& count, const std::string& key, const std::string& value) {
+    if (count < out.size()) {
+        out[count].first = key;
+        out[count].second = value;
+    } else {
+        out.emplace_back(key, value);
+    }
+    ++count;
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool compareValues(const std::string* actual, XmlPipeline::Comparison comparison, const std::string& expected) {
+    using Comparison = XmlPipeline::Comparison;
+    if (comparison == Comparison::Exists) return actual != nullptr;
+    if (!actual) return comparison == Comparison::NotEqual;
+
+    switch (comparison) {
+        case Comparison::Equal: return *actual == expected;
+        case Comparison::NotEqual: return *actual != expected;
+        case Comparison::Contains: return actual->find(expected) != std::string::npos;
+        default: break;
+    }
+
+    double left = 0;
+    double right = 0;
+    int order;
+    if (parseNumber(*actual, left) && parseNumber(expected, right)) {
+        order = left < right ? -1 : (left > right ? 1 : 0);
+    } else {
+        order = actual->compare(expected);
+    }
+    switch (comparison) {
+        case Comparison::Less: return order < 0;
+        case Comparison::LessOrEqual: return order <= 0;
+        case Comparison::Greater: return order > 0;
+        case Comparison::GreaterOrEqual: return order >= 0;
+        default: return false;
+    }
+}
+
+// Splits at separators outside double quotes; quotes are kept in the pieces
+std::vector<std::string> splitUnquoted(const std::string& text, char separator) {
+    std::vector<std::string> pieces(1);
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (quoted && c == '\\' && i + 1 < text.size()) {
+            pieces.back() += c;
+            pieces.back() += text[++i];
+            continue;
+        }
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == separator && !quoted) {
+            pieces.emplace_back();
+            continue;
+        }
+        pieces.back() += c;
+    }
+    return pieces;
+}
+
+// Strips surrounding whitespace and double quotes, resolving \" and \\ inside
+std::string unquoted(const std::string& text) {
+    std::string value = trimmed(text);
+    if (value.size() < 2 || value.front() != '"' || value.back() != '"') {
+        return value;
+    }
+    std::string result;
+    for (size_t i = 1; i + 1 < value.size(); ++i) {
+        if (value[i] == '\\' && i + 2 < value.size()) ++i;
+        result += value[i];
+    }
+    return result;
+}
+
+bool parseComparison(const std::string& op, XmlPipeline::Comparison& comparison) {
+    using Comparison = XmlPipeline::Comparison;
+    if (op == "=" || op == "==") comparison = Comparison::Equal;
+    else if (op == "!=") comparison = Comparison::NotEqual;
+    else if (op == "<") comparison = Comparison::Less;
+    else if (op == "<=") comparison = Comparison::LessOrEqual;
+    else if (op == ">") comparison = Comparison::Greater;
+    else if (op == ">=") comparison = Comparison::GreaterOrEqual;
+    else if (op == "~") comparison = Comparison::Contains;
+    else return false;
+    return true;
+}
+
+template <Style S>
+struct JsonRecordWriter {
+    static void lineBreak(std::string& out) {
+        if constexpr (OutputStyleTraits<S>::kLineBreaks) {
+            out += '\n';
+        } else {
+            (void)out;
+        }
+    }
+
+    static void begin(std::string& out) {
+        out += '[';
+    }
+
+    static void record(std::string& out, const Record& record, bool first) {
+        if (!first) out += ',';
+        lineBreak(out);
+        writer_detail::appendIndent<S>(out, 1);
+        out += '{';
+        for (size_t i = 0; i < record.fields.size(); ++i) {
+            if (i > 0) out += ',';
+            lineBreak(out);
+            writer_detail::appendIndent<S>(out, 2);
+            out += '"';
+            writer_detail::appendEscapedQuoted(out, record.fields[i].first);
+            out += OutputStyleTraits<S>::kIndentWidth > 0 ? "\": \"" : "\":\"";
+            writer_detail::appendEscapedQuoted(out, record.fields[i].second);
+            out += '"';
+        }
+        if (!record.fields.empty()) {
+            lineBreak(out);
+            writer_detail::appendIndent<S>(out, 1);
+        }
+        out += '}';
+    }
+
+    static void end(std::string& out, bool empty) {
+        if (!empty) lineBreak(out);
+        out += "]\n";
+    }
+};
+
+// Same layout as XmlStreamConverter's CSV: columns fixed by the first record
+class CsvRecordWriter {
+public:
+    void record(std::string& out, const Record& record) {
+        if (!headerWritten_) {
+            for (size_t i = 0; i < record.fields.size(); ++i) {
+                columns_.push_back(record.fields[i].first);
+                if (i > 0) out += ',';
+                appendQuoted(out, record.fields[i].first);
+            }
+            out += '\n';
+            headerWritten_ = true;
+        }
+
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) out += ',';
+            const std::string* value = record.field(columns_[i]);
+            appendQuoted(out, value ? *value : std::string());
+        }
+        out += '\n';
+    }
+
+private:
+    static void appendQuoted(std::string& out, const std::string& value) {
+        out += '"';
+        for (char c : value) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    bool headerWritten_ = false;
+    std::vector<std::string> columns_;
+};
+
+} // namespace
+
+// One executable stage. Runs of project and rename stages are fused into a
+// single Project step: keepAll keeps every field under its renamed name,
+// otherwise only the columns (source -> target) are kept, in that order
+struct XmlPipeline::Step {
+    Stage::Kind kind;
+    std::string name;
+    Predicate predicate;
+    bool keepAll = true;
+    std::unordered_map<std::string, std::string> renames;
+    std::vector<std::pair<std::string, std::string>> columns;
+    Mapper mapper;
+    uint64_t count = 0;
+    uint64_t passed = 0;
+
+    // Appends a project or rename stage to this remapping
+    void fuse(const Stage& stage) {
+        if (stage.kind == Stage::Kind::Rename) {
+            if (keepAll) {
+                // Composition of two renamings; names nobody renamed map to themselves
+                bool renamedSource = false;
+                for (auto& entry : renames) {
+                    if (entry.second == stage.from) entry.second = stage.to;
+                    renamedSource = renamedSource || entry.first == stage.from;
+                }
+                if (!renamedSource) renames.emplace(stage.from, stage.to);
+            } else {
+                for (auto& column : columns) {
+                    if (column.second == stage.from) column.second = stage.to;
+                }
+            }
+            return;
+        }
+
+        std::vector<std::pair<std::string, std::string>> selected;
+        for (const std::string& name : stage.fields) {
+            if (!keepAll) {
+                for (const auto& column : columns) {
+                    if (column.second == name) {
+                        selected.push_back(column);
+                        break;
+                    }
+                }
+                continue;
+            }
+            // Find the source field that currently carries this name
+            bool found = false;
+            for (const auto& entry : renames) {
+                if (entry.second == name) {
+                    selected.emplace_back(entry.first, name);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found && renames.find(name) == renames.end()) {
+                selected.emplace_back(name, name);
+            }
+        }
+        keepAll = false;
+        renames.clear();
+        columns = std::move(selected);
+    }
+
+    void remap(const std::vector<Field>& in, std::vector<Field>& out) const {
+        size_t count = 0;
+        if (keepAll) {
+            for (const auto& field : in) {
+                auto it = renames.find(field.first);
+                putField(out, count, it != renames.end() ? it->second : field.first, field.second);
+            }
+        } else {
+            for (const auto& column : columns) {
+                if (const std::string* value = findField(in, column.first)) {
+                    putField(out, count, column.second, *value);
+                }
+            }
+        }
+        out.resize(count);
+    }
+};
+
+const std::string* XmlPipeline::Record::field(const std::string& key) const {
+    return findField(fields, key);
+}
+
+void XmlPipeline::Record::set(const std::string& key, const std::string& value) {
+    for (auto& field : fields) {
+        if (field.first == key) {
+            field.second = value;
+            return;
+        }
+    }
+    fields.emplace_back(key, value);
+}
+
+XmlPipeline::XmlPipeline()
+    : nextProgress_(0), recordsRead_(0), recordsWritten_(0), bytesRead_(0) {
+}
+
+XmlPipeline& XmlPipeline::records(const std::string& name) {
+    Stage stage;
+    stage.kind = Stage::Kind::Records;
+    stage.name = name;
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+XmlPipeline& XmlPipeline::filter(Predicate predicate) {
+    Stage stage;
+    stage.kind = Stage::Kind::Filter;
+    stage.predicate = std::move(predicate);
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+XmlPipeline& XmlPipeline::where(const std::string& field, Comparison comparison, const std::string& value) {
+    return filter([field, comparison, value](const Record& record) {
+        return compareValues(record.field(field), comparison, value);
+    });
+}
+
+XmlPipeline& XmlPipeline::project(const std::vector<std::string>& fields) {
+    Stage stage;
+    stage.kind = Stage::Kind::Project;
+    stage.fields = fields;
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+XmlPipeline& XmlPipeline::rename(const std::string& from, const std::string& to) {
+    Stage stage;
+    stage.kind = Stage::Kind::Rename;
+    stage.from = from;
+    stage.to = to;
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+XmlPipeline& XmlPipeline::map(Mapper mapper) {
+    Stage stage;
+    stage.kind = Stage::Kind::Map;
+    stage.mapper = std::move(mapper);
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+XmlPipeline& XmlPipeline::limit(uint64_t count) {
+    Stage stage;
+    stage.kind = Stage::Kind::Limit;
+    stage.count = count;
+    stages_.push_back(std::move(stage));
+    return *this;
+}
+
+void XmlPipeline::clear() {
+    stages_.clear();
+}
+
+bool XmlPipeline::parse(const std::string& spec) {
+    errorMessage_.clear();
+    const size_t firstNew = stages_.size();
+    auto fail = [this, firstNew](const std::string& message) {
+        stages_.erase(stages_.begin() + static_cast<std::ptrdiff_t>(firstNew), stages_.end());
+        errorMessage_ = message;
+        return false;
+    };
+
+    for (const std::string& piece : splitUnquoted(spec, '|')) {
+        const std::string text = trimmed(piece);
+        if (text.empty()) {
+            return fail("Empty pipeline stage");
+        }
+        const size_t space = text.find_first_of(" \t");
+        const std::string keyword = text.substr(0, space);
+        const std::string argument = space == std::string::npos ? "" : trimmed(text.substr(space));
+
+        if (keyword == "records") {
+            if (argument.empty()) return fail("records needs an element name");
+            records(unquoted(argument));
+        } else if (keyword == "where") {
+            size_t opStart = argument.find_first_of("=!<>~");
+            std::string field = unquoted(argument.substr(0, opStart));
+            if (field.empty()) return fail("where needs a field name");
+            if (opStart == std::string::npos) {
+                where(field, Comparison::Exists);
+                continue;
+            }
+            size_t opEnd = argument.find_first_not_of("=!<>~", opStart);
+            Comparison comparison;
+            if (!parseComparison(argument.substr(opStart, opEnd - opStart), comparison)) {
+                return fail("Unknown operator in: " + text);
+            }
+            where(field, comparison, opEnd == std::string::npos ? "" : unquoted(argument.substr(opEnd)));
+        } else if (keyword == "select") {
+            std::vector<std::string> fields;
+            for (const std::string& name : splitUnquoted(argument, ',')) {
+                fields.push_back(unquoted(name));
+                if (fields.back().empty()) return fail("Empty field name in: " + text);
+            }
+            project(fields);
+        } else if (keyword == "rename") {
+            for (const std::string& pair : splitUnquoted(argument, ',')) {
+                std::vector<std::string> names = splitUnquoted(pair, '=');
+                if (names.size() != 2 || unquoted(names[0]).empty() || unquoted(names[1]).empty()) {
+                    return fail("rename expects old=new, got: " + trimmed(pair));
+                }
+                rename(unquoted(names[0]), unquoted(names[1]));
+            }
+        } else if (keyword == "map") {
+            std::vector<std::string> words;
+            for (const std::string& word : splitUnquoted(argument, ' ')) {
+                if (!trimmed(word).empty()) words.push_back(unquoted(word));
+            }
+            if (words.size() != 2) return fail("map expects <field> upper|lower|trim");
+            const std::string field = words[0];
+            const std::string function = words[1];
+            if (function == "upper" || function == "lower") {
+                const bool upper = function == "upper";
+                map([field, upper](Record& record) {
+                    for (auto& entry : record.fields) {
+                        if (entry.first != field) continue;
+                        for (char& c : entry.second) {
+                            unsigned char u = static_cast<unsigned char>(c);
+                            c = static_cast<char>(upper ? std::toupper(u) : std::tolower(u));
+                        }
+                    }
+                });
+            } else if (function == "trim") {
+                map([field](Record& record) {
+                    for (auto& entry : record.fields) {
+                        if (entry.first == field) entry.second = trimmed(entry.second);
+                    }
+                });
+            } else {
+                return fail("Unknown map function: " + function);
+            }
+        } else if (keyword == "limit") {
+            char* end = nullptr;
+            unsigned long long count = std::strtoull(argument.c_str(), &end, 10);
+            if (argument.empty() || *end != '\0') return fail("limit needs a record count");
+            limit(count);
+        } else {
+            return fail("Unknown pipeline stage: " + keyword);
+        }
+    }
+    return true;
+}
+
+std::vector<XmlPipeline::Step> XmlPipeline::compile() const {
+    std::vector<Step> steps;
+    for (const Stage& stage : stages_) {
+        const bool remapping = stage.kind == Stage::Kind::Project || stage.kind == Stage::Kind::Rename;
+        if (remapping && !steps.empty() && steps.back().kind == Stage::Kind::Project) {
+            steps.back().fuse(stage);
+            continue;
+        }
+
+        Step step;
+        step.kind = remapping ? Stage::Kind::Project : stage.kind;
+        step.name = stage.name;
+        step.predicate = stage.predicate;
+        step.mapper = stage.mapper;
+        step.count = stage.count;
+        if (remapping) step.fuse(stage);
+        steps.push_back(std::move(step));
+    }
+    return steps;
+}
+
+bool XmlPipeline::run(std::istream& input, const BatchCallback& sink) {
+    errorMessage_.clear();
+    nextProgress_ = kProgressInterval;
+    recordsRead_ = 0;
+    recordsWritten_ = 0;
+    bytesRead_ = 0;
+
+    std::vector<Step> steps = compile();
+    XmlStreamReader reader(input);
+    XmlRecordBuilder builder(config_);
+    std::vector<Record> batch;
+    batch.reserve(kBatchSize);
+    Record current;
+    std::vector<Field> scratch;
+    bool rootSeen = false;
+    bool exhausted = false;  // a limit was reached, nothing more can pass
+
+    auto deliver = [this, &batch, &sink]() {
+        if (batch.empty()) return true;
+        recordsWritten_ += batch.size();
+        bool ok = sink(batch);
+        batch.clear();
+        if (!ok && errorMessage_.empty()) {
+            errorMessage_ = "Pipeline cancelled";
+        }
+        return ok;
+    };
+
+    // Runs the record the builder just closed through every step
+    auto process = [&]() {
+        const std::string& name = builder.recordName();
+        size_t i = 0;
+        // Name checks up front reject records before any field is copied
+        for (; i < steps.size() && steps[i].kind == Stage::Kind::Records; ++i) {
+            if (name != steps[i].name) return false;
+        }
+        current.name = name;
+        if (i < steps.size() && steps[i].kind == Stage::Kind::Project) {
+            steps[i++].remap(builder.fields(), current.fields);
+        } else {
+            current.fields = builder.fields();
+        }
+
+        for (; i < steps.size(); ++i) {
+            Step& step = steps[i];
+            switch (step.kind) {
+                case Stage::Kind::Records:
+                    if (current.name != step.name) return false;
+                    break;
+                case Stage::Kind::Filter:
+                    if (!step.predicate(current)) return false;
+                    break;
+                case Stage::Kind::Project:
+                    step.remap(current.fields, scratch);
+                    current.fields.swap(scratch);
+                    break;
+                case Stage::Kind::Map:
+                    step.mapper(current);
+                    break;
+                case Stage::Kind::Limit:
+                    if (step.passed >= step.count) return false;
+                    if (++step.passed == step.count) exhausted = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return true;
+    };
+
+    bool ok = true;
+    for (const Step& step : steps) {
+        if (step.kind == Stage::Kind::Limit && step.count == 0) exhausted = true;
+    }
+
+    while (ok && !exhausted) {
+        XmlStreamReader::TokenType token = reader.next();
+        if (token == XmlStreamReader::TokenType::Error) {
+            errorMessage_ = reader.getErrorMessage();
+            ok = false;
+            break;
+        }
+        if (token == XmlStreamReader::TokenType::EndDocument) {
+            break;
+        }
+
+        switch (token) {
+            case XmlStreamReader::TokenType::StartElement:
+                if (reader.depth() == 0) {
+                    if (rootSeen) {
+                        errorMessage_ = "Multiple root elements (line " +
+                                        std::to_string(reader.lineNumber()) + ")";
+                        ok = false;
+                        break;
+                    }
+                    rootSeen = true;
+                }
+                builder.startElement(reader);
+                break;
+            case XmlStreamReader::TokenType::EndElement:
+                if (builder.endElement()) {
+                    ++recordsRead_;
+                    if (process()) {
+                        batch.push_back(std::move(current));
+                        current = Record();
+                        if (batch.size() >= kBatchSize) ok = deliver();
+                    }
+                }
+                break;
+            case XmlStreamReader::TokenType::Text:
+            case XmlStreamReader::TokenType::CData:
+                builder.characters(reader);
+                break;
+            default:
+                break;
+        }
+
+        ok = ok && reportProgress(reader.bytesConsumed());
+    }
+
+    if (ok && !rootSeen && !exhausted) {
+        errorMessage_ = "No root element found";
+        ok = false;
+    }
+    bytesRead_ = reader.bytesConsumed();
+    ok = ok && deliver();
+    if (ok && progressCallback_) {
+        progressCallback_(bytesRead_);
+    }
+    return ok;
+}
+
+bool XmlPipeline::run(std::istream& input, std::ostream& output, XmlSerializer::Format format,
+                      XmlSerializer::OutputStyle style) {
+    std::string buffer;
+    buffer.reserve(kFlushThreshold + 4096);
+    auto flush = [this, &buffer, &output](bool force) {
+        if (!force && buffer.size() < kFlushThreshold) return true;
+        output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        if (!output) {
+            errorMessage_ = "Failed to write output";
+            return false;
+        }
+        return true;
+    };
+
+    if (format == XmlSerializer::Format::CSV) {
+        CsvRecordWriter writer;
+        bool ok = run(input, [&](const std::vector<Record>& batch) {
+            for (const Record& record : batch) writer.record(buffer, record);
+            return flush(false);
+        });
+        return ok && flush(true);
+    }
+    if (format != XmlSerializer::Format::JSON) {
+        errorMessage_ = "Pipelines write JSON or CSV only";
+        return false;
+    }
+
+    auto runJson = [&](auto writer) {
+        using Writer = decltype(writer);
+        bool first = true;
+        Writer::begin(buffer);
+        bool ok = run(input, [&](const std::vector<Record>& batch) {
+            for (const Record& record : batch) {
+                Writer::record(buffer, record, first);
+                first = false;
+            }
+            return flush(false);
+        });
+        if (!ok) return false;
+        Writer::end(buffer, first);
+        return flush(true);
+    };
+    switch (style) {
+        case Style::Compact: return runJson(JsonRecordWriter<Style::Compact>());
+        case Style::Minified: return runJson(JsonRecordWriter<Style::Minified>());
+        case Style::Pretty:
+        default: return runJson(JsonRecordWriter<Style::Pretty>());
+    }
+}
+
+bool XmlPipeline::runFile(const std::string& inputPath, const std::string& outputPath,
+                          XmlSerializer::Format format, XmlSerializer::OutputStyle style) {
+    CompressedInputStream input(inputPath);
+    if (!input.isOpen()) {
+        errorMessage_ = input.getErrorMessage();
+        return false;
+    }
+
+    CompressionType outputCompression = compressionFromExtension(outputPath);
+    if (!isCompressionSupported(outputCompression)) {
+        errorMessage_ = "Zstandard support is not available in this build";
+        return false;
+    }
+    CompressedOutputStream output(outputPath, outputCompression);
+    if (!output.isOpen()) {
+        errorMessage_ = output.getErrorMessage();
+        return false;
+    }
+
+    // Report the position in the compressed file so progress matches its size
+    ProgressCallback callback = progressCallback_;
+    if (callback && input.compression() != CompressionType::None) {
+        progressCallback_ = [&input, &callback](uint64_t) {
+            return callback(input.compressedBytesRead());
+        };
+    }
+
+    bool ok = run(input, output, format, style);
+    progressCallback_ = callback;
+    if (input.hasError()) {
+        errorMessage_ = input.getErrorMessage();
+        ok = false;
+    }
+    if (!output.close() && ok) {
+        errorMessage_ = output.getErrorMessage();
+        ok = false;
+    }
+    if (!ok) {
+        // Do not leave a truncated document behind
+        std::remove(outputPath.c_str());
+    }
+    return ok;
+}
+
+std::vector<XmlPipeline::Record> XmlPipeline::preview(std::istream& input, size_t maxRecords) {
+    std::vector<Record> records;
+    limit(maxRecords);
+    run(input, [&records](const std::vector<Record>& batch) {
+        records.insert(records.end(), batch.begin(), batch.end());
+        return true;
+    });
+    stages_.pop_back();
+    return records;
+}
+
+bool XmlPipeline::reportProgress(uint64_t bytesRead) {
+    bytesRead_ = bytesRead;
+    if (bytesRead < nextProgress_) {
+        return true;
+    }
+    nextProgress_ = bytesRead + kProgressInterval;
+    if (progressCallback_ && !progressCallback_(bytesRead)) {
+        errorMessage_ = "Pipeline cancelled";
+        return false;
+    }
+    return true;
+}
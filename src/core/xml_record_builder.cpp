@@ -0,0 +1,78 @@
+#include "xml_record_builder.h"
+
+namespace {
+
+std::string trimmed(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+XmlRecordBuilder::XmlRecordBuilder(const XmlSerializer::SerializationConfig& config)
+    : config_(config) {
+}
+
+void XmlRecordBuilder::startElement(const XmlStreamReader& reader) {
+    int depth = reader.depth();
+    if (depth == 0) return;  // the root only groups the records
+
+    if (depth == 1) {
+        recordName_ = reader.name();
+        fields_.clear();
+        fieldIndex_.clear();
+        path_.clear();
+        texts_.clear();
+    } else {
+        path_.push_back(path_.empty() ? reader.name() : path_.back() + "." + reader.name());
+    }
+    texts_.emplace_back();
+
+    const std::string prefix = path_.empty() ? std::string() : path_.back() + ".";
+    for (const auto& attr : reader.attributes()) {
+        setField(prefix + config_.attributePrefix + attr.first, attr.second);
+    }
+}
+
+bool XmlRecordBuilder::endElement() {
+    if (texts_.empty()) return false;  // end of the root
+
+    std::string text = trimmed(texts_.back());
+    texts_.pop_back();
+
+    if (!path_.empty()) {
+        if (!text.empty()) setField(path_.back(), text);
+        path_.pop_back();
+        return false;
+    }
+
+    if (!text.empty()) setField(config_.textElementName, text);
+    return true;
+}
+
+void XmlRecordBuilder::characters(const XmlStreamReader& reader) {
+    if (!texts_.empty()) {
+        texts_.back() += reader.text();
+    }
+}
+
+const std::string* XmlRecordBuilder::field(const std::string& name) const {
+    auto it = fieldIndex_.find(name);
+    return it != fieldIndex_.end() ? &fields_[it->second].second : nullptr;
+}
+
+void XmlRecordBuilder::setField(const std::string& name, const std::string& value) {
+    auto it = fieldIndex_.find(name);
+    if (it == fieldIndex_.end()) {
+        fieldIndex_.emplace(name, fields_.size());
+        fields_.emplace_back(name, value);
+    } else {
+        // Repeated elements within a record share one field
+        std::string& existing = fields_[it->second].second;
+        if (!existing.empty()) existing += "; ";
+        existing += value;
+    }
+}
@@ -0,0 +1,562 @@
+#include "xml_record_index.h"
+#include "cache_directory.h"
+#include "xml_parser.h"
+#include "xml_stream_reader.h"
+#include "compressed_stream.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// Index file layout: this header, then blocks of [type][count][entries].
+// Values are in host byte order: the index is a local cache, not an exchange
+// format.
+struct XmlRecordIndex::Header {
+    char magic[8];
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t stride;
+    uint64_t complete;
+    uint64_t resumeOffset;    // source offset where indexing continues
+    uint64_t recordCount;
+    uint64_t committedBytes;  // index file bytes covered by the last checkpoint
+    char keyAttribute[64];
+};
+
+struct XmlRecordIndex::ChunkResult {
+    size_t start = 0;
+    size_t next = 0;  // first record at or past the chunk limit, or the content end
+    uint64_t count = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> offsets;  // local ordinals
+    std::vector<std::pair<std::string, uint64_t>> keys;
+    std::string error;
+};
+
+namespace {
+
+const char kMagic[8] = {'N', 'X', 'R', 'I', 'D', 'X', '0', '1'};
+
+enum BlockType : uint64_t {
+    OffsetBlock = 1,  // count x (ordinal, offset)
+    KeyBlock = 2      // count x (ordinal, length, key bytes)
+};
+
+// Chunks smaller than this are not worth a thread
+constexpr size_t kMinChunkBytes = 1024 * 1024;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isNameEnd(char c) {
+    return isSpace(c) || c == '/' || c == '>';
+}
+
+void appendU64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool readU64(std::istream& in, uint64_t& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+// Finds attribute name in the start tag at tag and returns its unescaped value
+bool findAttribute(const char* tag, const char* limit, const std::string& name, std::string& value) {
+    const char* p = tag + 1;
+    while (p < limit && !isNameEnd(*p)) ++p;
+    while (p < limit) {
+        while (p < limit && isSpace(*p)) ++p;
+        if (p >= limit || *p == '>' || *p == '/') return false;
+
+        const char* nameBegin = p;
+        while (p < limit && *p != '=' && !isNameEnd(*p)) ++p;
+        const char* nameEnd = p;
+        while (p < limit && isSpace(*p)) ++p;
+        if (p >= limit || *p != '=') return false;
+        ++p;
+        while (p < limit && isSpace(*p)) ++p;
+        if (p >= limit || (*p != '"' && *p != '\'')) return false;
+
+        const char quote = *p++;
+        const void* close = std::memchr(p, quote, static_cast<size_t>(limit - p));
+        if (!close) return false;
+        const char* valueEnd = static_cast<const char*>(close);
+        if (static_cast<size_t>(nameEnd - nameBegin) == name.size() &&
+            std::memcmp(nameBegin, name.data(), name.size()) == 0) {
+            value = XmlStreamReader::unescape(std::string(p, valueEnd));
+            return true;
+        }
+        p = valueEnd + 1;
+    }
+    return false;
+}
+
+int64_t modificationTime(const std::string& path, std::error_code& error) {
+    return static_cast<int64_t>(fs::last_write_time(fs::u8path(path), error).time_since_epoch().count());
+}
+
+} // namespace
+
+XmlRecordIndex::XmlRecordIndex()
+    : sourceSize_(0), sourceTime_(0), stride_(kDefaultStride), complete_(false), recordCount_(0) {
+}
+
+bool XmlRecordIndex::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message;
+    }
+    return false;
+}
+
+void XmlRecordIndex::close() {
+    source_.close();
+    layout_ = XmlRecordScanner::Layout();
+    recordName_.clear();
+    keyAttribute_.clear();
+    complete_ = false;
+    recordCount_ = 0;
+    offsets_.clear();
+    keys_.clear();
+    errorMessage_.clear();
+}
+
+std::string XmlRecordIndex::defaultIndexPath(const std::string& sourcePath) {
+    std::string beside = sourcePath + ".nxidx";
+    std::error_code error;
+    if (fs::exists(fs::u8path(beside), error)) {
+        return beside;
+    }
+    {
+        std::ofstream probe(fs::u8path(beside), std::ios::binary | std::ios::app);
+        if (probe.is_open()) {
+            probe.close();
+            fs::remove(fs::u8path(beside), error);
+            return beside;
+        }
+    }
+
+    // Read-only directory: key the cache file by the absolute source path
+    fs::path cache = userCacheDirectory("index");
+    fs::path absolute = fs::absolute(fs::u8path(sourcePath), error);
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx",
+                  static_cast<unsigned long long>(std::hash<std::string>()(absolute.u8string())));
+    return (cache / (fs::u8path(sourcePath).filename().u8string() + "-" + hash + ".nxidx")).u8string();
+}
+
+bool XmlRecordIndex::openSource(const std::string& sourcePath) {
+    if (detectCompression(sourcePath) != CompressionType::None) {
+        return fail("Compressed files cannot be indexed; decompress " + sourcePath + " first");
+    }
+    std::error_code error;
+    sourceTime_ = modificationTime(sourcePath, error);
+    if (error || !source_.open(sourcePath)) {
+        return fail(source_.hasError() ? source_.getErrorMessage() : "Cannot open " + sourcePath);
+    }
+    sourceSize_ = source_.size();
+
+    XmlRecordScanner scanner(source_.data(), source_.size());
+    if (!scanner.scanLayout()) {
+        return fail(sourcePath + ": " + scanner.getErrorMessage());
+    }
+    layout_ = scanner.layout();
+
+    size_t pos = layout_.contentBegin;
+    size_t begin = 0;
+    size_t end = 0;
+    if (scanner.nextRecord(pos, begin, end)) {
+        size_t nameEnd = begin + 1;
+        while (nameEnd < end && !isNameEnd(source_.data()[nameEnd])) ++nameEnd;
+        recordName_.assign(source_.data() + begin + 1, nameEnd - begin - 1);
+    }
+    return true;
+}
+
+bool XmlRecordIndex::readIndex(const std::string& indexPath, Header& header) {
+    std::ifstream in(fs::u8path(indexPath), std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail("Not a record index: " + indexPath);
+    }
+    if (header.sourceSize != sourceSize_ || header.sourceTime != sourceTime_) {
+        return fail("The record index is out of date");
+    }
+
+    // Nothing below is trusted: every count, length, ordinal and offset is
+    // checked against the committed bytes, the record count and the source
+    std::error_code error;
+    const uint64_t fileBytes = fs::file_size(fs::u8path(indexPath), error);
+    if (error || header.committedBytes < sizeof(header) || header.committedBytes > fileBytes ||
+        header.stride == 0 || header.resumeOffset < layout_.contentBegin || header.resumeOffset > layout_.contentEnd) {
+        return fail("The record index is corrupt");
+    }
+
+    keyAttribute_.assign(header.keyAttribute, strnlen(header.keyAttribute, sizeof(header.keyAttribute)));
+    stride_ = header.stride;
+    complete_ = header.complete != 0;
+    recordCount_ = header.recordCount;
+    offsets_.clear();
+    keys_.clear();
+
+    const uint64_t entryBytes = 2 * sizeof(uint64_t);
+    uint64_t position = sizeof(header);
+    while (position < header.committedBytes) {
+        uint64_t type = 0;
+        uint64_t count = 0;
+        if (header.committedBytes - position < entryBytes || !readU64(in, type) || !readU64(in, count)) {
+            return fail("The record index is corrupt");
+        }
+        position += entryBytes;
+        if ((type != OffsetBlock && type != KeyBlock) || count > (header.committedBytes - position) / entryBytes) {
+            return fail("The record index is corrupt");
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t ordinal = 0;
+            uint64_t value = 0;
+            if (header.committedBytes - position < entryBytes || !readU64(in, ordinal) || !readU64(in, value) ||
+                ordinal >= recordCount_) {
+                return fail("The record index is corrupt");
+            }
+            position += entryBytes;
+            if (type == OffsetBlock) {
+                // Ascending, and each one inside the source's content
+                if (value < layout_.contentBegin || value >= layout_.contentEnd ||
+                    (!offsets_.empty() && (ordinal <= offsets_.back().first || value <= offsets_.back().second))) {
+                    return fail("The record index is corrupt");
+                }
+                offsets_.emplace_back(ordinal, value);
+            } else {
+                if (value > header.committedBytes - position) {
+                    return fail("The record index is corrupt");
+                }
+                std::string key(static_cast<size_t>(value), '\0');
+                if (!in.read(&key[0], static_cast<std::streamsize>(value))) {
+                    return fail("The record index is corrupt");
+                }
+                position += value;
+                keys_.emplace_back(std::move(key), ordinal);
+            }
+        }
+    }
+    // findRecord starts from the entry at or before an ordinal, so record 0
+    // must have one
+    if (recordCount_ > 0 && (offsets_.empty() || offsets_.front().first != 0)) {
+        return fail("The record index is corrupt");
+    }
+    return true;
+}
+
+bool XmlRecordIndex::load(const std::string& sourcePath, const std::string& indexPath) {
+    close();
+    Header header;
+    if (!openSource(sourcePath) || !readIndex(indexPath, header)) {
+        source_.close();
+        return false;
+    }
+    if (!complete_) {
+        source_.close();
+        return fail("The record index is incomplete; build it again to finish");
+    }
+    std::sort(keys_.begin(), keys_.end());
+    return true;
+}
+
+bool XmlRecordIndex::build(const std::string& sourcePath, const std::string& indexPath,
+                           const Options& options) {
+    close();
+    Header header;
+    if (options.stride == 0 || options.segmentBytes == 0) {
+        return fail("Stride and segment size must be positive");
+    }
+    if (options.keyAttribute.size() >= sizeof(header.keyAttribute)) {
+        return fail("Key attribute name is too long");
+    }
+    if (!openSource(sourcePath)) {
+        return false;
+    }
+
+    // Reuse a current index, or pick up where an interrupted build stopped; a
+    // stale or foreign file is simply rebuilt
+    bool resume = false;
+    std::error_code error;
+    if (fs::exists(fs::u8path(indexPath), error) && readIndex(indexPath, header) &&
+        header.stride == options.stride && keyAttribute_ == options.keyAttribute) {
+        if (complete_) {
+            std::sort(keys_.begin(), keys_.end());
+            return true;
+        }
+        resume = true;
+    }
+    errorMessage_.clear();
+
+    if (!resume) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.sourceSize = sourceSize_;
+        header.sourceTime = sourceTime_;
+        header.stride = options.stride;
+        header.resumeOffset = layout_.contentBegin;
+        header.committedBytes = sizeof(header);
+        std::memcpy(header.keyAttribute, options.keyAttribute.data(), options.keyAttribute.size());
+        offsets_.clear();
+        keys_.clear();
+        recordCount_ = 0;
+
+        std::ofstream create(fs::u8path(indexPath), std::ios::binary | std::ios::trunc);
+        create.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!create) {
+            return fail("Cannot write index " + indexPath);
+        }
+    } else {
+        // Drop anything written after the last checkpoint
+        fs::resize_file(fs::u8path(indexPath), header.committedBytes, error);
+    }
+    keyAttribute_ = options.keyAttribute;
+    stride_ = options.stride;
+    complete_ = false;
+
+    std::fstream out(fs::u8path(indexPath), std::ios::in | std::ios::out | std::ios::binary);
+    if (!out || error) {
+        return fail("Cannot write index " + indexPath);
+    }
+
+    const unsigned threadCount = options.threadCount ? options.threadCount
+                                                     : std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t totalBytes = layout_.contentEnd - layout_.contentBegin;
+    size_t pos = static_cast<size_t>(header.resumeOffset);
+
+    while (pos < layout_.contentEnd) {
+        size_t segmentEnd = pos + static_cast<size_t>(std::min<uint64_t>(options.segmentBytes, layout_.contentEnd - pos));
+        size_t offsetsBefore = offsets_.size();
+        size_t keysBefore = keys_.size();
+        size_t next = 0;
+        if (!indexSegment(pos, segmentEnd, threadCount, next)) {
+            return false;
+        }
+
+        // Checkpoint: append the new entries, then commit them in the header
+        std::string block;
+        appendU64(block, OffsetBlock);
+        appendU64(block, offsets_.size() - offsetsBefore);
+        for (size_t i = offsetsBefore; i < offsets_.size(); ++i) {
+            appendU64(block, offsets_[i].first);
+            appendU64(block, offsets_[i].second);
+        }
+        if (keys_.size() > keysBefore) {
+            appendU64(block, KeyBlock);
+            appendU64(block, keys_.size() - keysBefore);
+            for (size_t i = keysBefore; i < keys_.size(); ++i) {
+                appendU64(block, keys_[i].second);
+                appendU64(block, keys_[i].first.size());
+                block += keys_[i].first;
+            }
+        }
+        out.seekp(static_cast<std::streamoff>(header.committedBytes));
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        out.flush();
+
+        header.committedBytes += block.size();
+        header.resumeOffset = next;
+        header.recordCount = recordCount_;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.flush();
+        if (!out) {
+            return fail("Failed to write index " + indexPath);
+        }
+
+        pos = next;
+        if (progressCallback_ && !progressCallback_(pos - layout_.contentBegin, totalBytes)) {
+            return fail("Indexing cancelled");
+        }
+    }
+
+    header.complete = 1;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    if (!out) {
+        return fail("Failed to write index " + indexPath);
+    }
+    complete_ = true;
+    std::sort(keys_.begin(), keys_.end());
+    return true;
+}
+
+size_t XmlRecordIndex::findCandidate(size_t from) const {
+    const char* data = source_.data();
+    const size_t limit = layout_.contentEnd;
+    if (recordName_.empty()) {
+        return limit;
+    }
+    while (from < limit) {
+        const void* hit = std::memchr(data + from, '<', limit - from);
+        if (!hit) break;
+        size_t pos = static_cast<const char*>(hit) - data;
+        size_t nameEnd = pos + 1 + recordName_.size();
+        if (nameEnd < limit && isNameEnd(data[nameEnd]) &&
+            std::memcmp(data + pos + 1, recordName_.data(), recordName_.size()) == 0) {
+            return pos;
+        }
+        from = pos + 1;
+    }
+    return limit;
+}
+
+XmlRecordIndex::ChunkResult XmlRecordIndex::scanChunk(size_t start, size_t limit) const {
+    ChunkResult result;
+    result.start = start;
+    result.next = layout_.contentEnd;
+    if (start >= layout_.contentEnd) {
+        return result;
+    }
+
+    XmlRecordScanner scanner(source_.data(), source_.size());
+    scanner.setContentRange(start, layout_.contentEnd);
+    size_t pos = start;
+    size_t begin = 0;
+    size_t end = 0;
+    std::string key;
+    while (scanner.nextRecord(pos, begin, end)) {
+        if (begin >= limit) {
+            result.next = begin;
+            return result;
+        }
+        if (result.count % stride_ == 0) {
+            result.offsets.emplace_back(result.count, begin);
+        }
+        if (!keyAttribute_.empty() &&
+            findAttribute(source_.data() + begin, source_.data() + end, keyAttribute_, key)) {
+            result.keys.emplace_back(key, result.count);
+        }
+        ++result.count;
+    }
+    if (scanner.hasError()) {
+        result.error = scanner.getErrorMessage();
+    }
+    return result;
+}
+
+bool XmlRecordIndex::indexSegment(size_t begin, size_t end, unsigned threadCount, size_t& next) {
+    const size_t length = end - begin;
+    const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, length / kMinChunkBytes));
+    std::vector<size_t> bounds(chunkCount + 1);
+    for (size_t k = 0; k < chunkCount; ++k) {
+        bounds[k] = begin + static_cast<size_t>(static_cast<uint64_t>(length) * k / chunkCount);
+    }
+    bounds[chunkCount] = end;
+
+    // Speculative pass: every chunk but the first guesses its first record
+    std::vector<ChunkResult> results(chunkCount);
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&]() {
+        size_t k;
+        while ((k = nextChunk.fetch_add(1)) < chunkCount) {
+            size_t start = (k == 0) ? begin : findCandidate(bounds[k]);
+            results[k] = scanChunk(start, bounds[k + 1]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    // Stitch the chunks together, rescanning any whose guess was wrong
+    size_t handoff = begin;
+    for (size_t k = 0; k < chunkCount; ++k) {
+        if (results[k].start != handoff) {
+            results[k] = scanChunk(handoff, bounds[k + 1]);
+        }
+        const ChunkResult& result = results[k];
+        if (!result.error.empty()) {
+            return fail(result.error);
+        }
+        for (const auto& entry : result.offsets) {
+            offsets_.emplace_back(recordCount_ + entry.first, entry.second);
+        }
+        for (const auto& entry : result.keys) {
+            keys_.emplace_back(entry.first, recordCount_ + entry.second);
+        }
+        recordCount_ += result.count;
+        handoff = result.next;
+    }
+    next = handoff;
+    return true;
+}
+
+bool XmlRecordIndex::findRecord(uint64_t ordinal, uint64_t& begin, uint64_t& end) {
+    errorMessage_.clear();
+    if (!isOpen()) {
+        return fail("No record index is loaded");
+    }
+    if (ordinal >= recordCount_) {
+        return fail("Record " + std::to_string(ordinal + 1) + " is out of range; the file has " +
+                    std::to_string(recordCount_) + " records");
+    }
+
+    auto entry = std::upper_bound(offsets_.begin(), offsets_.end(), ordinal,
+                                  [](uint64_t value, const std::pair<uint64_t, uint64_t>& item) {
+                                      return value < item.first;
+                                  });
+    if (entry == offsets_.begin()) {
+        return fail("The record index is corrupt");
+    }
+    --entry;
+
+    XmlRecordScanner scanner(source_.data(), source_.size());
+    scanner.setContentRange(static_cast<size_t>(entry->second), layout_.contentEnd);
+    size_t pos = static_cast<size_t>(entry->second);
+    size_t recordBegin = 0;
+    size_t recordEnd = 0;
+    for (uint64_t skip = ordinal - entry->first;; --skip) {
+        if (!scanner.nextRecord(pos, recordBegin, recordEnd)) {
+            return fail(scanner.hasError() ? scanner.getErrorMessage()
+                                           : "Record not found; the index may be out of date");
+        }
+        if (skip == 0) break;
+    }
+    begin = recordBegin;
+    end = recordEnd;
+    return true;
+}
+
+std::vector<uint64_t> XmlRecordIndex::findByKey(const std::string& value) const {
+    std::vector<uint64_t> ordinals;
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), std::make_pair(value, uint64_t(0)));
+    for (; it != keys_.end() && it->first == value; ++it) {
+        ordinals.push_back(it->second);
+    }
+    return ordinals;
+}
+
+bool XmlRecordIndex::readRecordText(uint64_t ordinal, std::string& text) {
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    if (!findRecord(ordinal, begin, end)) {
+        return false;
+    }
+    text.assign(source_.data() + begin, static_cast<size_t>(end - begin));
+    return true;
+}
+
+std::shared_ptr<XmlNode> XmlRecordIndex::readRecord(uint64_t ordinal) {
+    std::string text;
+    if (!readRecordText(ordinal, text)) {
+        return nullptr;
+    }
+    XmlParser parser;
+    auto record = parser.parseString(text);
+    if (!record) {
+        fail(parser.getErrorMessage());
+    }
+    return record;
+}
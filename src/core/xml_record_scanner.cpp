@@ -0,0 +1,236 @@
+#include "xml_record_scanner.h"
+#include <cstring>
+
+namespace {
+
+constexpr size_t npos = static_cast<size_t>(-1);
+
+bool isNameEnd(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>';
+}
+
+} // namespace
+
+XmlRecordScanner::XmlRecordScanner(const char* data, size_t size)
+    : data_(data), size_(size), partial_(false), reachedEndTag_(false) {
+}
+
+bool XmlRecordScanner::fail(const std::string& message, size_t offset) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message + " at offset " + std::to_string(offset);
+    }
+    return false;
+}
+
+size_t XmlRecordScanner::find(const char* pattern, size_t from, size_t limit) const {
+    const size_t length = std::strlen(pattern);
+    while (from + length <= limit) {
+        const void* hit = std::memchr(data_ + from, pattern[0], limit - from - length + 1);
+        if (!hit) return npos;
+        size_t pos = static_cast<const char*>(hit) - data_;
+        if (std::memcmp(data_ + pos, pattern, length) == 0) return pos;
+        from = pos + 1;
+    }
+    return npos;
+}
+
+size_t XmlRecordScanner::findTagEnd(size_t from, size_t limit) const {
+    // '>' may appear inside quoted attribute values
+    char quote = 0;
+    for (size_t i = from; i < limit; ++i) {
+        char c = data_[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return i;
+        }
+    }
+    return npos;
+}
+
+size_t XmlRecordScanner::skipMarkup(size_t pos, size_t limit) const {
+    // pos is at "<!" or "<?"; returns the offset just past the construct
+    size_t end;
+    if (data_[pos + 1] == '?') {
+        end = find("?>", pos + 2, limit);
+        return end == npos ? npos : end + 2;
+    }
+    if (find("<!--", pos, pos + 4 <= limit ? pos + 4 : limit) == pos) {
+        end = find("-->", pos + 4, limit);
+        return end == npos ? npos : end + 3;
+    }
+    if (find("<![CDATA[", pos, pos + 9 <= limit ? pos + 9 : limit) == pos) {
+        end = find("]]>", pos + 9, limit);
+        return end == npos ? npos : end + 3;
+    }
+
+    // <!DOCTYPE ...> with an optional [internal subset]
+    int brackets = 0;
+    char quote = 0;
+    for (size_t i = pos + 2; i < limit; ++i) {
+        char c = data_[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '[') {
+            ++brackets;
+        } else if (c == ']') {
+            --brackets;
+        } else if (c == '>' && brackets <= 0) {
+            return i + 1;
+        }
+    }
+    return npos;
+}
+
+bool XmlRecordScanner::scanLayout() {
+    if (!scanRootStart()) {
+        return false;
+    }
+    if (data_[layout_.contentBegin - 2] == '/') {
+        return true;  // <root/>
+    }
+
+    // Only comments, PIs and whitespace may follow the root, so its end tag
+    // is found quickly by searching backwards
+    const std::string closing = "</" + layout_.rootName;
+    for (size_t i = size_; i-- > layout_.contentBegin;) {
+        if (data_[i] != '<' || size_ - i < closing.size() + 1) continue;
+        if (std::memcmp(data_ + i, closing.data(), closing.size()) == 0 &&
+            isNameEnd(data_[i + closing.size()])) {
+            size_t end = findTagEnd(i, size_);
+            if (end == npos) break;
+            layout_.contentEnd = i;
+            layout_.rootEnd = end + 1;
+            return true;
+        }
+    }
+    return fail("Root element <" + layout_.rootName + "> is not closed", size_);
+}
+
+bool XmlRecordScanner::scanRootStart() {
+    errorMessage_.clear();
+    layout_ = Layout();
+    partial_ = false;
+    reachedEndTag_ = false;
+
+    size_t pos = 0;
+    while (true) {
+        const void* hit = pos < size_ ? std::memchr(data_ + pos, '<', size_ - pos) : nullptr;
+        if (!hit) {
+            return fail("No root element found", size_);
+        }
+        pos = static_cast<const char*>(hit) - data_;
+        if (pos + 1 < size_ && (data_[pos + 1] == '?' || data_[pos + 1] == '!')) {
+            size_t next = skipMarkup(pos, size_);
+            if (next == npos) return fail("Unterminated markup in the prolog", pos);
+            pos = next;
+            continue;
+        }
+        break;
+    }
+
+    size_t tagEnd = findTagEnd(pos + 1, size_);
+    if (tagEnd == npos) {
+        return fail("Unterminated root start tag", pos);
+    }
+    size_t nameEnd = pos + 1;
+    while (nameEnd < tagEnd && !isNameEnd(data_[nameEnd])) {
+        ++nameEnd;
+    }
+    layout_.rootName.assign(data_ + pos + 1, nameEnd - pos - 1);
+    if (layout_.rootName.empty()) {
+        return fail("Invalid root tag name", pos);
+    }
+    layout_.rootBegin = pos;
+    layout_.contentBegin = tagEnd + 1;
+
+    if (data_[tagEnd - 1] == '/') {
+        // <root/>: no records
+        layout_.contentEnd = layout_.rootEnd = layout_.contentBegin;
+    } else {
+        layout_.contentEnd = layout_.rootEnd = size_;
+    }
+    return true;
+}
+
+void XmlRecordScanner::setContentRange(size_t begin, size_t end, bool partial) {
+    errorMessage_.clear();
+    layout_.contentBegin = begin;
+    layout_.contentEnd = end;
+    partial_ = partial;
+    reachedEndTag_ = false;
+}
+
+bool XmlRecordScanner::nextRecord(size_t& pos, size_t& begin, size_t& end) {
+    const size_t limit = layout_.contentEnd;
+    int depth = 0;
+    size_t resume = pos;  // start of the record or markup being scanned
+
+    // Running into the limit is an error for a complete document, but only
+    // means "not written yet" for partial content
+    auto truncated = [&](const char* message, size_t offset) {
+        if (partial_) {
+            pos = resume;
+            return false;
+        }
+        return fail(message, offset);
+    };
+
+    while (pos < limit) {
+        const void* hit = std::memchr(data_ + pos, '<', limit - pos);
+        if (!hit) {
+            pos = limit;
+            break;
+        }
+        size_t lt = static_cast<const char*>(hit) - data_;
+        if (depth == 0) resume = lt;
+        if (lt + 1 >= limit) {
+            return truncated("Unterminated tag", lt);
+        }
+        char next = data_[lt + 1];
+
+        if (next == '!' || next == '?') {
+            size_t after = skipMarkup(lt, limit);
+            if (after == npos) return truncated("Unterminated markup", lt);
+            pos = after;
+            continue;
+        }
+
+        size_t tagEnd = findTagEnd(lt + 1, limit);
+        if (tagEnd == npos) return truncated("Unterminated tag", lt);
+
+        if (next == '/') {
+            if (depth == 0) {
+                if (partial_) {
+                    pos = lt;
+                    reachedEndTag_ = true;
+                    return false;
+                }
+                return fail("Unexpected end tag", lt);
+            }
+            pos = tagEnd + 1;
+            if (--depth == 0) {
+                end = pos;
+                return true;
+            }
+        } else {
+            pos = tagEnd + 1;
+            if (depth == 0) begin = lt;
+            if (data_[tagEnd - 1] != '/') {
+                ++depth;
+            } else if (depth == 0) {
+                end = pos;
+                return true;
+            }
+        }
+    }
+
+    if (depth > 0) {
+        return truncated("Unterminated record", begin);
+    }
+    return false;
+}
@@ -0,0 +1,742 @@
+#include "xml_schema_profiler.h"
+#include "xml_stream_reader.h"
+#include "xml_record_scanner.h"
+#include "mapped_file.h"
+#include "compressed_stream.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+namespace {
+
+using TokenType = XmlStreamReader::TokenType;
+
+// Files smaller than this are profiled on one thread
+constexpr size_t kMinParallelBytes = 4 * 1024 * 1024;
+
+// Read-only stream over a memory range, for feeding mapped chunks to the reader
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const char* data, size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
+
+bool isXmlWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isXmlWhitespace(text[begin])) ++begin;
+    while (end > begin && isXmlWhitespace(text[end - 1])) --end;
+    return text.substr(begin, end - begin);
+}
+
+bool isDigits(const std::string& text, size_t begin, size_t end) {
+    if (begin >= end) return false;
+    for (size_t i = begin; i < end; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) return false;
+    }
+    return true;
+}
+
+bool isInteger(const std::string& text) {
+    size_t start = (!text.empty() && (text[0] == '-' || text[0] == '+')) ? 1 : 0;
+    return isDigits(text, start, text.size());
+}
+
+bool isDecimal(const std::string& text) {
+    size_t start = (!text.empty() && (text[0] == '-' || text[0] == '+')) ? 1 : 0;
+    size_t dot = text.find('.', start);
+    if (dot == std::string::npos) return isDigits(text, start, text.size());
+    bool whole = dot == start || isDigits(text, start, dot);
+    bool fraction = dot + 1 == text.size() || isDigits(text, dot + 1, text.size());
+    return whole && fraction && text.size() - start > 1;
+}
+
+// YYYY-MM-DD
+bool isDate(const std::string& text, size_t length) {
+    return length == 10 && text.size() >= 10 && isDigits(text, 0, 4) && text[4] == '-' &&
+           isDigits(text, 5, 7) && text[7] == '-' && isDigits(text, 8, 10);
+}
+
+// YYYY-MM-DDThh:mm:ss[.fraction][Z|(+|-)hh:mm]
+bool isDateTime(const std::string& text) {
+    if (text.size() < 19 || !isDate(text, 10) || text[10] != 'T' || !isDigits(text, 11, 13) ||
+        text[13] != ':' || !isDigits(text, 14, 16) || text[16] != ':' || !isDigits(text, 17, 19)) {
+        return false;
+    }
+    size_t pos = 19;
+    if (pos < text.size() && text[pos] == '.') {
+        size_t digits = ++pos;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) ++pos;
+        if (pos == digits) return false;
+    }
+    if (pos == text.size()) return true;
+    if (text[pos] == 'Z') return pos + 1 == text.size();
+    return (text[pos] == '+' || text[pos] == '-') && pos + 6 == text.size() &&
+           isDigits(text, pos + 1, pos + 3) && text[pos + 3] == ':' && isDigits(text, pos + 4, pos + 6);
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream out;
+    out << std::setprecision(15) << value;
+    return out.str();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ValueStats / Profile
+
+void XmlSchemaProfiler::ValueStats::add(const std::string& value) {
+    ++count;
+    if (count == 1) {
+        minLength = maxLength = value.size();
+    } else {
+        minLength = std::min(minLength, value.size());
+        maxLength = std::max(maxLength, value.size());
+    }
+
+    allBoolean = allBoolean && (value == "true" || value == "false");
+    allInteger = allInteger && isInteger(value);
+    allDecimal = allDecimal && isDecimal(value);
+    allDate = allDate && isDate(value, value.size());
+    allDateTime = allDateTime && isDateTime(value);
+    if (allDecimal) {
+        double number = std::strtod(value.c_str(), nullptr);
+        if (count == 1) {
+            minNumber = maxNumber = number;
+        } else {
+            minNumber = std::min(minNumber, number);
+            maxNumber = std::max(maxNumber, number);
+        }
+    }
+
+    std::string sample = value.size() > kMaxSampleLength ? value.substr(0, kMaxSampleLength) : value;
+    for (auto& entry : samples) {
+        if (entry.first == sample) {
+            ++entry.second;
+            return;
+        }
+    }
+    if (samples.size() < kMaxDistinctValues) {
+        samples.emplace_back(std::move(sample), 1);
+    } else {
+        truncatedSamples = true;
+    }
+}
+
+void XmlSchemaProfiler::ValueStats::merge(const ValueStats& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    count += other.count;
+    minLength = std::min(minLength, other.minLength);
+    maxLength = std::max(maxLength, other.maxLength);
+    allBoolean = allBoolean && other.allBoolean;
+    allInteger = allInteger && other.allInteger;
+    allDecimal = allDecimal && other.allDecimal;
+    allDate = allDate && other.allDate;
+    allDateTime = allDateTime && other.allDateTime;
+    if (allDecimal) {
+        minNumber = std::min(minNumber, other.minNumber);
+        maxNumber = std::max(maxNumber, other.maxNumber);
+    }
+
+    truncatedSamples = truncatedSamples || other.truncatedSamples;
+    for (const auto& sample : other.samples) {
+        auto it = std::find_if(samples.begin(), samples.end(),
+                               [&sample](const std::pair<std::string, uint64_t>& entry) {
+                                   return entry.first == sample.first;
+                               });
+        if (it != samples.end()) {
+            it->second += sample.second;
+        } else if (samples.size() < kMaxDistinctValues) {
+            samples.push_back(sample);
+        } else {
+            truncatedSamples = true;
+        }
+    }
+}
+
+std::string XmlSchemaProfiler::ValueStats::typeName() const {
+    if (count == 0) return "string";
+    if (allBoolean) return "boolean";
+    if (allInteger) return "integer";
+    if (allDecimal) return "decimal";
+    if (allDate) return "date";
+    if (allDateTime) return "dateTime";
+    return "string";
+}
+
+void XmlSchemaProfiler::Profile::merge(const Profile& other) {
+    elementCount += other.elementCount;
+    if (depthHistogram.size() < other.depthHistogram.size()) {
+        depthHistogram.resize(other.depthHistogram.size(), 0);
+    }
+    for (size_t i = 0; i < other.depthHistogram.size(); ++i) {
+        depthHistogram[i] += other.depthHistogram[i];
+    }
+    if (rootPath.empty()) {
+        rootPath = other.rootPath;
+    }
+
+    for (const auto& item : other.elements) {
+        const ElementStats& from = item.second;
+        ElementStats& into = elements[item.first];
+        if (into.name.empty()) {
+            into.name = from.name;
+            into.depth = from.depth;
+        }
+        into.count += from.count;
+        if (from.parentCount > 0) {
+            if (into.parentCount == 0) {
+                into.minPerParent = from.minPerParent;
+                into.maxPerParent = from.maxPerParent;
+            } else {
+                into.minPerParent = std::min(into.minPerParent, from.minPerParent);
+                into.maxPerParent = std::max(into.maxPerParent, from.maxPerParent);
+            }
+            into.parentCount += from.parentCount;
+        }
+        into.withChildren += from.withChildren;
+        into.mixedCount += from.mixedCount;
+        into.text.merge(from.text);
+        for (const auto& attribute : from.attributes) {
+            into.attributes[attribute.first].merge(attribute.second);
+        }
+        for (const std::string& child : from.children) {
+            if (std::find(into.children.begin(), into.children.end(), child) == into.children.end()) {
+                into.children.push_back(child);
+            }
+        }
+    }
+}
+
+uint64_t XmlSchemaProfiler::Profile::minOccurs(const std::string& path) const {
+    auto it = elements.find(path);
+    if (it == elements.end()) return 0;
+    if (path == rootPath) return 1;
+    auto parent = elements.find(path.substr(0, path.rfind('/')));
+    if (parent == elements.end() || it->second.parentCount < parent->second.count) {
+        return 0;
+    }
+    return it->second.minPerParent;
+}
+
+uint64_t XmlSchemaProfiler::Profile::maxOccurs(const std::string& path) const {
+    auto it = elements.find(path);
+    if (it == elements.end()) return 0;
+    return path == rootPath ? 1 : it->second.maxPerParent;
+}
+
+// ---------------------------------------------------------------------------
+// Builder: folds one token stream into a Profile
+
+class XmlSchemaProfiler::Builder {
+public:
+    struct Frame {
+        std::string path;
+        ElementStats* stats = nullptr;
+        std::vector<std::pair<std::string, uint64_t>> childCounts;
+        std::string text;
+        bool hasChildren = false;
+    };
+
+    explicit Builder(Profile& profile) : profile_(profile), depthOffset_(0) {}
+
+    // For a run of records: their parent, the root, is already open
+    void openRoot(const std::string& rootPath) {
+        Frame frame;
+        frame.path = rootPath;
+        frame.stats = &profile_.elements[rootPath];
+        frame.stats->name = rootPath.substr(1);
+        profile_.rootPath = rootPath;
+        frames_.push_back(std::move(frame));
+        depthOffset_ = 1;
+    }
+
+    Frame takeRoot() {
+        Frame frame = std::move(frames_.front());
+        frames_.clear();
+        return frame;
+    }
+
+    bool consume(XmlStreamReader& reader, const std::function<bool(uint64_t)>& progress,
+                 std::string& error) {
+        uint64_t nextProgress = kProgressInterval;
+        while (true) {
+            TokenType token = reader.next();
+            switch (token) {
+                case TokenType::Error:
+                    error = reader.getErrorMessage();
+                    return false;
+                case TokenType::EndDocument:
+                    return true;
+                case TokenType::StartElement:
+                    startElement(reader);
+                    break;
+                case TokenType::EndElement:
+                    endElement();
+                    break;
+                case TokenType::Text:
+                case TokenType::CData:
+                    characters(reader.text());
+                    break;
+                default:
+                    break;
+            }
+            if (progress && reader.bytesConsumed() >= nextProgress) {
+                nextProgress = reader.bytesConsumed() + kProgressInterval;
+                if (!progress(reader.bytesConsumed())) {
+                    error = "Profiling cancelled";
+                    return false;
+                }
+            }
+        }
+    }
+
+    void finish(Frame& frame) {
+        ElementStats& stats = *frame.stats;
+        std::string text = trim(frame.text);
+        if (!text.empty()) {
+            stats.text.add(text);
+        }
+        if (frame.hasChildren) {
+            ++stats.withChildren;
+            if (!text.empty()) ++stats.mixedCount;
+        }
+        for (const auto& child : frame.childCounts) {
+            ElementStats& childStats = profile_.elements[frame.path + "/" + child.first];
+            if (childStats.parentCount == 0) {
+                childStats.minPerParent = childStats.maxPerParent = child.second;
+            } else {
+                childStats.minPerParent = std::min(childStats.minPerParent, child.second);
+                childStats.maxPerParent = std::max(childStats.maxPerParent, child.second);
+            }
+            ++childStats.parentCount;
+        }
+    }
+
+private:
+    void startElement(const XmlStreamReader& reader) {
+        const int depth = reader.depth() + depthOffset_;
+        Frame* parent = frames_.empty() ? nullptr : &frames_.back();
+
+        Frame frame;
+        frame.path = (parent ? parent->path : std::string()) + "/" + reader.name();
+        ElementStats& stats = profile_.elements[frame.path];
+        if (stats.count == 0 && stats.name.empty()) {
+            stats.name = reader.name();
+            stats.depth = depth;
+            if (parent) {
+                parent->stats->children.push_back(reader.name());
+            } else if (profile_.rootPath.empty()) {
+                profile_.rootPath = frame.path;
+            }
+        }
+        ++stats.count;
+        ++profile_.elementCount;
+        if (profile_.depthHistogram.size() <= static_cast<size_t>(depth)) {
+            profile_.depthHistogram.resize(depth + 1, 0);
+        }
+        ++profile_.depthHistogram[depth];
+        for (const auto& attribute : reader.attributes()) {
+            stats.attributes[attribute.first].add(attribute.second);
+        }
+
+        if (parent) {
+            parent->hasChildren = true;
+            auto it = std::find_if(parent->childCounts.begin(), parent->childCounts.end(),
+                                   [&reader](const std::pair<std::string, uint64_t>& entry) {
+                                       return entry.first == reader.name();
+                                   });
+            if (it != parent->childCounts.end()) {
+                ++it->second;
+            } else {
+                parent->childCounts.emplace_back(reader.name(), 1);
+            }
+        }
+
+        frame.stats = &stats;
+        frames_.push_back(std::move(frame));
+    }
+
+    void endElement() {
+        if (frames_.empty()) return;
+        Frame frame = std::move(frames_.back());
+        frames_.pop_back();
+        finish(frame);
+    }
+
+    void characters(const std::string& text) {
+        if (frames_.empty()) return;
+        std::string& buffer = frames_.back().text;
+        if (buffer.size() < kMaxTextLength) {
+            buffer.append(text, 0, kMaxTextLength - buffer.size());
+        }
+    }
+
+    Profile& profile_;
+    int depthOffset_;
+    std::vector<Frame> frames_;
+};
+
+// ---------------------------------------------------------------------------
+// XmlSchemaProfiler
+
+XmlSchemaProfiler::XmlSchemaProfiler() : threadCount_(0) {
+}
+
+bool XmlSchemaProfiler::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message;
+    }
+    return false;
+}
+
+bool XmlSchemaProfiler::profileString(const std::string& xml) {
+    MemoryBuffer buffer(xml.data(), xml.size());
+    std::istream input(&buffer);
+    return profileStream(input);
+}
+
+bool XmlSchemaProfiler::profileStream(std::istream& input) {
+    profile_ = Profile();
+    errorMessage_.clear();
+
+    XmlStreamReader reader(input);
+    Builder builder(profile_);
+    std::string error;
+    if (!builder.consume(reader, progressCallback_, error)) {
+        return fail(error);
+    }
+    if (profile_.rootPath.empty()) {
+        return fail("No root element found");
+    }
+    return true;
+}
+
+bool XmlSchemaProfiler::profileFile(const std::string& path) {
+    profile_ = Profile();
+    errorMessage_.clear();
+
+    if (detectCompression(path) != CompressionType::None) {
+        CompressedInputStream input(path);
+        if (!input.isOpen()) {
+            return fail(input.getErrorMessage());
+        }
+        // Report the position in the compressed file so progress matches its size
+        ProgressCallback callback = progressCallback_;
+        if (callback) {
+            progressCallback_ = [&input, &callback](uint64_t) {
+                return callback(input.compressedBytesRead());
+            };
+        }
+        bool ok = profileStream(input);
+        progressCallback_ = callback;
+        if (input.hasError()) {
+            errorMessage_.clear();
+            return fail(input.getErrorMessage());
+        }
+        return ok;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        return fail(file.getErrorMessage());
+    }
+    unsigned threads = threadCount_ ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 1 || file.size() < kMinParallelBytes) {
+        MemoryBuffer buffer(file.data(), file.size());
+        std::istream input(&buffer);
+        return profileStream(input);
+    }
+    return profileMapped(file.data(), file.size());
+}
+
+bool XmlSchemaProfiler::profileMapped(const char* data, size_t size) {
+    XmlRecordScanner scanner(data, size);
+    if (!scanner.scanLayout()) {
+        return fail(scanner.getErrorMessage());
+    }
+    const XmlRecordScanner::Layout layout = scanner.layout();
+
+    // The root element on its own: its attributes, depth 0
+    std::string rootXml(data + layout.rootBegin, layout.contentBegin - layout.rootBegin);
+    const bool selfClosing = rootXml.size() >= 2 && rootXml[rootXml.size() - 2] == '/';
+    if (!selfClosing) {
+        rootXml += "</" + layout.rootName + ">";
+    }
+    {
+        MemoryBuffer buffer(rootXml.data(), rootXml.size());
+        std::istream input(&buffer);
+        XmlStreamReader reader(input);
+        Builder builder(profile_);
+        std::string error;
+        if (!builder.consume(reader, nullptr, error)) {
+            return fail(error);
+        }
+    }
+    if (selfClosing || layout.contentEnd == layout.contentBegin) {
+        return true;
+    }
+
+    // Cut the content into runs of whole records of roughly equal size
+    const unsigned threads = threadCount_ ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+    const size_t target = (layout.contentEnd - layout.contentBegin) / (threads * 4) + 1;
+    std::vector<size_t> cuts{layout.contentBegin};
+    size_t pos = layout.contentBegin;
+    size_t begin = 0;
+    size_t end = 0;
+    while (scanner.nextRecord(pos, begin, end)) {
+        if (end - cuts.back() >= target) {
+            cuts.push_back(end);
+        }
+    }
+    if (scanner.hasError()) {
+        return fail(scanner.getErrorMessage());
+    }
+    if (cuts.back() != layout.contentEnd) {
+        cuts.push_back(layout.contentEnd);
+    }
+
+    const size_t chunkCount = cuts.size() - 1;
+    std::vector<Profile> profiles(chunkCount);
+    std::vector<Builder::Frame> roots(chunkCount);
+    std::vector<std::string> errors(chunkCount);
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<bool> stop{false};
+    const std::string rootPath = profile_.rootPath;
+
+    auto worker = [&](bool reportsProgress) {
+        size_t chunk;
+        while (!stop && (chunk = nextChunk.fetch_add(1)) < chunkCount) {
+            MemoryBuffer buffer(data + cuts[chunk], cuts[chunk + 1] - cuts[chunk]);
+            std::istream input(&buffer);
+            XmlStreamReader reader(input);
+            Builder builder(profiles[chunk]);
+            builder.openRoot(rootPath);
+            if (!builder.consume(reader, nullptr, errors[chunk])) {
+                errors[chunk] += " (in the records at byte offset " + std::to_string(cuts[chunk]) + ")";
+                stop = true;
+                break;
+            }
+            roots[chunk] = builder.takeRoot();
+
+            uint64_t done = bytesDone += cuts[chunk + 1] - cuts[chunk];
+            if (reportsProgress && progressCallback_ && !progressCallback_(layout.contentBegin + done)) {
+                errors[chunk] = "Profiling cancelled";
+                stop = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    unsigned workerCount = static_cast<unsigned>(std::min<size_t>(threads, chunkCount));
+    for (unsigned i = 1; i < workerCount; ++i) {
+        workers.emplace_back(worker, false);
+    }
+    worker(true);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (const std::string& error : errors) {
+        if (!error.empty()) {
+            return fail(error);
+        }
+    }
+
+    // Merge in document order, then close the root with the combined
+    // per-root child counts and text
+    Builder::Frame root;
+    root.path = rootPath;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        profile_.merge(profiles[chunk]);
+        Builder::Frame& part = roots[chunk];
+        root.hasChildren = root.hasChildren || part.hasChildren;
+        if (root.text.size() < kMaxTextLength) {
+            root.text.append(part.text, 0, kMaxTextLength - root.text.size());
+        }
+        for (const auto& child : part.childCounts) {
+            auto it = std::find_if(root.childCounts.begin(), root.childCounts.end(),
+                                   [&child](const std::pair<std::string, uint64_t>& entry) {
+                                       return entry.first == child.first;
+                                   });
+            if (it != root.childCounts.end()) {
+                it->second += child.second;
+            } else {
+                root.childCounts.push_back(child);
+            }
+        }
+    }
+    root.stats = &profile_.elements[rootPath];
+    Builder(profile_).finish(root);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+
+namespace {
+
+using Profile = XmlSchemaProfiler::Profile;
+using ElementStats = XmlSchemaProfiler::ElementStats;
+using ValueStats = XmlSchemaProfiler::ValueStats;
+
+bool isNamespaceDeclaration(const std::string& name) {
+    return name == "xmlns" || name.compare(0, 6, "xmlns:") == 0;
+}
+
+void writeXsdElement(const Profile& profile, const std::string& path, int indent, std::string& out) {
+    const ElementStats& stats = profile.elements.at(path);
+    const std::string pad(static_cast<size_t>(indent) * 2, ' ');
+
+    std::string occurs;
+    if (path != profile.rootPath) {
+        // Observed lower bounds above one are usually accidental; keep them loose
+        if (profile.minOccurs(path) == 0) {
+            occurs += " minOccurs=\"0\"";
+        }
+        if (profile.maxOccurs(path) > 1) {
+            occurs += " maxOccurs=\"unbounded\"";
+        }
+    }
+
+    std::vector<std::pair<std::string, const ValueStats*>> attributes;
+    for (const auto& attribute : stats.attributes) {
+        if (!isNamespaceDeclaration(attribute.first)) {
+            attributes.emplace_back(attribute.first, &attribute.second);
+        }
+    }
+
+    if (stats.children.empty() && attributes.empty()) {
+        out += pad + "<xs:element name=\"" + stats.name + "\" type=\"xs:" + stats.text.typeName() +
+               "\"" + occurs + "/>\n";
+        return;
+    }
+
+    auto writeAttributes = [&](const std::string& attributePad) {
+        for (const auto& attribute : attributes) {
+            out += attributePad + "<xs:attribute name=\"" + attribute.first + "\" type=\"xs:" +
+                   attribute.second->typeName() + "\"";
+            if (attribute.second->count == stats.count) {
+                out += " use=\"required\"";
+            }
+            out += "/>\n";
+        }
+    };
+
+    out += pad + "<xs:element name=\"" + stats.name + "\"" + occurs + ">\n";
+    if (!stats.children.empty()) {
+        out += pad + "  <xs:complexType" + (stats.mixedCount > 0 ? " mixed=\"true\"" : "") + ">\n";
+        out += pad + "    <xs:sequence>\n";
+        for (const std::string& child : stats.children) {
+            writeXsdElement(profile, path + "/" + child, indent + 3, out);
+        }
+        out += pad + "    </xs:sequence>\n";
+        writeAttributes(pad + "    ");
+        out += pad + "  </xs:complexType>\n";
+    } else if (stats.text.count > 0) {
+        out += pad + "  <xs:complexType>\n";
+        out += pad + "    <xs:simpleContent>\n";
+        out += pad + "      <xs:extension base=\"xs:" + stats.text.typeName() + "\">\n";
+        writeAttributes(pad + "        ");
+        out += pad + "      </xs:extension>\n";
+        out += pad + "    </xs:simpleContent>\n";
+        out += pad + "  </xs:complexType>\n";
+    } else {
+        out += pad + "  <xs:complexType>\n";
+        writeAttributes(pad + "    ");
+        out += pad + "  </xs:complexType>\n";
+    }
+    out += pad + "</xs:element>\n";
+}
+
+void writeValueSummary(const ValueStats& values, uint64_t owners, std::string& out) {
+    out += values.typeName();
+    if (owners > 0) {
+        out += values.count == owners ? ", always present" : ", in " + std::to_string(values.count) +
+                                                              " of " + std::to_string(owners);
+    }
+    out += ", length " + std::to_string(values.minLength) + ".." + std::to_string(values.maxLength);
+    if (values.allDecimal) {
+        out += ", range " + formatNumber(values.minNumber) + ".." + formatNumber(values.maxNumber);
+    }
+    out += values.truncatedSamples ? ", values include " : ", values ";
+    for (size_t i = 0; i < values.samples.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += "\"" + values.samples[i].first + "\" (" + std::to_string(values.samples[i].second) + ")";
+    }
+    if (values.truncatedSamples) out += ", ...";
+    out += "\n";
+}
+
+void writeReportElement(const Profile& profile, const std::string& path, std::string& out) {
+    const ElementStats& stats = profile.elements.at(path);
+    out += path + "  x" + std::to_string(stats.count);
+    if (path != profile.rootPath) {
+        uint64_t maxOccurs = profile.maxOccurs(path);
+        out += "  occurs " + std::to_string(profile.minOccurs(path)) + ".." + std::to_string(maxOccurs) +
+               " per parent";
+    }
+    if (stats.mixedCount > 0) {
+        out += "  mixed content in " + std::to_string(stats.mixedCount);
+    }
+    out += "\n";
+    for (const auto& attribute : stats.attributes) {
+        out += "    @" + attribute.first + ": ";
+        writeValueSummary(attribute.second, stats.count, out);
+    }
+    if (stats.text.count > 0) {
+        out += "    text: ";
+        writeValueSummary(stats.text, stats.count, out);
+    }
+    for (const std::string& child : stats.children) {
+        writeReportElement(profile, path + "/" + child, out);
+    }
+}
+
+} // namespace
+
+std::string XmlSchemaProfiler::toXsd() const {
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<!-- Draft inferred from " + std::to_string(profile_.elementCount) +
+                      " elements; review types and occurrence limits -->\n"
+                      "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\" elementFormDefault=\"qualified\">\n";
+    if (!profile_.rootPath.empty()) {
+        writeXsdElement(profile_, profile_.rootPath, 1, out);
+    }
+    out += "</xs:schema>\n";
+    return out;
+}
+
+std::string XmlSchemaProfiler::toReport() const {
+    std::string out = "Elements: " + std::to_string(profile_.elementCount) +
+                      "  Distinct paths: " + std::to_string(profile_.elements.size()) +
+                      "  Max depth: " + std::to_string(profile_.depthHistogram.empty() ? 0 : profile_.depthHistogram.size() - 1) +
+                      "\n\nElements per depth:\n";
+    for (size_t depth = 0; depth < profile_.depthHistogram.size(); ++depth) {
+        out += "  " + std::to_string(depth) + ": " + std::to_string(profile_.depthHistogram[depth]) + "\n";
+    }
+    out += "\n";
+    if (!profile_.rootPath.empty()) {
+        writeReportElement(profile_, profile_.rootPath, out);
+    }
+    return out;
+}
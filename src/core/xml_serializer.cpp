@@ -1,8 +1,11 @@
 #include "xml_serializer.h"
+#include "serialization_writers.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <regex>
+#include <atomic>
+#include <thread>
 #include <QtGlobal>
 
 XmlSerializer::XmlSerializer() {
@@ -10,23 +13,41 @@ XmlSerializer::XmlSerializer() {
 
 std::string XmlSerializer::serializeToXml(const std::shared_ptr<XmlNode>& node, 
                                          OutputStyle style) const {
-    return _serializeXmlNode(node, 0, style);
+    std::string out;
+    _writeNode(node, Format::XML, style, 0, out);
+    return out;
 }
 
 std::string XmlSerializer::serializeToJson(const std::shared_ptr<XmlNode>& node,
                                           OutputStyle style) const {
-    return _serializeJsonNode(node, 0, style);
+    std::string out;
+    _writeNode(node, Format::JSON, style, 0, out);
+    return out;
 }
 
 std::string XmlSerializer::serializeToYaml(const std::shared_ptr<XmlNode>& node,
                                           OutputStyle style) const {
-    return _serializeYamlNode(node, 0, style);
+    std::string out;
+    _writeNode(node, Format::YAML, style, 0, out);
+    return out;
 }
 
 std::string XmlSerializer::serializeToCsv(const std::shared_ptr<XmlNode>& node) const {
     return _serializeCsvNode(node);
 }
 
+std::string XmlSerializer::serializeToCbor(const std::shared_ptr<XmlNode>& node) const {
+    std::string out;
+    BinaryNodeWriter<CborEncoder>::writeNode(node, out);
+    return out;
+}
+
+std::string XmlSerializer::serializeToMessagePack(const std::shared_ptr<XmlNode>& node) const {
+    std::string out;
+    BinaryNodeWriter<MessagePackEncoder>::writeNode(node, out);
+    return out;
+}
+
 std::string XmlSerializer::serialize(const std::shared_ptr<XmlNode>& node,
                                     Format format,
                                     OutputStyle style) const {
@@ -39,11 +60,65 @@ std::string XmlSerializer::serialize(const std::shared_ptr<XmlNode>& node,
             return serializeToYaml(node, style);
         case Format::CSV:
             return serializeToCsv(node);
+        case Format::CBOR:
+            return serializeToCbor(node);
+        case Format::MessagePack:
+            return serializeToMessagePack(node);
         default:
             return serializeToXml(node, style);
     }
 }
 
+std::string XmlSerializer::serializeParallel(const std::shared_ptr<XmlNode>& node,
+                                            Format format,
+                                            OutputStyle style,
+                                            unsigned threadCount) const {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    // CSV output is a single flat table, binary output is cheap enough serially,
+    // and small or non-element roots are not worth splitting
+    if (!node || format == Format::CSV || isBinaryFormat(format) || threadCount == 1 ||
+        node->getType() != XmlNode::NodeType::Element) {
+        return serialize(node, format, style);
+    }
+    
+    SerializedFragments fragments = _serializeChildrenParallel(node, format, style, threadCount);
+    if (fragments.chunks.empty()) {
+        return serialize(node, format, style);
+    }
+    
+    std::string out;
+    _writeNode(node, format, style, 0, out, &fragments);
+    return out;
+}
+
+std::string XmlSerializer::serializeIncremental(const std::shared_ptr<XmlNode>& node,
+                                              Format format,
+                                              OutputStyle style,
+                                              unsigned threadCount) const {
+    if (!node || format == Format::CSV || isBinaryFormat(format) ||
+        node->getType() != XmlNode::NodeType::Element) {
+        return serialize(node, format, style);
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    std::string out;
+    _writeIncremental(node, format, style, 0, 0, threadCount, out);
+    return out;
+}
+
+void XmlSerializer::clearFragmentCache(const std::shared_ptr<XmlNode>& node) const {
+    if (!node) return;
+    node->fragmentCache().reset();
+    for (const auto& child : node->getChildren()) {
+        clearFragmentCache(child);
+    }
+}
+
 std::shared_ptr<XmlNode> XmlSerializer::deserializeFromXml(const std::string& content) const {
     Q_UNUSED(content);
     // Use existing XmlParser
@@ -69,6 +144,126 @@ std::shared_ptr<XmlNode> XmlSerializer::deserializeFromCsv(const std::string& co
     return nullptr;
 }
 
+namespace {
+
+// Rebuilds the XmlNode tree from the CBOR/MessagePack element maps written by
+// BinaryNodeWriter or the streaming converter. Unknown members are skipped.
+template <typename Reader>
+class BinaryNodeReader {
+public:
+    explicit BinaryNodeReader(Reader& reader) : reader_(reader) {}
+
+    std::shared_ptr<XmlNode> readDocument() {
+        auto root = readElement(0);
+        if (!root) return nullptr;
+        // A streamed export is the root header followed by one object per record
+        while (!reader_.atEnd()) {
+            auto record = readElement(1);
+            if (!record) return nullptr;
+            root->addChild(record);
+        }
+        return root;
+    }
+
+private:
+    static constexpr int kMaxDepth = 512;
+
+    bool readString(std::string& out) {
+        BinaryItem item;
+        if (!reader_.next(item)) return false;
+        return item.kind == BinaryItem::Kind::String && reader_.readString(item, out);
+    }
+
+    // Iterates a map or array, calling visit() for each element (arrays) or key (maps)
+    template <typename Visit>
+    bool forEach(const BinaryItem& container, Visit visit) {
+        for (uint64_t i = 0; container.indefinite || i < container.length; ++i) {
+            BinaryItem item;
+            if (!reader_.next(item)) return false;
+            if (item.kind == BinaryItem::Kind::Break) return container.indefinite;
+            if (!visit(item)) return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<XmlNode> readElement(int depth) {
+        BinaryItem item;
+        if (depth > kMaxDepth || !reader_.next(item)) return nullptr;
+        return readElement(item, depth);
+    }
+
+    std::shared_ptr<XmlNode> readElement(const BinaryItem& item, int depth) {
+        if (item.kind == BinaryItem::Kind::String) {
+            auto text = std::make_shared<XmlNode>("", XmlNode::NodeType::Text);
+            std::string value;
+            if (!reader_.readString(item, value)) return nullptr;
+            text->setValue(value);
+            return text;
+        }
+        if (item.kind != BinaryItem::Kind::Map) return nullptr;
+
+        auto node = std::make_shared<XmlNode>();
+        std::string key;
+        std::string value;
+        bool ok = forEach(item, [&](const BinaryItem& keyItem) {
+            if (keyItem.kind != BinaryItem::Kind::String) return false;
+            if (!reader_.readString(keyItem, key)) return false;
+
+            if (key == "@name") {
+                if (!readString(value)) return false;
+                node->setName(value);
+                return true;
+            }
+            if (key == "@text") {
+                if (!readString(value)) return false;
+                node->setValue(value);
+                return true;
+            }
+
+            BinaryItem member;
+            if (!reader_.next(member)) return false;
+            if (key == "@attributes" && member.kind == BinaryItem::Kind::Map) {
+                return forEach(member, [&](const BinaryItem& nameItem) {
+                    std::string name;
+                    if (nameItem.kind != BinaryItem::Kind::String ||
+                        !reader_.readString(nameItem, name) || !readString(value)) {
+                        return false;
+                    }
+                    node->addAttribute(name, value);
+                    return true;
+                });
+            }
+            if (key == "@children" && member.kind == BinaryItem::Kind::Array) {
+                if (depth >= kMaxDepth) return false;
+                return forEach(member, [&](const BinaryItem& childItem) {
+                    auto child = readElement(childItem, depth + 1);
+                    if (!child) return false;
+                    node->addChild(child);
+                    return true;
+                });
+            }
+            return reader_.skip(member);
+        });
+        return ok ? node : nullptr;
+    }
+
+    Reader& reader_;
+};
+
+} // namespace
+
+std::shared_ptr<XmlNode> XmlSerializer::deserializeFromCbor(const std::string& content) const {
+    if (content.empty()) return nullptr;
+    CborReader reader(content.data(), content.size());
+    return BinaryNodeReader<CborReader>(reader).readDocument();
+}
+
+std::shared_ptr<XmlNode> XmlSerializer::deserializeFromMessagePack(const std::string& content) const {
+    if (content.empty()) return nullptr;
+    MessagePackReader reader(content.data(), content.size());
+    return BinaryNodeReader<MessagePackReader>(reader).readDocument();
+}
+
 bool XmlSerializer::validateXml(const std::string& xmlContent) const {
     try {
         // Try to parse XML, if successful then valid
@@ -105,188 +300,208 @@ std::string XmlSerializer::convertToYaml(const std::shared_ptr<XmlNode>& node) c
 
 // Private method implementations
 
-std::string XmlSerializer::_serializeXmlNode(const std::shared_ptr<XmlNode>& node, 
-                                            int indent, 
-                                            OutputStyle style) const {
-    if (!node) return "";
-    
-    std::stringstream ss;
-    std::string indentStr = _getIndent(indent, style);
-    
-    switch (node->getType()) {
-        case XmlNode::NodeType::Element: {
-            ss << indentStr << "<" << node->getName();
-            
-            // Add attributes
-            for (const auto& attr : node->getAttributes()) {
-                ss << " " << attr.first << "=\"" << _escapeXmlString(attr.second) << "\"";
-            }
-            
-            if (node->isLeaf() && node->getValue().empty()) {
-                ss << " />";
-                if (style != OutputStyle::Compact) ss << "\n";
-            } else {
-                ss << ">";
-                
-                if (!node->getValue().empty()) {
-                    ss << _escapeXmlString(node->getValue());
-                }
-                
-                bool hasChildren = false;
-                for (const auto& child : node->getChildren()) {
-                    if (child->getType() == XmlNode::NodeType::Element) {
-                        if (!hasChildren && style != OutputStyle::Compact) {
-                            ss << "\n";
-                        }
-                        ss << _serializeXmlNode(child, indent + 1, style);
-                        hasChildren = true;
-                    }
-                }
-                
-                // Handle text child nodes
-                for (const auto& child : node->getChildren()) {
-                    if (child->getType() == XmlNode::NodeType::Text) {
-                        ss << _escapeXmlString(child->getValue());
-                    }
-                }
-                
-                if (hasChildren && style != OutputStyle::Compact) {
-                    ss << indentStr;
-                }
-                ss << "</" << node->getName() << ">";
-                if (style != OutputStyle::Compact) ss << "\n";
-            }
-            break;
-        }
-        case XmlNode::NodeType::Text:
-            ss << _escapeXmlString(node->getValue());
+namespace {
+
+using Format = XmlSerializer::Format;
+using OutputStyle = XmlSerializer::OutputStyle;
+
+// The only runtime dispatch: one switch per call, then the specialized writer recurses
+template <Format F>
+void writeWithStyle(const std::shared_ptr<XmlNode>& node, OutputStyle style, int indent,
+                    const XmlSerializer::SerializationConfig& config, std::string& out,
+                    const SerializedFragments* fragments) {
+    switch (style) {
+        case OutputStyle::Compact:
+            NodeWriter<F, OutputStyle::Compact>::writeNode(node, indent, config, out, fragments);
             break;
-        case XmlNode::NodeType::Comment:
-            if (config_.includeComments) {
-                ss << indentStr << "<!-- " << node->getValue() << " -->";
-                if (style != OutputStyle::Compact) ss << "\n";
-            }
+        case OutputStyle::Minified:
+            NodeWriter<F, OutputStyle::Minified>::writeNode(node, indent, config, out, fragments);
             break;
         default:
+            NodeWriter<F, OutputStyle::Pretty>::writeNode(node, indent, config, out, fragments);
             break;
     }
-    
-    return ss.str();
 }
 
-std::string XmlSerializer::_serializeJsonNode(const std::shared_ptr<XmlNode>& node,
-                                             int indent,
-                                             OutputStyle style) const {
-    if (!node) return "null";
+size_t countSubtreeNodes(const std::shared_ptr<XmlNode>& node) {
+    size_t count = 1;
+    for (const auto& child : node->getChildren()) {
+        count += countSubtreeNodes(child);
+    }
+    return count;
+}
+
+} // namespace
+
+SerializedFragments XmlSerializer::_serializeChildrenParallel(
+    const std::shared_ptr<XmlNode>& node, Format format, OutputStyle style,
+    unsigned threadCount) const {
+    SerializedFragments fragments;
     
-    std::stringstream ss;
-    std::string indentStr = _getIndent(indent, style);
-    std::string childIndentStr = _getIndent(indent + 1, style);
+    std::vector<std::shared_ptr<XmlNode>> elements;
+    std::vector<size_t> sizes;
+    size_t totalNodes = 0;
+    for (const auto& child : node->getChildren()) {
+        if (child->getType() == XmlNode::NodeType::Element) {
+            elements.push_back(child);
+            sizes.push_back(countSubtreeNodes(child));
+            totalNodes += sizes.back();
+        }
+    }
     
-    switch (node->getType()) {
-        case XmlNode::NodeType::Element: {
-            ss << indentStr << "{\n";
-            
-            // Add element name
-            ss << childIndentStr << "\"@name\": \"" << _escapeJsonString(node->getName()) << "\"";
-            
-            // Add attributes
-            if (!node->getAttributes().empty()) {
-                ss << ",\n" << childIndentStr << "\"@attributes\": {\n";
-                std::string attrIndentStr = _getIndent(indent + 2, style);
-                bool first = true;
-                for (const auto& attr : node->getAttributes()) {
-                    if (!first) ss << ",\n";
-                    ss << attrIndentStr << "\"" << _escapeJsonString(attr.first) << "\": \"" 
-                       << _escapeJsonString(attr.second) << "\"";
-                    first = false;
-                }
-                ss << "\n" << childIndentStr << "}";
-            }
-            
-            // Add text content
-            if (!node->getValue().empty()) {
-                ss << ",\n" << childIndentStr << "\"@text\": \"" 
-                   << _escapeJsonString(node->getValue()) << "\"";
-            }
-            
-            // Add child elements
-            std::vector<std::shared_ptr<XmlNode>> elementChildren;
-            std::vector<std::shared_ptr<XmlNode>> textChildren;
-            
-            for (const auto& child : node->getChildren()) {
-                if (child->getType() == XmlNode::NodeType::Element) {
-                    elementChildren.push_back(child);
-                } else if (child->getType() == XmlNode::NodeType::Text) {
-                    textChildren.push_back(child);
-                }
-            }
-            
-            if (!elementChildren.empty()) {
-                ss << ",\n" << childIndentStr << "\"@children\": [\n";
-                for (size_t i = 0; i < elementChildren.size(); ++i) {
-                    if (i > 0) ss << ",\n";
-                    ss << _serializeJsonNode(elementChildren[i], indent + 2, style);
-                }
-                ss << "\n" << childIndentStr << "]";
+    if (elements.size() < 2 || totalNodes < config_.parallelMinNodes) {
+        return fragments;
+    }
+    
+    // Split the children into contiguous, size-balanced chunks. Using a few chunks per
+    // thread keeps the workers busy when subtree sizes are uneven.
+    size_t chunkCount = std::min(elements.size(), static_cast<size_t>(threadCount) * 4);
+    size_t targetNodes = (totalNodes + chunkCount - 1) / chunkCount;
+    std::vector<size_t> chunkBegin{0};
+    size_t accumulated = 0;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        accumulated += sizes[i];
+        if (accumulated >= targetNodes && i + 1 < elements.size()) {
+            chunkBegin.push_back(i + 1);
+            accumulated = 0;
+        }
+    }
+    chunkBegin.push_back(elements.size());
+    
+    // Children sit one level below the root for XML and two levels below for JSON/YAML
+    int childIndent = (format == Format::XML) ? 1 : 2;
+    const char* separator = (format == Format::JSON) ? ",\n" : "";
+    
+    fragments.storage.resize(chunkBegin.size() - 1);
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&]() {
+        size_t chunk;
+        while ((chunk = nextChunk.fetch_add(1)) < fragments.storage.size()) {
+            std::string& buffer = fragments.storage[chunk];
+            for (size_t i = chunkBegin[chunk]; i < chunkBegin[chunk + 1]; ++i) {
+                if (i > chunkBegin[chunk]) buffer += separator;
+                _writeNode(elements[i], format, style, childIndent, buffer);
             }
-            
-            ss << "\n" << indentStr << "}";
-            break;
         }
-        case XmlNode::NodeType::Text:
-            ss << "\"" << _escapeJsonString(node->getValue()) << "\"";
-            break;
-        default:
-            ss << "null";
-            break;
+    };
+    
+    std::vector<std::thread> workers;
+    unsigned workerCount = std::min<unsigned>(threadCount, fragments.storage.size());
+    for (unsigned i = 1; i < workerCount; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
     }
     
-    return ss.str();
+    fragments.chunks.assign(fragments.storage.begin(), fragments.storage.end());
+    return fragments;
 }
 
-std::string XmlSerializer::_serializeYamlNode(const std::shared_ptr<XmlNode>& node,
-                                             int indent,
-                                             OutputStyle style) const {
-    if (!node) return "";
+void XmlSerializer::_writeIncremental(const std::shared_ptr<XmlNode>& node, Format format,
+                                      OutputStyle style, int indent, int depth,
+                                      unsigned threadCount, std::string& out) const {
+    using Entry = SerializedFragmentCache::Entry;
     
-    std::stringstream ss;
-    std::string indentStr = _getIndent(indent, style);
-    
-    switch (node->getType()) {
-        case XmlNode::NodeType::Element: {
-            ss << indentStr << node->getName() << ":\n";
-            
-            // Add attributes
-            if (!node->getAttributes().empty()) {
-                ss << indentStr << "  attributes:\n";
-                for (const auto& attr : node->getAttributes()) {
-                    ss << indentStr << "    " << attr.first << ": \"" 
-                       << _escapeYamlString(attr.second) << "\"\n";
-                }
-            }
-            
-            // Add text content
-            if (!node->getValue().empty()) {
-                ss << indentStr << "  text: \"" << _escapeYamlString(node->getValue()) << "\"\n";
+    std::vector<std::shared_ptr<XmlNode>> elements;
+    if (depth < config_.fragmentCacheDepth) {
+        for (const auto& child : node->getChildren()) {
+            if (child->getType() == XmlNode::NodeType::Element) {
+                elements.push_back(child);
             }
-            
-            // Add child elements
-            for (const auto& child : node->getChildren()) {
-                if (child->getType() == XmlNode::NodeType::Element) {
-                    ss << _serializeYamlNode(child, indent + 2, style);
-                }
+        }
+    }
+    if (elements.empty()) {
+        _writeNode(node, format, style, indent, out);
+        return;
+    }
+    
+    const int childIndent = indent + ((format == Format::XML) ? 1 : 2);
+    const size_t slot = SerializedFragmentCache::slot(format, style);
+    
+    std::vector<Entry*> entries;
+    std::vector<size_t> stale;
+    entries.reserve(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        auto& cache = elements[i]->fragmentCache();
+        if (!cache) {
+            cache = std::make_shared<SerializedFragmentCache>();
+        }
+        Entry& entry = cache->entries[slot];
+        if (!entry.valid || entry.revision != elements[i]->getRevision() ||
+            entry.indent != childIndent || entry.includeComments != config_.includeComments) {
+            stale.push_back(i);
+        }
+        entries.push_back(&entry);
+    }
+    
+    auto refresh = [&](size_t i) {
+        Entry& entry = *entries[i];
+        entry.text.clear();
+        _writeIncremental(elements[i], format, style, childIndent, depth + 1, 1, entry.text);
+        entry.revision = elements[i]->getRevision();
+        entry.indent = childIndent;
+        entry.includeComments = config_.includeComments;
+        entry.valid = true;
+    };
+    
+    // Stale children of the export root are independent subtrees; rebuild them in parallel
+    size_t staleNodes = 0;
+    if (threadCount > 1 && stale.size() >= 2) {
+        for (size_t i : stale) {
+            staleNodes += countSubtreeNodes(elements[i]);
+        }
+    }
+    
+    if (staleNodes >= config_.parallelMinNodes) {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            size_t index;
+            while ((index = next.fetch_add(1)) < stale.size()) {
+                refresh(stale[index]);
             }
-            break;
+        };
+        std::vector<std::thread> workers;
+        unsigned workerCount = std::min<unsigned>(threadCount, stale.size());
+        for (unsigned i = 1; i < workerCount; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
         }
-        case XmlNode::NodeType::Text:
-            ss << indentStr << "- \"" << _escapeYamlString(node->getValue()) << "\"\n";
+    } else {
+        for (size_t i : stale) {
+            refresh(i);
+        }
+    }
+    
+    SerializedFragments fragments;
+    fragments.chunks.reserve(entries.size());
+    size_t fragmentBytes = 0;
+    for (const Entry* entry : entries) {
+        fragments.chunks.emplace_back(entry->text);
+        fragmentBytes += entry->text.size() + 2;
+    }
+    out.reserve(out.size() + fragmentBytes + 256);
+    _writeNode(node, format, style, indent, out, &fragments);
+}
+
+void XmlSerializer::_writeNode(const std::shared_ptr<XmlNode>& node, Format format,
+                               OutputStyle style, int indent, std::string& out,
+                               const SerializedFragments* fragments) const {
+    switch (format) {
+        case Format::JSON:
+            writeWithStyle<Format::JSON>(node, style, indent, config_, out, fragments);
+            break;
+        case Format::YAML:
+            writeWithStyle<Format::YAML>(node, style, indent, config_, out, fragments);
             break;
         default:
+            writeWithStyle<Format::XML>(node, style, indent, config_, out, fragments);
             break;
     }
-    
-    return ss.str();
 }
 
 std::string XmlSerializer::_serializeCsvNode(const std::shared_ptr<XmlNode>& node) const {
@@ -327,83 +542,3 @@ std::string XmlSerializer::_serializeCsvNode(const std::shared_ptr<XmlNode>& nod
     
     return ss.str();
 }
-
-std::string XmlSerializer::_getIndent(int level, OutputStyle style) const {
-    if (style == OutputStyle::Compact) return "";
-    
-    std::string indent;
-    int spaces = (style == OutputStyle::Pretty) ? 2 : 0;
-    for (int i = 0; i < level * spaces; ++i) {
-        indent += " ";
-    }
-    return indent;
-}
-
-std::string XmlSerializer::_escapeXmlString(const std::string& str) const {
-    std::string result = str;
-    
-    // Replace XML special characters
-    std::map<std::string, std::string> replacements = {
-        {"&", "&amp;"},
-        {"<", "&lt;"},
-        {">", "&gt;"},
-        {"\"", "&quot;"},
-        {"'", "&apos;"}
-    };
-    
-    for (const auto& replacement : replacements) {
-        size_t pos = 0;
-        while ((pos = result.find(replacement.first, pos)) != std::string::npos) {
-            result.replace(pos, replacement.first.length(), replacement.second);
-            pos += replacement.second.length();
-        }
-    }
-    
-    return result;
-}
-
-std::string XmlSerializer::_escapeJsonString(const std::string& str) const {
-    std::string result = str;
-    
-    // Replace JSON special characters
-    std::map<std::string, std::string> replacements = {
-        {"\\", "\\\\"},
-        {"\"", "\\\""},
-        {"\n", "\\n"},
-        {"\r", "\\r"},
-        {"\t", "\\t"}
-    };
-    
-    for (const auto& replacement : replacements) {
-        size_t pos = 0;
-        while ((pos = result.find(replacement.first, pos)) != std::string::npos) {
-            result.replace(pos, replacement.first.length(), replacement.second);
-            pos += replacement.second.length();
-        }
-    }
-    
-    return result;
-}
-
-std::string XmlSerializer::_escapeYamlString(const std::string& str) const {
-    std::string result = str;
-    
-    // Replace YAML special characters
-    std::map<std::string, std::string> replacements = {
-        {"\\", "\\\\"},
-        {"\"", "\\\""},
-        {"\n", "\\n"},
-        {"\r", "\\r"},
-        {"\t", "\\t"}
-    };
-    
-    for (const auto& replacement : replacements) {
-        size_t pos = 0;
-        while ((pos = result.find(replacement.first, pos)) != std::string::npos) {
-            result.replace(pos, replacement.first.length(), replacement.second);
-            pos += replacement.second.length();
-        }
-    }
-    
-    return result;
-} 
\ No newline at end of file
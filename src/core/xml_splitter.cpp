@@ -0,0 +1,320 @@
+#include "xml_splitter.h"
+#include "xml_record_scanner.h"
+#include "mapped_file.h"
+#include "compressed_stream.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// A run of consecutive bytes of one output file, starting at offset and
+// gathered from pieces of the mapped inputs
+struct XmlSplitter::WriteTask {
+    size_t file;
+    uint64_t offset;
+    size_t bytes = 0;
+    std::vector<std::pair<const char*, size_t>> pieces;
+};
+
+namespace {
+
+constexpr size_t npos = static_cast<size_t>(-1);
+
+// Appends size bytes at the end of file, starting a new task whenever the
+// current one reaches kWriteChunk so large copies are shared between threads
+template <typename Task>
+void appendWrite(std::vector<Task>& tasks, size_t file, uint64_t& offset,
+                 const char* source, size_t size, size_t chunk) {
+    while (size > 0) {
+        if (tasks.empty() || tasks.back().file != file || tasks.back().bytes >= chunk) {
+            tasks.push_back(Task{file, offset, 0, {}});
+        }
+        Task& task = tasks.back();
+        size_t take = std::min(size, chunk - task.bytes);
+        task.pieces.emplace_back(source, take);
+        task.bytes += take;
+        offset += take;
+        source += take;
+        size -= take;
+    }
+}
+
+// Moves a shard boundary from the end of a record past the whitespace that
+// follows it, up to and including the line break, so shards start on a fresh
+// line with the record's own indentation
+size_t extendOverLineBreak(const char* data, size_t pos, size_t limit) {
+    size_t i = pos;
+    while (i < limit && (data[i] == ' ' || data[i] == '\t' || data[i] == '\r')) {
+        ++i;
+    }
+    return (i < limit && data[i] == '\n') ? i + 1 : pos;
+}
+
+std::string shardName(const std::string& stem, size_t index, size_t count) {
+    std::string number = std::to_string(index + 1);
+    size_t width = std::max<size_t>(4, std::to_string(count).size());
+    if (number.size() < width) {
+        number.insert(0, width - number.size(), '0');
+    }
+    return stem + ".part-" + number + ".xml";
+}
+
+} // namespace
+
+XmlSplitter::XmlSplitter() : threadCount_(0), recordCount_(0) {
+}
+
+bool XmlSplitter::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message;
+    }
+    return false;
+}
+
+bool XmlSplitter::splitByRecordCount(const std::string& inputPath, const std::string& outputDirectory,
+                                     uint64_t recordsPerFile) {
+    return split(inputPath, outputDirectory, Limit::Records, recordsPerFile);
+}
+
+bool XmlSplitter::splitBySize(const std::string& inputPath, const std::string& outputDirectory,
+                              uint64_t maxBytes) {
+    return split(inputPath, outputDirectory, Limit::Bytes, maxBytes);
+}
+
+bool XmlSplitter::split(const std::string& inputPath, const std::string& outputDirectory,
+                        Limit limit, uint64_t amount) {
+    errorMessage_.clear();
+    outputFiles_.clear();
+    recordCount_ = 0;
+
+    if (amount == 0) {
+        return fail(limit == Limit::Records ? "Records per file must be at least 1"
+                                            : "Maximum file size must be at least 1 byte");
+    }
+    if (detectCompression(inputPath) != CompressionType::None) {
+        return fail("Compressed files cannot be split; decompress " + inputPath + " first");
+    }
+
+    MappedFile input;
+    if (!input.open(inputPath)) {
+        return fail(input.getErrorMessage());
+    }
+    XmlRecordScanner scanner(input.data(), input.size());
+    if (!scanner.scanLayout()) {
+        return fail(inputPath + ": " + scanner.getErrorMessage());
+    }
+    const XmlRecordScanner::Layout& layout = scanner.layout();
+
+    // The header runs to the end of the root start tag's line so shards after
+    // the first also start their records on a new line
+    const char* data = input.data();
+    const size_t headerSize = extendOverLineBreak(data, layout.contentBegin, layout.contentEnd);
+    const size_t footerSize = input.size() - layout.contentEnd;
+
+    // Plan the shards: cuts[i] is where the content of shard i begins
+    std::vector<size_t> cuts{headerSize};
+    uint64_t shardRecords = 0;
+    size_t pos = layout.contentBegin;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t previousEnd = 0;
+    while (scanner.nextRecord(pos, begin, end)) {
+        bool full;
+        if (limit == Limit::Records) {
+            full = shardRecords >= amount;
+        } else {
+            size_t shardEnd = extendOverLineBreak(data, end, layout.contentEnd);
+            full = headerSize + (shardEnd - cuts.back()) + footerSize > amount;
+        }
+        if (shardRecords > 0 && full) {
+            cuts.push_back(extendOverLineBreak(data, previousEnd, begin));
+            shardRecords = 0;
+        }
+        ++shardRecords;
+        previousEnd = end;
+        ++recordCount_;
+    }
+    cuts.push_back(layout.contentEnd);
+
+    std::error_code error;
+    fs::create_directories(fs::u8path(outputDirectory), error);
+    if (error) {
+        return fail("Cannot create directory " + outputDirectory + ": " + error.message());
+    }
+
+    // Every shard is header + its slice of the content + footer
+    const size_t shardCount = cuts.size() - 1;
+    const std::string stem = fs::u8path(inputPath).stem().u8string();
+
+    std::vector<WriteTask> tasks;
+    std::vector<uint64_t> fileSizes;
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        outputFiles_.push_back((fs::u8path(outputDirectory) / fs::u8path(shardName(stem, shard, shardCount))).u8string());
+        uint64_t offset = 0;
+        appendWrite(tasks, shard, offset, data, headerSize, kWriteChunk);
+        appendWrite(tasks, shard, offset, data + cuts[shard], cuts[shard + 1] - cuts[shard], kWriteChunk);
+        appendWrite(tasks, shard, offset, data + layout.contentEnd, footerSize, kWriteChunk);
+        fileSizes.push_back(offset);
+    }
+    return writeTasks(tasks, fileSizes);
+}
+
+bool XmlSplitter::merge(const std::vector<std::string>& inputPaths, const std::string& outputPath) {
+    errorMessage_.clear();
+    outputFiles_.clear();
+    recordCount_ = 0;
+
+    if (inputPaths.empty()) {
+        return fail("No files to merge");
+    }
+
+    std::vector<std::unique_ptr<MappedFile>> inputs;
+    std::vector<XmlRecordScanner::Layout> layouts;
+    for (const std::string& path : inputPaths) {
+        if (fs::u8path(path) == fs::u8path(outputPath)) {
+            return fail("The merge output cannot also be an input: " + path);
+        }
+        if (detectCompression(path) != CompressionType::None) {
+            return fail("Compressed files cannot be merged; decompress " + path + " first");
+        }
+        auto input = std::make_unique<MappedFile>();
+        if (!input->open(path)) {
+            return fail(input->getErrorMessage());
+        }
+
+        XmlRecordScanner scanner(input->data(), input->size());
+        if (!scanner.scanLayout()) {
+            return fail(path + ": " + scanner.getErrorMessage());
+        }
+        if (!layouts.empty() && scanner.layout().rootName != layouts.front().rootName) {
+            return fail(path + ": root element <" + scanner.layout().rootName +
+                        "> does not match <" + layouts.front().rootName + ">");
+        }
+
+        // Counting the records also checks that the content is balanced
+        size_t pos = scanner.layout().contentBegin;
+        size_t begin = 0;
+        size_t end = 0;
+        while (scanner.nextRecord(pos, begin, end)) {
+            ++recordCount_;
+        }
+        if (scanner.hasError()) {
+            return fail(path + ": " + scanner.getErrorMessage());
+        }
+
+        layouts.push_back(scanner.layout());
+        inputs.push_back(std::move(input));
+    }
+
+    // The first input supplies the prolog, root tags and trailing bytes. Like
+    // split(), the header takes the rest of the root start tag's line.
+    std::vector<size_t> contentBegins;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        contentBegins.push_back(extendOverLineBreak(inputs[i]->data(), layouts[i].contentBegin,
+                                                    layouts[i].contentEnd));
+    }
+    const MappedFile& first = *inputs.front();
+    const XmlRecordScanner::Layout& firstLayout = layouts.front();
+    std::vector<WriteTask> tasks;
+    uint64_t offset = 0;
+    appendWrite(tasks, 0, offset, first.data(), contentBegins.front(), kWriteChunk);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        appendWrite(tasks, 0, offset, inputs[i]->data() + contentBegins[i],
+                    layouts[i].contentEnd - contentBegins[i], kWriteChunk);
+    }
+    appendWrite(tasks, 0, offset, first.data() + firstLayout.contentEnd,
+                first.size() - firstLayout.contentEnd, kWriteChunk);
+
+    outputFiles_.push_back(outputPath);
+    return writeTasks(tasks, {offset});
+}
+
+bool XmlSplitter::writeTasks(const std::vector<WriteTask>& tasks, const std::vector<uint64_t>& fileSizes) {
+    // Create every file at its final size so tasks can write their ranges in
+    // any order through independent handles
+    for (size_t i = 0; i < outputFiles_.size(); ++i) {
+        std::ofstream create(fs::u8path(outputFiles_[i]), std::ios::binary | std::ios::trunc);
+        std::error_code error;
+        if (create) {
+            create.close();
+            fs::resize_file(fs::u8path(outputFiles_[i]), fileSizes[i], error);
+        }
+        if (!create || error) {
+            fail("Cannot create " + outputFiles_[i]);
+            break;
+        }
+    }
+
+    uint64_t totalBytes = 0;
+    for (uint64_t size : fileSizes) {
+        totalBytes += size;
+    }
+
+    std::atomic<size_t> nextTask{0};
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<size_t> failedFile{npos};
+    std::atomic<bool> cancelled{false};
+
+    auto worker = [&](bool reportsProgress) {
+        std::fstream stream;
+        size_t openFile = npos;
+        size_t index;
+        while (!cancelled && failedFile == npos && (index = nextTask.fetch_add(1)) < tasks.size()) {
+            const WriteTask& task = tasks[index];
+            if (openFile != task.file) {
+                stream.close();
+                stream.clear();
+                stream.open(fs::u8path(outputFiles_[task.file]), std::ios::in | std::ios::out | std::ios::binary);
+                openFile = task.file;
+            }
+            stream.seekp(static_cast<std::streamoff>(task.offset));
+            for (const auto& piece : task.pieces) {
+                stream.write(piece.first, static_cast<std::streamsize>(piece.second));
+            }
+            if (!stream.flush()) {
+                size_t none = npos;
+                failedFile.compare_exchange_strong(none, task.file);
+                break;
+            }
+
+            uint64_t done = bytesDone += task.bytes;
+            if (reportsProgress && progressCallback_ && !progressCallback_(done, totalBytes)) {
+                cancelled = true;
+            }
+        }
+    };
+
+    if (!hasError()) {
+        std::vector<std::thread> workers;
+        unsigned threadCount = threadCount_ ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+        unsigned workerCount = static_cast<unsigned>(std::min<size_t>(threadCount, tasks.size()));
+        for (unsigned i = 1; i < workerCount; ++i) {
+            workers.emplace_back(worker, false);
+        }
+        worker(true);
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        if (failedFile != npos) {
+            fail("Failed to write " + outputFiles_[failedFile]);
+        } else if (cancelled) {
+            fail("Operation cancelled");
+        }
+    }
+
+    if (hasError()) {
+        // Do not leave partial output behind
+        for (const std::string& path : outputFiles_) {
+            std::error_code ignored;
+            fs::remove(fs::u8path(path), ignored);
+        }
+        outputFiles_.clear();
+        return false;
+    }
+    return true;
+}
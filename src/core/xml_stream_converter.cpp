@@ -0,0 +1,527 @@
+#include "xml_stream_converter.h"
+#include "xml_stream_reader.h"
+#include "xml_record_builder.h"
+#include "serialization_writers.h"
+#include "compressed_stream.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <vector>
+
+namespace {
+
+using Style = XmlSerializer::OutputStyle;
+
+std::string trimmed(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+// XmlNode keeps attributes in a std::map (last duplicate wins); mirror that so
+// the streamed output matches the DOM export byte for byte.
+std::map<std::string, std::string> sortedAttributes(const XmlStreamReader& reader) {
+    std::map<std::string, std::string> attributes;
+    for (const auto& attr : reader.attributes()) {
+        attributes[attr.first] = attr.second;
+    }
+    return attributes;
+}
+
+struct OpenElement {
+    int indent;
+    bool hasChildren;
+    std::string text;  // character data seen before the first child element
+};
+
+template <Style S>
+class JsonEmitter {
+public:
+    using Writer = JsonTextWriter<S>;
+
+    void startElement(const XmlStreamReader& reader, std::string& out) {
+        int indent = 0;
+        if (!stack_.empty()) {
+            OpenElement& parent = stack_.back();
+            if (!parent.hasChildren) {
+                Writer::text(out, parent.indent, trimmed(parent.text));
+                Writer::beginChildren(out, parent.indent);
+                parent.hasChildren = true;
+            } else {
+                Writer::childSeparator(out);
+            }
+            indent = parent.indent + 2;
+        }
+        Writer::beginElement(out, indent, reader.name());
+        Writer::attributes(out, indent, sortedAttributes(reader));
+        stack_.push_back({indent, false, std::string()});
+    }
+
+    void endElement(std::string& out) {
+        const OpenElement& element = stack_.back();
+        if (element.hasChildren) {
+            Writer::endChildren(out, element.indent);
+        } else {
+            Writer::text(out, element.indent, trimmed(element.text));
+        }
+        Writer::endElement(out, element.indent);
+        stack_.pop_back();
+    }
+
+    void characters(const XmlStreamReader& reader) {
+        if (!stack_.empty() && !stack_.back().hasChildren) {
+            stack_.back().text += reader.text();
+        }
+    }
+
+private:
+    std::vector<OpenElement> stack_;
+};
+
+template <Style S>
+class YamlEmitter {
+public:
+    using Writer = YamlTextWriter<S>;
+
+    void startElement(const XmlStreamReader& reader, std::string& out) {
+        int indent = 0;
+        if (!stack_.empty()) {
+            OpenElement& parent = stack_.back();
+            if (!parent.hasChildren) {
+                Writer::text(out, parent.indent, trimmed(parent.text));
+                parent.hasChildren = true;
+            }
+            indent = parent.indent + 2;
+        }
+        Writer::beginElement(out, indent, reader.name(), sortedAttributes(reader));
+        stack_.push_back({indent, false, std::string()});
+    }
+
+    void endElement(std::string& out) {
+        const OpenElement& element = stack_.back();
+        if (!element.hasChildren) {
+            Writer::text(out, element.indent, trimmed(element.text));
+        }
+        stack_.pop_back();
+    }
+
+    void characters(const XmlStreamReader& reader) {
+        if (!stack_.empty() && !stack_.back().hasChildren) {
+            stack_.back().text += reader.text();
+        }
+    }
+
+private:
+    std::vector<OpenElement> stack_;
+};
+
+// Indefinite-length maps and arrays let CBOR be written in document order
+// without knowing member or child counts up front.
+class CborEmitter {
+public:
+    using Writer = BinaryNodeWriter<CborEncoder>;
+
+    void startElement(const XmlStreamReader& reader, std::string& out) {
+        if (!stack_.empty()) {
+            OpenElement& parent = stack_.back();
+            if (!parent.hasChildren) {
+                writeText(out, parent.text);
+                Writer::key(out, "@children");
+                CborEncoder::beginIndefiniteArray(out);
+                parent.hasChildren = true;
+            }
+        }
+        CborEncoder::beginIndefiniteMap(out);
+        Writer::key(out, "@name");
+        CborEncoder::string(out, reader.name());
+        auto attributes = sortedAttributes(reader);
+        if (!attributes.empty()) {
+            Writer::attributes(out, attributes);
+        }
+        stack_.push_back({0, false, std::string()});
+    }
+
+    void endElement(std::string& out) {
+        const OpenElement& element = stack_.back();
+        if (element.hasChildren) {
+            CborEncoder::breakCode(out);
+        } else {
+            writeText(out, element.text);
+        }
+        CborEncoder::breakCode(out);
+        stack_.pop_back();
+    }
+
+    void characters(const XmlStreamReader& reader) {
+        if (!stack_.empty() && !stack_.back().hasChildren) {
+            stack_.back().text += reader.text();
+        }
+    }
+
+private:
+    static void writeText(std::string& out, const std::string& text) {
+        std::string value = trimmed(text);
+        if (value.empty()) return;
+        Writer::key(out, "@text");
+        CborEncoder::string(out, value);
+    }
+
+    std::vector<OpenElement> stack_;
+};
+
+// MessagePack has no indefinite lengths, so the stream is written as the root
+// header object ({"@name", "@attributes", "@text"}) followed by one complete
+// object per record. Each record is assembled in a side buffer with fixed-width
+// headers that are patched when the element closes.
+class MessagePackEmitter {
+public:
+    using Writer = BinaryNodeWriter<MessagePackEncoder>;
+
+    void startElement(const XmlStreamReader& reader, std::string& out) {
+        if (reader.depth() == 0) {
+            rootName_ = reader.name();
+            rootAttributes_ = sortedAttributes(reader);
+            rootText_.clear();
+            headerWritten_ = false;
+            return;
+        }
+
+        if (!headerWritten_) {
+            writeHeader(out);
+        }
+
+        if (!frames_.empty()) {
+            Frame& parent = frames_.back();
+            if (!parent.hasChildren) {
+                writeText(parent);
+                Writer::key(record_, "@children");
+                parent.childrenOffset = record_.size();
+                MessagePackEncoder::fixedArrayHeader(record_, 0);
+                ++parent.members;
+                parent.hasChildren = true;
+            }
+            ++parent.childCount;
+        }
+
+        Frame frame;
+        frame.mapOffset = record_.size();
+        MessagePackEncoder::fixedMapHeader(record_, 0);
+        Writer::key(record_, "@name");
+        MessagePackEncoder::string(record_, reader.name());
+        auto attributes = sortedAttributes(reader);
+        if (!attributes.empty()) {
+            Writer::attributes(record_, attributes);
+            ++frame.members;
+        }
+        frames_.push_back(std::move(frame));
+    }
+
+    void endElement(std::string& out) {
+        if (frames_.empty()) {
+            // End of the root: a document without records still needs its header
+            if (!headerWritten_) writeHeader(out);
+            return;
+        }
+
+        Frame& frame = frames_.back();
+        if (frame.hasChildren) {
+            MessagePackEncoder::patchFixedHeader(record_, frame.childrenOffset, frame.childCount);
+        } else {
+            writeText(frame);
+        }
+        MessagePackEncoder::patchFixedHeader(record_, frame.mapOffset, frame.members);
+        frames_.pop_back();
+
+        if (frames_.empty()) {
+            out += record_;
+            record_.clear();
+        }
+    }
+
+    void characters(const XmlStreamReader& reader) {
+        if (!frames_.empty()) {
+            if (!frames_.back().hasChildren) frames_.back().text += reader.text();
+        } else if (!headerWritten_) {
+            rootText_ += reader.text();
+        }
+    }
+
+private:
+    struct Frame {
+        size_t mapOffset = 0;
+        size_t childrenOffset = 0;
+        uint64_t members = 1;  // "@name"
+        uint64_t childCount = 0;
+        bool hasChildren = false;
+        std::string text;
+    };
+
+    void writeText(Frame& frame) {
+        std::string value = trimmed(frame.text);
+        if (value.empty()) return;
+        Writer::key(record_, "@text");
+        MessagePackEncoder::string(record_, value);
+        ++frame.members;
+    }
+
+    void writeHeader(std::string& out) {
+        std::string text = trimmed(rootText_);
+        MessagePackEncoder::mapHeader(out, 1 + (rootAttributes_.empty() ? 0 : 1) + (text.empty() ? 0 : 1));
+        Writer::key(out, "@name");
+        MessagePackEncoder::string(out, rootName_);
+        if (!rootAttributes_.empty()) {
+            Writer::attributes(out, rootAttributes_);
+        }
+        if (!text.empty()) {
+            Writer::key(out, "@text");
+            MessagePackEncoder::string(out, text);
+        }
+        headerWritten_ = true;
+    }
+
+    std::string rootName_;
+    std::map<std::string, std::string> rootAttributes_;
+    std::string rootText_;
+    bool headerWritten_ = false;
+    std::vector<Frame> frames_;
+    std::string record_;
+};
+
+// One row per child of the root element. Only the current record is held in
+// memory; the column set is fixed by the first record.
+class CsvEmitter {
+public:
+    explicit CsvEmitter(const XmlSerializer::SerializationConfig& config)
+        : record_(config), headerWritten_(false) {}
+
+    void startElement(const XmlStreamReader& reader, std::string& out) {
+        (void)out;
+        record_.startElement(reader);
+    }
+
+    void endElement(std::string& out) {
+        if (record_.endElement()) {
+            writeRecord(out);
+        }
+    }
+
+    void characters(const XmlStreamReader& reader) {
+        record_.characters(reader);
+    }
+
+private:
+    static void appendQuoted(std::string& out, const std::string& value) {
+        out += '"';
+        for (char c : value) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    void writeRecord(std::string& out) {
+        if (!headerWritten_) {
+            const auto& fields = record_.fields();
+            for (size_t i = 0; i < fields.size(); ++i) {
+                columns_.push_back(fields[i].first);
+                if (i > 0) out += ',';
+                appendQuoted(out, fields[i].first);
+            }
+            out += '\n';
+            headerWritten_ = true;
+        }
+
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) out += ',';
+            const std::string* value = record_.field(columns_[i]);
+            appendQuoted(out, value ? *value : std::string());
+        }
+        out += '\n';
+    }
+
+    XmlRecordBuilder record_;
+    bool headerWritten_;
+    std::vector<std::string> columns_;
+};
+
+} // namespace
+
+XmlStreamConverter::XmlStreamConverter()
+    : nextProgress_(0), bytesRead_(0), elementCount_(0) {
+}
+
+bool XmlStreamConverter::convert(std::istream& input, std::ostream& output,
+                                 XmlSerializer::Format format,
+                                 XmlSerializer::OutputStyle style) {
+    errorMessage_.clear();
+    nextProgress_ = kProgressInterval;
+    bytesRead_ = 0;
+    elementCount_ = 0;
+
+    switch (format) {
+        case XmlSerializer::Format::JSON:
+            switch (style) {
+                case Style::Compact: { JsonEmitter<Style::Compact> e; return run(input, output, e); }
+                case Style::Minified: { JsonEmitter<Style::Minified> e; return run(input, output, e); }
+                case Style::Pretty:
+                default: { JsonEmitter<Style::Pretty> e; return run(input, output, e); }
+            }
+        case XmlSerializer::Format::YAML:
+            switch (style) {
+                case Style::Compact: { YamlEmitter<Style::Compact> e; return run(input, output, e); }
+                case Style::Minified: { YamlEmitter<Style::Minified> e; return run(input, output, e); }
+                case Style::Pretty:
+                default: { YamlEmitter<Style::Pretty> e; return run(input, output, e); }
+            }
+        case XmlSerializer::Format::CSV: {
+            CsvEmitter e(config_);
+            return run(input, output, e);
+        }
+        case XmlSerializer::Format::CBOR: {
+            CborEmitter e;
+            return run(input, output, e);
+        }
+        case XmlSerializer::Format::MessagePack: {
+            MessagePackEmitter e;
+            return run(input, output, e);
+        }
+        default:
+            errorMessage_ = "Streaming conversion supports JSON, YAML, CSV, CBOR and MessagePack output only";
+            return false;
+    }
+}
+
+bool XmlStreamConverter::convertFile(const std::string& inputPath, const std::string& outputPath,
+                                     XmlSerializer::Format format,
+                                     XmlSerializer::OutputStyle style) {
+    CompressedInputStream input(inputPath);
+    if (!input.isOpen()) {
+        errorMessage_ = input.getErrorMessage();
+        return false;
+    }
+
+    CompressionType outputCompression = compressionFromExtension(outputPath);
+    if (!isCompressionSupported(outputCompression)) {
+        errorMessage_ = "Zstandard support is not available in this build";
+        return false;
+    }
+    CompressedOutputStream output(outputPath, outputCompression);
+    if (!output.isOpen()) {
+        errorMessage_ = output.getErrorMessage();
+        return false;
+    }
+
+    // Decompressed offsets would overshoot the file size, so report the
+    // position in the compressed file instead
+    ProgressCallback callback = progressCallback_;
+    if (callback && input.compression() != CompressionType::None) {
+        progressCallback_ = [&input, &callback](uint64_t) {
+            return callback(input.compressedBytesRead());
+        };
+    }
+
+    bool ok = convert(input, output, format, style);
+    progressCallback_ = callback;
+    if (input.hasError()) {
+        errorMessage_ = input.getErrorMessage();
+        ok = false;
+    }
+    if (!output.close() && ok) {
+        errorMessage_ = output.getErrorMessage();
+        ok = false;
+    }
+    if (!ok) {
+        // Do not leave a truncated document behind
+        std::remove(outputPath.c_str());
+    }
+    return ok;
+}
+
+template <typename Emitter>
+bool XmlStreamConverter::run(std::istream& input, std::ostream& output, Emitter& emitter) {
+    XmlStreamReader reader(input);
+    std::string buffer;
+    buffer.reserve(kFlushThreshold + 4096);
+    bool rootSeen = false;
+
+    while (true) {
+        XmlStreamReader::TokenType token = reader.next();
+        if (token == XmlStreamReader::TokenType::Error) {
+            errorMessage_ = reader.getErrorMessage();
+            return false;
+        }
+        if (token == XmlStreamReader::TokenType::EndDocument) {
+            break;
+        }
+
+        switch (token) {
+            case XmlStreamReader::TokenType::StartElement:
+                if (reader.depth() == 0) {
+                    if (rootSeen) {
+                        errorMessage_ = "Multiple root elements (line " +
+                                        std::to_string(reader.lineNumber()) + ")";
+                        return false;
+                    }
+                    rootSeen = true;
+                }
+                emitter.startElement(reader, buffer);
+                ++elementCount_;
+                break;
+            case XmlStreamReader::TokenType::EndElement:
+                emitter.endElement(buffer);
+                break;
+            case XmlStreamReader::TokenType::Text:
+            case XmlStreamReader::TokenType::CData:
+                emitter.characters(reader);
+                break;
+            default:
+                break;
+        }
+
+        if (!flush(buffer, output) || !reportProgress(reader.bytesConsumed())) {
+            return false;
+        }
+    }
+
+    if (!rootSeen) {
+        errorMessage_ = "No root element found";
+        return false;
+    }
+
+    bytesRead_ = reader.bytesConsumed();
+    if (!flush(buffer, output, true)) {
+        return false;
+    }
+    if (progressCallback_) {
+        progressCallback_(bytesRead_);
+    }
+    return true;
+}
+
+bool XmlStreamConverter::reportProgress(uint64_t bytesRead) {
+    bytesRead_ = bytesRead;
+    if (bytesRead < nextProgress_) {
+        return true;
+    }
+    nextProgress_ = bytesRead + kProgressInterval;
+    if (progressCallback_ && !progressCallback_(bytesRead)) {
+        errorMessage_ = "Conversion cancelled";
+        return false;
+    }
+    return true;
+}
+
+bool XmlStreamConverter::flush(std::string& buffer, std::ostream& output, bool force) {
+    if (!force && buffer.size() < kFlushThreshold) {
+        return true;
+    }
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    if (!output) {
+        errorMessage_ = "Failed to write output";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,389 @@
+#include "xml_stream_reader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+XmlStreamReader::XmlStreamReader(std::istream& input, size_t chunkSize)
+    : input_(input), chunkSize_(std::max<size_t>(chunkSize, 16)), pos_(0), consumedBefore_(0),
+      eof_(false), tokenType_(TokenType::None), emptyElement_(false), pendingEnd_(false),
+      depth_(0), line_(1), lineCursor_(1), tokenOffset_(0) {
+}
+
+XmlStreamReader::TokenType XmlStreamReader::next() {
+    if (pendingEnd_) {
+        // Synthesized end of a self-closing element
+        pendingEnd_ = false;
+        emptyElement_ = false;
+        attributes_.clear();
+        raw_.clear();
+        openElements_.pop_back();
+        depth_ = static_cast<int>(openElements_.size());
+        tokenType_ = TokenType::EndElement;
+        return tokenType_;
+    }
+
+    if (tokenType_ == TokenType::Error || tokenType_ == TokenType::EndDocument) {
+        return tokenType_;
+    }
+
+    compact();
+    name_.clear();
+    attributes_.clear();
+    text_.clear();
+    emptyElement_ = false;
+
+    if (pos_ >= buffer_.size() && !fill()) {
+        if (!openElements_.empty()) {
+            return fail("Unexpected end of file: <" + openElements_.back() + "> is not closed");
+        }
+        raw_.clear();
+        depth_ = 0;
+        tokenType_ = TokenType::EndDocument;
+        return tokenType_;
+    }
+
+    tokenOffset_ = consumedBefore_ + pos_;
+    line_ = lineCursor_;
+
+    if (buffer_[pos_] == '<') {
+        return readMarkup();
+    }
+    return readText();
+}
+
+std::string XmlStreamReader::attribute(const std::string& key) const {
+    for (const auto& attr : attributes_) {
+        if (attr.first == key) {
+            return attr.second;
+        }
+    }
+    return "";
+}
+
+bool XmlStreamReader::isWhitespace() const {
+    return std::all_of(text_.begin(), text_.end(), [](char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    });
+}
+
+bool XmlStreamReader::fill() {
+    if (eof_) return false;
+
+    size_t oldSize = buffer_.size();
+    buffer_.resize(oldSize + chunkSize_);
+    input_.read(&buffer_[oldSize], static_cast<std::streamsize>(chunkSize_));
+    size_t got = static_cast<size_t>(input_.gcount());
+    buffer_.resize(oldSize + got);
+
+    if (!input_) {
+        eof_ = true;
+    }
+    return got > 0;
+}
+
+void XmlStreamReader::compact() {
+    // Drop consumed bytes once they dominate the buffer; only done between tokens
+    // so offsets held while scanning a token stay valid.
+    if (pos_ > 0 && pos_ >= chunkSize_ && pos_ * 2 >= buffer_.size()) {
+        buffer_.erase(0, pos_);
+        consumedBefore_ += pos_;
+        pos_ = 0;
+    }
+}
+
+size_t XmlStreamReader::find(const char* pattern, size_t from) {
+    size_t length = std::strlen(pattern);
+    while (true) {
+        size_t found = buffer_.find(pattern, from, length);
+        if (found != std::string::npos) {
+            return found;
+        }
+        size_t scanned = buffer_.size();
+        if (!fill()) {
+            return std::string::npos;
+        }
+        if (scanned + 1 > length) {
+            from = std::max(from, scanned + 1 - length);
+        }
+    }
+}
+
+size_t XmlStreamReader::findTagEnd(size_t from) {
+    char quote = '\0';
+    size_t i = from;
+    while (true) {
+        for (; i < buffer_.size(); ++i) {
+            char c = buffer_[i];
+            if (quote) {
+                if (c == quote) quote = '\0';
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                return i;
+            }
+        }
+        if (!fill()) {
+            return std::string::npos;
+        }
+    }
+}
+
+size_t XmlStreamReader::findDoctypeEnd(size_t from) {
+    char quote = '\0';
+    int bracketDepth = 0;
+    size_t i = from;
+    while (true) {
+        for (; i < buffer_.size(); ++i) {
+            char c = buffer_[i];
+            if (quote) {
+                if (c == quote) quote = '\0';
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '[') {
+                ++bracketDepth;
+            } else if (c == ']') {
+                --bracketDepth;
+            } else if (c == '>' && bracketDepth <= 0) {
+                return i;
+            }
+        }
+        if (!fill()) {
+            return std::string::npos;
+        }
+    }
+}
+
+bool XmlStreamReader::startsWith(const char* prefix) {
+    size_t length = std::strlen(prefix);
+    while (buffer_.size() - pos_ < length) {
+        if (!fill()) return false;
+    }
+    return buffer_.compare(pos_, length, prefix) == 0;
+}
+
+void XmlStreamReader::takeRaw(size_t end) {
+    raw_.assign(buffer_, pos_, end - pos_);
+    lineCursor_ += static_cast<int>(std::count(raw_.begin(), raw_.end(), '\n'));
+    pos_ = end;
+}
+
+XmlStreamReader::TokenType XmlStreamReader::fail(const std::string& message) {
+    errorMessage_ = message + " (line " + std::to_string(lineCursor_) + ")";
+    tokenType_ = TokenType::Error;
+    return tokenType_;
+}
+
+XmlStreamReader::TokenType XmlStreamReader::readMarkup() {
+    depth_ = static_cast<int>(openElements_.size());
+
+    if (startsWith("<?")) {
+        size_t end = find("?>", pos_ + 2);
+        if (end == std::string::npos) return fail("Unterminated processing instruction");
+        text_.assign(buffer_, pos_ + 2, end - pos_ - 2);
+        name_ = text_.substr(0, text_.find_first_of(" \t\r\n"));
+        takeRaw(end + 2);
+        tokenType_ = TokenType::ProcessingInstruction;
+        return tokenType_;
+    }
+
+    if (startsWith("<!--")) {
+        size_t end = find("-->", pos_ + 4);
+        if (end == std::string::npos) return fail("Unterminated comment");
+        text_.assign(buffer_, pos_ + 4, end - pos_ - 4);
+        takeRaw(end + 3);
+        tokenType_ = TokenType::Comment;
+        return tokenType_;
+    }
+
+    if (startsWith("<![CDATA[")) {
+        size_t end = find("]]>", pos_ + 9);
+        if (end == std::string::npos) return fail("Unterminated CDATA section");
+        text_.assign(buffer_, pos_ + 9, end - pos_ - 9);
+        takeRaw(end + 3);
+        tokenType_ = TokenType::CData;
+        return tokenType_;
+    }
+
+    if (startsWith("<!")) {
+        size_t end = findDoctypeEnd(pos_ + 2);
+        if (end == std::string::npos) return fail("Unterminated declaration");
+        text_.assign(buffer_, pos_ + 2, end - pos_ - 2);
+        takeRaw(end + 1);
+        tokenType_ = TokenType::Doctype;
+        return tokenType_;
+    }
+
+    if (startsWith("</")) {
+        size_t end = findTagEnd(pos_ + 2);
+        if (end == std::string::npos) return fail("Unterminated closing tag");
+        return readEndTag(end);
+    }
+
+    size_t end = findTagEnd(pos_ + 1);
+    if (end == std::string::npos) return fail("Unterminated start tag");
+    return readStartTag(end);
+}
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool isNameEnd(char c) {
+    return isSpace(c) || c == '/' || c == '>' || c == '=';
+}
+
+} // namespace
+
+XmlStreamReader::TokenType XmlStreamReader::readStartTag(size_t end) {
+    const char* p = buffer_.data() + pos_ + 1;
+    const char* tagEnd = buffer_.data() + end;
+
+    const char* nameBegin = p;
+    while (p < tagEnd && !isNameEnd(*p)) ++p;
+    if (p == nameBegin) return fail("Invalid tag name");
+    name_.assign(nameBegin, p);
+
+    while (true) {
+        while (p < tagEnd && isSpace(*p)) ++p;
+        if (p >= tagEnd || *p == '/') break;
+
+        const char* keyBegin = p;
+        while (p < tagEnd && !isNameEnd(*p)) ++p;
+        if (p == keyBegin) return fail("Invalid attribute in <" + name_ + ">");
+        std::string key(keyBegin, p);
+
+        while (p < tagEnd && isSpace(*p)) ++p;
+        if (p >= tagEnd || *p != '=') return fail("Expected '=' after attribute name");
+        ++p;
+        while (p < tagEnd && isSpace(*p)) ++p;
+        if (p >= tagEnd || (*p != '"' && *p != '\'')) {
+            return fail("Expected quote around attribute value");
+        }
+        char quote = *p++;
+        const char* valueBegin = p;
+        while (p < tagEnd && *p != quote) ++p;
+        if (p >= tagEnd) return fail("Unterminated attribute value");
+
+        std::string value;
+        appendUnescaped(value, valueBegin, p);
+        attributes_.emplace_back(std::move(key), std::move(value));
+        ++p;
+    }
+
+    emptyElement_ = (end > pos_ + 1 && buffer_[end - 1] == '/');
+    openElements_.push_back(name_);
+    pendingEnd_ = emptyElement_;
+    takeRaw(end + 1);
+    tokenType_ = TokenType::StartElement;
+    return tokenType_;
+}
+
+XmlStreamReader::TokenType XmlStreamReader::readEndTag(size_t end) {
+    size_t nameBegin = pos_ + 2;
+    size_t nameEnd = end;
+    while (nameEnd > nameBegin && isSpace(buffer_[nameEnd - 1])) --nameEnd;
+    name_.assign(buffer_, nameBegin, nameEnd - nameBegin);
+
+    if (openElements_.empty()) {
+        return fail("Unexpected closing tag </" + name_ + ">");
+    }
+    if (openElements_.back() != name_) {
+        return fail("Mismatched closing tag: expected " + openElements_.back() + ", got " + name_);
+    }
+
+    openElements_.pop_back();
+    depth_ = static_cast<int>(openElements_.size());
+    takeRaw(end + 1);
+    tokenType_ = TokenType::EndElement;
+    return tokenType_;
+}
+
+XmlStreamReader::TokenType XmlStreamReader::readText() {
+    size_t end = find("<", pos_);
+    if (end == std::string::npos) {
+        end = buffer_.size();
+    }
+
+    depth_ = static_cast<int>(openElements_.size());
+    appendUnescaped(text_, buffer_.data() + pos_, buffer_.data() + end);
+    takeRaw(end);
+    tokenType_ = TokenType::Text;
+    return tokenType_;
+}
+
+std::string XmlStreamReader::unescape(const std::string& text) {
+    std::string result;
+    appendUnescaped(result, text.data(), text.data() + text.size());
+    return result;
+}
+
+namespace {
+
+void appendUtf8(std::string& out, unsigned long codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+void XmlStreamReader::appendUnescaped(std::string& out, const char* begin, const char* end) {
+    const char* p = begin;
+    while (p < end) {
+        const char* amp = static_cast<const char*>(std::memchr(p, '&', end - p));
+        if (!amp) {
+            out.append(p, end);
+            return;
+        }
+        out.append(p, amp);
+
+        const char* semicolon = static_cast<const char*>(
+            std::memchr(amp, ';', std::min<ptrdiff_t>(end - amp, 12)));
+        if (!semicolon) {
+            out += '&';
+            p = amp + 1;
+            continue;
+        }
+
+        std::string entity(amp + 1, semicolon);
+        if (entity == "lt") {
+            out += '<';
+        } else if (entity == "gt") {
+            out += '>';
+        } else if (entity == "amp") {
+            out += '&';
+        } else if (entity == "quot") {
+            out += '"';
+        } else if (entity == "apos") {
+            out += '\'';
+        } else if (entity.size() > 1 && entity[0] == '#') {
+            bool hex = (entity[1] == 'x' || entity[1] == 'X');
+            char* parsedEnd = nullptr;
+            const char* digits = entity.c_str() + (hex ? 2 : 1);
+            unsigned long codePoint = std::strtoul(digits, &parsedEnd, hex ? 16 : 10);
+            if (parsedEnd && *parsedEnd == '\0' && *digits != '\0') {
+                appendUtf8(out, codePoint);
+            } else {
+                out.append(amp, semicolon + 1);
+            }
+        } else {
+            // Unknown entity: keep it verbatim
+            out.append(amp, semicolon + 1);
+        }
+        p = semicolon + 1;
+    }
+}
@@ -0,0 +1,150 @@
+#include "xml_tail_reader.h"
+#include "xml_record_scanner.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+XmlTailReader::XmlTailReader() : fileOffset_(0), finished_(false), recordCount_(0) {
+}
+
+bool XmlTailReader::open(const std::string& path) {
+    close();
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+    if (!file.is_open()) {
+        return fail("Cannot open file: " + path);
+    }
+    path_ = path;
+    return true;
+}
+
+void XmlTailReader::close() {
+    path_.clear();
+    errorMessage_.clear();
+    reset();
+}
+
+void XmlTailReader::reset() {
+    fileOffset_ = 0;
+    pending_.clear();
+    root_.reset();
+    finished_ = false;
+    recordCount_ = 0;
+}
+
+bool XmlTailReader::fail(const std::string& message) {
+    if (errorMessage_.empty()) {
+        errorMessage_ = message;
+    }
+    return false;
+}
+
+bool XmlTailReader::poll(Update& update) {
+    update = Update();
+    if (!isOpen()) {
+        return fail("No file is being followed");
+    }
+    if (hasError()) {
+        return false;
+    }
+
+    if (!readAppended(update)) {
+        return false;
+    }
+    if (!root_ && !readRootStart(update)) {
+        return false;
+    }
+    if (root_ && !finished_ && !readRecords(update)) {
+        return false;
+    }
+    if (finished_) {
+        // Whatever follows the root end tag (comments, whitespace) is shown as is
+        update.appendedText += pending_;
+        pending_.clear();
+    }
+    return true;
+}
+
+bool XmlTailReader::readAppended(Update& update) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(std::filesystem::u8path(path_), error);
+    if (error) {
+        return fail("Cannot read " + path_ + ": " + error.message());
+    }
+    if (size < fileOffset_) {
+        reset();
+        update.restarted = true;
+    }
+    if (size == fileOffset_) {
+        return true;
+    }
+
+    size_t count = static_cast<size_t>(std::min<uint64_t>(size - fileOffset_, kMaxReadPerPoll));
+    update.hasMore = size - fileOffset_ > count;
+
+    std::ifstream file(std::filesystem::u8path(path_), std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(fileOffset_));
+    size_t start = pending_.size();
+    pending_.resize(start + count);
+    file.read(&pending_[start], static_cast<std::streamsize>(count));
+    // The writer may be in the middle of a write; keep what actually arrived
+    size_t received = file ? count : static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0));
+    pending_.resize(start + received);
+    fileOffset_ += received;
+    if (!file && received == 0) {
+        return fail("Cannot read " + path_);
+    }
+    return true;
+}
+
+bool XmlTailReader::readRootStart(Update& update) {
+    XmlRecordScanner scanner(pending_.data(), pending_.size());
+    if (!scanner.scanRootStart()) {
+        // Most likely the prolog is still being written
+        if (pending_.size() > kMaxPrologBytes) {
+            return fail(path_ + ": " + scanner.getErrorMessage());
+        }
+        return true;
+    }
+
+    // Build the root from its start tag alone; the records are added as they arrive
+    const XmlRecordScanner::Layout& layout = scanner.layout();
+    std::string startTag = pending_.substr(layout.rootBegin, layout.contentBegin - layout.rootBegin);
+    bool selfClosing = startTag.size() >= 2 && startTag[startTag.size() - 2] == '/';
+    root_ = parser_.parseString(selfClosing ? startTag : startTag + "</" + layout.rootName + ">");
+    if (!root_) {
+        return fail(path_ + ": " + parser_.getErrorMessage());
+    }
+    finished_ = selfClosing;
+
+    update.appendedText.append(pending_, 0, layout.contentBegin);
+    pending_.erase(0, layout.contentBegin);
+    return true;
+}
+
+bool XmlTailReader::readRecords(Update& update) {
+    XmlRecordScanner scanner(pending_.data(), pending_.size());
+    scanner.setContentRange(0, pending_.size(), true);
+
+    size_t pos = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    while (scanner.nextRecord(pos, begin, end)) {
+        auto record = parser_.parseString(pending_.substr(begin, end - begin));
+        if (!record) {
+            return fail(path_ + ": record at offset " +
+                        std::to_string(fileOffset_ - pending_.size() + begin) + ": " +
+                        parser_.getErrorMessage());
+        }
+        root_->addChild(record);
+        update.records.push_back(record);
+        ++recordCount_;
+    }
+    if (scanner.hasError()) {
+        return fail(path_ + ": " + scanner.getErrorMessage());
+    }
+    finished_ = scanner.reachedEndTag();
+
+    update.appendedText.append(pending_, 0, pos);
+    pending_.erase(0, pos);
+    return true;
+}
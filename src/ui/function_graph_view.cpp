@@ -137,10 +137,13 @@ void FunctionGraphView::setupUI() {
     )");
 }
 
-void FunctionGraphView::setParserData(const CppParser& parser) {
-    functions_ = parser.getFunctions();
-    classes_ = parser.getClasses();
-    functionCalls_ = parser.getFunctionCalls();
+void FunctionGraphView::setCodeModel(const CodeModel& model) {
+    functions_ = model.getFunctions();
+    functionNodes_.clear();
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        functionNodes_.push_back(model.getFunctionNode(i));
+    }
+    callGraph_ = model.getCallGraph();
 }
 
 void FunctionGraphView::generateGraph() {
@@ -160,7 +163,7 @@ void FunctionGraphView::generateGraph() {
     graphView_->fitInView(scene_->sceneRect(), Qt::KeepAspectRatio);
     
     infoLabel_->setText(QString("Displaying %1 functions, %2 call relationships")
-                       .arg(functions_.size())
+                       .arg(nodes_.size())
                        .arg(edges_.size()));
 }
 
@@ -172,9 +175,13 @@ void FunctionGraphView::clearGraph() {
 }
 
 void FunctionGraphView::createNodes() {
-    for (const auto& func : functions_) {
-        FunctionNode* node = new FunctionNode(func);
-        nodes_[func.name] = node;
+    for (size_t i = 0; i < functions_.size(); ++i) {
+        // A declaration and its definition are one node, shown as the first
+        const std::string& key = callGraph_.name(functionNodes_[i]);
+        if (nodes_.count(key)) continue;
+        
+        FunctionNode* node = new FunctionNode(functions_[i], functionNodes_[i]);
+        nodes_[key] = node;
         scene_->addItem(node);
         
         // Connect node click events
@@ -183,17 +190,15 @@ void FunctionGraphView::createNodes() {
 }
 
 void FunctionGraphView::createEdges() {
-    for (const auto& callPair : functionCalls_) {
-        const std::string& callerName = callPair.first;
-        const auto& calledFunctions = callPair.second;
-        
-        auto callerIt = nodes_.find(callerName);
+    // One edge per caller/callee pair, however often the call repeats
+    for (CallGraph::NodeId caller = 0; caller < callGraph_.nodeCount(); ++caller) {
+        auto callerIt = nodes_.find(callGraph_.name(caller));
         if (callerIt == nodes_.end()) continue;
         
         FunctionNode* callerNode = callerIt->second;
         
-        for (const std::string& calledName : calledFunctions) {
-            auto calledIt = nodes_.find(calledName);
+        for (const CallGraph::Edge& edge : callGraph_.callees(caller)) {
+            auto calledIt = nodes_.find(callGraph_.name(edge.node));
             if (calledIt != nodes_.end()) {
                 FunctionNode* calledNode = calledIt->second;
                 FunctionEdge* edge = new FunctionEdge(callerNode, calledNode);
@@ -240,24 +245,17 @@ void FunctionGraphView::layoutHierarchical() {
     if (nodes_.empty()) return;
     
     // Find root nodes (functions not called by other functions)
-    std::set<std::string> calledFunctions;
-    for (const auto& pair : functionCalls_) {
-        for (const std::string& called : pair.second) {
-            calledFunctions.insert(called);
-        }
-    }
-    
     std::vector<std::string> rootFunctions;
-    for (const auto& func : functions_) {
-        if (calledFunctions.find(func.name) == calledFunctions.end()) {
-            rootFunctions.push_back(func.name);
+    for (const auto& pair : nodes_) {
+        if (callGraph_.callers(pair.second->getGraphNode()).empty()) {
+            rootFunctions.push_back(pair.first);
         }
     }
     
     // If no root nodes, randomly select some
     if (rootFunctions.empty()) {
-        for (int i = 0; i < std::min(3, (int)functions_.size()); ++i) {
-            rootFunctions.push_back(functions_[i].name);
+        for (int i = 0; i < std::min(3, (int)functionNodes_.size()); ++i) {
+            rootFunctions.push_back(callGraph_.name(functionNodes_[i]));
         }
     }
     
@@ -276,21 +274,19 @@ void FunctionGraphView::layoutHierarchical() {
         std::string current = queue.front();
         queue.pop();
         
-        auto it = functionCalls_.find(current);
-        if (it != functionCalls_.end()) {
-            for (const std::string& called : it->second) {
-                if (levels.find(called) == levels.end()) {
-                    levels[called] = levels[current] + 1;
-                    queue.push(called);
-                }
+        for (const CallGraph::Edge& edge : callGraph_.callees(callGraph_.find(current))) {
+            const std::string& called = callGraph_.name(edge.node);
+            if (levels.find(called) == levels.end()) {
+                levels[called] = levels[current] + 1;
+                queue.push(called);
             }
         }
     }
     
     // Assign levels to unassigned nodes
-    for (const auto& func : functions_) {
-        if (levels.find(func.name) == levels.end()) {
-            levels[func.name] = 0;
+    for (const auto& pair : nodes_) {
+        if (levels.find(pair.first) == levels.end()) {
+            levels[pair.first] = 0;
         }
     }
     
@@ -423,34 +419,33 @@ void FunctionGraphView::onNodeClicked(FunctionNode* node) {
     node->setSelected(true);
     
     // Show function details
-    const CppFunction& func = node->getFunction();
+    const CodeFunction& func = node->getFunction();
     QString details = QString(
         "<h3 style='color: #4EC9B0;'>%1</h3>"
-        "<p><b>Return Type:</b> %2</p>"
+        "<p><b>Signature:</b> %2</p>"
         "<p><b>Line Number:</b> %3</p>"
         "<p><b>Parameters:</b></p>"
         "<ul>%4</ul>"
         "<p><b>Called Functions:</b> %5</p>"
-    ).arg(QString::fromStdString(func.name))
-     .arg(QString::fromStdString(func.returnType))
+    ).arg(QString::fromStdString(func.qualifiedName).toHtmlEscaped())
+     .arg(QString::fromStdString(func.signature).toHtmlEscaped())
      .arg(func.lineNumber);
     
     QString paramList;
     for (const auto& param : func.parameters) {
-        paramList += QString("<li>%1 %2</li>")
+        // Python parameters may have no annotation
+        QString paramText = QString("%1 %2")
                     .arg(QString::fromStdString(param.type))
-                    .arg(QString::fromStdString(param.name));
+                    .arg(QString::fromStdString(param.name)).trimmed();
+        paramList += QString("<li>%1</li>").arg(paramText.toHtmlEscaped());
     }
     
-    QString calledFuncs;
-    auto it = functionCalls_.find(func.name);
-    if (it != functionCalls_.end()) {
-        QStringList called;
-        for (const std::string& name : it->second) {
-            called << QString::fromStdString(name);
-        }
-        calledFuncs = called.join(", ");
+    QStringList called;
+    for (const CallGraph::Edge& edge : callGraph_.callees(node->getGraphNode())) {
+        QString name = QString::fromStdString(callGraph_.name(edge.node)).toHtmlEscaped();
+        called << (edge.count > 1 ? QString("%1 (%2 calls)").arg(name).arg(edge.count) : name);
     }
+    QString calledFuncs = called.join(", ");
     
     details = details.arg(paramList).arg(calledFuncs);
     detailsLabel_->setText(details);
@@ -470,8 +465,8 @@ void FunctionGraphView::showFunctionDetails(const QString& functionName) {
 }
 
 // FunctionNode 实现
-FunctionNode::FunctionNode(const CppFunction& function, QGraphicsItem* parent)
-    : QObject(), QGraphicsEllipseItem(-40, -40, 80, 80, parent), function_(function), 
+FunctionNode::FunctionNode(const CodeFunction& function, CallGraph::NodeId graphNode, QGraphicsItem* parent)
+    : QObject(), QGraphicsEllipseItem(-40, -40, 80, 80, parent), function_(function), graphNode_(graphNode),
       isSelected_(false), isHighlighted_(false) {
     
     // Set node style
@@ -484,6 +479,7 @@ FunctionNode::FunctionNode(const CppFunction& function, QGraphicsItem* parent)
     textItem_ = new QGraphicsTextItem(QString::fromStdString(function.name), this);
     textItem_->setDefaultTextColor(QColor("#CCCCCC"));
     textItem_->setFont(QFont("Arial", 10, QFont::Bold));
+    setToolTip(QString::fromStdString(function.qualifiedName));
     
     // Center text
     QRectF textRect = textItem_->boundingRect();
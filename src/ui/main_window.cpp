@@ -1,6 +1,8 @@
 #include "main_window.h"
 #include <QApplication>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QMessageBox>
 #include <QTreeWidgetItem>
 #include <QTextStream>
@@ -27,12 +29,22 @@
 #include <QScrollBar>
 #include <QPainter>
 #include <QTextBlock>
+#include <QTextDocument>
+#include <QSignalBlocker>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
+#include "compressed_stream.h"
 #include "markdown_highlighter.h"
 #include "cpp_highlighter.h"
 #include "python_highlighter.h"
 #include "go_highlighter.h"
+#include "symbol_cache.h"
 
 // Enhanced FoldingTextEdit with line numbers
 class EnhancedFoldingTextEdit : public FoldingTextEdit {
@@ -127,6 +139,14 @@ private:
 
 #include "main_window.moc"
 
+namespace {
+
+// Fallback poll for file systems without change notifications; keeps the
+// append-to-display latency under 100 ms either way
+constexpr int kTailPollIntervalMs = 50;
+
+} // namespace
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent) {
     setupUi();
@@ -147,6 +167,33 @@ MainWindow::MainWindow(QWidget *parent)
     currentHighlighter_ = nullptr;
     isDarkTheme_ = true; // Default to dark theme
     
+    // Tail mode: react to change notifications at once and poll as a fallback
+    tailWatcher_ = new QFileSystemWatcher(this);
+    connect(tailWatcher_, &QFileSystemWatcher::fileChanged, this, &MainWindow::pollTail);
+    tailTimer_ = new QTimer(this);
+    connect(tailTimer_, &QTimer::timeout, this, &MainWindow::pollTail);
+    
+    // Project indexing runs on its own thread; its progress is polled
+    indexSucceeded_ = false;
+    indexTimer_ = new QTimer(this);
+    connect(indexTimer_, &QTimer::timeout, this, &MainWindow::pollProjectIndex);
+    
+    // Long file operations too
+    jobSucceeded_ = false;
+    jobTimer_ = new QTimer(this);
+    connect(jobTimer_, &QTimer::timeout, this, &MainWindow::pollJob);
+    
+    // Code analysis follows the editor once a file has been parsed; edits
+    // are applied when typing pauses
+    documentLineCount_ = 0;
+    dirtyFirstLine_ = 0;
+    dirtyEndLine_ = -1;
+    dirtyLineDelta_ = 0;
+    graphFollowsDocument_ = false;
+    analysisTimer_ = new QTimer(this);
+    analysisTimer_->setSingleShot(true);
+    connect(analysisTimer_, &QTimer::timeout, this, &MainWindow::refreshCodeAnalysis);
+    
     setWindowTitle("Nexus - Multi-Purpose Code Editor & Visualizer");
     
     // Set window icon
@@ -157,6 +204,8 @@ MainWindow::MainWindow(QWidget *parent)
 }
 
 MainWindow::~MainWindow() {
+    stopProjectIndex();
+    stopJob();
 }
 
 void MainWindow::setupUi() {
@@ -288,12 +337,19 @@ void MainWindow::setupUi() {
     functionGraphView_ = new FunctionGraphView();
     rightTabs_->addTab(functionGraphView_, "Function Graph");
     
+    // Schema Tab: one row per element path, attributes as child rows
+    schemaTree_ = new QTreeWidget();
+    schemaTree_->setHeaderLabels({"Element", "Count", "Occurs", "Type", "Values"});
+    schemaTree_->setStyleSheet("QTreeWidget { background-color: #1E1E1E; border: none; color: #D4D4D4; }");
+    rightTabs_->addTab(schemaTree_, "Schema");
+    
     rightLayout->addWidget(rightTabs_);
     
     // Connect signals
     connect(treeWidget_, &QTreeWidget::itemClicked, this, &MainWindow::onTreeItemClicked);
     connect(xmlEditor_, &QPlainTextEdit::textChanged, this, &MainWindow::renderMarkdownPreview);
     connect(xmlEditor_, &QPlainTextEdit::textChanged, this, &MainWindow::updateLineCount);
+    connect(xmlEditor_->document(), &QTextDocument::contentsChange, this, &MainWindow::onDocumentContentsChange);
 }
 
 void MainWindow::setupMenuBar() {
@@ -322,6 +378,19 @@ void MainWindow::setupMenuBar() {
     exportCsvAction_ = exportMenu->addAction("To &CSV...");
     connect(exportCsvAction_, &QAction::triggered, this, &MainWindow::exportToCsv);
     
+    exportCborAction_ = exportMenu->addAction("To C&BOR...");
+    connect(exportCborAction_, &QAction::triggered, this, &MainWindow::exportToCbor);
+    
+    exportMessagePackAction_ = exportMenu->addAction("To &MessagePack...");
+    connect(exportMessagePackAction_, &QAction::triggered, this, &MainWindow::exportToMessagePack);
+    
+    exportSqliteAction_ = exportMenu->addAction("To &SQLite Database...");
+    connect(exportSqliteAction_, &QAction::triggered, this, &MainWindow::exportToSqlite);
+    
+    exportXsdAction_ = exportMenu->addAction("To XSD &Draft...");
+    exportXsdAction_->setToolTip("Write an XML Schema inferred from the current XML");
+    connect(exportXsdAction_, &QAction::triggered, this, &MainWindow::exportToXsd);
+    
     // Import submenu
     QMenu* importMenu = fileMenu->addMenu("&Import");
     importJsonAction_ = importMenu->addAction("From &JSON...");
@@ -330,6 +399,31 @@ void MainWindow::setupMenuBar() {
     importYamlAction_ = importMenu->addAction("From &YAML...");
     connect(importYamlAction_, &QAction::triggered, this, &MainWindow::importFromYaml);
     
+    convertLargeXmlAction_ = fileMenu->addAction("Convert &Large XML...");
+    convertLargeXmlAction_->setToolTip("Stream an XML file to JSON, YAML or CSV without loading it");
+    connect(convertLargeXmlAction_, &QAction::triggered, this, &MainWindow::convertLargeXml);
+    
+    pipelineAction_ = fileMenu->addAction("Run &Pipeline...");
+    pipelineAction_->setToolTip("Filter, select and rename the records of an XML file and write them as JSON or CSV");
+    connect(pipelineAction_, &QAction::triggered, this, &MainWindow::runPipeline);
+    
+    splitXmlAction_ = fileMenu->addAction("S&plit XML...");
+    splitXmlAction_->setToolTip("Split a record-oriented XML file into smaller files");
+    connect(splitXmlAction_, &QAction::triggered, this, &MainWindow::splitXml);
+    
+    mergeXmlAction_ = fileMenu->addAction("&Merge XML...");
+    mergeXmlAction_->setToolTip("Join the records of several XML files into one file");
+    connect(mergeXmlAction_, &QAction::triggered, this, &MainWindow::mergeXml);
+    
+    compareXmlAction_ = fileMenu->addAction("Compare &XML Files...");
+    compareXmlAction_->setToolTip("Show the structural differences between two XML files");
+    connect(compareXmlAction_, &QAction::triggered, this, &MainWindow::compareXmlFiles);
+    
+    tailAction_ = fileMenu->addAction("&Tail XML File...");
+    tailAction_->setCheckable(true);
+    tailAction_->setToolTip("Follow a growing XML log and show records as they are appended");
+    connect(tailAction_, &QAction::toggled, this, &MainWindow::toggleTailMode);
+    
     fileMenu->addSeparator();
     
     exitAction_ = fileMenu->addAction("E&xit");
@@ -342,6 +436,15 @@ void MainWindow::setupMenuBar() {
     searchAction_->setShortcut(QKeySequence::Find);
     connect(searchAction_, &QAction::triggered, this, &MainWindow::showSearchDialog);
     
+    goToRecordAction_ = editMenu->addAction("&Go to Record...");
+    goToRecordAction_->setShortcut(QKeySequence("Ctrl+G"));
+    goToRecordAction_->setToolTip("Jump to a record of a large XML file by number or key");
+    connect(goToRecordAction_, &QAction::triggered, this, &MainWindow::goToRecord);
+    
+    profileSchemaAction_ = editMenu->addAction("Profile XML &Schema");
+    profileSchemaAction_->setToolTip("Infer element paths, occurrences and value types of the current XML");
+    connect(profileSchemaAction_, &QAction::triggered, this, &MainWindow::profileSchema);
+    
     editMenu->addSeparator();
     foldAllAction_ = editMenu->addAction("Fold &All");
     foldAllAction_->setShortcut(QKeySequence("Ctrl+Shift+["));
@@ -351,6 +454,14 @@ void MainWindow::setupMenuBar() {
     unfoldAllAction_->setShortcut(QKeySequence("Ctrl+Shift+]"));
     connect(unfoldAllAction_, &QAction::triggered, this, &MainWindow::unfoldAllXml);
     
+    editMenu->addSeparator();
+    formatDocumentAction_ = editMenu->addAction("F&ormat Document");
+    formatDocumentAction_->setShortcut(QKeySequence("Ctrl+Shift+I"));
+    connect(formatDocumentAction_, &QAction::triggered, this, &MainWindow::formatDocument);
+    
+    minifyDocumentAction_ = editMenu->addAction("&Minify Document");
+    connect(minifyDocumentAction_, &QAction::triggered, this, &MainWindow::minifyDocument);
+    
     editMenu->addSeparator();
     
     // Parse shortcuts
@@ -796,21 +907,22 @@ void MainWindow::setupStyle() {
 }
 
 void MainWindow::openFile() {
-    QString filters = "Go Files (*.go);;Python Files (*.py *.pyw);;C++ Files (*.cpp *.cc *.cxx *.h *.hpp *.hxx);;XML Files (*.xml);;Markdown Files (*.md *.markdown);;All Files (*)";
+    QString filters = "Go Files (*.go);;Python Files (*.py *.pyw);;C++ Files (*.cpp *.cc *.cxx *.h *.hpp *.hxx);;XML Files (*.xml *.xml.gz *.xml.xz *.xml.zst);;Markdown Files (*.md *.markdown);;All Files (*)";
     QString fileName = QFileDialog::getOpenFileName(this,
         "Open File", "", filters);
     
     if (!fileName.isEmpty()) {
+        stopTail();
         currentFilePath_ = fileName.toStdString();
         fileLabel_->setText(QFileInfo(fileName).fileName());
         parseButton_->setEnabled(true);
         
-        // Load content
-        QFile file(fileName);
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            QString content = in.readAll();
-            file.close();
+        // Load content, decompressing .gz/.xz/.zst on the fly
+        std::string bytes;
+        QString error;
+        if (readFileContent(fileName, bytes, error)) {
+            QString content = QString::fromUtf8(bytes.data(), static_cast<int>(bytes.size()));
+            resetDocumentAnalysis();
             xmlEditor_->setPlainText(content);
             originalXmlContent_ = content;
             isEditing_ = false;
@@ -818,7 +930,7 @@ void MainWindow::openFile() {
             saveAction_->setEnabled(false);
             xmlEditor_->setReadOnly(true);
         } else {
-            QMessageBox::critical(this, "Error", "Failed to open file: " + fileName);
+            QMessageBox::critical(this, "Error", "Failed to open file: " + fileName + "\n" + error);
             return;
         }
         
@@ -857,27 +969,30 @@ void MainWindow::openProject() {
         parseButton_->setEnabled(true);
         
         statusBar()->showMessage("Project opened: " + projectPath);
+        
+        // Index the code in the background; the UI stays usable meanwhile
+        startProjectIndex(projectPath);
     }
 }
 
 bool MainWindow::isCurrentFileMarkdown() const {
-    QString qpath = QString::fromStdString(currentFilePath_).toLower();
+    QString qpath = QString::fromStdString(stripCompressionExtension(currentFilePath_)).toLower();
     return qpath.endsWith(".md") || qpath.endsWith(".markdown");
 }
 
 bool MainWindow::isCurrentFileCpp() const {
-    QString qpath = QString::fromStdString(currentFilePath_).toLower();
+    QString qpath = QString::fromStdString(stripCompressionExtension(currentFilePath_)).toLower();
     return qpath.endsWith(".cpp") || qpath.endsWith(".cc") || qpath.endsWith(".cxx") ||
            qpath.endsWith(".h") || qpath.endsWith(".hpp") || qpath.endsWith(".hxx");
 }
 
 bool MainWindow::isCurrentFilePython() const {
-    QString qpath = QString::fromStdString(currentFilePath_).toLower();
+    QString qpath = QString::fromStdString(stripCompressionExtension(currentFilePath_)).toLower();
     return qpath.endsWith(".py") || qpath.endsWith(".pyw");
 }
 
 bool MainWindow::isCurrentFileGo() const {
-    QString qpath = QString::fromStdString(currentFilePath_).toLower();
+    QString qpath = QString::fromStdString(stripCompressionExtension(currentFilePath_)).toLower();
     return qpath.endsWith(".go");
 }
 
@@ -985,18 +1100,16 @@ void MainWindow::saveFile() {
     }
     
     QString fileName = QFileDialog::getSaveFileName(this,
-        "Save XML File", "", "XML Files (*.xml);;All Files (*)");
+        "Save XML File", "", "XML Files (*.xml);;Compressed XML (*.xml.gz *.xml.xz *.xml.zst);;All Files (*)");
     
     if (!fileName.isEmpty()) {
         try {
-            std::string xmlContent = serializer_.serializeToXml(rootNode_);
-            std::ofstream file(fileName.toStdString());
-            if (file.is_open()) {
-                file << xmlContent;
-                file.close();
+            std::string xmlContent = serializer_.serializeIncremental(rootNode_, XmlSerializer::Format::XML);
+            QString error;
+            if (writeExportFile(fileName, xmlContent, error)) {
                 statusBar()->showMessage("File saved: " + fileName);
             } else {
-                QMessageBox::critical(this, "Error", "Failed to save file.");
+                QMessageBox::critical(this, "Error", "Failed to save file.\n" + error);
             }
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Error", 
@@ -1057,7 +1170,20 @@ void MainWindow::populateTreeWidget(const std::shared_ptr<XmlNode>& node, QTreeW
     } else {
         item = new QTreeWidgetItem(treeWidget_);
     }
+    setupTreeItem(item, node);
     
+    // Recursively add children
+    for (const auto& child : node->getChildren()) {
+        populateTreeWidget(child, item);
+    }
+    
+    // Expand the item if it has children
+    if (!node->isLeaf()) {
+        item->setExpanded(true);
+    }
+}
+
+void MainWindow::setupTreeItem(QTreeWidgetItem* item, const std::shared_ptr<XmlNode>& node) {
     // Set item text based on node type
     QString displayText;
     switch (node->getType()) {
@@ -1101,17 +1227,89 @@ void MainWindow::populateTreeWidget(const std::shared_ptr<XmlNode>& node, QTreeW
         }
     } else if (node->getType() == XmlNode::NodeType::Text) {
         item->setIcon(0, style()->standardIcon(QStyle::SP_MessageBoxInformation));
+    } else {
+        item->setIcon(0, QIcon());
+    }
+}
+
+void MainWindow::refreshTreeWidget(const std::shared_ptr<XmlNode>& newRoot) {
+    // Without a tree that shows rootNode_ there is nothing to reuse
+    QTreeWidgetItem* topItem = treeWidget_->topLevelItemCount() == 1 ? treeWidget_->topLevelItem(0) : nullptr;
+    if (!rootNode_ || !newRoot || !topItem ||
+        topItem->data(0, Qt::UserRole).value<std::shared_ptr<XmlNode>>() != rootNode_) {
+        treeWidget_->clear();
+        rootNode_ = newRoot;
+        populateTreeWidget(rootNode_);
+        return;
     }
     
-    // Recursively add children
-    for (const auto& child : node->getChildren()) {
-        populateTreeWidget(child, item);
+    if (rootNode_->contentEquals(*newRoot)) {
+        return;
+    }
+    refreshTreeItem(topItem, rootNode_, newRoot);
+    rootNode_ = newRoot;
+}
+
+void MainWindow::refreshTreeItem(QTreeWidgetItem* item, const std::shared_ptr<XmlNode>& oldNode,
+                                 const std::shared_ptr<XmlNode>& newNode) {
+    // item shows oldNode, whose content differs from newNode. Branches with
+    // equal hashes keep their items (and expansion state): the old subtree is
+    // grafted into the new tree in place of its equal copy, so the items stay
+    // bound to nodes of the current tree.
+    setupTreeItem(item, newNode);
+    const std::vector<std::shared_ptr<XmlNode>> oldChildren = oldNode->getChildren();
+    const std::vector<std::shared_ptr<XmlNode>> newChildren = newNode->getChildren();
+    if (item->childCount() != static_cast<int>(oldChildren.size())) {
+        qDeleteAll(item->takeChildren());
+        for (const auto& child : newChildren) {
+            populateTreeWidget(child, item);
+        }
+        return;
     }
     
-    // Expand the item if it has children
-    if (!node->isLeaf()) {
-        item->setExpanded(true);
+    const size_t shorter = std::min(oldChildren.size(), newChildren.size());
+    size_t prefix = 0;
+    while (prefix < shorter && oldChildren[prefix]->contentEquals(*newChildren[prefix])) {
+        newNode->setChild(prefix, oldChildren[prefix]);
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < shorter - prefix &&
+           oldChildren[oldChildren.size() - 1 - suffix]->contentEquals(*newChildren[newChildren.size() - 1 - suffix])) {
+        newNode->setChild(newChildren.size() - 1 - suffix, oldChildren[oldChildren.size() - 1 - suffix]);
+        ++suffix;
+    }
+    
+    const size_t oldCount = oldChildren.size() - prefix - suffix;
+    const size_t newCount = newChildren.size() - prefix - suffix;
+    for (size_t i = 0; i < std::max(oldCount, newCount); ++i) {
+        const int row = static_cast<int>(prefix + i);
+        if (i < oldCount && i < newCount) {
+            const auto& oldChild = oldChildren[prefix + i];
+            const auto& newChild = newChildren[prefix + i];
+            if (oldChild->contentEquals(*newChild)) {
+                newNode->setChild(prefix + i, oldChild);
+                continue;
+            }
+            if (oldChild->getType() == newChild->getType() && oldChild->getName() == newChild->getName()) {
+                refreshTreeItem(item->child(row), oldChild, newChild);
+                continue;
+            }
+            delete item->takeChild(row);
+        } else if (i < oldCount) {
+            delete item->takeChild(static_cast<int>(prefix + newCount));
+            continue;
+        }
+        
+        QTreeWidgetItem* childItem = new QTreeWidgetItem();
+        item->insertChild(row, childItem);
+        setupTreeItem(childItem, newChildren[prefix + i]);
+        for (const auto& grandchild : newChildren[prefix + i]->getChildren()) {
+            populateTreeWidget(grandchild, childItem);
+        }
+        childItem->setExpanded(!newChildren[prefix + i]->isLeaf());
     }
+    item->setExpanded(!newNode->isLeaf());
 }
 
 void MainWindow::displayNodeDetails(const std::shared_ptr<XmlNode>& node) {
@@ -1192,13 +1390,84 @@ void MainWindow::updateLineCount() {
     if (!xmlEditor_) return;
     
     int lineCount = xmlEditor_->document()->blockCount();
-    int charCount = xmlEditor_->toPlainText().length();
+    // characterCount() avoids copying the whole document on every change
+    int charCount = xmlEditor_->document()->characterCount() - 1;
     
     lineCountLabel_->setText(QString("Lines: %1").arg(lineCount));
     charCountLabel_->setText(QString("Chars: %1").arg(charCount));
 }
 
 
+void MainWindow::startProjectIndex(const QString& projectPath) {
+    stopProjectIndex();
+    
+    projectIndexer_ = std::make_unique<ProjectIndexer>();
+    projectIndexer_->setCachePath(SymbolCache::defaultCachePath(projectPath.toStdString()));
+    indexFilesDone_ = 0;
+    indexFilesTotal_ = 0;
+    indexCancelled_ = false;
+    indexFinished_ = false;
+    indexSucceeded_ = false;
+    
+    // Called on the indexing thread: only the atomics are touched there.
+    // The indexer also checks indexCancelled_ while listing and merging, so
+    // stopProjectIndex() does not wait for the whole pass.
+    projectIndexer_->setProgressCallback([this](size_t filesDone, size_t filesTotal) {
+        indexFilesDone_ = filesDone;
+        indexFilesTotal_ = filesTotal;
+        return true;
+    });
+    projectIndexer_->setCancelFlag(&indexCancelled_);
+    
+    progressBar_->setVisible(true);
+    progressBar_->setRange(0, 0); // Indeterminate while files are listed
+    
+    ProjectIndexer* indexer = projectIndexer_.get();
+    std::string rootPath = projectPath.toStdString();
+    indexThread_ = std::thread([this, indexer, rootPath]() {
+        indexSucceeded_ = indexer->indexProject(rootPath);
+        indexFinished_ = true;
+    });
+    indexTimer_->start(100);
+}
+
+void MainWindow::stopProjectIndex() {
+    indexTimer_->stop();
+    if (indexThread_.joinable()) {
+        indexCancelled_ = true;
+        indexThread_.join();
+        progressBar_->setVisible(false);
+    }
+}
+
+void MainWindow::pollProjectIndex() {
+    size_t total = indexFilesTotal_;
+    if (total > 0) {
+        progressBar_->setRange(0, 100);
+        progressBar_->setValue(static_cast<int>(indexFilesDone_ * 100 / total));
+    }
+    if (!indexFinished_) {
+        return;
+    }
+    
+    indexTimer_->stop();
+    indexThread_.join();
+    progressBar_->setVisible(false);
+    
+    if (!indexSucceeded_) {
+        statusBar()->showMessage("Project indexing stopped: " +
+                                 QString::fromStdString(projectIndexer_->getErrorMessage()));
+        return;
+    }
+    statusBar()->showMessage(QString("Project indexed: %1 source files (%2 unchanged), %3 functions, "
+                                     "%4 of %5 calls resolved")
+                             .arg(projectIndexer_->getFiles().size())
+                             .arg(projectIndexer_->getReusedFileCount())
+                             .arg(projectIndexer_->getFunctionCount())
+                             .arg(projectIndexer_->getResolvedCallCount())
+                             .arg(projectIndexer_->getCallCount()));
+}
+
 void MainWindow::populateProjectTree(const QString& projectPath) {
     treeWidget_->clear();
     treeWidget_->setHeaderLabel("Project Structure");
@@ -1228,12 +1497,8 @@ void MainWindow::populateProjectTreeRecursive(const QDir& dir, QTreeWidgetItem*
     // Add directories first
     QFileInfoList dirs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
     for (const QFileInfo& dirInfo : dirs) {
-        // Skip common build/cache directories
-        if (dirInfo.fileName().startsWith('.') || 
-            dirInfo.fileName() == "build" || 
-            dirInfo.fileName() == "bin" ||
-            dirInfo.fileName() == "obj" ||
-            dirInfo.fileName() == "node_modules") {
+        // Skip common build/cache directories, as the project indexer does
+        if (ProjectIndexer::isSkippedDirectory(dirInfo.fileName().toStdString())) {
             continue;
         }
         
@@ -1280,18 +1545,16 @@ void MainWindow::exportToJson() {
     }
     
     QString fileName = QFileDialog::getSaveFileName(this,
-        "Export to JSON", "", "JSON Files (*.json);;All Files (*)");
+        "Export to JSON", "", "JSON Files (*.json);;Compressed JSON (*.json.gz *.json.xz *.json.zst);;All Files (*)");
     
     if (!fileName.isEmpty()) {
         try {
-            std::string jsonContent = serializer_.serializeToJson(rootNode_);
-            std::ofstream file(fileName.toStdString());
-            if (file.is_open()) {
-                file << jsonContent;
-                file.close();
+            std::string jsonContent = serializer_.serializeIncremental(rootNode_, XmlSerializer::Format::JSON);
+            QString error;
+            if (writeExportFile(fileName, jsonContent, error)) {
                 statusBar()->showMessage("Exported to JSON: " + fileName);
             } else {
-                QMessageBox::critical(this, "Error", "Failed to save JSON file.");
+                QMessageBox::critical(this, "Error", "Failed to save JSON file.\n" + error);
             }
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Error", 
@@ -1307,18 +1570,16 @@ void MainWindow::exportToYaml() {
     }
     
     QString fileName = QFileDialog::getSaveFileName(this,
-        "Export to YAML", "", "YAML Files (*.yaml *.yml);;All Files (*)");
+        "Export to YAML", "", "YAML Files (*.yaml *.yml);;Compressed YAML (*.yaml.gz *.yaml.xz *.yaml.zst);;All Files (*)");
     
     if (!fileName.isEmpty()) {
         try {
-            std::string yamlContent = serializer_.serializeToYaml(rootNode_);
-            std::ofstream file(fileName.toStdString());
-            if (file.is_open()) {
-                file << yamlContent;
-                file.close();
+            std::string yamlContent = serializer_.serializeIncremental(rootNode_, XmlSerializer::Format::YAML);
+            QString error;
+            if (writeExportFile(fileName, yamlContent, error)) {
                 statusBar()->showMessage("Exported to YAML: " + fileName);
             } else {
-                QMessageBox::critical(this, "Error", "Failed to save YAML file.");
+                QMessageBox::critical(this, "Error", "Failed to save YAML file.\n" + error);
             }
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Error", 
@@ -1334,18 +1595,16 @@ void MainWindow::exportToCsv() {
     }
     
     QString fileName = QFileDialog::getSaveFileName(this,
-        "Export to CSV", "", "CSV Files (*.csv);;All Files (*)");
+        "Export to CSV", "", "CSV Files (*.csv);;Compressed CSV (*.csv.gz *.csv.xz *.csv.zst);;All Files (*)");
     
     if (!fileName.isEmpty()) {
         try {
             std::string csvContent = serializer_.serializeToCsv(rootNode_);
-            std::ofstream file(fileName.toStdString());
-            if (file.is_open()) {
-                file << csvContent;
-                file.close();
+            QString error;
+            if (writeExportFile(fileName, csvContent, error)) {
                 statusBar()->showMessage("Exported to CSV: " + fileName);
             } else {
-                QMessageBox::critical(this, "Error", "Failed to save CSV file.");
+                QMessageBox::critical(this, "Error", "Failed to save CSV file.\n" + error);
             }
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Error", 
@@ -1354,6 +1613,1016 @@ void MainWindow::exportToCsv() {
     }
 }
 
+void MainWindow::exportToCbor() {
+    exportBinary(XmlSerializer::Format::CBOR, "Export to CBOR", "CBOR Files (*.cbor);;All Files (*)");
+}
+
+void MainWindow::exportToMessagePack() {
+    exportBinary(XmlSerializer::Format::MessagePack, "Export to MessagePack",
+                 "MessagePack Files (*.msgpack *.mpk);;All Files (*)");
+}
+
+void MainWindow::exportBinary(XmlSerializer::Format format, const QString& title, const QString& filter) {
+    if (!rootNode_) {
+        QMessageBox::warning(this, "Warning", "No XML data to export.");
+        return;
+    }
+    
+    QString fileName = QFileDialog::getSaveFileName(this, title, "", filter);
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    std::string content = serializer_.serialize(rootNode_, format);
+    QString error;
+    if (writeExportFile(fileName, content, error)) {
+        statusBar()->showMessage(QString("Exported %1 bytes to %2").arg(content.size()).arg(fileName));
+    } else {
+        QMessageBox::critical(this, "Error", "Failed to save file: " + fileName + "\n" + error);
+    }
+}
+
+void MainWindow::exportToSqlite() {
+    if (offerToCancelJob("Export to SQLite")) {
+        return;
+    }
+    
+    // An unmodified XML file is shredded straight from disk, so the export
+    // never depends on the tree; otherwise the current tree is streamed
+    const bool fromFile = !currentFilePath_.empty() && !isEditing_ &&
+        QFileInfo(QString::fromStdString(stripCompressionExtension(currentFilePath_))).suffix().toLower() == "xml";
+    if (!fromFile && !rootNode_) {
+        QMessageBox::warning(this, "Warning", "No XML data to export.");
+        return;
+    }
+    
+    QString fileName = QFileDialog::getSaveFileName(this,
+        "Export to SQLite", "", "SQLite Databases (*.db *.sqlite *.sqlite3);;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    std::string xmlContent;
+    if (!fromFile) {
+        xmlContent = serializer_.serialize(rootNode_, XmlSerializer::Format::XML);
+    }
+    const uint64_t totalBytes = fromFile ? static_cast<uint64_t>(QFileInfo(QString::fromStdString(currentFilePath_)).size())
+                                         : xmlContent.size();
+    
+    auto exporter = std::make_shared<SqliteExporter>();
+    exporter->setProgressCallback([this](uint64_t bytesRead) {
+        jobBytesDone_ = bytesRead;
+        return !jobCancelled_;
+    });
+    
+    std::string inputPath = fromFile ? currentFilePath_ : std::string();
+    std::string outputPath = fileName.toStdString();
+    auto content = std::make_shared<std::string>(std::move(xmlContent));
+    startJob("export", "Exporting to " + QFileInfo(fileName).fileName() + "... (Export to SQLite again to cancel)",
+             totalBytes,
+             [exporter, inputPath, outputPath, content]() {
+                 if (!inputPath.empty()) {
+                     return exporter->exportFile(inputPath, outputPath);
+                 }
+                 std::istringstream input(*content);
+                 return exporter->exportStream(input, outputPath);
+             },
+             [this, exporter, fileName](bool ok) {
+                 if (ok) {
+                     statusBar()->showMessage(QString("Exported %1 rows into %2 tables: %3")
+                                              .arg(exporter->getRecordCount()).arg(exporter->getTableCount())
+                                              .arg(fileName));
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Export cancelled; " + fileName + " is incomplete");
+                 } else {
+                     QMessageBox::critical(this, "Error",
+                         QString("Failed to export to SQLite: %1")
+                             .arg(QString::fromStdString(exporter->getErrorMessage())));
+                 }
+             });
+}
+
+bool MainWindow::readFileContent(const QString& fileName, std::string& content, QString& error) {
+    CompressedInputStream file(fileName.toStdString());
+    if (!file.isOpen()) {
+        error = QString::fromStdString(file.getErrorMessage());
+        return false;
+    }
+    
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (file.hasError()) {
+        error = QString::fromStdString(file.getErrorMessage());
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::writeExportFile(const QString& fileName, const std::string& content, QString& error) {
+    // "out.json.gz" is gzip-compressed JSON; plain names are written as-is
+    CompressionType compression = compressionFromExtension(fileName.toStdString());
+    if (!isCompressionSupported(compression)) {
+        error = "Zstandard support is not available in this build";
+        return false;
+    }
+    
+    CompressedOutputStream file(fileName.toStdString(), compression);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!file.close()) {
+        error = QString::fromStdString(file.getErrorMessage());
+        QFile::remove(fileName);
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::convertLargeXml() {
+    if (offerToCancelJob("Convert Large XML")) {
+        return;
+    }
+    
+    QString inputName = QFileDialog::getOpenFileName(this,
+        "Convert Large XML", "", "XML Files (*.xml *.xml.gz *.xml.xz *.xml.zst);;All Files (*)");
+    if (inputName.isEmpty()) {
+        return;
+    }
+    
+    QString selectedFilter;
+    QString outputName = QFileDialog::getSaveFileName(this,
+        "Convert To", QFileInfo(inputName).completeBaseName() + ".json",
+        "JSON Files (*.json);;YAML Files (*.yaml *.yml);;CSV Files (*.csv);;"
+        "CBOR Files (*.cbor);;MessagePack Files (*.msgpack *.mpk);;SQLite Databases (*.db *.sqlite *.sqlite3)",
+        &selectedFilter);
+    if (outputName.isEmpty()) {
+        return;
+    }
+    
+    // The extension decides the format, falling back to the chosen filter
+    XmlSerializer::Format format = XmlSerializer::Format::JSON;
+    QString suffix = QFileInfo(QString::fromStdString(stripCompressionExtension(outputName.toStdString())))
+                         .suffix().toLower();
+    if (suffix == "yaml" || suffix == "yml") {
+        format = XmlSerializer::Format::YAML;
+    } else if (suffix == "csv") {
+        format = XmlSerializer::Format::CSV;
+    } else if (suffix == "cbor") {
+        format = XmlSerializer::Format::CBOR;
+    } else if (suffix == "msgpack" || suffix == "mpk") {
+        format = XmlSerializer::Format::MessagePack;
+    } else if (suffix != "json") {
+        if (selectedFilter.startsWith("YAML")) format = XmlSerializer::Format::YAML;
+        else if (selectedFilter.startsWith("CSV")) format = XmlSerializer::Format::CSV;
+        else if (selectedFilter.startsWith("CBOR")) format = XmlSerializer::Format::CBOR;
+        else if (selectedFilter.startsWith("MessagePack")) format = XmlSerializer::Format::MessagePack;
+    }
+    // SQLite is not a serializer format; it goes through SqliteExporter
+    const bool toSqlite = suffix == "db" || suffix == "sqlite" || suffix == "sqlite3" ||
+                          (suffix != "json" && selectedFilter.startsWith("SQLite"));
+    
+    // Called on the job thread: only the atomics are touched there
+    auto progress = [this](uint64_t bytesRead) {
+        jobBytesDone_ = bytesRead;
+        return !jobCancelled_;
+    };
+    
+    // Written by the thread, read by the finish function after the join
+    auto result = std::make_shared<std::string>();
+    std::string inputPath = inputName.toStdString();
+    std::string outputPath = outputName.toStdString();
+    startJob("conversion", "Converting " + QFileInfo(inputName).fileName() + "... (Convert Large XML again to cancel)",
+             static_cast<uint64_t>(QFileInfo(inputName).size()),
+             [progress, result, inputPath, outputPath, format, toSqlite]() {
+                 bool ok;
+                 if (toSqlite) {
+                     SqliteExporter exporter;
+                     exporter.setProgressCallback(progress);
+                     ok = exporter.exportFile(inputPath, outputPath);
+                     *result = ok
+                         ? QString("Exported %1 rows into %2 tables").arg(exporter.getRecordCount())
+                               .arg(exporter.getTableCount()).toStdString()
+                         : "Failed to export to SQLite: " + exporter.getErrorMessage();
+                 } else {
+                     XmlStreamConverter converter;
+                     converter.setProgressCallback(progress);
+                     ok = converter.convertFile(inputPath, outputPath, format);
+                     *result = ok
+                         ? QString("Converted %1 elements").arg(converter.getElementCount()).toStdString()
+                         : "Failed to convert XML: " + converter.getErrorMessage();
+                 }
+                 return ok;
+             },
+             [this, result, outputName](bool ok) {
+                 if (!ok && jobCancelled_) {
+                     statusBar()->showMessage("Conversion cancelled; " + outputName + " is incomplete");
+                 } else if (ok) {
+                     statusBar()->showMessage(QString::fromStdString(*result) + ": " + outputName);
+                 } else {
+                     QMessageBox::critical(this, "Error", QString::fromStdString(*result));
+                 }
+             });
+}
+
+void MainWindow::startJob(const QString& name, const QString& message, uint64_t bytesTotal,
+                          std::function<bool()> work, std::function<void(bool succeeded)> finish) {
+    jobBytesTotal_ = bytesTotal;
+    jobBytesDone_ = 0;
+    jobCancelled_ = false;
+    jobFinished_ = false;
+    jobSucceeded_ = false;
+    jobName_ = name;
+    jobFinish_ = std::move(finish);
+    progressBar_->setVisible(true);
+    progressBar_->setRange(0, bytesTotal > 0 ? 100 : 0); // Indeterminate until a total is known
+    progressBar_->setValue(0);
+    statusBar()->showMessage(message);
+    
+    jobThread_ = std::thread([this, work]() {
+        jobSucceeded_ = work();
+        jobFinished_ = true;
+    });
+    jobTimer_->start(100);
+}
+
+bool MainWindow::offerToCancelJob(const QString& title) {
+    // One job at a time; triggering an action again offers to cancel it
+    if (!jobThread_.joinable()) {
+        return false;
+    }
+    if (QMessageBox::question(this, title, "Cancel the running " + jobName_ + "?") == QMessageBox::Yes) {
+        jobCancelled_ = true;
+    }
+    return true;
+}
+
+void MainWindow::stopJob() {
+    jobTimer_->stop();
+    if (jobThread_.joinable()) {
+        jobCancelled_ = true;
+        jobThread_.join();
+        progressBar_->setVisible(false);
+    }
+    jobFinish_ = nullptr;
+}
+
+void MainWindow::pollJob() {
+    uint64_t total = jobBytesTotal_;
+    if (total > 0) {
+        progressBar_->setRange(0, 100);
+        progressBar_->setValue(static_cast<int>(std::min<uint64_t>(jobBytesDone_, total) * 100 / total));
+    }
+    if (!jobFinished_) {
+        return;
+    }
+    
+    jobTimer_->stop();
+    jobThread_.join();
+    progressBar_->setVisible(false);
+    
+    // The finish function may start the next job
+    std::function<void(bool)> finish = std::move(jobFinish_);
+    jobFinish_ = nullptr;
+    finish(jobSucceeded_);
+}
+
+void MainWindow::splitXml() {
+    if (offerToCancelJob("Split XML")) {
+        return;
+    }
+    
+    QString inputName = QFileDialog::getOpenFileName(this,
+        "Split XML", "", "XML Files (*.xml);;All Files (*)");
+    if (inputName.isEmpty()) {
+        return;
+    }
+    
+    QStringList modes = {"By record count", "By file size (MB)"};
+    bool ok = false;
+    QString mode = QInputDialog::getItem(this, "Split XML", "Split:", modes, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    const bool bySize = (mode == modes[1]);
+    int amount = bySize
+        ? QInputDialog::getInt(this, "Split XML", "Maximum file size (MB):", 100, 1, 1024 * 1024, 1, &ok)
+        : QInputDialog::getInt(this, "Split XML", "Records per file:", 100000, 1, 2147483647, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    QString outputDirectory = QFileDialog::getExistingDirectory(this,
+        "Split Into Folder", QFileInfo(inputName).absolutePath());
+    if (outputDirectory.isEmpty()) {
+        return;
+    }
+    
+    // Called on the job thread: only the atomics are touched there
+    auto splitter = std::make_shared<XmlSplitter>();
+    splitter->setProgressCallback([this](uint64_t bytesDone, uint64_t bytesTotal) {
+        jobBytesDone_ = bytesDone;
+        jobBytesTotal_ = bytesTotal;
+        return !jobCancelled_;
+    });
+    
+    std::string inputPath = inputName.toStdString();
+    std::string outputPath = outputDirectory.toStdString();
+    const uint64_t limit = bySize ? static_cast<uint64_t>(amount) * 1024 * 1024 : static_cast<uint64_t>(amount);
+    startJob("split", "Splitting " + QFileInfo(inputName).fileName() + "... (Split XML again to cancel)", 0,
+             [splitter, inputPath, outputPath, limit, bySize]() {
+                 return bySize ? splitter->splitBySize(inputPath, outputPath, limit)
+                               : splitter->splitByRecordCount(inputPath, outputPath, limit);
+             },
+             [this, splitter, outputDirectory](bool ok) {
+                 if (ok) {
+                     statusBar()->showMessage(QString("Split %1 records into %2 files in %3")
+                                              .arg(splitter->getRecordCount())
+                                              .arg(splitter->getOutputFiles().size())
+                                              .arg(outputDirectory));
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Split cancelled; " + outputDirectory + " holds the files written so far");
+                 } else {
+                     QMessageBox::critical(this, "Error",
+                         QString("Failed to split XML: %1").arg(QString::fromStdString(splitter->getErrorMessage())));
+                 }
+             });
+}
+
+void MainWindow::mergeXml() {
+    if (offerToCancelJob("Merge XML")) {
+        return;
+    }
+    
+    QStringList inputNames = QFileDialog::getOpenFileNames(this,
+        "Merge XML", "", "XML Files (*.xml);;All Files (*)");
+    if (inputNames.isEmpty()) {
+        return;
+    }
+    // Shards named part-0001, part-0002, ... come back in order
+    inputNames.sort();
+    
+    QString outputName = QFileDialog::getSaveFileName(this,
+        "Merge Into", QFileInfo(inputNames.first()).absolutePath(), "XML Files (*.xml)");
+    if (outputName.isEmpty()) {
+        return;
+    }
+    
+    auto splitter = std::make_shared<XmlSplitter>();
+    splitter->setProgressCallback([this](uint64_t bytesDone, uint64_t bytesTotal) {
+        jobBytesDone_ = bytesDone;
+        jobBytesTotal_ = bytesTotal;
+        return !jobCancelled_;
+    });
+    
+    std::vector<std::string> inputPaths;
+    for (const QString& name : inputNames) {
+        inputPaths.push_back(name.toStdString());
+    }
+    std::string outputPath = outputName.toStdString();
+    startJob("merge", QString("Merging %1 files... (Merge XML again to cancel)").arg(inputNames.size()), 0,
+             [splitter, inputPaths, outputPath]() {
+                 return splitter->merge(inputPaths, outputPath);
+             },
+             [this, splitter, outputName](bool ok) {
+                 if (ok) {
+                     statusBar()->showMessage(QString("Merged %1 records into %2")
+                                              .arg(splitter->getRecordCount()).arg(outputName));
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Merge cancelled; " + outputName + " is incomplete");
+                 } else {
+                     QMessageBox::critical(this, "Error",
+                         QString("Failed to merge XML: %1").arg(QString::fromStdString(splitter->getErrorMessage())));
+                 }
+             });
+}
+
+void MainWindow::compareXmlFiles() {
+    if (offerToCancelJob("Compare XML Files")) {
+        return;
+    }
+    
+    const QString filter = "XML Files (*.xml *.xml.gz *.xml.xz *.xml.zst);;All Files (*)";
+    QString oldName = QFileDialog::getOpenFileName(this, "Compare XML: Old File",
+        QString::fromStdString(currentFilePath_), filter);
+    if (oldName.isEmpty()) {
+        return;
+    }
+    QString newName = QFileDialog::getOpenFileName(this, "Compare XML: New File", QFileInfo(oldName).path(), filter);
+    if (newName.isEmpty()) {
+        return;
+    }
+    
+    // Written by the job thread, read by the finish function after the join.
+    // The parser reports no progress, so cancelling takes effect between steps.
+    struct Comparison {
+        std::shared_ptr<XmlNode> oldRoot;
+        std::shared_ptr<XmlNode> newRoot;
+        XmlDiff diff;
+        std::string error;
+    };
+    auto comparison = std::make_shared<Comparison>();
+    std::string oldPath = oldName.toStdString();
+    std::string newPath = newName.toStdString();
+    startJob("comparison", "Comparing " + QFileInfo(oldName).fileName() + " and " + QFileInfo(newName).fileName() +
+                 "... (Compare XML Files again to cancel)", 0,
+             [this, comparison, oldPath, newPath]() {
+                 XmlParser parser;
+                 comparison->oldRoot = parser.parseFile(oldPath);
+                 if (comparison->oldRoot && !jobCancelled_) {
+                     comparison->newRoot = parser.parseFile(newPath);
+                 }
+                 if (!comparison->newRoot) {
+                     comparison->error = "Failed to parse XML: " + parser.getErrorMessage();
+                     return false;
+                 }
+                 if (jobCancelled_) {
+                     return false;
+                 }
+                 if (!comparison->diff.diff(comparison->oldRoot, comparison->newRoot)) {
+                     comparison->error = comparison->diff.getErrorMessage();
+                     return false;
+                 }
+                 return true;
+             },
+             [this, comparison, oldName, newName](bool ok) {
+                 if (!ok) {
+                     if (jobCancelled_) {
+                         statusBar()->showMessage("Comparison cancelled");
+                     } else {
+                         statusBar()->clearMessage();
+                         QMessageBox::critical(this, "Error", QString::fromStdString(comparison->error));
+                     }
+                     return;
+                 }
+                 const XmlDiff& diff = comparison->diff;
+                 if (diff.isIdentical()) {
+                     statusBar()->showMessage("The files are structurally identical");
+                     QMessageBox::information(this, "Compare XML", "The files are structurally identical.");
+                     return;
+                 }
+                 
+                 XmlDiffView* view = new XmlDiffView(this);
+                 view->setAttribute(Qt::WA_DeleteOnClose);
+                 view->setDiff(diff, comparison->oldRoot, comparison->newRoot, oldName, newName);
+                 view->show();
+                 statusBar()->showMessage(QString("%1 differences found").arg(diff.getEdits().size()));
+             });
+}
+
+void MainWindow::runPipeline() {
+    if (offerToCancelJob("Run Pipeline")) {
+        return;
+    }
+    
+    // An unmodified XML file is streamed from disk, otherwise the current tree
+    // is the input; with neither, ask for a file
+    const bool fromFile = !currentFilePath_.empty() && !isEditing_ &&
+        QFileInfo(QString::fromStdString(stripCompressionExtension(currentFilePath_))).suffix().toLower() == "xml";
+    QString inputName;
+    std::string xmlContent;
+    if (fromFile) {
+        inputName = QString::fromStdString(currentFilePath_);
+    } else if (rootNode_ && !isCppMode_ && !isPythonMode_ && !isGoMode_ && !isMarkdownMode_) {
+        xmlContent = serializer_.serialize(rootNode_, XmlSerializer::Format::XML);
+    } else {
+        inputName = QFileDialog::getOpenFileName(this,
+            "Run Pipeline", "", "XML Files (*.xml *.xml.gz *.xml.xz *.xml.zst);;All Files (*)");
+        if (inputName.isEmpty()) {
+            return;
+        }
+    }
+    
+    bool ok = false;
+    QString spec = QInputDialog::getText(this, "Run Pipeline",
+        "Stages, separated by |:\n"
+        "records <name>, where <field> [=|!=|<|<=|>|>=|~ <value>], select <field>, ...,\n"
+        "rename <old>=<new>, map <field> upper|lower|trim, limit <n>",
+        QLineEdit::Normal, pipelineSpec_, &ok).trimmed();
+    if (!ok || spec.isEmpty()) {
+        return;
+    }
+    pipelineSpec_ = spec;
+    
+    auto pipeline = std::make_shared<XmlPipeline>();
+    if (!pipeline->parse(spec.toStdString())) {
+        QMessageBox::warning(this, "Run Pipeline",
+            QString("Invalid pipeline: %1").arg(QString::fromStdString(pipeline->getErrorMessage())));
+        return;
+    }
+    // Called on the job thread: only the atomics are touched there
+    pipeline->setProgressCallback([this](uint64_t bytesRead) {
+        jobBytesDone_ = bytesRead;
+        return !jobCancelled_;
+    });
+    
+    // Preview the first results; only as much of the input is read as they
+    // need, which is all of it when few records match
+    const uint64_t totalBytes = !inputName.isEmpty() ? static_cast<uint64_t>(QFileInfo(inputName).size())
+                                                     : xmlContent.size();
+    auto content = std::make_shared<std::string>(std::move(xmlContent));
+    auto records = std::make_shared<std::vector<XmlPipeline::Record>>();
+    auto error = std::make_shared<std::string>();
+    std::string inputPath = inputName.toStdString();
+    startJob("pipeline", "Previewing pipeline... (Run Pipeline again to cancel)", totalBytes,
+             [pipeline, records, error, inputPath, content]() {
+                 if (!inputPath.empty()) {
+                     CompressedInputStream input(inputPath);
+                     if (!input.isOpen()) {
+                         *error = input.getErrorMessage();
+                         return false;
+                     }
+                     *records = pipeline->preview(input, kPipelinePreviewRecords);
+                 } else {
+                     std::istringstream input(*content);
+                     *records = pipeline->preview(input, kPipelinePreviewRecords);
+                 }
+                 if (pipeline->hasError()) {
+                     *error = "Pipeline failed: " + pipeline->getErrorMessage();
+                     return false;
+                 }
+                 return true;
+             },
+             [this, pipeline, records, error, inputName, content](bool ok) {
+                 if (ok) {
+                     statusBar()->clearMessage();
+                     showPipelinePreview(pipeline, *records, inputName, content);
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Pipeline cancelled");
+                 } else {
+                     QMessageBox::critical(this, "Error", QString::fromStdString(*error));
+                 }
+             });
+}
+
+void MainWindow::showPipelinePreview(const std::shared_ptr<XmlPipeline>& pipeline,
+                                     const std::vector<XmlPipeline::Record>& records,
+                                     const QString& inputName, const std::shared_ptr<std::string>& content) {
+    QStringList columns;
+    for (const auto& record : records) {
+        for (const auto& field : record.fields) {
+            QString name = QString::fromStdString(field.first);
+            if (!columns.contains(name)) columns << name;
+        }
+    }
+    
+    QDialog dialog(this);
+    dialog.setWindowTitle("Pipeline Preview");
+    dialog.resize(800, 500);
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    QLabel* summary = new QLabel(records.empty()
+        ? QString("No records match the pipeline.")
+        : QString("First %1 records of the result:").arg(records.size()), &dialog);
+    layout->addWidget(summary);
+    QTableWidget* table = new QTableWidget(static_cast<int>(records.size()), columns.size(), &dialog);
+    table->setHorizontalHeaderLabels(columns);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    for (int row = 0; row < static_cast<int>(records.size()); ++row) {
+        for (const auto& field : records[row].fields) {
+            table->setItem(row, columns.indexOf(QString::fromStdString(field.first)),
+                           new QTableWidgetItem(QString::fromStdString(field.second)));
+        }
+    }
+    table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(table);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Close, &dialog);
+    buttons->button(QDialogButtonBox::Save)->setText("Run to File...");
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    
+    QString selectedFilter;
+    QString outputName = QFileDialog::getSaveFileName(this, "Write Pipeline Result", "",
+        "JSON Files (*.json);;CSV Files (*.csv)", &selectedFilter);
+    if (outputName.isEmpty()) {
+        return;
+    }
+    QString suffix = QFileInfo(QString::fromStdString(stripCompressionExtension(outputName.toStdString())))
+                         .suffix().toLower();
+    XmlSerializer::Format format = XmlSerializer::Format::JSON;
+    if (suffix == "csv" || (suffix != "json" && selectedFilter.startsWith("CSV"))) {
+        format = XmlSerializer::Format::CSV;
+    }
+    
+    const uint64_t totalBytes = !inputName.isEmpty() ? static_cast<uint64_t>(QFileInfo(inputName).size())
+                                                     : content->size();
+    // writeExportFile touches no window state, so the thread may call it
+    auto error = std::make_shared<QString>();
+    std::string inputPath = inputName.toStdString();
+    startJob("pipeline", "Running pipeline... (Run Pipeline again to cancel)", totalBytes,
+             [this, pipeline, error, inputPath, content, outputName, format]() {
+                 if (!inputPath.empty()) {
+                     return pipeline->runFile(inputPath, outputName.toStdString(), format);
+                 }
+                 std::istringstream input(*content);
+                 std::ostringstream output;
+                 return pipeline->run(input, output, format) && writeExportFile(outputName, output.str(), *error);
+             },
+             [this, pipeline, error, outputName](bool ok) {
+                 if (ok) {
+                     statusBar()->showMessage(QString("Wrote %1 of %2 records to %3")
+                                              .arg(pipeline->getRecordsWritten()).arg(pipeline->getRecordsRead())
+                                              .arg(outputName));
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Pipeline cancelled; " + outputName + " is incomplete");
+                 } else {
+                     QString message = !error->isEmpty() ? *error : QString::fromStdString(pipeline->getErrorMessage());
+                     QMessageBox::critical(this, "Error", QString("Pipeline failed: %1").arg(message));
+                 }
+             });
+}
+
+void MainWindow::toggleTailMode(bool enabled) {
+    if (!enabled) {
+        QString fileName = QString::fromStdString(tailReader_.path());
+        stopTail();
+        statusBar()->showMessage("Stopped following " + fileName);
+        return;
+    }
+    
+    QString fileName = QFileDialog::getOpenFileName(this,
+        "Tail XML File", "", "XML Files (*.xml *.log);;All Files (*)");
+    if (fileName.isEmpty()) {
+        QSignalBlocker blocker(tailAction_);
+        tailAction_->setChecked(false);
+        return;
+    }
+    startTail(fileName);
+}
+
+void MainWindow::startTail(const QString& fileName) {
+    stopTail();
+    if (!tailReader_.open(fileName.toStdString())) {
+        QMessageBox::critical(this, "Error", QString::fromStdString(tailReader_.getErrorMessage()));
+        QSignalBlocker blocker(tailAction_);
+        tailAction_->setChecked(false);
+        return;
+    }
+    
+    clearDisplay();
+    showAnalysisPanel();
+    currentFilePath_ = fileName.toStdString();
+    fileLabel_->setText(QFileInfo(fileName).fileName() + " (tail)");
+    isMarkdownMode_ = false;
+    isCppMode_ = false;
+    isPythonMode_ = false;
+    isGoMode_ = false;
+    applyHighlighterForCurrentFile();
+    
+    // The editor mirrors the file while it is followed
+    isEditing_ = false;
+    editAction_->setEnabled(false);
+    saveAction_->setEnabled(false);
+    xmlEditor_->setReadOnly(true);
+    resetDocumentAnalysis();
+    xmlEditor_->clear();
+    
+    {
+        QSignalBlocker blocker(tailAction_);
+        tailAction_->setChecked(true);
+    }
+    tailWatcher_->addPath(fileName);
+    tailTimer_->start(kTailPollIntervalMs);
+    pollTail();
+}
+
+void MainWindow::stopTail() {
+    if (!tailReader_.isOpen()) {
+        return;
+    }
+    tailTimer_->stop();
+    if (!tailWatcher_->files().isEmpty()) {
+        tailWatcher_->removePaths(tailWatcher_->files());
+    }
+    tailReader_.close();
+    
+    originalXmlContent_ = xmlEditor_->toPlainText();
+    editAction_->setEnabled(true);
+    QSignalBlocker blocker(tailAction_);
+    tailAction_->setChecked(false);
+}
+
+void MainWindow::pollTail() {
+    if (!tailReader_.isOpen()) {
+        return;
+    }
+    
+    XmlTailReader::Update update;
+    if (!tailReader_.poll(update)) {
+        QString error = QString::fromStdString(tailReader_.getErrorMessage());
+        stopTail();
+        QMessageBox::critical(this, "Error", "Stopped following the file: " + error);
+        return;
+    }
+    
+    // A replaced file drops the change notification; watch the new one
+    QString fileName = QString::fromStdString(tailReader_.path());
+    if (!tailWatcher_->files().contains(fileName)) {
+        tailWatcher_->addPath(fileName);
+    }
+    
+    if (update.restarted) {
+        treeWidget_->clear();
+        xmlEditor_->clear();
+    }
+    
+    if (!update.appendedText.empty()) {
+        // Keep following the end unless the user scrolled away from it
+        QScrollBar* scrollBar = xmlEditor_->verticalScrollBar();
+        const bool atBottom = scrollBar->value() == scrollBar->maximum();
+        QTextCursor cursor(xmlEditor_->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(QString::fromUtf8(update.appendedText.data(),
+                                            static_cast<int>(update.appendedText.size())));
+        if (atBottom) {
+            scrollBar->setValue(scrollBar->maximum());
+        }
+    }
+    
+    if (tailReader_.rootNode()) {
+        rootNode_ = tailReader_.rootNode();
+        if (treeWidget_->topLevelItemCount() == 0) {
+            // First records (or a restart): the root already holds them
+            populateTreeWidget(rootNode_);
+        } else {
+            QTreeWidgetItem* rootItem = treeWidget_->topLevelItem(0);
+            for (const auto& record : update.records) {
+                populateTreeWidget(record, rootItem);
+            }
+        }
+    }
+    
+    if (!update.records.empty() || update.restarted) {
+        statusBar()->showMessage(QString("Following %1: %2 records%3")
+                                 .arg(QFileInfo(fileName).fileName())
+                                 .arg(tailReader_.getRecordCount())
+                                 .arg(tailReader_.isFinished() ? " (closed)" : ""));
+    }
+    if (update.hasMore) {
+        // Catch up in steps so the window stays responsive
+        QTimer::singleShot(0, this, &MainWindow::pollTail);
+    }
+}
+
+void MainWindow::ensureRecordIndex(std::function<void()> ready) {
+    // An index is reused while the file is unchanged
+    QFileInfo sourceInfo(QString::fromStdString(currentFilePath_));
+    if (recordIndex_ && recordIndexSource_ == currentFilePath_ &&
+        recordIndexTime_ == sourceInfo.lastModified()) {
+        ready();
+        return;
+    }
+    recordIndex_.reset();
+    
+    auto index = std::make_shared<XmlRecordIndex>();
+    const std::string indexPath = XmlRecordIndex::defaultIndexPath(currentFilePath_);
+    if (index->load(currentFilePath_, indexPath)) {
+        recordIndex_ = index;
+        recordIndexSource_ = currentFilePath_;
+        recordIndexTime_ = sourceInfo.lastModified();
+        ready();
+        return;
+    }
+    
+    if (offerToCancelJob("Index Records")) {
+        return;
+    }
+    bool ok = false;
+    QString key = QInputDialog::getText(this, "Index Records",
+        "Also index records by this attribute (leave empty for none):", QLineEdit::Normal, "id", &ok);
+    if (!ok) {
+        return;
+    }
+    XmlRecordIndex::Options options;
+    options.keyAttribute = key.trimmed().toStdString();
+    
+    // Called on the job thread: only the atomics are touched there
+    index->setProgressCallback([this](uint64_t bytesDone, uint64_t bytesTotal) {
+        jobBytesDone_ = bytesDone;
+        jobBytesTotal_ = bytesTotal;
+        return !jobCancelled_;
+    });
+    
+    std::string sourcePath = currentFilePath_;
+    QDateTime sourceTime = sourceInfo.lastModified();
+    startJob("indexing", "Indexing " + sourceInfo.fileName() + "... (Go to Record again to cancel)", 0,
+             [index, sourcePath, indexPath, options]() {
+                 return index->build(sourcePath, indexPath, options);
+             },
+             [this, index, sourcePath, sourceTime, ready](bool ok) {
+                 if (!ok) {
+                     if (jobCancelled_) {
+                         statusBar()->showMessage("Indexing cancelled");
+                     } else {
+                         QMessageBox::critical(this, "Error",
+                             QString("Failed to index records: %1")
+                                 .arg(QString::fromStdString(index->getErrorMessage())));
+                     }
+                     return;
+                 }
+                 recordIndex_ = index;
+                 recordIndexSource_ = sourcePath;
+                 recordIndexTime_ = sourceTime;
+                 // Another file may have been opened meanwhile; the index file
+                 // stays on disk for the next Go to Record on this one
+                 if (currentFilePath_ == sourcePath) {
+                     ready();
+                 } else {
+                     statusBar()->showMessage("Indexed " + QString::fromStdString(sourcePath));
+                 }
+             });
+}
+
+void MainWindow::goToRecord() {
+    if (currentFilePath_.empty()) {
+        QMessageBox::warning(this, "Warning", "Please select a file first.");
+        return;
+    }
+    ensureRecordIndex([this]() { goToIndexedRecord(); });
+}
+
+void MainWindow::goToIndexedRecord() {
+    const QString keyAttribute = QString::fromStdString(recordIndex_->getKeyAttribute());
+    QString prompt = QString("Record number (1-%1)").arg(recordIndex_->getRecordCount());
+    if (!keyAttribute.isEmpty()) {
+        prompt += QString(" or %1 value").arg(keyAttribute);
+    }
+    bool ok = false;
+    QString query = QInputDialog::getText(this, "Go to Record", prompt + ":", QLineEdit::Normal, "", &ok).trimmed();
+    if (!ok || query.isEmpty()) {
+        return;
+    }
+    
+    // Numbers are ordinals unless the index has a key that matches
+    bool isNumber = false;
+    qulonglong number = query.toULongLong(&isNumber);
+    std::vector<uint64_t> matches;
+    if (!keyAttribute.isEmpty()) {
+        matches = recordIndex_->findByKey(query.toStdString());
+    }
+    uint64_t ordinal;
+    if (!matches.empty()) {
+        ordinal = matches.front();
+    } else if (isNumber && number > 0) {
+        ordinal = number - 1;
+    } else {
+        QMessageBox::information(this, "Go to Record", "No record matches " + query);
+        return;
+    }
+    
+    auto record = recordIndex_->readRecord(ordinal);
+    if (!record) {
+        QMessageBox::critical(this, "Error", QString::fromStdString(recordIndex_->getErrorMessage()));
+        return;
+    }
+    
+    clearDisplay();
+    showAnalysisPanel();
+    rootNode_ = record;
+    populateTreeWidget(rootNode_);
+    displayNodeDetails(rootNode_);
+    
+    QString message = QString("Record %1 of %2").arg(ordinal + 1).arg(recordIndex_->getRecordCount());
+    if (matches.size() > 1) {
+        message += QString(" (first of %1 matches)").arg(matches.size());
+    }
+    statusBar()->showMessage(message);
+}
+
+void MainWindow::runSchemaProfile(std::function<void()> done) {
+    if (isMarkdownMode_ || isCppMode_ || isPythonMode_ || isGoMode_) {
+        statusBar()->showMessage("Schema profiling is only available for XML");
+        return;
+    }
+    if (offerToCancelJob("Profile XML Schema")) {
+        return;
+    }
+    
+    // An unmodified XML file is profiled from disk, in parallel; otherwise
+    // the editor buffer is
+    const bool fromFile = !currentFilePath_.empty() && !isEditing_ &&
+        QFileInfo(QString::fromStdString(stripCompressionExtension(currentFilePath_))).suffix().toLower() == "xml";
+    std::string xmlContent;
+    if (!fromFile) {
+        xmlContent = xmlEditor_->toPlainText().toStdString();
+        if (xmlContent.empty()) {
+            QMessageBox::warning(this, "Warning", "No XML data to profile.");
+            return;
+        }
+    }
+    const uint64_t totalBytes = fromFile ? static_cast<uint64_t>(QFileInfo(QString::fromStdString(currentFilePath_)).size())
+                                         : xmlContent.size();
+    
+    // schemaProfiler_ is replaced only once the job is done, so the schema
+    // tree can read it meanwhile
+    auto profiler = std::make_shared<XmlSchemaProfiler>();
+    profiler->setProgressCallback([this](uint64_t bytesRead) {
+        jobBytesDone_ = bytesRead;
+        return !jobCancelled_;
+    });
+    
+    std::string inputPath = fromFile ? currentFilePath_ : std::string();
+    auto content = std::make_shared<std::string>(std::move(xmlContent));
+    startJob("profiling", "Profiling schema... (Profile XML Schema again to cancel)", totalBytes,
+             [profiler, inputPath, content]() {
+                 return !inputPath.empty() ? profiler->profileFile(inputPath) : profiler->profileString(*content);
+             },
+             [this, profiler, done](bool ok) {
+                 if (ok) {
+                     schemaProfiler_ = std::move(*profiler);
+                     done();
+                 } else if (jobCancelled_) {
+                     statusBar()->showMessage("Schema profiling cancelled");
+                 } else {
+                     QMessageBox::critical(this, "Error",
+                         QString("Failed to profile XML: %1")
+                             .arg(QString::fromStdString(profiler->getErrorMessage())));
+                 }
+             });
+}
+
+void MainWindow::profileSchema() {
+    runSchemaProfile([this]() { showSchemaProfile(); });
+}
+
+void MainWindow::showSchemaProfile() {
+    const XmlSchemaProfiler::Profile& profile = schemaProfiler_.getProfile();
+    schemaTree_->clear();
+    populateSchemaTree(profile.rootPath, nullptr);
+    schemaTree_->expandAll();
+    for (int column = 0; column < schemaTree_->columnCount(); ++column) {
+        schemaTree_->resizeColumnToContents(column);
+    }
+    
+    // The text report goes to the details tab
+    detailsTextEdit_->setPlainText(QString::fromStdString(schemaProfiler_.toReport()));
+    showAnalysisPanel();
+    rightTabs_->setCurrentWidget(schemaTree_);
+    statusBar()->showMessage(QString("Profiled %1 elements in %2 distinct paths")
+                             .arg(profile.elementCount).arg(profile.elements.size()));
+}
+
+void MainWindow::populateSchemaTree(const std::string& path, QTreeWidgetItem* parentItem) {
+    const XmlSchemaProfiler::Profile& profile = schemaProfiler_.getProfile();
+    auto it = profile.elements.find(path);
+    if (it == profile.elements.end()) {
+        return;
+    }
+    const XmlSchemaProfiler::ElementStats& stats = it->second;
+    
+    auto describeValues = [](const XmlSchemaProfiler::ValueStats& values) {
+        QStringList samples;
+        for (const auto& sample : values.samples) {
+            samples << QString::fromStdString(sample.first);
+        }
+        QString text = samples.join(", ");
+        if (values.truncatedSamples) {
+            text += ", ...";
+        }
+        return text;
+    };
+    
+    QTreeWidgetItem* item = parentItem ? new QTreeWidgetItem(parentItem) : new QTreeWidgetItem(schemaTree_);
+    item->setText(0, QString::fromStdString(stats.name));
+    item->setToolTip(0, QString::fromStdString(path));
+    item->setText(1, QString::number(stats.count));
+    item->setText(2, QString("%1..%2").arg(profile.minOccurs(path)).arg(profile.maxOccurs(path)));
+    if (stats.text.count > 0) {
+        item->setText(3, QString::fromStdString(stats.text.typeName()) + (stats.mixedCount > 0 ? " (mixed)" : ""));
+        item->setText(4, describeValues(stats.text));
+    }
+    
+    for (const auto& attribute : stats.attributes) {
+        QTreeWidgetItem* attributeItem = new QTreeWidgetItem(item);
+        attributeItem->setText(0, "@" + QString::fromStdString(attribute.first));
+        attributeItem->setText(1, QString::number(attribute.second.count));
+        attributeItem->setText(2, attribute.second.count == stats.count ? "required" : "optional");
+        attributeItem->setText(3, QString::fromStdString(attribute.second.typeName()));
+        attributeItem->setText(4, describeValues(attribute.second));
+    }
+    for (const std::string& child : stats.children) {
+        populateSchemaTree(path + "/" + child, item);
+    }
+}
+
+void MainWindow::exportToXsd() {
+    runSchemaProfile([this]() { saveXsdDraft(); });
+}
+
+void MainWindow::saveXsdDraft() {
+    QString fileName = QFileDialog::getSaveFileName(this,
+        "Export XSD Draft", "", "XML Schema Files (*.xsd);;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (writeExportFile(fileName, schemaProfiler_.toXsd(), error)) {
+        statusBar()->showMessage("Exported XSD draft to: " + fileName);
+    } else {
+        QMessageBox::critical(this, "Error", "Failed to export XSD: " + error);
+    }
+}
+
 void MainWindow::importFromJson() {
     QString fileName = QFileDialog::getOpenFileName(this,
         "Import from JSON", "", "JSON Files (*.json);;All Files (*)");
@@ -1570,6 +2839,41 @@ void MainWindow::unfoldAllXml() {
     }
 }
 
+void MainWindow::formatDocument() {
+    reformatEditor(XmlFormatter::Mode::Pretty);
+}
+
+void MainWindow::minifyDocument() {
+    reformatEditor(XmlFormatter::Mode::Minify);
+}
+
+void MainWindow::reformatEditor(XmlFormatter::Mode mode) {
+    if (isMarkdownMode_ || isCppMode_ || isPythonMode_ || isGoMode_) {
+        statusBar()->showMessage("Format Document is only available for XML");
+        return;
+    }
+    
+    // Token-level reformatting: no XmlNode tree is built for the buffer
+    XmlFormatter::Options options;
+    options.mode = mode;
+    XmlFormatter formatter(options);
+    std::string formatted;
+    if (!formatter.formatString(xmlEditor_->toPlainText().toStdString(), formatted)) {
+        QMessageBox::warning(this, "Warning",
+            QString("Cannot format invalid XML: %1").arg(QString::fromStdString(formatter.getErrorMessage())));
+        return;
+    }
+    
+    // The result is an edit like any other: it can be saved, cancelled or undone
+    if (!isEditing_) {
+        toggleEditMode();
+    }
+    QTextCursor cursor(xmlEditor_->document());
+    cursor.select(QTextCursor::Document);
+    cursor.insertText(QString::fromStdString(formatted));
+    statusBar()->showMessage(mode == XmlFormatter::Mode::Pretty ? "Document formatted" : "Document minified");
+}
+
 void MainWindow::toggleEditMode() {
     if (!isEditing_) {
         // Enter edit mode
@@ -1617,8 +2921,10 @@ void MainWindow::saveXmlContent() {
     }
     
     // Validate XML before saving
+    std::shared_ptr<XmlNode> savedRoot;
     try {
         auto testNode = parser_.parseString(newContent.toStdString());
+        savedRoot = testNode;
         if (!testNode) {
             QMessageBox::StandardButton reply = QMessageBox::question(this, "Warning", 
                 "The XML content appears to be invalid. Save anyway?",
@@ -1650,6 +2956,10 @@ void MainWindow::saveXmlContent() {
         editAction_->setText("Edit");
         saveAction_->setEnabled(false);
         
+        // Only the branches that were edited are rebuilt in the tree
+        if (savedRoot && !isCppMode_ && !isPythonMode_ && !isGoMode_) {
+            refreshTreeWidget(savedRoot);
+        }
         statusBar()->showMessage("XML content saved successfully");
     } else {
         QMessageBox::critical(this, "Error", "Failed to save XML content");
@@ -1670,38 +2980,17 @@ void MainWindow::parseCpp() {
     statusBar()->showMessage("Parsing C++ file...");
     QApplication::processEvents(); // Update UI
     
-    QString content = xmlEditor_->toPlainText();
-    std::string cppContent = content.toStdString();
-    
     // Check file size, show prompt for large files
-    if (cppContent.length() > 100000) { // 100KB
+    if (xmlEditor_->document()->characterCount() > 100000) { // 100KB
         progressBar_->setRange(0, 100);
         progressBar_->setValue(50);
         statusBar()->showMessage("Parsing large C++ file, please wait...");
         QApplication::processEvents();
     }
     
-    if (cppParser_.parseFile(cppContent)) {
-        progressBar_->setValue(100);
-        statusBar()->showMessage("C++ file parsed successfully");
-        
-        // Show parsing statistics in analysis panel
-        const auto& functions = cppParser_.getFunctions();
-        const auto& classes = cppParser_.getClasses();
-        QString info = QString("<h3>C++ Analysis Results</h3>"
-                              "<p><b>Functions found:</b> %1</p>"
-                              "<p><b>Classes found:</b> %2</p>"
-                              "<p>Click 'Generate Function Graph' to visualize the code structure.</p>")
-                      .arg(functions.size())
-                      .arg(classes.size());
-        detailsTextEdit_->setHtml(info);
-        rightTabs_->setCurrentIndex(0); // Show details tab
-        
-        // Enable function graph generation
-        parseButton_->setEnabled(true);
-    } else {
-        QMessageBox::critical(this, "Error", "C++ file parsing failed");
-    }
+    analyzeDocument(SourceLanguage::Cpp);
+    progressBar_->setValue(100);
+    statusBar()->showMessage("C++ file parsed successfully");
     
     // Hide progress bar
     progressBar_->setVisible(false);
@@ -1714,59 +3003,20 @@ void MainWindow::parsePython() {
     }
     
     showAnalysisPanel();
-    
-    QString content = xmlEditor_->toPlainText();
-    std::string pythonContent = content.toStdString();
-    
-    if (pythonParser_.parseFile(pythonContent)) {
-        statusBar()->showMessage("Python file parsed successfully");
-        
-        // Show parsing statistics in analysis panel
-        const auto& functions = pythonParser_.getFunctions();
-        const auto& classes = pythonParser_.getClasses();
-        QString info = QString("<h3>Python Analysis Results</h3>"
-                              "<p><b>Functions found:</b> %1</p>"
-                              "<p><b>Classes found:</b> %2</p>"
-                              "<p>Click 'Generate Function Graph' to visualize the code structure.</p>")
-                      .arg(functions.size())
-                      .arg(classes.size());
-        detailsTextEdit_->setHtml(info);
-        rightTabs_->setCurrentIndex(0); // Show details tab
-        
-        // Enable function graph generation
-        parseButton_->setEnabled(true);
-    } else {
-        QMessageBox::critical(this, "Error", "Python file parsing failed");
-    }
+    analyzeDocument(SourceLanguage::Python);
+    statusBar()->showMessage("Python file parsed successfully");
 }
 
 void MainWindow::generateFunctionGraph() {
-    bool hasFunctions = false;
-    
-    if (isCppMode_ && !cppParser_.getFunctions().empty()) {
-        // Set C++ parsing data to graph view
-        functionGraphView_->setParserData(cppParser_);
-        hasFunctions = true;
-    } else if (isPythonMode_ && !pythonParser_.getFunctions().empty()) {
-        // Need to create a conversion function to convert Python data to C++ data format
-        // Or modify FunctionGraphView to support multiple parser types
-        // For simplicity, we temporarily use adapter pattern
-        CppParser adaptedParser;
-        adaptPythonToCppParser(adaptedParser);
-        functionGraphView_->setParserData(adaptedParser);
-        hasFunctions = true;
-    } else if (isGoMode_ && !goParser_.getFunctions().empty()) {
-        // Convert Go parsing data to C++ data format
-        CppParser adaptedParser;
-        adaptGoToCppParser(adaptedParser);
-        functionGraphView_->setParserData(adaptedParser);
-        hasFunctions = true;
-    }
-    
-    if (!hasFunctions) {
+    // Every parser fills the same code model, so no language is converted
+    applyDocumentEdits();
+    if (!documentParser_.isLoaded() || documentParser_.getCodeModel().getFunctions().empty()) {
         QMessageBox::warning(this, "Warning", "Please parse code file first");
         return;
     }
+    functionGraphView_->setCodeModel(documentParser_.getCodeModel());
+    // Redrawn from now on whenever the analysis is refreshed after an edit
+    graphFollowsDocument_ = true;
     
     // Show analysis panel if not already shown
     showAnalysisPanel();
@@ -1787,190 +3037,151 @@ void MainWindow::parseGo() {
     }
     
     showAnalysisPanel();
-    
-    QString content = xmlEditor_->toPlainText();
-    std::string goContent = content.toStdString();
-    
-    if (goParser_.parseFile(goContent)) {
-        statusBar()->showMessage("Go file parsed successfully");
-        
-        // Show parsing statistics in analysis panel
-        const auto& functions = goParser_.getFunctions();
-        const auto& structs = goParser_.getStructs();
-        const auto& interfaces = goParser_.getInterfaces();
-        QString info = QString("<h3>Go Analysis Results</h3>"
-                              "<p><b>Functions found:</b> %1</p>"
-                              "<p><b>Structs found:</b> %2</p>"
-                              "<p><b>Interfaces found:</b> %3</p>"
-                              "<p>Click 'Generate Function Graph' to visualize the code structure.</p>")
-                      .arg(functions.size())
-                      .arg(structs.size())
-                      .arg(interfaces.size());
-        detailsTextEdit_->setHtml(info);
-        rightTabs_->setCurrentIndex(0); // Show details tab
-        
-        // Enable function graph generation
-        parseButton_->setEnabled(true);
-    } else {
-        QMessageBox::critical(this, "Error", "Go file parsing failed");
-    }
+    analyzeDocument(SourceLanguage::Go);
+    statusBar()->showMessage("Go file parsed successfully");
 }
 
-void MainWindow::adaptPythonToCppParser(CppParser& cppParser) {
-    // Clear target parser
-    cppParser.clear();
-    
-    // Convert Python functions to C++ function format
-    const auto& pythonFunctions = pythonParser_.getFunctions();
-    const auto& pythonClasses = pythonParser_.getClasses();
-    const auto& pythonCalls = pythonParser_.getFunctionCalls();
-    
-    // This is a simplified adapter implementation
-    // In actual applications, you may need to modify FunctionGraphView to support generic parser interface
+void MainWindow::analyzeDocument(SourceLanguage language) {
+    // The whole text is parsed only the first time; afterwards the model is
+    // kept current by onDocumentContentsChange
+    applyDocumentEdits();
+    if (!documentParser_.isLoaded() || documentParser_.getLanguage() != language) {
+        documentParser_.reset(language, xmlEditor_->toPlainText().toStdString());
+        documentLineCount_ = xmlEditor_->document()->blockCount();
+    }
     
-    // Since CppParser's internal data is private, we need to populate data through parsing
-    // Here we construct a temporary C++ code string to simulate conversion
-    std::string adaptedCppCode;
+    // Show parsing statistics in analysis panel
+    showCodeSummary();
+    rightTabs_->setCurrentIndex(0); // Show details tab
     
-    // Convert class definitions
-    for (const auto& pythonClass : pythonClasses) {
-        adaptedCppCode += "class " + pythonClass.name;
-        if (!pythonClass.baseClasses.empty()) {
-            adaptedCppCode += " : public " + pythonClass.baseClasses[0];
-        }
-        adaptedCppCode += " {\npublic:\n";
-        
-        // Convert class methods
-        for (const auto& method : pythonClass.methods) {
-            adaptedCppCode += "    void " + method.name + "(";
-            for (size_t i = 0; i < method.parameters.size(); ++i) {
-                if (i > 0) adaptedCppCode += ", ";
-                adaptedCppCode += "int " + method.parameters[i].name;
-            }
-            adaptedCppCode += ") {\n";
-            
-            // Add function calls
-            auto it = pythonCalls.find(method.name);
-            if (it != pythonCalls.end()) {
-                for (const std::string& calledFunc : it->second) {
-                    adaptedCppCode += "        " + calledFunc + "();\n";
-                }
-            }
-            
-            adaptedCppCode += "    }\n";
-        }
-        adaptedCppCode += "};\n\n";
+    // Enable function graph generation
+    parseButton_->setEnabled(true);
+}
+
+void MainWindow::onDocumentContentsChange(int position, int charsRemoved, int charsAdded) {
+    Q_UNUSED(charsRemoved);
+    if (!documentParser_.isLoaded()) {
+        return;
     }
     
-    // Convert independent functions
-    for (const auto& pythonFunc : pythonFunctions) {
-        if (pythonFunc.className.empty()) { // Only handle independent functions
-            adaptedCppCode += "void " + pythonFunc.name + "(";
-            for (size_t i = 0; i < pythonFunc.parameters.size(); ++i) {
-                if (i > 0) adaptedCppCode += ", ";
-                adaptedCppCode += "int " + pythonFunc.parameters[i].name;
-            }
-            adaptedCppCode += ") {\n";
-            
-            // Add function calls
-            auto it = pythonCalls.find(pythonFunc.name);
-            if (it != pythonCalls.end()) {
-                for (const std::string& calledFunc : it->second) {
-                    adaptedCppCode += "    " + calledFunc + "();\n";
-                }
-            }
-            
-            adaptedCppCode += "}\n\n";
+    // Highlighters report their format changes here as well; they only make
+    // the range to reparse a little larger
+    QTextDocument* document = xmlEditor_->document();
+    QTextBlock lastBlock = document->findBlock(position + charsAdded);
+    if (!lastBlock.isValid()) lastBlock = document->lastBlock();
+    QTextBlock firstBlock = document->findBlock(position);
+    int first = firstBlock.isValid() ? firstBlock.blockNumber() : lastBlock.blockNumber();
+    int end = lastBlock.blockNumber() + 1;
+    int delta = document->blockCount() - documentLineCount_;
+    documentLineCount_ = document->blockCount();
+    
+    if (dirtyEndLine_ < 0) {
+        dirtyFirstLine_ = first;
+        dirtyEndLine_ = end;
+        dirtyLineDelta_ = delta;
+    } else {
+        // Lines [first, end - delta) before this edit are [first, end) now
+        if (dirtyEndLine_ >= end - delta) {
+            dirtyEndLine_ += delta;
+        } else if (dirtyEndLine_ > first) {
+            dirtyEndLine_ = end;
         }
+        dirtyFirstLine_ = std::min(dirtyFirstLine_, first);
+        dirtyEndLine_ = std::max(dirtyEndLine_, end);
+        dirtyLineDelta_ += delta;
     }
-    
-    // Parse adapted code
-    cppParser.parseFile(adaptedCppCode);
+    analysisTimer_->start(250);
 }
 
-void MainWindow::adaptGoToCppParser(CppParser& cppParser) {
-    // Clear target parser
-    cppParser.clear();
-    
-    // Convert Go functions to C++ function format
-    const auto& goFunctions = goParser_.getFunctions();
-    const auto& goStructs = goParser_.getStructs();
-    const auto& goCalls = goParser_.getFunctionCalls();
-    
-    // Construct a temporary C++ code string to simulate conversion
-    std::string adaptedCppCode;
-    
-    // Convert struct definitions
-    for (const auto& goStruct : goStructs) {
-        adaptedCppCode += "class " + goStruct.name + " {\npublic:\n";
-        
-        // Convert struct fields
-        for (const auto& field : goStruct.fields) {
-            adaptedCppCode += "    int " + field + ";\n";
-        }
-        
-        adaptedCppCode += "};\n\n";
+void MainWindow::applyDocumentEdits() {
+    if (dirtyEndLine_ < 0) {
+        return;
     }
-    
-    // Convert function definitions
-    for (const auto& goFunc : goFunctions) {
-        // Handle return types (Go can have multiple return values)
-        std::string returnType = "void";
-        if (!goFunc.returnTypes.empty()) {
-            returnType = goFunc.returnTypes[0]; // Simplified handling, only take first return type
-            // Map Go types to C++ types
-            if (returnType == "string") returnType = "std::string";
-            else if (returnType == "int") returnType = "int";
-            else if (returnType == "bool") returnType = "bool";
-            else if (returnType == "float64") returnType = "double";
-            else returnType = "int"; // Default type
-        }
-        
-        // Handle methods (with receiver)
-        if (goFunc.isMethod) {
-            adaptedCppCode += "class " + goFunc.receiverType + " {\npublic:\n";
-            adaptedCppCode += "    " + returnType + " " + goFunc.name + "(";
-        } else {
-            adaptedCppCode += returnType + " " + goFunc.name + "(";
-        }
-        
-        // Convert parameters
-        for (size_t i = 0; i < goFunc.parameters.size(); ++i) {
-            if (i > 0) adaptedCppCode += ", ";
-            
-            std::string paramType = goFunc.parameters[i].type;
-            // Simple type mapping
-            if (paramType == "string") paramType = "std::string";
-            else if (paramType == "int") paramType = "int";
-            else if (paramType == "bool") paramType = "bool";
-            else if (paramType == "float64") paramType = "double";
-            else paramType = "int"; // Default type
-            
-            adaptedCppCode += paramType + " " + goFunc.parameters[i].name;
-        }
-        
-        adaptedCppCode += ") {\n";
-        
-        // Add function calls
-        auto it = goCalls.find(goFunc.name);
-        if (it != goCalls.end()) {
-            for (const std::string& calledFunc : it->second) {
-                adaptedCppCode += "    " + calledFunc + "();\n";
-            }
-        }
-        
-        if (goFunc.isMethod) {
-            adaptedCppCode += "    }\n};\n\n";
+    QTextDocument* document = xmlEditor_->document();
+    int lineCount = dirtyEndLine_ - dirtyFirstLine_;
+    documentParser_.update(dirtyFirstLine_, lineCount - dirtyLineDelta_, lineCount, [document](int first, int count) {
+        std::string text;
+        QTextBlock block = document->findBlockByNumber(first);
+        for (int i = 0; i < count && block.isValid(); ++i, block = block.next()) {
+            text += block.text().toStdString();
+            text += '\n';
+        }
+        return text;
+    });
+    dirtyEndLine_ = -1;
+}
+
+void MainWindow::refreshCodeAnalysis() {
+    applyDocumentEdits();
+    if (!documentParser_.isLoaded()) {
+        return;
+    }
+    showCodeSummary();
+    if (graphFollowsDocument_) {
+        functionGraphView_->setCodeModel(documentParser_.getCodeModel());
+        functionGraphView_->generateGraph();
+    }
+}
+
+void MainWindow::resetDocumentAnalysis() {
+    analysisTimer_->stop();
+    documentParser_.clear();
+    dirtyEndLine_ = -1;
+    graphFollowsDocument_ = false;
+}
+
+void MainWindow::showCodeSummary() {
+    const CodeModel& model = documentParser_.getCodeModel();
+    size_t classes = 0;
+    size_t structs = 0;
+    size_t interfaces = 0;
+    for (const CodeType& type : model.getTypes()) {
+        if (type.kind == "struct") {
+            ++structs;
+        } else if (type.kind == "interface") {
+            ++interfaces;
         } else {
-            adaptedCppCode += "}\n\n";
+            ++classes;
         }
     }
     
-    // Parse adapted code
-    cppParser.parseFile(adaptedCppCode);
+    QString info;
+    switch (model.getLanguage()) {
+        case SourceLanguage::Cpp:
+        case SourceLanguage::Python:
+            info = QString("<h3>%1 Analysis Results</h3>"
+                           "<p><b>Functions found:</b> %2</p>"
+                           "<p><b>Classes found:</b> %3</p>")
+                   .arg(model.getLanguage() == SourceLanguage::Cpp ? "C++" : "Python")
+                   .arg(model.getFunctions().size())
+                   .arg(classes);
+            break;
+        case SourceLanguage::Go:
+            info = QString("<h3>Go Analysis Results</h3>"
+                           "<p><b>Functions found:</b> %1</p>"
+                           "<p><b>Structs found:</b> %2</p>"
+                           "<p><b>Interfaces found:</b> %3</p>")
+                   .arg(model.getFunctions().size())
+                   .arg(structs)
+                   .arg(interfaces);
+            break;
+    }
+    info += "<p>Click 'Generate Function Graph' to visualize the code structure.</p>";
+    
+    // Outline: functions in source order with their lines
+    info += "<ul>";
+    for (const CodeFunction& function : model.getFunctions()) {
+        info += QString("<li>%1 <span style='color: #808080;'>line %2</span></li>")
+                .arg(QString::fromStdString(function.qualifiedName).toHtmlEscaped())
+                .arg(function.lineNumber);
+    }
+    info += "</ul>";
+    detailsTextEdit_->setHtml(info);
 }
 
 void MainWindow::loadFileFromPath(const QString& filePath) {
+    stopTail();
+    
     // Set current file path
     currentFilePath_ = filePath.toStdString();
     
@@ -1978,23 +3189,22 @@ void MainWindow::loadFileFromPath(const QString& filePath) {
     QFileInfo fileInfo(filePath);
     fileLabel_->setText(fileInfo.fileName());
     
-    // Read file content
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // Read file content, decompressing .gz/.xz/.zst on the fly
+    std::string bytes;
+    QString error;
+    if (!readFileContent(filePath, bytes, error)) {
         QMessageBox::critical(this, "Error", 
-            QString("Cannot open file: %1").arg(filePath));
+            QString("Cannot open file: %1\n%2").arg(filePath, error));
         return;
     }
     
-    QTextStream in(&file);
-    QString content = in.readAll();
-    file.close();
-    
     // Set editor content
-    xmlEditor_->setPlainText(content);
+    resetDocumentAnalysis();
+    xmlEditor_->setPlainText(QString::fromUtf8(bytes.data(), static_cast<int>(bytes.size())));
     
-    // Set mode based on file extension
-    QString extension = fileInfo.suffix().toLower();
+    // Set mode based on file extension ("notes.md.gz" is Markdown)
+    QString extension = QFileInfo(QString::fromStdString(stripCompressionExtension(currentFilePath_)))
+                            .suffix().toLower();
     isMarkdownMode_ = (extension == "md" || extension == "markdown");
     isCppMode_ = (extension == "cpp" || extension == "cxx" || extension == "cc" || extension == "c");
     isPythonMode_ = (extension == "py");
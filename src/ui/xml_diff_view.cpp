@@ -0,0 +1,224 @@
+#include "xml_diff_view.h"
+#include <QBrush>
+#include <QColor>
+#include <algorithm>
+
+namespace {
+
+const QColor kDeletedColor("#F48771");
+const QColor kInsertedColor("#89D185");
+const QColor kMovedColor("#75BEFF");
+const QColor kChangedColor("#CCA700");
+const QColor kUnchangedColor("#808080");
+
+QColor editColor(XmlDiff::Edit::Type type) {
+    switch (type) {
+        case XmlDiff::Edit::Type::Insert: return kInsertedColor;
+        case XmlDiff::Edit::Type::Delete: return kDeletedColor;
+        case XmlDiff::Edit::Type::Move: return kMovedColor;
+        default: return kChangedColor;
+    }
+}
+
+QString shorten(const std::string& text) {
+    QString value = QString::fromStdString(text).simplified();
+    return value.length() > 60 ? value.left(57) + "..." : value;
+}
+
+} // namespace
+
+XmlDiffView::XmlDiffView(QWidget* parent)
+    : QDialog(parent) {
+    setupUi();
+    setWindowTitle("Compare XML");
+    resize(1100, 750);
+}
+
+void XmlDiffView::setupUi() {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    
+    summaryLabel_ = new QLabel();
+    mainLayout->addWidget(summaryLabel_);
+    
+    QSplitter* verticalSplitter = new QSplitter(Qt::Vertical);
+    QSplitter* treeSplitter = new QSplitter(Qt::Horizontal);
+    
+    QWidget* oldPanel = new QWidget();
+    QVBoxLayout* oldLayout = new QVBoxLayout(oldPanel);
+    oldLayout->setContentsMargins(0, 0, 0, 0);
+    oldLabel_ = new QLabel();
+    oldTree_ = new QTreeWidget();
+    oldTree_->setHeaderHidden(true);
+    oldLayout->addWidget(oldLabel_);
+    oldLayout->addWidget(oldTree_);
+    
+    QWidget* newPanel = new QWidget();
+    QVBoxLayout* newLayout = new QVBoxLayout(newPanel);
+    newLayout->setContentsMargins(0, 0, 0, 0);
+    newLabel_ = new QLabel();
+    newTree_ = new QTreeWidget();
+    newTree_->setHeaderHidden(true);
+    newLayout->addWidget(newLabel_);
+    newLayout->addWidget(newTree_);
+    
+    treeSplitter->addWidget(oldPanel);
+    treeSplitter->addWidget(newPanel);
+    
+    editList_ = new QListWidget();
+    editList_->setStyleSheet("QListWidget { font-family: 'Cascadia Code', monospace; }");
+    verticalSplitter->addWidget(treeSplitter);
+    verticalSplitter->addWidget(editList_);
+    verticalSplitter->setSizes({550, 200});
+    mainLayout->addWidget(verticalSplitter);
+    
+    connect(editList_, &QListWidget::currentRowChanged, this, &XmlDiffView::onEditSelected);
+}
+
+void XmlDiffView::setDiff(const XmlDiff& diff, const std::shared_ptr<XmlNode>& oldRoot,
+                          const std::shared_ptr<XmlNode>& newRoot, const QString& oldTitle, const QString& newTitle) {
+    const auto& edits = diff.getEdits();
+    edits_.assign(edits.begin(), edits.begin() + std::min(edits.size(), kMaxShownEdits));
+    oldLabel_->setText(oldTitle);
+    newLabel_->setText(newTitle);
+    
+    QString summary = QString("%1 edits; %2 identical subtrees skipped")
+                      .arg(edits.size()).arg(diff.getSkippedCount());
+    if (edits.size() > edits_.size()) {
+        summary += QString(" (showing the first %1)").arg(edits_.size());
+    }
+    summaryLabel_->setText(summary);
+    
+    // Every edited node and its ancestors are shown; everything else is folded
+    NodeSet oldPath;
+    NodeSet newPath;
+    EditMarks oldMarks;
+    EditMarks newMarks;
+    auto addAncestors = [](const std::shared_ptr<XmlNode>& node, NodeSet& set) {
+        auto current = node;
+        while (current && set.insert(current.get()).second) {
+            current = current->getParent();
+        }
+    };
+    for (const auto& edit : edits_) {
+        if (edit.oldNode) {
+            addAncestors(edit.oldNode, oldPath);
+            oldMarks.emplace(edit.oldNode.get(), edit.type);
+        }
+        if (edit.newNode) {
+            addAncestors(edit.newNode, newPath);
+            newMarks.emplace(edit.newNode.get(), edit.type);
+        }
+    }
+    
+    buildTree(oldTree_, oldRoot, oldPath, oldMarks, oldItems_);
+    buildTree(newTree_, newRoot, newPath, newMarks, newItems_);
+    
+    editList_->clear();
+    QStringList lines = QString::fromStdString(diff.toScript()).split('\n', QString::SkipEmptyParts);
+    for (int i = 0; i < static_cast<int>(edits_.size()) && i < lines.size(); ++i) {
+        QListWidgetItem* item = new QListWidgetItem(lines[i]);
+        item->setForeground(editColor(edits_[i].type));
+        editList_->addItem(item);
+    }
+}
+
+void XmlDiffView::buildTree(QTreeWidget* tree, const std::shared_ptr<XmlNode>& root, const NodeSet& onPath,
+                            const EditMarks& marks, ItemMap& items) {
+    tree->clear();
+    items.clear();
+    if (!root) {
+        return;
+    }
+    QTreeWidgetItem* rootItem = new QTreeWidgetItem(tree);
+    rootItem->setText(0, nodeLabel(*root));
+    items[root.get()] = rootItem;
+    addBranch(root, rootItem, onPath, marks, items);
+    tree->expandAll();
+}
+
+void XmlDiffView::addBranch(const std::shared_ptr<XmlNode>& node, QTreeWidgetItem* item, const NodeSet& onPath,
+                            const EditMarks& marks, ItemMap& items) {
+    auto mark = marks.find(node.get());
+    if (mark != marks.end()) {
+        item->setForeground(0, editColor(mark->second));
+        // Whole subtrees that appear or disappear are shown (up to a limit)
+        if (mark->second == XmlDiff::Edit::Type::Delete || mark->second == XmlDiff::Edit::Type::Insert) {
+            int budget = kMaxSubtreeItems;
+            addSubtree(node, item, budget);
+            return;
+        }
+    }
+    
+    int unchanged = 0;
+    auto flushUnchanged = [&]() {
+        if (unchanged > 0) {
+            QTreeWidgetItem* folded = new QTreeWidgetItem(item);
+            folded->setText(0, QString("... %1 unchanged").arg(unchanged));
+            folded->setForeground(0, kUnchangedColor);
+            unchanged = 0;
+        }
+    };
+    for (const auto& child : node->getChildren()) {
+        if (onPath.count(child.get()) == 0) {
+            ++unchanged;
+            continue;
+        }
+        flushUnchanged();
+        QTreeWidgetItem* childItem = new QTreeWidgetItem(item);
+        childItem->setText(0, nodeLabel(*child));
+        items[child.get()] = childItem;
+        addBranch(child, childItem, onPath, marks, items);
+    }
+    flushUnchanged();
+}
+
+void XmlDiffView::addSubtree(const std::shared_ptr<XmlNode>& node, QTreeWidgetItem* item, int& budget) {
+    for (const auto& child : node->getChildren()) {
+        if (budget-- <= 0) {
+            QTreeWidgetItem* more = new QTreeWidgetItem(item);
+            more->setText(0, "...");
+            more->setForeground(0, kUnchangedColor);
+            return;
+        }
+        QTreeWidgetItem* childItem = new QTreeWidgetItem(item);
+        childItem->setText(0, nodeLabel(*child));
+        childItem->setForeground(0, item->foreground(0));
+        addSubtree(child, childItem, budget);
+    }
+}
+
+QString XmlDiffView::nodeLabel(const XmlNode& node) {
+    switch (node.getType()) {
+        case XmlNode::NodeType::Text:
+            return "\"" + shorten(node.getValue()) + "\"";
+        case XmlNode::NodeType::Comment:
+            return "<!-- " + shorten(node.getValue()) + " -->";
+        case XmlNode::NodeType::ProcessingInstruction:
+            return "<?" + QString::fromStdString(node.getName()) + " " + shorten(node.getValue()) + "?>";
+        default:
+            break;
+    }
+    QString label = "<" + QString::fromStdString(node.getName());
+    for (const auto& attribute : node.getAttributes()) {
+        label += QString(" %1=\"%2\"").arg(QString::fromStdString(attribute.first), shorten(attribute.second));
+    }
+    return label + ">";
+}
+
+void XmlDiffView::onEditSelected(int row) {
+    if (row < 0 || row >= static_cast<int>(edits_.size())) {
+        return;
+    }
+    const XmlDiff::Edit& edit = edits_[row];
+    auto select = [](QTreeWidget* tree, const ItemMap& items, const std::shared_ptr<XmlNode>& node) {
+        auto it = node ? items.find(node.get()) : items.end();
+        if (it == items.end()) {
+            tree->clearSelection();
+            return;
+        }
+        tree->setCurrentItem(it->second);
+        tree->scrollToItem(it->second, QAbstractItemView::PositionAtCenter);
+    };
+    select(oldTree_, oldItems_, edit.oldNode);
+    select(newTree_, newItems_, edit.newNode);
+}
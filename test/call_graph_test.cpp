@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "call_graph.h"
+#include "cpp_parser.h"
+
+TEST(CallGraphTest, BuildsAdjacencyWithCounts) {
+    CallGraph graph;
+    CallGraph::NodeId main = graph.addNode("main");
+    CallGraph::NodeId load = graph.addNode("load");
+    CallGraph::NodeId print = graph.addNode("print", false);
+    graph.addCall(main, print);
+    graph.addCall(main, load);
+    graph.addCall(main, print);
+    graph.addCall(load, print);
+    graph.build();
+
+    EXPECT_EQ(graph.nodeCount(), 3u);
+    EXPECT_EQ(graph.edgeCount(), 3u);
+    EXPECT_TRUE(graph.isDefined(load));
+    EXPECT_FALSE(graph.isDefined(print));
+    EXPECT_EQ(graph.find("missing"), CallGraph::kNoNode);
+
+    CallGraph::EdgeRange callees = graph.callees(main);
+    ASSERT_EQ(callees.size(), 2u);
+    EXPECT_EQ(callees.begin()[0].node, load);
+    EXPECT_EQ(callees.begin()[0].count, 1u);
+    EXPECT_EQ(callees.begin()[1].node, print);
+    EXPECT_EQ(callees.begin()[1].count, 2u);
+
+    CallGraph::EdgeRange callers = graph.callers(print);
+    ASSERT_EQ(callers.size(), 2u);
+    EXPECT_EQ(callers.begin()[0].node, main);
+    EXPECT_EQ(callers.begin()[0].count, 2u);
+    EXPECT_EQ(callers.begin()[1].node, load);
+    EXPECT_TRUE(graph.callers(main).empty());
+    EXPECT_TRUE(graph.callees(CallGraph::kNoNode).empty());
+
+    // A node added after build() has no edges until the next build()
+    CallGraph::NodeId late = graph.addNode("late");
+    graph.addCall(late, main);
+    EXPECT_TRUE(graph.callees(late).empty());
+    graph.build();
+    EXPECT_EQ(graph.callerNames("main"), std::vector<std::string>{"late"});
+    EXPECT_EQ(graph.calleeNames("main"), (std::vector<std::string>{"load", "print"}));
+}
+
+TEST(CallGraphTest, BuiltByParsers) {
+    CppParser parser;
+    ASSERT_TRUE(parser.parseFile(
+        "void log(int level);\n"
+        "void step() { log(1); log(2); }\n"
+        "void run() { step(); log(3); step(); }\n"));
+
+    const CallGraph& graph = parser.getCodeModel().getCallGraph();
+    CallGraph::NodeId run = graph.find("run");
+    ASSERT_NE(run, CallGraph::kNoNode);
+    ASSERT_EQ(graph.callees(run).size(), 2u);
+    EXPECT_EQ(graph.name(graph.callees(run).begin()->node), "log");
+    EXPECT_EQ(graph.callees(run).begin()[1].count, 2u);
+
+    // Duplicates stay in getFunctionCalls(), callers are listed once
+    EXPECT_EQ(parser.getFunctionCalls().at("step").size(), 2u);
+    EXPECT_EQ(parser.getCallingFunctions("log"), (std::vector<std::string>{"step", "run"}));
+    EXPECT_EQ(parser.getCallingFunctions("unknown"), std::vector<std::string>{});
+}
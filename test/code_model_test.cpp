@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "code_model.h"
+#include "cpp_parser.h"
+#include "python_parser.h"
+#include "go_parser.h"
+
+namespace {
+
+const CodeFunction* findFunction(const CodeModel& model, const std::string& qualifiedName) {
+    for (const auto& func : model.getFunctions()) {
+        if (func.qualifiedName == qualifiedName) return &func;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(CodeModelTest, FilledByCppParser) {
+    CppParser parser;
+    ASSERT_TRUE(parser.parseFile(
+        "class Store : public Base {\n"
+        "public:\n"
+        "    int get(const std::string& key, int fallback = 0) const { return find(key); }\n"
+        "};\n"
+        "void run() { Store s; s.get(\"k\"); }\n"));
+
+    const CodeModel& model = parser.getCodeModel();
+    EXPECT_EQ(model.getLanguage(), SourceLanguage::Cpp);
+    ASSERT_EQ(model.getTypes().size(), 1u);
+    EXPECT_EQ(model.getTypes()[0].kind, "class");
+    EXPECT_EQ(model.getTypes()[0].baseTypes, std::vector<std::string>{"Base"});
+
+    const CodeFunction* get = findFunction(model, "Store::get");
+    ASSERT_NE(get, nullptr);
+    EXPECT_EQ(get->container, "Store");
+    EXPECT_EQ(get->returnType, "int");
+    ASSERT_EQ(get->parameters.size(), 2u);
+    EXPECT_EQ(get->parameters[0].type, "const std::string&");
+    EXPECT_EQ(get->parameters[1].defaultValue, "0");
+    EXPECT_EQ(get->lineNumber, 3);
+
+    ASSERT_NE(findFunction(model, "run"), nullptr);
+    EXPECT_EQ(model.getFunctionCalls().at("run"), std::vector<std::string>{"get"});
+    EXPECT_EQ(model.getCalls().size(), parser.getCallSites().size());
+}
+
+TEST(CodeModelTest, FilledByPythonAndGoParsers) {
+    PythonParser python;
+    ASSERT_TRUE(python.parseFile(
+        "class Cache(dict):\n"
+        "    def get(self, key: str, default=None) -> int:\n"
+        "        return self.load(key)\n"));
+
+    const CodeModel& pythonModel = python.getCodeModel();
+    EXPECT_EQ(pythonModel.getLanguage(), SourceLanguage::Python);
+    const CodeFunction* get = findFunction(pythonModel, "Cache.get");
+    ASSERT_NE(get, nullptr);
+    EXPECT_EQ(get->container, "Cache");
+    EXPECT_EQ(get->signature, "def get(self, key: str, default = None) -> int");
+    ASSERT_EQ(get->parameters.size(), 3u);
+    EXPECT_EQ(get->parameters[1].type, "str");
+    ASSERT_EQ(pythonModel.getCalls().size(), 1u);
+    EXPECT_EQ(pythonModel.getCalls()[0].callee, "load");
+    EXPECT_EQ(pythonModel.getCalls()[0].qualifier, "self");
+
+    GoParser go;
+    ASSERT_TRUE(go.parseFile(
+        "package store\n"
+        "\n"
+        "type Store struct{}\n"
+        "\n"
+        "type Getter interface {\n"
+        "\tGet(key string) ([]byte, error)\n"
+        "}\n"
+        "\n"
+        "func (s *Store) Get(key string, opts ...Option) ([]byte, error) {\n"
+        "\treturn s.load(key)\n"
+        "}\n"));
+
+    const CodeModel& goModel = go.getCodeModel();
+    EXPECT_EQ(goModel.getLanguage(), SourceLanguage::Go);
+    ASSERT_EQ(goModel.getTypes().size(), 2u);
+    EXPECT_EQ(goModel.getTypes()[1].kind, "interface");
+
+    const CodeFunction* method = findFunction(goModel, "(*Store).Get");
+    ASSERT_NE(method, nullptr);
+    EXPECT_EQ(method->container, "*Store");
+    EXPECT_EQ(method->returnType, "([]byte, error)");
+    ASSERT_EQ(method->parameters.size(), 2u);
+    EXPECT_EQ(method->parameters[0].type, "string");
+    EXPECT_EQ(method->parameters[1].type, "...Option");
+    EXPECT_EQ(goModel.getFunctionCalls().at("Get"), std::vector<std::string>{"load"});
+
+    go.clear();
+    EXPECT_TRUE(go.getCodeModel().getFunctions().empty());
+}
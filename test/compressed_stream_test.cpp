@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "compressed_stream.h"
+#include "xml_parser.h"
+#include "xml_stream_converter.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+std::string makeXml(int records) {
+    std::string xml = "<?xml version=\"1.0\"?>\n<log>\n";
+    for (int i = 0; i < records; ++i) {
+        xml += "  <entry id=\"" + std::to_string(i) + "\"><msg>line " + std::to_string(i) + "</msg></entry>\n";
+    }
+    xml += "</log>\n";
+    return xml;
+}
+
+std::string readAll(const std::string& path) {
+    CompressedInputStream input(path);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+std::string readRaw(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void writeCompressed(const std::string& path, CompressionType type, const std::string& content) {
+    CompressedOutputStream output(path, type);
+    output << content;
+    ASSERT_TRUE(output.close()) << output.getErrorMessage();
+}
+
+} // namespace
+
+TEST(CompressedStreamTest, RoundTripsEachFormat) {
+    // Larger than the internal buffers so refills and multi-block output are exercised
+    std::string xml = makeXml(20000);
+
+    for (auto type : {CompressionType::None, CompressionType::Gzip,
+                      CompressionType::Xz, CompressionType::Zstd}) {
+        if (!isCompressionSupported(type)) continue;
+
+        std::string path = testing::TempDir() + "nexus_round_trip" +
+                           std::to_string(static_cast<int>(type));
+        writeCompressed(path, type, xml);
+        EXPECT_EQ(detectCompression(path), type);
+
+        CompressedInputStream input(path);
+        ASSERT_TRUE(input.isOpen());
+        EXPECT_EQ(input.compression(), type);
+        std::string decoded(std::istreambuf_iterator<char>(input), {});
+        EXPECT_EQ(decoded, xml);
+        EXPECT_FALSE(input.hasError());
+        std::remove(path.c_str());
+    }
+}
+
+TEST(CompressedStreamTest, ReadsConcatenatedGzipMembers) {
+    std::string first = testing::TempDir() + "nexus_part1.gz";
+    std::string second = testing::TempDir() + "nexus_part2.gz";
+    writeCompressed(first, CompressionType::Gzip, "<root><a/>");
+    writeCompressed(second, CompressionType::Gzip, "<b/></root>");
+
+    std::string joined = testing::TempDir() + "nexus_joined.gz";
+    {
+        std::ofstream output(joined, std::ios::binary);
+        output << readRaw(first) << readRaw(second);
+    }
+    EXPECT_EQ(readAll(joined), "<root><a/><b/></root>");
+
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+    std::remove(joined.c_str());
+}
+
+TEST(CompressedStreamTest, ReportsTruncatedInput) {
+    std::string path = testing::TempDir() + "nexus_truncated.xml.gz";
+    writeCompressed(path, CompressionType::Gzip, makeXml(2000));
+
+    std::string raw = readRaw(path);
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(raw.data(), static_cast<std::streamsize>(raw.size() / 2));
+    }
+
+    XmlParser parser;
+    EXPECT_EQ(parser.parseFile(path), nullptr);
+    EXPECT_TRUE(parser.hasError());
+    std::remove(path.c_str());
+}
+
+TEST(CompressedStreamTest, ParserReadsCompressedFiles) {
+    std::string path = testing::TempDir() + "nexus_parse.xml.xz";
+    writeCompressed(path, CompressionType::Xz, makeXml(500));
+
+    XmlParser parser;
+    auto root = parser.parseFile(path);
+    ASSERT_NE(root, nullptr) << parser.getErrorMessage();
+    EXPECT_EQ(root->getName(), "log");
+    ASSERT_EQ(root->getChildren().size(), 500u);
+    EXPECT_EQ(root->getChildren()[499]->getAttribute("id"), "499");
+    std::remove(path.c_str());
+}
+
+TEST(CompressedStreamTest, ConverterHandlesCompressedInputAndOutput) {
+    std::string xml = makeXml(300);
+    std::string input = testing::TempDir() + "nexus_convert.xml.gz";
+    std::string output = testing::TempDir() + "nexus_convert.json.gz";
+    writeCompressed(input, CompressionType::Gzip, xml);
+
+    XmlStreamConverter converter;
+    uint64_t lastProgress = 0;
+    converter.setProgressCallback([&lastProgress](uint64_t bytesRead) {
+        lastProgress = bytesRead;
+        return true;
+    });
+    ASSERT_TRUE(converter.convertFile(input, output, XmlSerializer::Format::JSON))
+        << converter.getErrorMessage();
+    EXPECT_EQ(detectCompression(output), CompressionType::Gzip);
+    // Progress is measured against the compressed file
+    EXPECT_EQ(lastProgress, readRaw(input).size());
+
+    std::istringstream plainInput(xml);
+    std::ostringstream expected;
+    ASSERT_TRUE(converter.convert(plainInput, expected, XmlSerializer::Format::JSON));
+    EXPECT_EQ(readAll(output), expected.str());
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
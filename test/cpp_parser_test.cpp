@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "cpp_parser.h"
+#include <algorithm>
+
+namespace {
+
+const CppFunction* findFunction(const CppParser& parser, const std::string& name) {
+    for (const auto& func : parser.getFunctions()) {
+        if (func.name == name) return &func;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(CppParserTest, ParsesClassesAndFunctions) {
+    const std::string source =
+        "#include <string>\n"
+        "#define HELPER(x) \\\n"
+        "    void fake(x) {}\n"
+        "namespace app {\n"
+        "template <typename T>\n"
+        "class Shape : public Base<T, int>, private Named {\n"
+        "    Q_OBJECT\n"
+        "public:\n"
+        "    explicit Shape(int sides) : sides_(sides), name_{\"shape\"} {}\n"
+        "    virtual ~Shape();\n"
+        "    virtual double area() const = 0;\n"
+        "    static Shape* create(const std::string& name, int sides = 3);\n"
+        "private:\n"
+        "    int sides_, *cache_;\n"
+        "    std::map<int, int> lookup_;\n"
+        "};\n"
+        "} // namespace app\n"
+        "Shape* Shape::create(const std::string& name, int sides) {\n"
+        "    // notCalled(); \"alsoNot()\"\n"
+        "    const char* text = R\"sql(select count(*) from t where f(x))sql\";\n"
+        "    return new Shape(sides);\n"
+        "}\n";
+
+    CppParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+
+    ASSERT_EQ(parser.getClasses().size(), 1u);
+    const CppClass& shape = parser.getClasses()[0];
+    EXPECT_EQ(shape.name, "Shape");
+    EXPECT_EQ(shape.lineNumber, 6);
+    EXPECT_EQ(shape.baseClasses, (std::vector<std::string>{"Base<T, int>", "Named"}));
+    EXPECT_EQ(shape.memberVariables, (std::vector<std::string>{"sides_", "cache_", "lookup_"}));
+    ASSERT_EQ(shape.methods.size(), 4u);
+    EXPECT_EQ(shape.methods[0].accessLevel, "public");
+
+    // The constructor is defined in the class, create() outside of it; the
+    // pure virtual area() and the destructor only have declarations
+    std::vector<std::string> names;
+    for (const auto& func : parser.getFunctions()) names.push_back(func.name);
+    EXPECT_EQ(names, (std::vector<std::string>{"Shape", "~Shape", "area", "create"}));
+
+    const CppFunction* create = findFunction(parser, "create");
+    ASSERT_NE(create, nullptr);
+    EXPECT_EQ(create->className, "Shape");
+    EXPECT_EQ(create->returnType, "Shape*");
+    EXPECT_EQ(create->lineNumber, 18);
+    EXPECT_TRUE(create->isStatic);
+    EXPECT_EQ(create->accessLevel, "public");
+    ASSERT_EQ(create->parameters.size(), 2u);
+    EXPECT_EQ(create->parameters[0].type, "const std::string&");
+    EXPECT_EQ(create->parameters[0].name, "name");
+
+    const CppFunction* area = findFunction(parser, "area");
+    ASSERT_NE(area, nullptr);
+    EXPECT_TRUE(area->isVirtual);
+    EXPECT_TRUE(area->isConst);
+    EXPECT_EQ(parser.getFunctionSignature(*area), "double area() const");
+
+    EXPECT_EQ(findFunction(parser, "fake"), nullptr);
+    EXPECT_EQ(parser.getCalledFunctions("create"), (std::vector<std::string>{"Shape"}));
+}
+
+TEST(CppParserTest, RecordsCallSites) {
+    const std::string source =
+        "int helper(int value) { return value * 2; }\n"
+        "void run(Worker& worker) {\n"
+        "    std::vector<int> values(3);\n"
+        "    if (helper(1) > 0) {\n"
+        "        worker.start();\n"
+        "        auto total = std::max(helper(2), 4);\n"
+        "        auto ptr = std::make_shared<Worker>(total);\n"
+        "    }\n"
+        "    for (int i = 0; i < sizeof(values); ++i) emit progress(i);\n"
+        "    auto callback = [&]() { worker.stop(); };\n"
+        "}\n";
+
+    CppParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+    ASSERT_EQ(parser.getFunctions().size(), 2u);
+
+    EXPECT_EQ(parser.getCalledFunctions("run"),
+              (std::vector<std::string>{"helper", "start", "max", "helper", "make_shared", "progress", "stop"}));
+    EXPECT_EQ(parser.getCalledFunctions("helper"), std::vector<std::string>{});
+    EXPECT_EQ(parser.getCallingFunctions("helper"), std::vector<std::string>{"run"});
+
+    const auto& sites = parser.getCallSites();
+    ASSERT_EQ(sites.size(), 7u);
+    EXPECT_EQ(sites[2].callee, "max");
+    EXPECT_EQ(sites[2].qualifier, "std");
+    EXPECT_EQ(sites[2].lineNumber, 6);
+    EXPECT_EQ(sites[2].callerIndex, 1u);
+    EXPECT_EQ(sites[1].qualifier, "");
+}
+
+TEST(CppParserTest, SurvivesUnclosedAttributes) {
+    // Half-typed code must not stop the walk from making progress
+    CppParser parser;
+    for (const char* source : {"[[", "x[[", "[[nodiscard", "[[[", "int f() [[ {", "class [[deprecated S {};"}) {
+        parser.parseFile(source);
+    }
+    ASSERT_TRUE(parser.parseFile("[[nodiscard int size();\nint count() { return size(); }\n"));
+    ASSERT_FALSE(parser.getFunctions().empty());
+    EXPECT_EQ(parser.getFunctions().back().name, "count");
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "go_parser.h"
+
+namespace {
+
+const GoFunction* findFunction(const GoParser& parser, const std::string& name) {
+    for (const auto& func : parser.getFunctions()) {
+        if (func.name == name) return &func;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(GoParserTest, ParsesDeclarations) {
+    const std::string source =
+        "// Package store keeps things.\n"
+        "package store\n"
+        "\n"
+        "import (\n"
+        "\t\"fmt\"\n"
+        "\tlog \"github.com/x/log\"\n"
+        ")\n"
+        "\n"
+        "const query = `\n"
+        "func fake() {}\n"
+        "`\n"
+        "\n"
+        "// Store holds\n"
+        "// items.\n"
+        "type Store[K comparable, V any] struct {\n"
+        "\t*Base\n"
+        "\tio.Closer\n"
+        "\tname, path string `json:\"name\"`\n"
+        "\titems map[K]V\n"
+        "}\n"
+        "\n"
+        "type (\n"
+        "\tGetter interface {\n"
+        "\t\tGet(key string) (value []byte, err error)\n"
+        "\t\tfmt.Stringer\n"
+        "\t}\n"
+        "\tID int\n"
+        ")\n"
+        "\n"
+        "// Get returns a value.\n"
+        "func (s *Store[K, V]) Get(\n"
+        "\tkey K,\n"
+        "\tfallback V,\n"
+        ") (V, bool) {\n"
+        "\treturn s.items[key], true\n"
+        "}\n"
+        "\n"
+        "func Map[T, U any](xs []T, f func(T) U, opts ...Option) []U { return nil }\n"
+        "\n"
+        "func run(a, b int, c string) {}\n";
+
+    GoParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+    EXPECT_EQ(parser.getPackageName(), "store");
+
+    ASSERT_EQ(parser.getImports().size(), 2u);
+    EXPECT_EQ(parser.getImports()[1].path, "github.com/x/log");
+    EXPECT_EQ(parser.getImports()[1].alias, "log");
+    EXPECT_EQ(parser.getImports()[1].lineNumber, 6);
+
+    ASSERT_EQ(parser.getStructs().size(), 1u);
+    const GoStruct& store = parser.getStructs()[0];
+    EXPECT_EQ(store.name, "Store");
+    EXPECT_EQ(store.comment, "Store holds items.");
+    EXPECT_EQ(store.fields, (std::vector<std::string>{"Base", "Closer", "name", "path", "items"}));
+    ASSERT_EQ(store.methods.size(), 1u);
+    EXPECT_EQ(store.methods[0].name, "Get");
+
+    ASSERT_EQ(parser.getInterfaces().size(), 1u);
+    EXPECT_EQ(parser.getInterfaces()[0].methods,
+              (std::vector<std::string>{"Get(key string) (value []byte, err error)", "fmt.Stringer"}));
+
+    ASSERT_EQ(parser.getFunctions().size(), 3u);
+    EXPECT_EQ(findFunction(parser, "fake"), nullptr);
+
+    const GoFunction* get = findFunction(parser, "Get");
+    ASSERT_NE(get, nullptr);
+    EXPECT_TRUE(get->isMethod);
+    EXPECT_TRUE(get->isExported);
+    EXPECT_EQ(get->receiverName, "s");
+    EXPECT_EQ(get->receiverType, "*Store");
+    EXPECT_EQ(get->comment, "Get returns a value.");
+    EXPECT_EQ(get->lineNumber, 31);
+    EXPECT_EQ(parser.getFunctionSignature(*get), "func (s *Store) Get(key K, fallback V) (V, bool)");
+
+    const GoFunction* map = findFunction(parser, "Map");
+    ASSERT_NE(map, nullptr);
+    EXPECT_EQ(parser.getFunctionSignature(*map), "func Map[T, U any](xs []T, f func(T) U, opts ...Option) []U");
+    EXPECT_TRUE(map->parameters[2].isVariadic);
+
+    const GoFunction* run = findFunction(parser, "run");
+    ASSERT_NE(run, nullptr);
+    EXPECT_EQ(parser.getFunctionSignature(*run), "func run(a int, b int, c string)");
+    EXPECT_FALSE(run->isExported);
+}
+
+TEST(GoParserTest, RecordsCallSites) {
+    const std::string source =
+        "package main\n"
+        "\n"
+        "func main() {\n"
+        "\tdone := make(chan bool)\n"
+        "\tgo func() {\n"
+        "\t\tprocess(`raw ( text`, int64(3))\n"
+        "\t\tdone <- true\n"
+        "\t}()\n"
+        "\tfmt.Println(Map[int, string](nil, nil))\n"
+        "\tsrv.store.Get(\"k\")\n"
+        "}\n";
+
+    GoParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+    ASSERT_EQ(parser.getFunctions().size(), 1u);
+    EXPECT_EQ(parser.getCalledFunctions("main"), (std::vector<std::string>{"process", "Println", "Map", "Get"}));
+    EXPECT_EQ(parser.getCallingFunctions("Get"), std::vector<std::string>{"main"});
+
+    const auto& sites = parser.getCallSites();
+    ASSERT_EQ(sites.size(), 4u);
+    EXPECT_EQ(sites[0].lineNumber, 6);
+    EXPECT_EQ(sites[1].qualifier, "fmt");
+    EXPECT_EQ(sites[3].qualifier, "srv.store");
+    EXPECT_EQ(sites[3].callerIndex, 0u);
+}
+
+TEST(GoParserTest, LexesNumberAtStartOfSource) {
+    // Incremental chunks can start anywhere, a number included
+    GoParser parser;
+    parser.parseFile("1e-3\n\nfunc scale() float64 {\n\treturn 2.5e+1 * factor()\n}\n");
+    ASSERT_EQ(parser.getFunctions().size(), 1u);
+    EXPECT_EQ(parser.getCalledFunctions("scale"), std::vector<std::string>{"factor"});
+}
@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include "incremental_parser.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Text kept as lines, the way QTextDocument keeps blocks
+struct Document {
+    std::vector<std::string> lines;
+
+    explicit Document(const std::string& text) {
+        std::stringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) lines.push_back(line);
+        if (text.empty() || text.back() == '\n') lines.push_back("");
+    }
+
+    std::string text() const {
+        std::string joined;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (i > 0) joined += '\n';
+            joined += lines[i];
+        }
+        return joined;
+    }
+
+    // Replaces count lines from first with the lines of replacement
+    void edit(IncrementalParser& parser, int first, int count, const std::string& replacement) {
+        Document inserted(replacement);
+        lines.erase(lines.begin() + first, lines.begin() + first + count);
+        lines.insert(lines.begin() + first, inserted.lines.begin(), inserted.lines.end());
+        report(parser, first, count, static_cast<int>(inserted.lines.size()));
+    }
+
+    // Inserts the lines of text before line first, or removes count lines,
+    // reported with an empty old or new range
+    void insert(IncrementalParser& parser, int first, const std::string& text) {
+        Document inserted(text);
+        lines.insert(lines.begin() + first, inserted.lines.begin(), inserted.lines.end());
+        report(parser, first, 0, static_cast<int>(inserted.lines.size()));
+    }
+
+    void remove(IncrementalParser& parser, int first, int count) {
+        lines.erase(lines.begin() + first, lines.begin() + first + count);
+        report(parser, first, count, 0);
+    }
+
+    void report(IncrementalParser& parser, int first, int oldCount, int newCount) {
+        ASSERT_TRUE(parser.update(first, oldCount, newCount, [this](int from, int lineCount) {
+            std::string text;
+            for (int i = from; i < from + lineCount; ++i) text += lines[i] + '\n';
+            return text;
+        }));
+    }
+};
+
+CodeModel parseWhole(SourceLanguage language, const std::string& text) {
+    CppParser cpp;
+    PythonParser python;
+    GoParser go;
+    switch (language) {
+        case SourceLanguage::Cpp: cpp.parseFile(text); return cpp.getCodeModel();
+        case SourceLanguage::Python: python.parseFile(text); return python.getCodeModel();
+        case SourceLanguage::Go: go.parseFile(text); return go.getCodeModel();
+    }
+    return CodeModel();
+}
+
+void expectSameAsFullParse(IncrementalParser& parser, const Document& document) {
+    CodeModel full = parseWhole(parser.getLanguage(), document.text());
+    const CodeModel& model = parser.getCodeModel();
+    EXPECT_EQ(parser.getLineCount(), static_cast<int>(document.lines.size()));
+
+    ASSERT_EQ(model.getFunctions().size(), full.getFunctions().size()) << document.text();
+    for (size_t i = 0; i < full.getFunctions().size(); ++i) {
+        EXPECT_EQ(model.getFunctions()[i].qualifiedName, full.getFunctions()[i].qualifiedName);
+        EXPECT_EQ(model.getFunctions()[i].signature, full.getFunctions()[i].signature);
+        EXPECT_EQ(model.getFunctions()[i].lineNumber, full.getFunctions()[i].lineNumber);
+    }
+    ASSERT_EQ(model.getCalls().size(), full.getCalls().size());
+    for (size_t i = 0; i < full.getCalls().size(); ++i) {
+        EXPECT_EQ(model.getCalls()[i].callee, full.getCalls()[i].callee);
+        EXPECT_EQ(model.getCalls()[i].lineNumber, full.getCalls()[i].lineNumber);
+        EXPECT_EQ(model.getCalls()[i].callerIndex, full.getCalls()[i].callerIndex);
+    }
+
+    // Types come out per declaration, so only their set is the same
+    auto typeKeys = [](const CodeModel& m) {
+        std::vector<std::pair<int, std::string>> keys;
+        for (const CodeType& type : m.getTypes()) keys.emplace_back(type.lineNumber, type.name);
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+    EXPECT_EQ(typeKeys(model), typeKeys(full));
+    EXPECT_EQ(model.getCallGraph().edgeCount(), full.getCallGraph().edgeCount());
+}
+
+} // namespace
+
+TEST(IncrementalParserTest, MatchesFullParseAfterEdits) {
+    Document cpp(
+        "#include <vector>\n"
+        "namespace app {\n"
+        "\n"
+        "class Store : public Base {\n"
+        "public:\n"
+        "    int get(int id) { return find(id); }\n"
+        "};\n"
+        "\n"
+        "template <typename T>\n"
+        "T twice(T value) {\n"
+        "    return add(value, value);\n"
+        "}\n"
+        "\n"
+        "void run() {\n"
+        "    twice(1);\n"
+        "}\n"
+        "} // namespace app\n");
+    IncrementalParser parser;
+    parser.reset(SourceLanguage::Cpp, cpp.text());
+    expectSameAsFullParse(parser, cpp);
+    EXPECT_EQ(parser.getDeclarationLines(), (std::vector<int>{0, 1, 3, 8, 13, 16}));
+
+    cpp.edit(parser, 14, 1, "    twice(2);\n    log(\"{\");");
+    expectSameAsFullParse(parser, cpp);
+    // An unclosed brace swallows what follows until it is closed again
+    cpp.edit(parser, 10, 1, "    if (value) {");
+    expectSameAsFullParse(parser, cpp);
+    cpp.edit(parser, 10, 1, "    if (value) {} return mul(value);");
+    expectSameAsFullParse(parser, cpp);
+    cpp.edit(parser, 7, 1, "/* void hidden() {}");
+    expectSameAsFullParse(parser, cpp);
+    cpp.edit(parser, 7, 1, "void shown() { run(); }");
+    expectSameAsFullParse(parser, cpp);
+    cpp.edit(parser, 3, 4, "");
+    expectSameAsFullParse(parser, cpp);
+
+    // A declaration is dropped while another declaration defines it
+    Document declared(
+        "class Store {\n"
+        "public:\n"
+        "    int get(int);\n"
+        "    void put(int);\n"
+        "};\n"
+        "\n"
+        "int Store::get(int id) {\n"
+        "    return find(id);\n"
+        "}\n");
+    parser.reset(SourceLanguage::Cpp, declared.text());
+    expectSameAsFullParse(parser, declared);
+    EXPECT_EQ(parser.getCodeModel().getFunctions().size(), 2u);
+    declared.edit(parser, 6, 3, "");
+    expectSameAsFullParse(parser, declared);
+    EXPECT_EQ(parser.getCodeModel().getFunctions().size(), 2u);
+    declared.edit(parser, 6, 1, "int Store::get(int id) { return lookup(id); }");
+    expectSameAsFullParse(parser, declared);
+
+    // Pure insertions and removals, at the start, inside and at the end
+    declared.insert(parser, 0, "void first() {}\nvoid second() { first(); }");
+    expectSameAsFullParse(parser, declared);
+    declared.insert(parser, 6, "    int size();");
+    expectSameAsFullParse(parser, declared);
+    declared.insert(parser, static_cast<int>(declared.lines.size()), "void last() { second(); }");
+    expectSameAsFullParse(parser, declared);
+    declared.remove(parser, 0, 1);
+    expectSameAsFullParse(parser, declared);
+    declared.remove(parser, static_cast<int>(declared.lines.size()) - 1, 1);
+    expectSameAsFullParse(parser, declared);
+
+    Document python(
+        "import os\n"
+        "\n"
+        "@cached\n"
+        "def load(path):\n"
+        "    return read(path)\n"
+        "\n"
+        "class Loader(Base):\n"
+        "    def run(self):\n"
+        "        load(\"x\")\n"
+        "\n"
+        "TEXT = \"\"\"\n"
+        "def fake():\n"
+        "\"\"\"\n"
+        "if os.name:\n"
+        "    pass\n"
+        "else:\n"
+        "    pass\n");
+    parser.reset(SourceLanguage::Python, python.text());
+    expectSameAsFullParse(parser, python);
+    EXPECT_EQ(parser.getDeclarationLines(), (std::vector<int>{0, 2, 6, 10, 13}));
+
+    python.edit(parser, 4, 1, "    data = read(path)\n    return parse(data)");
+    expectSameAsFullParse(parser, python);
+    // Indenting a class moves it into the def above
+    python.edit(parser, 7, 1, "    class Loader(Base):");
+    expectSameAsFullParse(parser, python);
+    // The closing quotes now open a string that runs to the end
+    python.edit(parser, 11, 1, "def extra(): pass");
+    expectSameAsFullParse(parser, python);
+    python.edit(parser, 13, 1, "    helper()");
+    expectSameAsFullParse(parser, python);
+    python.edit(parser, 2, 1, "");
+    expectSameAsFullParse(parser, python);
+
+    Document go(
+        "package main\n"
+        "\n"
+        "import (\n"
+        "\t\"fmt\"\n"
+        ")\n"
+        "\n"
+        "type Store struct {\n"
+        "\titems []string\n"
+        "}\n"
+        "\n"
+        "func (s *Store) Get() string {\n"
+        "\treturn fmt.Sprint(s.items)\n"
+        "}\n"
+        "\n"
+        "var usage = `\n"
+        "func fake() {}\n"
+        "`\n"
+        "\n"
+        "func main() {\n"
+        "\tnew(Store).Get()\n"
+        "}\n");
+    parser.reset(SourceLanguage::Go, go.text());
+    expectSameAsFullParse(parser, go);
+    EXPECT_EQ(parser.getDeclarationLines(), (std::vector<int>{0, 2, 6, 10, 14, 18}));
+
+    go.edit(parser, 19, 1, "\tnew(Store).Get()\n\tfmt.Println(len(usage))");
+    expectSameAsFullParse(parser, go);
+    go.edit(parser, 16, 1, "");
+    expectSameAsFullParse(parser, go);
+    go.edit(parser, 16, 1, "`");
+    expectSameAsFullParse(parser, go);
+    go.edit(parser, 8, 1, "}\n\ntype Reader interface {\n\tRead() error\n}");
+    expectSameAsFullParse(parser, go);
+}
+
+TEST(IncrementalParserTest, ReparsesOnlyTheEditedDeclaration) {
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        text += "int f" + std::to_string(i) + "(int x) {\n    return g(x) + " + std::to_string(i) + ";\n}\n\n";
+    }
+    Document document(text);
+    IncrementalParser parser;
+    EXPECT_FALSE(parser.update(0, 1, 1, [](int, int) { return std::string(); }));
+    parser.reset(SourceLanguage::Cpp, document.text());
+    EXPECT_EQ(parser.getLastParsedLineCount(), 2001);
+    EXPECT_EQ(parser.getDeclarationCount(), 500u);
+
+    // Typing inside f250 reads its four lines, and the line after them
+    document.edit(parser, 1001, 1, "    return g(x) + h(x);");
+    EXPECT_EQ(parser.getLastParsedLineCount(), 4);
+    EXPECT_EQ(parser.getCodeModel().getCallGraph().calleeNames("f250"),
+              (std::vector<std::string>{"g", "h"}));
+
+    // A new line at the top moves every declaration below without reparsing it
+    document.edit(parser, 0, 1, "// header\nint f0(int x) {");
+    EXPECT_EQ(parser.getLastParsedLineCount(), 5);
+    EXPECT_EQ(parser.getCodeModel().getFunctions().back().lineNumber, 1998);
+    expectSameAsFullParse(parser, document);
+
+    parser.clear();
+    EXPECT_FALSE(parser.isLoaded());
+    EXPECT_TRUE(parser.getCodeModel().getFunctions().empty());
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "project_indexer.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream output(path, std::ios::binary);
+    output << content;
+}
+
+} // namespace
+
+TEST(ProjectIndexerTest, IndexesSupportedFilesInParallel) {
+    std::filesystem::path root = testing::TempDir() + "nexus_project_index";
+    std::filesystem::remove_all(root);
+    writeFile(root / "src/store.cpp", "int load(int id) { return id; }\nvoid save() { load(1); }\n");
+    writeFile(root / "src/store.h", "int load(int id);\n");
+    writeFile(root / "tools/gen.py", "def load(path):\n    return open(path)\n");
+    writeFile(root / "cmd/main.go", "package main\n\nfunc main() {\n\tload()\n}\n");
+    writeFile(root / "README.md", "# not code\n");
+    writeFile(root / "build/generated.cpp", "void skipped() {}\n");
+    writeFile(root / ".git/hook.py", "def skipped():\n    pass\n");
+    for (int i = 0; i < 40; ++i) {
+        writeFile(root / "gen" / ("f" + std::to_string(i) + ".go"),
+                  "package gen\n\nfunc F" + std::to_string(i) + "() {}\n");
+    }
+
+    ProjectIndexer indexer;
+    indexer.setThreadCount(4);
+    size_t lastDone = 0;
+    size_t lastTotal = 0;
+    indexer.setProgressCallback([&](size_t done, size_t total) {
+        lastDone = done;
+        lastTotal = total;
+        return true;
+    });
+    ASSERT_TRUE(indexer.indexProject(root.u8string())) << indexer.getErrorMessage();
+
+    const auto& files = indexer.getFiles();
+    ASSERT_EQ(files.size(), 44u);
+    EXPECT_EQ(lastDone, 44u);
+    EXPECT_EQ(lastTotal, 44u);
+    EXPECT_EQ(files[0].path, "cmd/main.go");
+    EXPECT_EQ(files[0].language, SourceLanguage::Go);
+    for (const auto& file : files) {
+        EXPECT_TRUE(file.parsed) << file.path;
+        EXPECT_EQ(file.path.find("skipped"), std::string::npos);
+    }
+
+    // The definition in the .cpp file and the declaration in the header
+    // both count, plus the Python function
+    const auto& loads = indexer.findFunctions("load");
+    ASSERT_EQ(loads.size(), 3u);
+    EXPECT_EQ(files[loads[0].file].path, "src/store.cpp");
+    EXPECT_EQ(files[loads[2].file].model.getFunctions()[loads[2].function].signature, "def load(path)");
+    EXPECT_EQ(indexer.findFunctions("skipped").size(), 0u);
+    EXPECT_EQ(indexer.findFunctions("F39").size(), 1u);
+    EXPECT_EQ(indexer.getFunctionCount(), 2u + 1u + 1u + 1u + 40u);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(ProjectIndexerTest, CancelsAndReportsMissingRoot) {
+    std::filesystem::path root = testing::TempDir() + "nexus_project_cancel";
+    std::filesystem::remove_all(root);
+    for (int i = 0; i < 20; ++i) {
+        writeFile(root / ("m" + std::to_string(i) + ".py"), "def f():\n    pass\n");
+    }
+
+    ProjectIndexer indexer;
+    indexer.setThreadCount(2);
+    indexer.setProgressCallback([](size_t, size_t) { return false; });
+    EXPECT_FALSE(indexer.indexProject(root.u8string()));
+    EXPECT_EQ(indexer.getErrorMessage(), "Indexing cancelled");
+
+    // The flag is seen while the directory is still being listed
+    std::atomic<bool> cancelled{true};
+    size_t progressCalls = 0;
+    indexer.setProgressCallback([&progressCalls](size_t, size_t) { return ++progressCalls > 0; });
+    indexer.setCancelFlag(&cancelled);
+    EXPECT_FALSE(indexer.indexProject(root.u8string()));
+    EXPECT_EQ(indexer.getErrorMessage(), "Indexing cancelled");
+    EXPECT_EQ(progressCalls, 0u);
+    EXPECT_TRUE(indexer.getFiles().empty());
+    indexer.setCancelFlag(nullptr);
+
+    indexer.setProgressCallback(nullptr);
+    EXPECT_FALSE(indexer.indexProject((root / "missing").u8string()));
+    EXPECT_TRUE(indexer.hasError());
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "python_parser.h"
+
+namespace {
+
+const PythonFunction* findFunction(const PythonParser& parser, const std::string& qualifiedName) {
+    for (const auto& func : parser.getFunctions()) {
+        if (func.qualifiedName == qualifiedName) return &func;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(PythonParserTest, AttachesMethodsDecoratorsAndDocstrings) {
+    const std::string source =
+        "import os\n"
+        "\n"
+        "@dataclass\n"
+        "class Store(Base, metaclass=Meta):\n"
+        "    '''Keeps items.\n"
+        "\n"
+        "    Second paragraph.\n"
+        "    '''\n"
+        "    limit: int = 10\n"
+        "\n"
+        "    def __init__(self, path: str,\n"
+        "                 items: dict[str, int] = None) -> None:\n"
+        "        self.path = path  # def fake(): pass\n"
+        "        self.items = load(path, \\\n"
+        "                          strict=True)\n"
+        "\n"
+        "    @staticmethod\n"
+        "    @cache.memoize(timeout=5)\n"
+        "    async def fetch(*args, **kwargs):\n"
+        "        \"\"\"Fetch.\"\"\"\n"
+        "        def helper(x): return os.path.join(x, \"\"\"\n"
+        "def not_a_function(): pass\n"
+        "\"\"\")\n"
+        "        return helper(args)\n"
+        "\n"
+        "def main():\n"
+        "    Store('db').fetch()\n";
+
+    PythonParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+
+    ASSERT_EQ(parser.getClasses().size(), 1u);
+    const PythonClass& store = parser.getClasses()[0];
+    EXPECT_EQ(store.name, "Store");
+    EXPECT_EQ(store.decorator, "dataclass");
+    EXPECT_EQ(store.baseClasses, std::vector<std::string>{"Base"});
+    EXPECT_EQ(store.docstring, "Keeps items.\n\nSecond paragraph.");
+    EXPECT_EQ(store.attributes, (std::vector<std::string>{"limit", "path", "items"}));
+    ASSERT_EQ(store.methods.size(), 2u);
+    EXPECT_EQ(store.methods[0].name, "__init__");
+    EXPECT_EQ(store.methods[1].calledFunctions, std::vector<std::string>{"helper"});
+
+    ASSERT_EQ(parser.getFunctions().size(), 4u);
+    EXPECT_EQ(findFunction(parser, "not_a_function"), nullptr);
+
+    const PythonFunction* init = findFunction(parser, "Store.__init__");
+    ASSERT_NE(init, nullptr);
+    EXPECT_EQ(init->className, "Store");
+    EXPECT_EQ(init->lineNumber, 11);
+    EXPECT_EQ(parser.getFunctionSignature(*init),
+              "def __init__(self, path: str, items: dict[str, int] = None) -> None");
+
+    const PythonFunction* fetch = findFunction(parser, "Store.fetch");
+    ASSERT_NE(fetch, nullptr);
+    EXPECT_TRUE(fetch->isAsync);
+    EXPECT_TRUE(fetch->isStaticMethod);
+    EXPECT_EQ(fetch->decorator, "staticmethod, cache.memoize");
+    EXPECT_EQ(fetch->docstring, "Fetch.");
+    EXPECT_EQ(parser.getFunctionSignature(*fetch), "async def fetch(*args, **kwargs)");
+
+    const PythonFunction* helper = findFunction(parser, "Store.fetch.<locals>.helper");
+    ASSERT_NE(helper, nullptr);
+    EXPECT_EQ(helper->className, "");
+
+    const PythonFunction* main = findFunction(parser, "main");
+    ASSERT_NE(main, nullptr);
+    EXPECT_EQ(main->lineNumber, 26);
+}
+
+TEST(PythonParserTest, RecordsCallSitesPerFunction) {
+    const std::string source =
+        "def outer(values):\n"
+        "    if check(values):\n"
+        "        def inner():\n"
+        "            return len(values) + compute()\n"
+        "        result = [transform(v) for v in values]\n"
+        "    self.log.info(\"done\")\n"
+        "    return result\n"
+        "run(outer)\n";
+
+    PythonParser parser;
+    ASSERT_TRUE(parser.parseFile(source));
+
+    EXPECT_EQ(parser.getCalledFunctions("outer"), (std::vector<std::string>{"check", "transform", "info"}));
+    EXPECT_EQ(parser.getCalledFunctions("inner"), std::vector<std::string>{"compute"});
+    EXPECT_EQ(parser.getCallingFunctions("compute"), std::vector<std::string>{"inner"});
+
+    const auto& sites = parser.getCallSites();
+    ASSERT_EQ(sites.size(), 4u);
+    EXPECT_EQ(sites[1].callee, "compute");
+    EXPECT_EQ(sites[1].callerIndex, 1u);
+    EXPECT_EQ(sites[1].lineNumber, 4);
+    EXPECT_EQ(sites[3].qualifier, "self.log");
+}
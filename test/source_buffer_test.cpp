@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "source_buffer.h"
+
+TEST(SourceBufferTest, IndexesLines) {
+    SourceBuffer source("first\r\nsecond\n\nlast");
+
+    EXPECT_EQ(source.lineCount(), 4u);
+    EXPECT_EQ(source.line(1), "first");
+    EXPECT_EQ(source.line(2), "second");
+    EXPECT_EQ(source.line(3), "");
+    EXPECT_EQ(source.line(4), "last");
+    EXPECT_EQ(source.line(5), "");
+
+    EXPECT_EQ(source.lineAt(0), 1);
+    EXPECT_EQ(source.lineAt(6), 1);  // '\n' of the "\r\n" break
+    EXPECT_EQ(source.lineAt(7), 2);
+    EXPECT_EQ(source.lineAt(14), 3);
+    EXPECT_EQ(source.lineAt(source.size() - 1), 4);
+    EXPECT_EQ(source.lineStart(4), 15u);
+
+    LineCursor cursor(source);
+    EXPECT_EQ(cursor.lineAt(2), 1);
+    EXPECT_EQ(cursor.lineAt(8), 2);
+    EXPECT_EQ(cursor.lineAt(16), 4);
+
+    SourceBuffer copy = source;
+    EXPECT_EQ(copy.text().data(), source.text().data());
+}
+
+TEST(SourceBufferTest, MasksCommentsAndLiterals) {
+    SourceBuffer cpp(
+        "#define TWICE(x) \\\n"
+        "    ((x) * 2)\n"
+        "int n = 1'000; // count\n"
+        "auto s = R\"x(a\n\"b)x\"; char c = '}';\n"
+        "/* block\n*/ f();");
+    SourceMask cppMask(cpp, SourceLanguage::Cpp);
+    const std::string& code = cppMask.code();
+
+    ASSERT_EQ(code.size(), cpp.size());
+    EXPECT_EQ(code.find("TWICE"), std::string::npos);
+    EXPECT_NE(code.find("int n = 1'000;"), std::string::npos);
+    EXPECT_EQ(code.find("count"), std::string::npos);
+    EXPECT_NE(code.find("R\"        \";"), std::string::npos);
+    EXPECT_NE(code.find("c = ' ';"), std::string::npos);
+    EXPECT_EQ(code.find('}'), std::string::npos);
+    EXPECT_NE(code.find("f();"), std::string::npos);
+    ASSERT_EQ(cppMask.comments().size(), 2u);
+    EXPECT_EQ(cpp.text().substr(cppMask.comments()[0].first, 8), "// count");
+
+    SourceBuffer python("x = '''a\n# b\n'''  # note\ny = \"#\"\n");
+    SourceMask pythonMask(python, SourceLanguage::Python);
+    EXPECT_EQ(pythonMask.code(), "x = '          '        \ny = \" \"\n");
+    ASSERT_EQ(pythonMask.comments().size(), 1u);
+
+    SourceBuffer go("s := `a\n// b`\n// doc\n");
+    SourceMask goMask(go, SourceLanguage::Go);
+    EXPECT_EQ(goMask.code(), "s := `      `\n      \n");
+    ASSERT_EQ(goMask.comments().size(), 1u);
+    EXPECT_EQ(go.lineAt(goMask.comments()[0].first), 3);
+}
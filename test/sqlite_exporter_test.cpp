@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "sqlite_exporter.h"
+#include <cstdio>
+#include <sqlite3.h>
+#include <sstream>
+
+namespace {
+
+// Runs a query and returns its rows as "a|b|c" strings, NULL as "<null>"
+std::vector<std::string> query(const std::string& databasePath, const std::string& sql) {
+    std::vector<std::string> rows;
+    sqlite3* db = nullptr;
+    sqlite3_open(databasePath.c_str(), &db);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string row;
+            for (int i = 0; i < sqlite3_column_count(stmt); ++i) {
+                if (i > 0) row += '|';
+                const unsigned char* text = sqlite3_column_text(stmt, i);
+                row += text ? reinterpret_cast<const char*>(text) : "<null>";
+            }
+            rows.push_back(row);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return rows;
+}
+
+void removeDatabase(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+} // namespace
+
+TEST(SqliteExporterTest, ShredsRecordsIntoTables) {
+    std::string path = testing::TempDir() + "nexus_shred.db";
+    removeDatabase(path);
+
+    std::istringstream input(
+        "<library>"
+        "<book id=\"1\"><title>Dune</title><tag>sf</tag><tag>classic</tag></book>"
+        "<author name=\"Herbert\"/>"
+        "<book id=\"2\" lang=\"en\"><title>Emma</title><Title>dup</Title></book>"
+        "</library>");
+
+    SqliteExporter exporter;
+    exporter.setBatchSize(1);  // force several transactions
+    ASSERT_TRUE(exporter.exportStream(input, path)) << exporter.getErrorMessage();
+    EXPECT_EQ(exporter.getRecordCount(), 3u);
+    EXPECT_EQ(exporter.getTableCount(), 2u);
+
+    // "lang" and "Title" appear only in the second book and are added on the fly;
+    // "Title" clashes with "title" in SQLite and gets a suffix
+    EXPECT_EQ(query(path, "SELECT _id, \"@id\", title, tag, \"@lang\", Title_2 FROM book ORDER BY _id"),
+              (std::vector<std::string>{"1|1|Dune|sf; classic|<null>|<null>",
+                                        "2|2|Emma|<null>|en|dup"}));
+    EXPECT_EQ(query(path, "SELECT \"@name\" FROM author"), std::vector<std::string>{"Herbert"});
+    EXPECT_EQ(query(path, "PRAGMA journal_mode"), std::vector<std::string>{"wal"});
+    removeDatabase(path);
+}
+
+TEST(SqliteExporterTest, ReplacesOrAppendsExistingTables) {
+    std::string path = testing::TempDir() + "nexus_append.db";
+    removeDatabase(path);
+
+    SqliteExporter exporter;
+    for (int i = 0; i < 2; ++i) {
+        std::istringstream input("<rows><row a=\"1\"/><row a=\"2\"/></rows>");
+        ASSERT_TRUE(exporter.exportStream(input, path));
+    }
+    EXPECT_EQ(query(path, "SELECT COUNT(*) FROM row"), std::vector<std::string>{"2"});
+
+    exporter.setReplaceTables(false);
+    std::istringstream more("<rows><row a=\"3\" b=\"x\"/></rows>");
+    ASSERT_TRUE(exporter.exportStream(more, path)) << exporter.getErrorMessage();
+    EXPECT_EQ(query(path, "SELECT \"@a\", \"@b\" FROM row ORDER BY _id"),
+              (std::vector<std::string>{"1|<null>", "2|<null>", "3|x"}));
+    removeDatabase(path);
+}
+
+TEST(SqliteExporterTest, RollsBackTheOpenBatchOnError) {
+    std::string path = testing::TempDir() + "nexus_broken.db";
+    removeDatabase(path);
+
+    std::istringstream input("<rows><row a=\"1\"/><row a=\"2\"/><row a=\"3\"></rows>");
+    SqliteExporter exporter;
+    exporter.setBatchSize(2);
+    EXPECT_FALSE(exporter.exportStream(input, path));
+    EXPECT_TRUE(exporter.hasError());
+    EXPECT_EQ(query(path, "SELECT COUNT(*) FROM row"), std::vector<std::string>{"2"});
+    removeDatabase(path);
+}
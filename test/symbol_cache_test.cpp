@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "symbol_cache.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream output(path, std::ios::binary);
+    output << content;
+}
+
+} // namespace
+
+TEST(SymbolCacheTest, RoundTripsCodeModels) {
+    std::filesystem::path root = testing::TempDir() + "nexus_symbol_cache";
+    std::filesystem::remove_all(root);
+    writeFile(root / "store.cpp",
+              "class Store : public Base {\npublic:\n    int get(int id, int fallback = 0);\n};\n"
+              "int Store::get(int id, int fallback) { return find(id); }\n");
+    writeFile(root / "main.go", "package main\n\nfunc (s *Store) Get() error {\n\treturn load()\n}\n");
+    std::string cachePath = (root / "cache" / "index.nxsym").u8string();
+
+    ProjectIndexer indexer;
+    ASSERT_TRUE(indexer.indexProject(root.u8string())) << indexer.getErrorMessage();
+    SymbolCache cache;
+    ASSERT_TRUE(cache.save(cachePath, indexer.getFiles())) << cache.getErrorMessage();
+
+    ASSERT_TRUE(cache.load(cachePath)) << cache.getErrorMessage();
+    ASSERT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find("missing.cpp"), nullptr);
+    for (const IndexedFile& original : indexer.getFiles()) {
+        const SymbolCache::Entry* loaded = cache.find(original.path);
+        ASSERT_NE(loaded, nullptr) << original.path;
+        EXPECT_EQ(loaded->language, original.language);
+        EXPECT_EQ(loaded->size, original.size);
+        EXPECT_EQ(loaded->modifiedTime, original.modifiedTime);
+        EXPECT_EQ(loaded->contentHash, original.contentHash);
+        CodeModel model;
+        ASSERT_TRUE(cache.readModel(*loaded, model));
+        EXPECT_EQ(model.getLanguage(), original.language);
+        const auto& functions = original.model.getFunctions();
+        ASSERT_EQ(model.getFunctions().size(), functions.size());
+        for (size_t i = 0; i < functions.size(); ++i) {
+            const CodeFunction& function = model.getFunctions()[i];
+            EXPECT_EQ(function.qualifiedName, functions[i].qualifiedName);
+            EXPECT_EQ(function.signature, functions[i].signature);
+            EXPECT_EQ(function.lineNumber, functions[i].lineNumber);
+            ASSERT_EQ(function.parameters.size(), functions[i].parameters.size());
+        }
+        EXPECT_EQ(model.getCalls().size(), original.model.getCalls().size());
+        EXPECT_EQ(model.getFunctionCalls(), original.model.getFunctionCalls());
+    }
+    CodeModel store;
+    ASSERT_TRUE(cache.readModel(*cache.find("store.cpp"), store));
+    ASSERT_EQ(store.getTypes().size(), 1u);
+    EXPECT_EQ(store.getTypes()[0].baseTypes, std::vector<std::string>{"Base"});
+    EXPECT_EQ(store.getCallGraph().calleeNames("Store::get"), std::vector<std::string>{"find"});
+
+    // A missing file is an empty cache, a damaged one an error
+    EXPECT_TRUE(cache.load((root / "none.nxsym").u8string()));
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(cache.load(root.u8string()));
+    std::string header = "NXSYM003";
+    header.append(8, '\xff');
+    header.append(8, '\0');
+    writeFile(root / "huge.nxsym", header);
+    EXPECT_FALSE(cache.load((root / "huge.nxsym").u8string()));
+    std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 3);
+    EXPECT_FALSE(cache.load(cachePath));
+    EXPECT_TRUE(cache.hasError());
+
+    EXPECT_NE(SymbolCache::hashContent("abcdefghi", 9), SymbolCache::hashContent("abcdefghj", 9));
+    EXPECT_NE(SymbolCache::hashContent("", 0), SymbolCache::hashContent("\0", 1));
+
+    std::filesystem::remove_all(root);
+}
+
+#ifndef _WIN32
+TEST(SymbolCacheTest, DefaultPathIsPerUser) {
+    const char* xdgCache = std::getenv("XDG_CACHE_HOME");
+    std::string saved = xdgCache ? xdgCache : "";
+    std::filesystem::path base = std::filesystem::absolute(testing::TempDir() + "nexus_xdg_cache");
+    setenv("XDG_CACHE_HOME", base.u8string().c_str(), 1);
+    std::filesystem::path path = std::filesystem::u8path(SymbolCache::defaultCachePath("/work/project"));
+    EXPECT_EQ(path.parent_path(), base / "nexus" / "index");
+    EXPECT_EQ(path.filename().u8string().rfind("project-", 0), 0u);
+    EXPECT_EQ(path.extension(), ".nxsym");
+    if (xdgCache) {
+        setenv("XDG_CACHE_HOME", saved.c_str(), 1);
+    } else {
+        unsetenv("XDG_CACHE_HOME");
+    }
+}
+#endif
+
+TEST(SymbolCacheTest, IndexerReparsesOnlyChangedFiles) {
+    std::filesystem::path root = testing::TempDir() + "nexus_symbol_reuse";
+    std::filesystem::remove_all(root);
+    writeFile(root / "a.py", "def alpha():\n    pass\n");
+    writeFile(root / "b.py", "def beta():\n    pass\n");
+    writeFile(root / "c.go", "package c\n\nfunc Gamma() {}\n");
+    std::string cachePath = (root / "cache.nxsym").u8string();
+
+    ProjectIndexer first;
+    first.setCachePath(cachePath);
+    ASSERT_TRUE(first.indexProject(root.u8string())) << first.getErrorMessage();
+    EXPECT_EQ(first.getReusedFileCount(), 0u);
+    ASSERT_TRUE(std::filesystem::exists(cachePath));
+
+    ProjectIndexer warm;
+    warm.setCachePath(cachePath);
+    ASSERT_TRUE(warm.indexProject(root.u8string())) << warm.getErrorMessage();
+    EXPECT_EQ(warm.getReusedFileCount(), 3u);
+    EXPECT_EQ(warm.findFunctions("Gamma").size(), 1u);
+
+    // b.py changes; a.py only gets a new time and is reused via its hash
+    writeFile(root / "b.py", "def beta2():\n    pass\n");
+    auto touched = std::filesystem::last_write_time(root / "a.py") + std::chrono::seconds(5);
+    std::filesystem::last_write_time(root / "a.py", touched);
+
+    ProjectIndexer edited;
+    edited.setCachePath(cachePath);
+    size_t firstProgress = 0;
+    edited.setProgressCallback([&](size_t done, size_t) {
+        if (firstProgress == 0) firstProgress = done;
+        return true;
+    });
+    ASSERT_TRUE(edited.indexProject(root.u8string())) << edited.getErrorMessage();
+    EXPECT_EQ(edited.getReusedFileCount(), 2u);
+    EXPECT_EQ(firstProgress, 2u);  // c.go was counted before any file was read
+    EXPECT_EQ(edited.findFunctions("beta").size(), 0u);
+    EXPECT_EQ(edited.findFunctions("beta2").size(), 1u);
+    EXPECT_EQ(edited.findFunctions("alpha").size(), 1u);
+
+    // The cache was rewritten with the new time, so a.py is now trusted
+    ProjectIndexer again;
+    again.setCachePath(cachePath);
+    ASSERT_TRUE(again.indexProject(root.u8string()));
+    EXPECT_EQ(again.getReusedFileCount(), 3u);
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "symbol_table.h"
+#include "cpp_parser.h"
+#include "project_indexer.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream output(path, std::ios::binary);
+    output << content;
+}
+
+// "path name" of the definition the nth call of callee in file resolves to,
+// "" when it does not resolve
+std::string resolveCall(const SymbolTable& table, uint32_t file, const CodeModel& model,
+                        const std::string& callee, size_t nth = 0) {
+    for (const CodeCall& call : model.getCalls()) {
+        if (call.callee != callee || nth-- > 0) continue;
+        SymbolLocation target;
+        if (!table.resolve(file, call, target)) return "";
+        return table.getPath(target.file) + " " + table.getSymbolName(target);
+    }
+    return "no such call";
+}
+
+} // namespace
+
+TEST(SymbolTableTest, ResolvesCppCallsAcrossFilesAndClasses) {
+    const std::vector<std::pair<std::string, std::string>> sources = {
+        {"src/store.h",
+         "class Store {\npublic:\n    int get(int id);\n    int get(int id, int fallback);\n};\n"
+         "class Cache : public Base {\npublic:\n    int get(int id);\n    void warm();\n};\n"},
+        {"src/store.cpp",
+         "int Store::get(int id) { return load(id); }\n"
+         "int Store::get(int id, int fallback) { return get(id) + fallback; }\n"
+         "void Cache::warm() { get(1); this->get(2); flush(); }\n"
+         "int Cache::get(int id) { return id; }\n"},
+        {"src/util.cpp", "int load(int id) { return id; }\nvoid Base::flush() {}\n"},
+        {"app/main.cpp",
+         "void run(Store& store, Cache* cache) {\n"
+         "    store.get(1, 2);\n    Store::get(3);\n    cache->warm();\n    load(4);\n    helper();\n}\n"},
+    };
+    std::vector<CodeModel> models;
+    for (const auto& source : sources) {
+        CppParser parser;
+        ASSERT_TRUE(parser.parseFile(source.second));
+        models.push_back(parser.getCodeModel());
+    }
+    SymbolTable table;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        EXPECT_EQ(table.addFile(sources[i].first, models[i]), i);
+    }
+
+    // Free functions are found in any file, overloads by argument count
+    EXPECT_EQ(resolveCall(table, 1, models[1], "load"), "src/util.cpp load");
+    EXPECT_EQ(resolveCall(table, 1, models[1], "get"), "src/store.cpp Store::get(int)");
+    // Methods of the caller's class and its bases come first, with or without this->
+    EXPECT_EQ(resolveCall(table, 1, models[1], "get", 1), "src/store.cpp Cache::get");
+    EXPECT_EQ(resolveCall(table, 1, models[1], "get", 2), "src/store.cpp Cache::get");
+    EXPECT_EQ(resolveCall(table, 1, models[1], "flush"), "src/util.cpp Base::flush");
+
+    // Objects are not typed: get() is a method of two classes, warm() of one.
+    // From another directory the declaration, added first, is as near as the
+    // definition and shares its name.
+    EXPECT_EQ(resolveCall(table, 3, models[3], "get"), "");
+    EXPECT_EQ(resolveCall(table, 3, models[3], "get", 1), "src/store.h Store::get(int)");
+    EXPECT_EQ(resolveCall(table, 3, models[3], "warm"), "src/store.h Cache::warm");
+    EXPECT_EQ(resolveCall(table, 3, models[3], "helper"), "");
+
+    EXPECT_EQ(table.findFunctions("get").size(), 6u);
+    EXPECT_EQ(table.findQualified("Cache::get").size(), 2u);
+    EXPECT_EQ(SymbolTable::hashName({"Store", "::", "get"}), SymbolTable::hashName({"Store::get"}));
+
+    // Within one file, same-named methods are separate graph nodes
+    const CallGraph& graph = models[1].getCallGraph();
+    EXPECT_EQ(graph.calleeNames("Cache::warm"), (std::vector<std::string>{"Cache::get", "flush"}));
+    EXPECT_EQ(graph.calleeNames("Store::get(int, int)"), std::vector<std::string>{"Store::get(int)"});
+    EXPECT_EQ(models[3].getCallGraph().calleeNames("run"),
+              (std::vector<std::string>{"store.get", "Store::get", "cache->warm", "load", "helper"}));
+}
+
+TEST(SymbolTableTest, ResolvesPythonAndGoImports) {
+    std::filesystem::path root = testing::TempDir() + "nexus_symbol_table";
+    std::filesystem::remove_all(root);
+    writeFile(root / "pkg/store.py",
+              "def load(path):\n    return path\n\n"
+              "class Store:\n    def get(self, key):\n        return self.fetch(key)\n\n"
+              "    def fetch(self, key):\n        return load(key)\n");
+    writeFile(root / "pkg/other.py", "def load(path):\n    return None\n");
+    writeFile(root / "app/main.py",
+              "import os\nfrom pkg.store import load as read_file\nimport pkg.other as other\nfrom pkg import store\n\n"
+              "def main():\n    def helper():\n        return read_file('a')\n"
+              "    helper()\n    other.load('b')\n    store.load('c')\n    os.path.join('d')\n");
+    writeFile(root / "internal/store/store.go",
+              "package store\n\ntype Store struct{}\n\n"
+              "func (s *Store) Get() string {\n\treturn s.load()\n}\n\n"
+              "func (s *Store) load() string {\n\treturn format()\n}\n\n"
+              "func Open() *Store {\n\treturn &Store{}\n}\n");
+    writeFile(root / "internal/store/format.go", "package store\n\nfunc format() string {\n\treturn \"\"\n}\n");
+    // Another Store type: its package has neither load() nor format()
+    writeFile(root / "internal/cache/cache.go",
+              "package cache\n\ntype Store struct{}\n\nfunc (s *Store) Flush() {\n\ts.load()\n\tformat()\n}\n");
+    writeFile(root / "cmd/app/main.go",
+              "package main\n\nimport (\n\t\"fmt\"\n\tst \"example.com/app/internal/store\"\n)\n\n"
+              "func main() {\n\ts := st.Open()\n\tfmt.Println(s.Get())\n}\n");
+
+    ProjectIndexer indexer;
+    ASSERT_TRUE(indexer.indexProject(root.u8string())) << indexer.getErrorMessage();
+    const SymbolTable& table = indexer.getSymbolTable();
+    const auto& files = indexer.getFiles();
+    auto fileIndex = [&](const std::string& path) {
+        for (uint32_t i = 0; i < files.size(); ++i) {
+            if (files[i].path == path) return i;
+        }
+        return UINT32_MAX;
+    };
+    uint32_t mainPy = fileIndex("app/main.py");
+    uint32_t storePy = fileIndex("pkg/store.py");
+    uint32_t storeGo = fileIndex("internal/store/store.go");
+    uint32_t mainGo = fileIndex("cmd/app/main.go");
+    uint32_t cacheGo = fileIndex("internal/cache/cache.go");
+    ASSERT_LT(mainGo, files.size());
+    ASSERT_LT(cacheGo, files.size());
+
+    EXPECT_EQ(files[mainPy].model.getImports().size(), 4u);
+    EXPECT_EQ(resolveCall(table, storePy, files[storePy].model, "fetch"), "pkg/store.py pkg.store.Store.fetch");
+    EXPECT_EQ(resolveCall(table, storePy, files[storePy].model, "load"), "pkg/store.py pkg.store.load");
+    const CodeModel& main = files[mainPy].model;
+    EXPECT_EQ(resolveCall(table, mainPy, main, "helper"), "app/main.py app.main.main.<locals>.helper");
+    EXPECT_EQ(resolveCall(table, mainPy, main, "read_file"), "pkg/store.py pkg.store.load");
+    EXPECT_EQ(resolveCall(table, mainPy, main, "load"), "pkg/other.py pkg.other.load");
+    EXPECT_EQ(resolveCall(table, mainPy, main, "load", 1), "pkg/store.py pkg.store.load");
+    EXPECT_EQ(resolveCall(table, mainPy, main, "join"), "");
+
+    EXPECT_EQ(resolveCall(table, storeGo, files[storeGo].model, "load"),
+              "internal/store/store.go internal/store.(*Store).load");
+    EXPECT_EQ(resolveCall(table, storeGo, files[storeGo].model, "format"),
+              "internal/store/format.go internal/store.format");
+    EXPECT_EQ(resolveCall(table, mainGo, files[mainGo].model, "Open"),
+              "internal/store/store.go internal/store.Open");
+    EXPECT_EQ(resolveCall(table, mainGo, files[mainGo].model, "Get"),
+              "internal/store/store.go internal/store.(*Store).Get");
+    EXPECT_EQ(resolveCall(table, cacheGo, files[cacheGo].model, "load"), "");
+    EXPECT_EQ(resolveCall(table, cacheGo, files[cacheGo].model, "format"), "");
+
+    // The project graph links callers to callees in other files
+    const CallGraph& graph = indexer.getCallGraph();
+    EXPECT_EQ(graph.calleeNames("cmd/app.main"),
+              (std::vector<std::string>{"internal/store.(*Store).Get", "internal/store.Open", "fmt.Println"}));
+    EXPECT_EQ(graph.callerNames("pkg.store.load"),
+              (std::vector<std::string>{"app.main.main", "app.main.main.<locals>.helper", "pkg.store.Store.fetch"}));
+    EXPECT_EQ(indexer.getCallCount(), 14u);
+    EXPECT_EQ(indexer.getResolvedCallCount(), 10u);  // Not os.path.join, fmt.Println and the two in cache.go
+
+    std::filesystem::remove_all(root);
+}
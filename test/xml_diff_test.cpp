@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "xml_diff.h"
+#include "xml_parser.h"
+
+class XmlDiffTest : public ::testing::Test {
+protected:
+    std::shared_ptr<XmlNode> parse(const std::string& xml) {
+        auto node = parser_.parseString(xml);
+        EXPECT_NE(node, nullptr) << parser_.getErrorMessage();
+        return node;
+    }
+
+    XmlParser parser_;
+    XmlDiff diff_;
+};
+
+TEST_F(XmlDiffTest, IdenticalTreesHaveNoEdits) {
+    const std::string xml = "<root a=\"1\"><item id=\"1\">x</item><!-- c --><item id=\"2\"/></root>";
+    ASSERT_TRUE(diff_.diff(parse(xml), parse(xml)));
+    EXPECT_TRUE(diff_.isIdentical());
+    EXPECT_EQ(diff_.getComparedCount(), 1u);
+    EXPECT_EQ(diff_.getSkippedCount(), 1u);
+}
+
+TEST_F(XmlDiffTest, ReportsValueAndAttributeChanges) {
+    ASSERT_TRUE(diff_.diff(parse("<root><a x=\"1\" y=\"2\">old</a><b/></root>"),
+                           parse("<root><a x=\"1\" y=\"3\" z=\"4\">new</a><b/></root>")));
+    EXPECT_EQ(diff_.toScript(),
+              "~ /root/a[1]/@y: \"2\" -> \"3\"\n"
+              "+ /root/a[1]/@z = \"4\"\n"
+              "~ /root/a[1]/text()[1]: \"old\" -> \"new\"\n");
+}
+
+TEST_F(XmlDiffTest, MatchesInsertsDeletesAndMoves) {
+    std::string oldXml = "<list>";
+    std::string newXml = "<list>";
+    for (int i = 0; i < 1000; ++i) {
+        // Record 10 is removed, 500 moves to the front, 999 gets a new sibling
+        const std::string record = "<rec id=\"" + std::to_string(i) + "\"><v>" + std::to_string(i) + "</v></rec>";
+        oldXml += record;
+        if (i != 10 && i != 500) newXml += record;
+        if (i == 999) newXml += "<rec id=\"new\"/>";
+    }
+    newXml.insert(6, "<rec id=\"500\"><v>500</v></rec>");
+    oldXml += "</list>";
+    newXml += "</list>";
+
+    ASSERT_TRUE(diff_.diff(parse(oldXml), parse(newXml)));
+    EXPECT_EQ(diff_.toScript(),
+              "- /list/rec[11]\n"
+              "> /list/rec[501] -> /list/rec[1]\n"
+              "+ /list/rec[1000]\n");
+    const auto& edits = diff_.getEdits();
+    ASSERT_EQ(edits.size(), 3u);
+    EXPECT_EQ(edits[0].type, XmlDiff::Edit::Type::Delete);
+    EXPECT_EQ(edits[0].oldNode->getAttribute("id"), "10");
+    EXPECT_EQ(edits[1].type, XmlDiff::Edit::Type::Move);
+    EXPECT_EQ(edits[1].oldNode->getAttribute("id"), "500");
+    EXPECT_EQ(edits[1].newPath, "/list/rec[1]");
+    EXPECT_EQ(edits[2].type, XmlDiff::Edit::Type::Insert);
+    EXPECT_EQ(edits[2].newNode->getAttribute("id"), "new");
+    // Only the differing middle of the list is looked at
+    EXPECT_LT(diff_.getComparedCount(), 10u);
+}
+
+TEST_F(XmlDiffTest, DetectsMovesAcrossParents) {
+    ASSERT_TRUE(diff_.diff(parse("<r><a><x k=\"1\"><y/></x></a><b/></r>"),
+                           parse("<r><a/><b><x k=\"1\"><y/></x></b></r>")));
+    ASSERT_EQ(diff_.getEdits().size(), 1u);
+    EXPECT_EQ(diff_.toScript(), "> /r/a[1]/x[1] -> /r/b[1]/x[1]\n");
+}
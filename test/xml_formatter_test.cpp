@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "xml_formatter.h"
+
+TEST(XmlFormatterTest, IndentsMinifiedXml) {
+    XmlFormatter formatter;
+    std::string output;
+    ASSERT_TRUE(formatter.formatString(
+        "<?xml version=\"1.0\"?><root a='1'><!-- note --><item><name>x &amp; y</name></item><empty/><e></e></root>",
+        output)) << formatter.getErrorMessage();
+
+    EXPECT_EQ(output,
+              "<?xml version=\"1.0\"?>\n"
+              "<root a='1'>\n"
+              "  <!-- note -->\n"
+              "  <item>\n"
+              "    <name>x &amp; y</name>\n"
+              "  </item>\n"
+              "  <empty/>\n"
+              "  <e></e>\n"
+              "</root>\n");
+}
+
+TEST(XmlFormatterTest, PreservesMixedContentAndCData) {
+    const std::string xml =
+        "<doc>\n"
+        "      <p>Some <b>bold</b>  and\n   <i>italic</i> text</p>\n"
+        "<p><b>a</b> <i>b</i></p>"
+        "<code><![CDATA[  x < y  ]]></code>"
+        "</doc>";
+
+    XmlFormatter::Options options;
+    options.useTabs = true;
+    XmlFormatter formatter(options);
+    std::string output;
+    ASSERT_TRUE(formatter.formatString(xml, output));
+
+    EXPECT_EQ(output,
+              "<doc>\n"
+              "\t<p>Some <b>bold</b>  and\n   <i>italic</i> text</p>\n"
+              "\t<p><b>a</b> <i>b</i></p>\n"
+              "\t<code><![CDATA[  x < y  ]]></code>\n"
+              "</doc>\n");
+}
+
+TEST(XmlFormatterTest, MinifiesAndRoundTrips) {
+    const std::string pretty =
+        "<root>\n"
+        "  <!-- keep -->\n"
+        "  <item id=\"1\">\n"
+        "    <name>A  B</name>\n"
+        "  </item>\n"
+        "</root>\n";
+
+    XmlFormatter::Options options;
+    options.mode = XmlFormatter::Mode::Minify;
+    XmlFormatter minifier(options);
+    std::string minified;
+    ASSERT_TRUE(minifier.formatString(pretty, minified));
+    EXPECT_EQ(minified, "<root><!-- keep --><item id=\"1\"><name>A  B</name></item></root>");
+
+    XmlFormatter formatter;
+    std::string restored;
+    ASSERT_TRUE(formatter.formatString(minified, restored));
+    EXPECT_EQ(restored, pretty);
+}
+
+TEST(XmlFormatterTest, FormatsElementsLargerThanTheLookahead) {
+    // The root is far larger than the lookahead window and is still reindented
+    std::string xml = "<rows>";
+    std::string expected = "<rows>\n";
+    while (xml.size() < 3 * XmlFormatter::kLookaheadBytes) {
+        xml += "<row><v>1</v></row>";
+        expected += "  <row>\n    <v>1</v>\n  </row>\n";
+    }
+    xml += "</rows>";
+    expected += "</rows>\n";
+
+    XmlFormatter formatter;
+    std::string output;
+    ASSERT_TRUE(formatter.formatString(xml, output));
+    EXPECT_EQ(output, expected);
+}
+
+TEST(XmlFormatterTest, ReportsMalformedInput) {
+    XmlFormatter formatter;
+    std::string output = "unchanged";
+    EXPECT_FALSE(formatter.formatString("<root><a></b></root>", output));
+    EXPECT_TRUE(formatter.hasError());
+    EXPECT_EQ(output, "unchanged");
+}
@@ -186,4 +186,44 @@ TEST_F(XmlParserTest, FindChild) {
     
     auto notFound = node->findChild("nonexistent");
     EXPECT_EQ(notFound, nullptr);
-} 
\ No newline at end of file
+} 
+
+TEST_F(XmlParserTest, SubtreeHashesTrackMutations) {
+    std::string xml = "<root><a x=\"1\"><b>t</b></a><a x=\"1\"><b>t</b></a><c/></root>";
+    auto node = parser_.parseString(xml);
+    ASSERT_NE(node, nullptr);
+
+    auto first = node->getChildren()[0];
+    auto second = node->getChildren()[1];
+    EXPECT_TRUE(first->contentEquals(*second));
+    EXPECT_FALSE(first->contentEquals(*node->getChildren()[2]));
+    EXPECT_TRUE(node->contentEquals(*parser_.parseString(xml)));
+
+    const uint64_t rootHash = node->getHash();
+    const uint64_t siblingHash = second->getHash();
+    first->getChildren()[0]->addAttribute("y", "2");
+    EXPECT_TRUE(node->changedSince(rootHash));
+    EXPECT_FALSE(first->contentEquals(*second));
+    EXPECT_FALSE(second->changedSince(siblingHash));
+
+    second->getChildren()[0]->addAttribute("y", "2");
+    EXPECT_TRUE(first->contentEquals(*second));
+    EXPECT_TRUE(second->changedSince(siblingHash));
+}
+
+TEST_F(XmlParserTest, FindsDuplicateSubtrees) {
+    auto node = parser_.parseString(
+        "<root><p><q>1</q></p><p><q>1</q></p><p><q>2</q></p><r><q>2</q></r></root>");
+    ASSERT_NE(node, nullptr);
+
+    // <p><q>1</q></p> twice; <q>2</q> twice under different parents. The two
+    // <q>1</q> are implied by their parents and not reported
+    auto groups = node->findDuplicateSubtrees();
+    ASSERT_EQ(groups.size(), 2u);
+    for (const auto& group : groups) {
+        ASSERT_EQ(group.size(), 2u);
+        EXPECT_TRUE(group[0]->contentEquals(*group[1]));
+    }
+    EXPECT_EQ(groups[0].front()->getName(), "p");
+    EXPECT_EQ(groups[1].front()->getName(), "q");
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "xml_pipeline.h"
+#include <sstream>
+
+namespace {
+
+const char* const kCatalog =
+    "<catalog>\n"
+    "  <book id=\"1\"><title>Alpha</title><price>8.5</price></book>\n"
+    "  <book id=\"2\"><title>Beta \"2\"</title><price>12</price></book>\n"
+    "  <magazine id=\"3\"><title>Gamma</title><price>30</price></magazine>\n"
+    "  <book id=\"4\"><title>Delta</title><price>100</price></book>\n"
+    "</catalog>\n";
+
+} // namespace
+
+TEST(XmlPipelineTest, FiltersProjectsAndRenames) {
+    XmlPipeline pipeline;
+    pipeline.records("book")
+        .where("price", XmlPipeline::Comparison::Greater, "9")
+        .project({"@id", "title"})
+        .rename("@id", "id");
+
+    std::istringstream input(kCatalog);
+    std::ostringstream output;
+    ASSERT_TRUE(pipeline.run(input, output, XmlSerializer::Format::CSV)) << pipeline.getErrorMessage();
+    // 12 and 100 compare as numbers, not as text
+    EXPECT_EQ(output.str(), "\"id\",\"title\"\n\"2\",\"Beta \"\"2\"\"\"\n\"4\",\"Delta\"\n");
+    EXPECT_EQ(pipeline.getRecordsRead(), 4u);
+    EXPECT_EQ(pipeline.getRecordsWritten(), 2u);
+}
+
+TEST(XmlPipelineTest, ParsesTextPipelines) {
+    XmlPipeline pipeline;
+    ASSERT_TRUE(pipeline.parse("where title ~ \"a\" | select title, price | rename title=name, name=label"
+                               " | map label upper | limit 2"));
+
+    std::istringstream input(kCatalog);
+    std::ostringstream output;
+    ASSERT_TRUE(pipeline.run(input, output, XmlSerializer::Format::JSON, XmlSerializer::OutputStyle::Compact));
+    EXPECT_EQ(output.str(), "[{\"label\":\"ALPHA\",\"price\":\"8.5\"},{\"label\":\"BETA \\\"2\\\"\",\"price\":\"12\"}]\n");
+
+    XmlPipeline invalid;
+    EXPECT_FALSE(invalid.parse("records book | sort title"));
+    EXPECT_TRUE(invalid.isEmpty());
+    EXPECT_FALSE(invalid.parse("where price >> 3"));
+}
+
+TEST(XmlPipelineTest, PreviewStopsAtTheLimit) {
+    XmlPipeline pipeline;
+    pipeline.where("@id", XmlPipeline::Comparison::NotEqual, "1");
+
+    // The document is never closed; the preview must not read that far
+    std::istringstream input("<catalog><book id=\"1\"/><book id=\"2\"/><book id=\"3\"/><book id=\"4\">");
+    auto records = pipeline.preview(input, 2);
+    EXPECT_FALSE(pipeline.hasError()) << pipeline.getErrorMessage();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(*records[0].field("@id"), "2");
+    EXPECT_EQ(*records[1].field("@id"), "3");
+    EXPECT_EQ(records[1].name, "book");
+
+    // The preview limit is not kept as a stage
+    std::istringstream full(kCatalog);
+    EXPECT_EQ(pipeline.preview(full, 10).size(), 3u);
+}
+
+TEST(XmlPipelineTest, DeliversRecordsInBatches) {
+    std::string xml = "<rows>";
+    for (size_t i = 0; i < XmlPipeline::kBatchSize * 2 + 5; ++i) {
+        xml += "<row n=\"" + std::to_string(i) + "\"/>";
+    }
+    xml += "</rows>";
+
+    XmlPipeline pipeline;
+    pipeline.map([](XmlPipeline::Record& record) { record.set("even", std::stoi(*record.field("@n")) % 2 ? "no" : "yes"); })
+        .where("even", XmlPipeline::Comparison::Equal, "yes");
+
+    std::vector<size_t> batchSizes;
+    std::istringstream input(xml);
+    ASSERT_TRUE(pipeline.run(input, [&batchSizes](const std::vector<XmlPipeline::Record>& batch) {
+        batchSizes.push_back(batch.size());
+        return true;
+    }));
+    ASSERT_EQ(batchSizes.size(), 2u);
+    EXPECT_EQ(batchSizes[0], XmlPipeline::kBatchSize);
+    EXPECT_EQ(batchSizes[1], 3u);
+}
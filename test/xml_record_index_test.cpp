@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "xml_record_index.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// Records nest an element with the record's own name, so chunks that guess
+// their first record from "<item" often start in the wrong place
+std::string makeXml(int records) {
+    std::string xml = "<?xml version=\"1.0\"?>\n<items>\n";
+    for (int i = 0; i < records; ++i) {
+        xml += "  <item id=\"k" + std::to_string(i % 1000) + "\" n='" + std::to_string(i) + "'>";
+        if (i % 3 == 0) {
+            xml += "<item nested=\"yes\"><item/></item>";
+        }
+        xml += "<!-- <item> -->value " + std::to_string(i) + "</item>\n";
+    }
+    xml += "</items>\n";
+    return xml;
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << content;
+}
+
+// Overwrites the 64-bit value at offset of a file
+void patchU64(const std::string& path, uint64_t offset, uint64_t value) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+TEST(XmlRecordIndexTest, SeeksToRecordsByOrdinalAndKey) {
+    std::string source = testing::TempDir() + "nexus_index.xml";
+    std::string index = source + ".nxidx";
+    writeFile(source, makeXml(5000));
+
+    XmlRecordIndex::Options options;
+    options.keyAttribute = "id";
+    options.stride = 64;
+    XmlRecordIndex recordIndex;
+    ASSERT_TRUE(recordIndex.build(source, index, options)) << recordIndex.getErrorMessage();
+    EXPECT_EQ(recordIndex.getRecordCount(), 5000u);
+
+    for (uint64_t ordinal : {0ull, 63ull, 64ull, 2500ull, 4999ull}) {
+        auto record = recordIndex.readRecord(ordinal);
+        ASSERT_NE(record, nullptr) << recordIndex.getErrorMessage();
+        EXPECT_EQ(record->getAttribute("n"), std::to_string(ordinal));
+    }
+    EXPECT_EQ(recordIndex.readRecord(5000), nullptr);
+
+    std::vector<uint64_t> matches = recordIndex.findByKey("k7");
+    ASSERT_EQ(matches.size(), 5u);
+    EXPECT_EQ(matches[0], 7u);
+    EXPECT_EQ(matches[4], 4007u);
+
+    // A second instance loads the saved index
+    XmlRecordIndex loaded;
+    ASSERT_TRUE(loaded.load(source, index)) << loaded.getErrorMessage();
+    EXPECT_EQ(loaded.getRecordCount(), 5000u);
+    EXPECT_EQ(loaded.getKeyAttribute(), "id");
+    std::string text;
+    ASSERT_TRUE(loaded.readRecordText(3, text));
+    EXPECT_EQ(text, "<item id=\"k3\" n='3'><item nested=\"yes\"><item/></item><!-- <item> -->value 3</item>");
+
+    std::remove(source.c_str());
+    std::remove(index.c_str());
+}
+
+TEST(XmlRecordIndexTest, ParallelBuildMatchesSequential) {
+    std::string source = testing::TempDir() + "nexus_index_parallel.xml";
+    writeFile(source, makeXml(60000));
+
+    XmlRecordIndex::Options options;
+    options.stride = 1;
+    options.threadCount = 1;
+    XmlRecordIndex sequential;
+    ASSERT_TRUE(sequential.build(source, source + ".seq", options)) << sequential.getErrorMessage();
+
+    options.threadCount = 8;
+    XmlRecordIndex parallel;
+    ASSERT_TRUE(parallel.build(source, source + ".par", options)) << parallel.getErrorMessage();
+    ASSERT_EQ(parallel.getRecordCount(), sequential.getRecordCount());
+
+    for (uint64_t ordinal = 0; ordinal < sequential.getRecordCount(); ordinal += 997) {
+        uint64_t begin1, end1, begin2, end2;
+        ASSERT_TRUE(sequential.findRecord(ordinal, begin1, end1));
+        ASSERT_TRUE(parallel.findRecord(ordinal, begin2, end2));
+        EXPECT_EQ(begin1, begin2);
+        EXPECT_EQ(end1, end2);
+    }
+
+    std::remove(source.c_str());
+    std::remove((source + ".seq").c_str());
+    std::remove((source + ".par").c_str());
+}
+
+TEST(XmlRecordIndexTest, ResumesCancelledBuild) {
+    std::string source = testing::TempDir() + "nexus_index_resume.xml";
+    std::string index = source + ".nxidx";
+    writeFile(source, makeXml(20000));
+
+    XmlRecordIndex::Options options;
+    options.keyAttribute = "id";
+    options.segmentBytes = 64 * 1024;
+
+    XmlRecordIndex recordIndex;
+    int checkpoints = 0;
+    recordIndex.setProgressCallback([&checkpoints](uint64_t, uint64_t) {
+        return ++checkpoints < 3;
+    });
+    EXPECT_FALSE(recordIndex.build(source, index, options));
+
+    XmlRecordIndex unfinished;
+    EXPECT_FALSE(unfinished.load(source, index));
+
+    uint64_t firstProgress = 0;
+    recordIndex.setProgressCallback([&firstProgress](uint64_t bytesDone, uint64_t) {
+        if (firstProgress == 0) firstProgress = bytesDone;
+        return true;
+    });
+    ASSERT_TRUE(recordIndex.build(source, index, options)) << recordIndex.getErrorMessage();
+    // The first checkpoint of the resumed build is past the three already saved
+    EXPECT_GT(firstProgress, 3 * options.segmentBytes);
+    EXPECT_EQ(recordIndex.getRecordCount(), 20000u);
+    EXPECT_EQ(recordIndex.findByKey("k999").size(), 20u);
+    auto record = recordIndex.readRecord(19999);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->getAttribute("n"), "19999");
+
+    // Changing the source makes the index stale
+    writeFile(source, makeXml(10));
+    XmlRecordIndex stale;
+    EXPECT_FALSE(stale.load(source, index));
+
+    std::remove(source.c_str());
+    std::remove(index.c_str());
+}
+
+TEST(XmlRecordIndexTest, RejectsDamagedIndex) {
+    std::string source = testing::TempDir() + "nexus_index_damaged.xml";
+    std::string index = source + ".nxidx";
+    std::string copy = index + ".good";
+    writeFile(source, makeXml(100));
+
+    // 128-byte header, then an offset block of two entries (ordinals 0 and
+    // 64) and a key block
+    XmlRecordIndex::Options options;
+    options.keyAttribute = "id";
+    options.stride = 64;
+    XmlRecordIndex recordIndex;
+    ASSERT_TRUE(recordIndex.build(source, index, options)) << recordIndex.getErrorMessage();
+    std::filesystem::copy_file(index, copy, std::filesystem::copy_options::overwrite_existing);
+    const uint64_t firstOrdinal = 128 + 16;
+    const uint64_t firstOffset = firstOrdinal + 8;
+    const uint64_t firstKeyLength = 128 + 16 + 32 + 16 + 8;
+
+    struct Damage {
+        uint64_t offset;
+        uint64_t value;
+    };
+    for (Damage damage : {Damage{firstKeyLength, 1ull << 60}, Damage{firstOffset, 1ull << 40},
+                          Damage{firstOffset, 0}, Damage{firstOrdinal, 1}, Damage{128 + 8, 1ull << 59}}) {
+        std::filesystem::copy_file(copy, index, std::filesystem::copy_options::overwrite_existing);
+        patchU64(index, damage.offset, damage.value);
+        XmlRecordIndex damaged;
+        EXPECT_FALSE(damaged.load(source, index)) << damage.offset;
+        EXPECT_EQ(damaged.getErrorMessage(), "The record index is corrupt");
+    }
+
+    std::remove(source.c_str());
+    std::remove(index.c_str());
+    std::remove(copy.c_str());
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "xml_schema_profiler.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+// Large enough for profileFile() to take the parallel path
+std::string makeCatalog(int books) {
+    std::string xml = "<?xml version=\"1.0\"?>\n<catalog version=\"2\">\n";
+    for (int i = 0; i < books; ++i) {
+        xml += "  <book id=\"" + std::to_string(i) + "\" available=\"" + (i % 2 ? "true" : "false") + "\">";
+        xml += "<title>Title " + std::to_string(i % 50) + "</title>";
+        xml += "<price>" + std::to_string(i % 100) + ".5</price>";
+        if (i % 4 == 0) {
+            xml += "<author>A</author><author>B</author>";
+        }
+        xml += "<published>2020-01-" + std::string(i % 28 < 9 ? "0" : "") + std::to_string(i % 28 + 1) +
+               "</published></book>\n";
+    }
+    xml += "</catalog>\n";
+    return xml;
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << content;
+}
+
+} // namespace
+
+TEST(XmlSchemaProfilerTest, CountsOccurrencesAndTypes) {
+    XmlSchemaProfiler profiler;
+    ASSERT_TRUE(profiler.profileString(makeCatalog(100))) << profiler.getErrorMessage();
+    const XmlSchemaProfiler::Profile& profile = profiler.getProfile();
+
+    EXPECT_EQ(profile.rootPath, "/catalog");
+    EXPECT_EQ(profile.elementCount, 1u + 100u * 4u + 25u * 2u);
+    ASSERT_EQ(profile.depthHistogram.size(), 3u);
+    EXPECT_EQ(profile.depthHistogram[0], 1u);
+    EXPECT_EQ(profile.depthHistogram[1], 100u);
+
+    const auto& book = profile.elements.at("/catalog/book");
+    EXPECT_EQ(book.count, 100u);
+    EXPECT_EQ(book.attributes.at("id").typeName(), "integer");
+    EXPECT_EQ(book.attributes.at("available").typeName(), "boolean");
+    EXPECT_EQ(book.children, (std::vector<std::string>{"title", "price", "author", "published"}));
+    EXPECT_EQ(profile.minOccurs("/catalog/book"), 100u);
+    EXPECT_EQ(profile.maxOccurs("/catalog/book"), 100u);
+
+    EXPECT_EQ(profile.minOccurs("/catalog/book/author"), 0u);
+    EXPECT_EQ(profile.maxOccurs("/catalog/book/author"), 2u);
+    EXPECT_EQ(profile.minOccurs("/catalog/book/title"), 1u);
+
+    const auto& price = profile.elements.at("/catalog/book/price");
+    EXPECT_EQ(price.text.typeName(), "decimal");
+    EXPECT_DOUBLE_EQ(price.text.minNumber, 0.5);
+    EXPECT_DOUBLE_EQ(price.text.maxNumber, 99.5);
+    EXPECT_EQ(profile.elements.at("/catalog/book/published").text.typeName(), "date");
+
+    const auto& title = profile.elements.at("/catalog/book/title").text;
+    EXPECT_EQ(title.samples.size(), XmlSchemaProfiler::kMaxDistinctValues);
+    EXPECT_TRUE(title.truncatedSamples);
+    EXPECT_EQ(title.samples[0].first, "Title 0");
+    EXPECT_EQ(title.samples[0].second, 2u);
+}
+
+TEST(XmlSchemaProfilerTest, ParallelFileMatchesSequential) {
+    const std::string xml = makeCatalog(40000);
+    const std::string path = "schema_profiler_test.xml";
+    writeFile(path, xml);
+
+    XmlSchemaProfiler sequential;
+    ASSERT_TRUE(sequential.profileString(xml));
+    XmlSchemaProfiler parallel;
+    parallel.setThreadCount(4);
+    ASSERT_TRUE(parallel.profileFile(path)) << parallel.getErrorMessage();
+    std::remove(path.c_str());
+
+    const auto& a = sequential.getProfile();
+    const auto& b = parallel.getProfile();
+    EXPECT_EQ(a.elementCount, b.elementCount);
+    EXPECT_EQ(a.depthHistogram, b.depthHistogram);
+    ASSERT_EQ(a.elements.size(), b.elements.size());
+    for (const auto& item : a.elements) {
+        const auto& other = b.elements.at(item.first);
+        EXPECT_EQ(item.second.count, other.count) << item.first;
+        EXPECT_EQ(item.second.children, other.children) << item.first;
+        EXPECT_EQ(a.minOccurs(item.first), b.minOccurs(item.first)) << item.first;
+        EXPECT_EQ(a.maxOccurs(item.first), b.maxOccurs(item.first)) << item.first;
+        EXPECT_EQ(item.second.text.typeName(), other.text.typeName()) << item.first;
+        EXPECT_EQ(item.second.text.count, other.text.count) << item.first;
+    }
+    EXPECT_EQ(sequential.toXsd(), parallel.toXsd());
+}
+
+TEST(XmlSchemaProfilerTest, WritesXsdDraft) {
+    XmlSchemaProfiler profiler;
+    ASSERT_TRUE(profiler.profileString(
+        "<root xmlns:x=\"urn:x\"><item code=\"a\">1</item><item>2<b/></item><note/></root>"));
+    const std::string xsd = profiler.toXsd();
+
+    EXPECT_NE(xsd.find("<xs:element name=\"root\">"), std::string::npos) << xsd;
+    EXPECT_NE(xsd.find("<xs:element name=\"item\" maxOccurs=\"unbounded\">"), std::string::npos) << xsd;
+    EXPECT_NE(xsd.find("<xs:complexType mixed=\"true\">"), std::string::npos) << xsd;
+    EXPECT_NE(xsd.find("<xs:element name=\"b\" type=\"xs:string\" minOccurs=\"0\"/>"), std::string::npos) << xsd;
+    EXPECT_NE(xsd.find("<xs:attribute name=\"code\" type=\"xs:string\"/>"), std::string::npos) << xsd;
+    EXPECT_EQ(xsd.find("name=\"xmlns"), std::string::npos) << xsd;
+
+    EXPECT_FALSE(profiler.profileString("<a><b></a>"));
+    EXPECT_TRUE(profiler.hasError());
+}
@@ -93,4 +93,119 @@ TEST_F(XmlSerializerTest, FormatConversion) {
     // Both should contain the root element name
     EXPECT_NE(json.find("root"), std::string::npos);
     EXPECT_NE(yaml.find("root"), std::string::npos);
-} 
\ No newline at end of file
+} 
+TEST_F(XmlSerializerTest, ParallelMatchesSerial) {
+    auto root = std::make_shared<XmlNode>("records");
+    for (int i = 0; i < 3000; ++i) {
+        auto record = std::make_shared<XmlNode>("record");
+        root->addChild(record);
+        record->addAttribute("id", std::to_string(i));
+        auto name = std::make_shared<XmlNode>("name");
+        record->addChild(name);
+        auto text = std::make_shared<XmlNode>("", XmlNode::NodeType::Text);
+        text->setValue("item <" + std::to_string(i) + ">");
+        name->addChild(text);
+    }
+    
+    const XmlSerializer::Format formats[] = {
+        XmlSerializer::Format::XML, XmlSerializer::Format::JSON, XmlSerializer::Format::YAML};
+    const XmlSerializer::OutputStyle styles[] = {
+        XmlSerializer::OutputStyle::Compact, XmlSerializer::OutputStyle::Pretty,
+        XmlSerializer::OutputStyle::Minified};
+    
+    for (auto format : formats) {
+        for (auto style : styles) {
+            std::string serial = serializer_.serialize(root, format, style);
+            EXPECT_EQ(serializer_.serializeParallel(root, format, style, 4), serial);
+            EXPECT_EQ(serializer_.serializeParallel(root, format, style, 3), serial);
+        }
+    }
+}
+
+TEST_F(XmlSerializerTest, EscapesSpecialCharactersOnce) {
+    auto root = std::make_shared<XmlNode>("root");
+    root->addAttribute("title", "a \"b\" & <c>");
+    
+    std::string xml = serializer_.serializeToXml(root, XmlSerializer::OutputStyle::Compact);
+    EXPECT_EQ(xml, "<root title=\"a &quot;b&quot; &amp; &lt;c&gt;\" />");
+    
+    std::string json = serializer_.serializeToJson(root, XmlSerializer::OutputStyle::Compact);
+    EXPECT_NE(json.find("\"title\": \"a \\\"b\\\" & <c>\""), std::string::npos);
+}
+
+TEST_F(XmlSerializerTest, IncrementalMatchesFullAfterEdits) {
+    auto root = std::make_shared<XmlNode>("records");
+    std::vector<std::shared_ptr<XmlNode>> names;
+    for (int i = 0; i < 200; ++i) {
+        auto record = std::make_shared<XmlNode>("record");
+        root->addChild(record);
+        record->addAttribute("id", std::to_string(i));
+        auto name = std::make_shared<XmlNode>("name");
+        record->addChild(name);
+        auto detail = std::make_shared<XmlNode>("detail");
+        name->addChild(detail);
+        detail->addAttribute("n", std::to_string(i));
+        names.push_back(name);
+    }
+    
+    const XmlSerializer::Format formats[] = {
+        XmlSerializer::Format::XML, XmlSerializer::Format::JSON, XmlSerializer::Format::YAML};
+    
+    for (auto format : formats) {
+        EXPECT_EQ(serializer_.serializeIncremental(root, format), serializer_.serialize(root, format));
+    }
+    
+    // A deep edit bumps the revision of every ancestor but not of the siblings
+    uint64_t rootRevision = root->getRevision();
+    uint64_t siblingRevision = root->getChildren()[8]->getRevision();
+    names[7]->getChildren()[0]->addAttribute("edited", "yes");
+    names[150]->setName("label");
+    root->getChildren()[42]->addChild(std::make_shared<XmlNode>("extra"));
+    EXPECT_GT(root->getRevision(), rootRevision);
+    EXPECT_EQ(root->getChildren()[8]->getRevision(), siblingRevision);
+    
+    for (auto format : formats) {
+        std::string incremental = serializer_.serializeIncremental(root, format, XmlSerializer::OutputStyle::Compact);
+        EXPECT_EQ(incremental, serializer_.serialize(root, format, XmlSerializer::OutputStyle::Compact));
+        EXPECT_EQ(serializer_.serializeIncremental(root, format), serializer_.serialize(root, format));
+    }
+    
+    // Moving a cached subtree to another depth must not reuse its old indentation
+    auto moved = root->getChildren()[3];
+    root->removeChild(moved);
+    root->getChildren()[0]->addChild(moved);
+    EXPECT_EQ(serializer_.serializeIncremental(root, XmlSerializer::Format::JSON),
+              serializer_.serialize(root, XmlSerializer::Format::JSON));
+}
+
+TEST_F(XmlSerializerTest, BinaryFormatsRoundTrip) {
+    auto leaf = std::make_shared<XmlNode>("a");
+    EXPECT_EQ(serializer_.serializeToCbor(leaf), std::string("\xa1\x65@name\x61" "a"));
+    EXPECT_EQ(serializer_.serializeToMessagePack(leaf), std::string("\x81\xa5@name\xa1" "a"));
+    
+    auto root = std::make_shared<XmlNode>("records");
+    root->addAttribute("source", "test");
+    for (int i = 0; i < 40; ++i) {
+        auto record = std::make_shared<XmlNode>("record");
+        root->addChild(record);
+        record->addAttribute("id", std::to_string(i));
+        auto name = std::make_shared<XmlNode>("name");
+        record->addChild(name);
+        name->setValue(std::string(i * 10, 'x'));
+    }
+    
+    std::string json = serializer_.serializeToJson(root);
+    for (auto format : {XmlSerializer::Format::CBOR, XmlSerializer::Format::MessagePack}) {
+        std::string bytes = serializer_.serialize(root, format);
+        EXPECT_LT(bytes.size(), json.size());
+        auto decoded = (format == XmlSerializer::Format::CBOR)
+                           ? serializer_.deserializeFromCbor(bytes)
+                           : serializer_.deserializeFromMessagePack(bytes);
+        ASSERT_NE(decoded, nullptr);
+        EXPECT_EQ(serializer_.serializeToJson(decoded), json);
+        
+        // Truncated input is rejected rather than half-decoded
+        EXPECT_EQ(serializer_.deserializeFromCbor(bytes.substr(0, bytes.size() / 2)), nullptr);
+        EXPECT_EQ(serializer_.deserializeFromMessagePack(bytes.substr(0, bytes.size() / 2)), nullptr);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "xml_splitter.h"
+#include "xml_record_scanner.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+std::string makeXml(int records) {
+    std::string xml = "<?xml version=\"1.0\"?>\n<!-- export -->\n<catalog version=\"2\">\n";
+    for (int i = 0; i < records; ++i) {
+        xml += "  <item id=\"" + std::to_string(i) + "\" note=\"a > b\"><name>Item " +
+               std::to_string(i) + "</name><![CDATA[</item>]]></item>\n";
+    }
+    xml += "</catalog>\n";
+    return xml;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream output(path, std::ios::binary);
+    output << content;
+}
+
+} // namespace
+
+TEST(XmlSplitterTest, ScannerFindsRecordsPastTrickyMarkup) {
+    std::string xml = "<?xml version=\"1.0\"?><!DOCTYPE r [<!ENTITY e \"<x>\">]>"
+                      "<r><a t='>'/><!-- <b> --><b><?pi <c>?><c/></b>text</r><!-- end -->";
+    XmlRecordScanner scanner(xml.data(), xml.size());
+    ASSERT_TRUE(scanner.scanLayout()) << scanner.getErrorMessage();
+    EXPECT_EQ(scanner.layout().rootName, "r");
+
+    std::vector<std::string> records;
+    size_t pos = scanner.layout().contentBegin;
+    size_t begin = 0;
+    size_t end = 0;
+    while (scanner.nextRecord(pos, begin, end)) {
+        records.push_back(xml.substr(begin, end - begin));
+    }
+    EXPECT_FALSE(scanner.hasError());
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0], "<a t='>'/>");
+    EXPECT_EQ(records[1], "<b><?pi <c>?><c/></b>");
+}
+
+TEST(XmlSplitterTest, SplitByRecordCountAndMergeRoundTrip) {
+    std::string xml = makeXml(1000);
+    std::string input = testing::TempDir() + "nexus_split_input.xml";
+    std::string directory = testing::TempDir() + "nexus_split_records";
+    writeFile(input, xml);
+
+    XmlSplitter splitter;
+    splitter.setThreadCount(4);
+    ASSERT_TRUE(splitter.splitByRecordCount(input, directory, 300)) << splitter.getErrorMessage();
+    EXPECT_EQ(splitter.getRecordCount(), 1000u);
+    std::vector<std::string> shards = splitter.getOutputFiles();
+    ASSERT_EQ(shards.size(), 4u);
+    EXPECT_EQ(std::filesystem::path(shards[0]).filename(), "nexus_split_input.part-0001.xml");
+
+    // Each shard is a complete document with its share of the records
+    std::string last = readFile(shards[3]);
+    EXPECT_EQ(last.rfind("<?xml version=\"1.0\"?>\n<!-- export -->\n<catalog version=\"2\">\n", 0), 0u);
+    EXPECT_NE(last.find("<item id=\"900\""), std::string::npos);
+    EXPECT_EQ(last.find("<item id=\"899\""), std::string::npos);
+
+    std::string merged = testing::TempDir() + "nexus_split_merged.xml";
+    ASSERT_TRUE(splitter.merge(shards, merged)) << splitter.getErrorMessage();
+    EXPECT_EQ(splitter.getRecordCount(), 1000u);
+    EXPECT_EQ(readFile(merged), xml);
+
+    std::filesystem::remove_all(directory);
+    std::remove(input.c_str());
+    std::remove(merged.c_str());
+}
+
+TEST(XmlSplitterTest, SplitBySizeKeepsShardsUnderLimit) {
+    std::string xml = makeXml(2000);
+    std::string input = testing::TempDir() + "nexus_split_size.xml";
+    std::string directory = testing::TempDir() + "nexus_split_size";
+    writeFile(input, xml);
+
+    XmlSplitter splitter;
+    const uint64_t limit = 10000;
+    ASSERT_TRUE(splitter.splitBySize(input, directory, limit)) << splitter.getErrorMessage();
+    ASSERT_GT(splitter.getOutputFiles().size(), 1u);
+
+    std::vector<std::string> shards = splitter.getOutputFiles();
+    for (const std::string& shard : shards) {
+        EXPECT_LE(readFile(shard).size(), limit);
+    }
+
+    std::string merged = testing::TempDir() + "nexus_split_size_merged.xml";
+    ASSERT_TRUE(splitter.merge(shards, merged)) << splitter.getErrorMessage();
+    EXPECT_EQ(readFile(merged), xml);
+    std::remove(merged.c_str());
+
+    std::filesystem::remove_all(directory);
+    std::remove(input.c_str());
+}
+
+TEST(XmlSplitterTest, ReportsErrors) {
+    std::string input = testing::TempDir() + "nexus_split_bad.xml";
+    writeFile(input, "<root><a><b></a>");
+
+    XmlSplitter splitter;
+    EXPECT_FALSE(splitter.splitByRecordCount(input, testing::TempDir() + "nexus_split_bad", 1));
+    EXPECT_TRUE(splitter.hasError());
+
+    std::string other = testing::TempDir() + "nexus_split_other.xml";
+    writeFile(input, "<root><a/></root>");
+    writeFile(other, "<feed><a/></feed>");
+    EXPECT_FALSE(splitter.merge({input, other}, testing::TempDir() + "nexus_split_out.xml"));
+    EXPECT_NE(splitter.getErrorMessage().find("<feed>"), std::string::npos);
+
+    std::remove(input.c_str());
+    std::remove(other.c_str());
+}
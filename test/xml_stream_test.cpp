@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "xml_stream_reader.h"
+#include "xml_stream_converter.h"
+#include "xml_serializer.h"
+#include "xml_parser.h"
+#include <sstream>
+
+TEST(XmlStreamReaderTest, TokenizesElementsAndText) {
+    std::istringstream input("<?xml version=\"1.0\"?><root a=\"1 &amp; 2\"><item/><!-- c --><b>x &lt; y</b></root>");
+    // Tiny chunks force tokens to straddle buffer refills
+    XmlStreamReader reader(input, 16);
+
+    EXPECT_EQ(reader.next(), XmlStreamReader::TokenType::ProcessingInstruction);
+    EXPECT_EQ(reader.name(), "xml");
+
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::StartElement);
+    EXPECT_EQ(reader.name(), "root");
+    EXPECT_EQ(reader.depth(), 0);
+    EXPECT_EQ(reader.attribute("a"), "1 & 2");
+
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::StartElement);
+    EXPECT_EQ(reader.name(), "item");
+    EXPECT_TRUE(reader.isEmptyElement());
+    EXPECT_EQ(reader.depth(), 1);
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::EndElement);
+    EXPECT_EQ(reader.name(), "item");
+
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::Comment);
+    EXPECT_EQ(reader.text(), " c ");
+
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::StartElement);
+    ASSERT_EQ(reader.next(), XmlStreamReader::TokenType::Text);
+    EXPECT_EQ(reader.text(), "x < y");
+    EXPECT_EQ(reader.depth(), 2);
+    EXPECT_EQ(reader.next(), XmlStreamReader::TokenType::EndElement);
+    EXPECT_EQ(reader.next(), XmlStreamReader::TokenType::EndElement);
+    EXPECT_EQ(reader.next(), XmlStreamReader::TokenType::EndDocument);
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST(XmlStreamReaderTest, ReportsMismatchedTags) {
+    std::istringstream input("<root><a></b></root>");
+    XmlStreamReader reader(input);
+
+    XmlStreamReader::TokenType token;
+    do {
+        token = reader.next();
+    } while (token != XmlStreamReader::TokenType::Error &&
+             token != XmlStreamReader::TokenType::EndDocument);
+
+    EXPECT_EQ(token, XmlStreamReader::TokenType::Error);
+    EXPECT_TRUE(reader.hasError());
+}
+
+TEST(XmlStreamConverterTest, MatchesDomExport) {
+    // Equivalent tree built by hand, one leaf value per record
+    auto root = std::make_shared<XmlNode>("catalog");
+    root->addAttribute("version", "2");
+    std::string xml = "<catalog version=\"2\">\n";
+    for (int i = 0; i < 50; ++i) {
+        auto book = std::make_shared<XmlNode>("book");
+        book->addAttribute("id", std::to_string(i));
+        book->addAttribute("lang", "en");
+        auto title = std::make_shared<XmlNode>("title");
+        title->setValue("Title \"" + std::to_string(i) + "\"");
+        book->addChild(title);
+        root->addChild(book);
+        xml += "  <book lang=\"en\" id=\"" + std::to_string(i) + "\">\n"
+               "    <title>Title &quot;" + std::to_string(i) + "&quot;</title>\n"
+               "  </book>\n";
+    }
+    xml += "</catalog>\n";
+
+    // The same document parsed keeps its text in Text children
+    XmlParser parser;
+    auto parsed = parser.parseString(xml);
+    ASSERT_NE(parsed, nullptr);
+
+    XmlSerializer serializer;
+    XmlStreamConverter converter;
+    for (auto format : {XmlSerializer::Format::JSON, XmlSerializer::Format::YAML}) {
+        for (auto style : {XmlSerializer::OutputStyle::Pretty,
+                           XmlSerializer::OutputStyle::Compact,
+                           XmlSerializer::OutputStyle::Minified}) {
+            std::istringstream input(xml);
+            std::ostringstream output;
+            ASSERT_TRUE(converter.convert(input, output, format, style)) << converter.getErrorMessage();
+            EXPECT_EQ(output.str(), serializer.serialize(root, format, style));
+            EXPECT_EQ(output.str(), serializer.serialize(parsed, format, style));
+        }
+    }
+    EXPECT_EQ(converter.getElementCount(), 101u);
+}
+
+TEST(XmlStreamConverterTest, WritesCsvRecords) {
+    std::istringstream input(
+        "<people>"
+        "<person id=\"1\"><name>Ann</name><address><city>Oslo</city></address></person>"
+        "<person id=\"2\"><name>Bob \"B\"</name></person>"
+        "</people>");
+    std::ostringstream output;
+
+    XmlStreamConverter converter;
+    ASSERT_TRUE(converter.convert(input, output, XmlSerializer::Format::CSV));
+    EXPECT_EQ(output.str(),
+              "\"@id\",\"name\",\"address.city\"\n"
+              "\"1\",\"Ann\",\"Oslo\"\n"
+              "\"2\",\"Bob \"\"B\"\"\",\"\"\n");
+}
+
+TEST(XmlStreamConverterTest, CancelsFromProgressCallback) {
+    std::string xml = "<root>";
+    while (xml.size() < 3 * XmlStreamConverter::kProgressInterval) {
+        xml += "<row value=\"0123456789\"/>";
+    }
+    xml += "</root>";
+
+    std::istringstream input(xml);
+    std::ostringstream output;
+    XmlStreamConverter converter;
+    converter.setProgressCallback([](uint64_t bytesRead) {
+        return bytesRead < XmlStreamConverter::kProgressInterval;
+    });
+
+    EXPECT_FALSE(converter.convert(input, output, XmlSerializer::Format::JSON));
+    EXPECT_TRUE(converter.hasError());
+}
+
+TEST(XmlStreamConverterTest, BinaryOutputDecodesToSameTree) {
+    std::string xml = "<log host=\"a\">";
+    for (int i = 0; i < 30; ++i) {
+        xml += "<entry level=\"info\"><msg>line " + std::to_string(i) + "</msg><tags><t>x</t><t>y</t></tags></entry>";
+    }
+    xml += "</log>";
+
+    XmlSerializer serializer;
+    XmlStreamConverter converter;
+    std::string expectedJson;
+    {
+        std::istringstream input(xml);
+        std::ostringstream output;
+        ASSERT_TRUE(converter.convert(input, output, XmlSerializer::Format::JSON));
+        expectedJson = output.str();
+    }
+
+    for (auto format : {XmlSerializer::Format::CBOR, XmlSerializer::Format::MessagePack}) {
+        std::istringstream input(xml);
+        std::ostringstream output;
+        ASSERT_TRUE(converter.convert(input, output, format)) << converter.getErrorMessage();
+        auto decoded = (format == XmlSerializer::Format::CBOR)
+                           ? serializer.deserializeFromCbor(output.str())
+                           : serializer.deserializeFromMessagePack(output.str());
+        ASSERT_NE(decoded, nullptr);
+        EXPECT_EQ(serializer.serializeToJson(decoded), expectedJson);
+    }
+}
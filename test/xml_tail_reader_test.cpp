@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "xml_tail_reader.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+void append(const std::string& path, const std::string& text) {
+    std::ofstream output(path, std::ios::binary | std::ios::app);
+    output << text;
+}
+
+void overwrite(const std::string& path, const std::string& text) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << text;
+}
+
+} // namespace
+
+TEST(XmlTailReaderTest, PicksUpAppendedRecords) {
+    std::string path = testing::TempDir() + "nexus_tail.xml";
+    overwrite(path, "<?xml version=\"1.0\"?>\n<log source=\"app\">\n  <event id=\"1\"/>\n  <event id=\"2\"><msg>hel");
+
+    XmlTailReader tail;
+    ASSERT_TRUE(tail.open(path));
+    XmlTailReader::Update update;
+    ASSERT_TRUE(tail.poll(update)) << tail.getErrorMessage();
+    ASSERT_NE(tail.rootNode(), nullptr);
+    EXPECT_EQ(tail.rootNode()->getName(), "log");
+    EXPECT_EQ(tail.rootNode()->getAttribute("source"), "app");
+    ASSERT_EQ(update.records.size(), 1u);
+    EXPECT_EQ(update.records[0]->getAttribute("id"), "1");
+    // The half-written record is held back
+    EXPECT_EQ(update.appendedText, "<?xml version=\"1.0\"?>\n<log source=\"app\">\n  <event id=\"1\"/>\n  ");
+
+    ASSERT_TRUE(tail.poll(update));
+    EXPECT_TRUE(update.records.empty());
+    EXPECT_TRUE(update.appendedText.empty());
+
+    append(path, "lo</msg></event>\n  <event id=\"3\"/>\n");
+    ASSERT_TRUE(tail.poll(update)) << tail.getErrorMessage();
+    ASSERT_EQ(update.records.size(), 2u);
+    EXPECT_EQ(update.records[0]->findChild("msg")->getChildren().at(0)->getValue(), "hello");
+    EXPECT_EQ(update.appendedText, "<event id=\"2\"><msg>hello</msg></event>\n  <event id=\"3\"/>\n");
+    EXPECT_EQ(tail.rootNode()->getChildren().size(), 3u);
+    EXPECT_EQ(tail.getRecordCount(), 3u);
+    EXPECT_FALSE(tail.isFinished());
+
+    append(path, "</log>\n");
+    ASSERT_TRUE(tail.poll(update));
+    EXPECT_TRUE(tail.isFinished());
+    EXPECT_EQ(update.appendedText, "</log>\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(XmlTailReaderTest, RestartsWhenFileIsTruncated) {
+    std::string path = testing::TempDir() + "nexus_tail_truncated.xml";
+    overwrite(path, "<log><event id=\"1\"/><event id=\"2\"/>");
+
+    XmlTailReader tail;
+    ASSERT_TRUE(tail.open(path));
+    XmlTailReader::Update update;
+    ASSERT_TRUE(tail.poll(update));
+    EXPECT_EQ(update.records.size(), 2u);
+
+    overwrite(path, "<log><event id=\"9\"/>");
+    ASSERT_TRUE(tail.poll(update));
+    EXPECT_TRUE(update.restarted);
+    ASSERT_EQ(update.records.size(), 1u);
+    EXPECT_EQ(update.records[0]->getAttribute("id"), "9");
+    EXPECT_EQ(tail.rootNode()->getChildren().size(), 1u);
+
+    std::remove(path.c_str());
+}
+
+TEST(XmlTailReaderTest, ReportsMalformedRecords) {
+    std::string path = testing::TempDir() + "nexus_tail_bad.xml";
+    overwrite(path, "<log><event><a></b></event>");
+
+    XmlTailReader tail;
+    ASSERT_TRUE(tail.open(path));
+    XmlTailReader::Update update;
+    EXPECT_FALSE(tail.poll(update));
+    EXPECT_TRUE(tail.hasError());
+
+    std::remove(path.c_str());
+}